@@ -0,0 +1,497 @@
+#include "AuthCredentials.h"
+#include "DownloadWorkerQueue.h"
+#include "JobTypes.h"
+#include "Log.h"
+#include "MockNexusServer.h"
+#include "NexusClient.h"
+
+#include <curl/curl.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+using Json   = nlohmann::json;
+using confy::bench::MockNexusServer;
+
+constexpr const char *kRepository = "bench-raw";
+constexpr const char *kVersion    = "1.0";
+constexpr const char *kBuildType  = "Release";
+
+struct BenchOptions
+{
+   std::string scenario{"all"};
+   std::size_t smallFiles{10000};
+   std::uint64_t smallBytes{4096};
+   std::size_t hugeFiles{3};
+   std::uint64_t hugeMiB{256};
+   std::uint64_t latencyMs{0};
+   std::uint64_t bandwidthKiBps{0};
+   std::size_t workers{6};
+   std::size_t repeat{1};
+   std::string outputFile;
+   std::string workDirectory;
+   bool keepFiles{false};
+};
+
+// One artifact download: what the mock serves below artifactPath and what
+// the bench expects to find in the target directory afterwards.
+struct ArtifactSpec
+{
+   std::string artifactPath;
+   std::size_t files{0};
+   std::uint64_t bytes{0};
+};
+
+struct RunResult
+{
+   bool ok{false};
+   std::string errorMessage;
+   double seconds{0.0};
+};
+
+std::string Usage()
+{
+   return "Usage: confy_bench [options]\n"
+          "\n"
+          "Downloads synthetic artifact trees from an in-process mock Nexus server and\n"
+          "prints the timings as JSON.\n"
+          "\n"
+          "Options:\n"
+          "  --scenario <name>       small-tree, huge-files, queue-small-tree,\n"
+          "                          queue-huge-files or all (default)\n"
+          "  --small-files <n>       Files in the small tree (default 10000)\n"
+          "  --small-bytes <n>       Size of each small file (default 4096)\n"
+          "  --huge-files <n>        Number of huge files (default 3)\n"
+          "  --huge-mib <n>          Size of each huge file in MiB (default 256)\n"
+          "  --latency-ms <n>        Delay added to every response (default 0)\n"
+          "  --bandwidth-kibps <n>   Per-connection limit in KiB/s (default unlimited)\n"
+          "  --workers <n>           DownloadWorkerQueue workers for queue-* (default 6)\n"
+          "  --repeat <n>            Runs per scenario (default 1)\n"
+          "  --work-dir <dir>        Download location (default <temp>/confy-bench)\n"
+          "  --output <file>         Write the JSON here instead of stdout\n"
+          "  --keep                  Keep the downloaded files\n";
+}
+
+bool ParseCount(const std::string &flag, const std::string &value, std::uint64_t &out, std::string &errorMessage)
+{
+   try {
+      std::size_t consumed = 0;
+      out                  = std::stoull(value, &consumed);
+      if (consumed == value.size()) {
+         return true;
+      }
+   } catch (const std::exception &) {
+   }
+   errorMessage = flag + " expects a non-negative number, got '" + value + "'";
+   return false;
+}
+
+bool ParseArguments(const std::vector<std::string> &args, BenchOptions &options, bool &showHelp, std::string &errorMessage)
+{
+   for (std::size_t i = 0; i < args.size(); ++i) {
+      const auto &flag = args[i];
+      if (flag == "-h" || flag == "--help") {
+         showHelp = true;
+         return true;
+      }
+      if (flag == "--keep") {
+         options.keepFiles = true;
+         continue;
+      }
+      if (i + 1 >= args.size()) {
+         errorMessage = "Missing value for " + flag;
+         return false;
+      }
+      const auto &value   = args[++i];
+      std::uint64_t count = 0;
+      if (flag == "--scenario") {
+         options.scenario = value;
+      } else if (flag == "--work-dir") {
+         options.workDirectory = value;
+      } else if (flag == "--output") {
+         options.outputFile = value;
+      } else if (!ParseCount(flag, value, count, errorMessage)) {
+         return false;
+      } else if (flag == "--small-files") {
+         options.smallFiles = static_cast<std::size_t>(count);
+      } else if (flag == "--small-bytes") {
+         options.smallBytes = count;
+      } else if (flag == "--huge-files") {
+         options.hugeFiles = static_cast<std::size_t>(count);
+      } else if (flag == "--huge-mib") {
+         options.hugeMiB = count;
+      } else if (flag == "--latency-ms") {
+         options.latencyMs = count;
+      } else if (flag == "--bandwidth-kibps") {
+         options.bandwidthKiBps = count;
+      } else if (flag == "--workers") {
+         options.workers = static_cast<std::size_t>(std::max<std::uint64_t>(count, 1));
+      } else if (flag == "--repeat") {
+         options.repeat = static_cast<std::size_t>(std::max<std::uint64_t>(count, 1));
+      } else {
+         errorMessage = "Unknown option '" + flag + "'";
+         return false;
+      }
+   }
+
+   static const std::vector<std::string> kScenarios = {
+       "all", "small-tree", "huge-files", "queue-small-tree", "queue-huge-files"};
+   if (std::find(kScenarios.begin(), kScenarios.end(), options.scenario) == kScenarios.end()) {
+      errorMessage = "Unknown scenario '" + options.scenario + "'";
+      return false;
+   }
+   return true;
+}
+
+// Small files are spread over directories of 100 so that listing the tree
+// takes as many browse requests as a real build output would.
+ArtifactSpec AddSmallTree(MockNexusServer &server,
+    const std::string &artifactPath,
+    std::size_t firstFile,
+    std::size_t fileCount,
+    std::uint64_t fileBytes)
+{
+   ArtifactSpec spec{artifactPath, fileCount, fileCount * fileBytes};
+   const auto prefix = artifactPath + "/" + kVersion + "/" + kBuildType + "/";
+   for (std::size_t i = firstFile; i < firstFile + fileCount; ++i) {
+      server.AddFile(prefix + "d" + std::to_string(i / 100) + "/f" + std::to_string(i) + ".bin", fileBytes);
+   }
+   return spec;
+}
+
+ArtifactSpec AddHugeFiles(MockNexusServer &server,
+    const std::string &artifactPath,
+    std::size_t firstFile,
+    std::size_t fileCount,
+    std::uint64_t fileBytes)
+{
+   ArtifactSpec spec{artifactPath, fileCount, fileCount * fileBytes};
+   const auto prefix = artifactPath + "/" + kVersion + "/" + kBuildType + "/";
+   for (std::size_t i = firstFile; i < firstFile + fileCount; ++i) {
+      server.AddFile(prefix + "huge" + std::to_string(i) + ".bin", fileBytes);
+   }
+   return spec;
+}
+
+std::uint64_t DirectoryBytes(const fs::path &directory, std::size_t &outFiles)
+{
+   std::uint64_t total = 0;
+   outFiles            = 0;
+   std::error_code ec;
+   for (fs::recursive_directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+      if (it->is_regular_file(ec)) {
+         total += it->file_size(ec);
+         ++outFiles;
+      }
+   }
+   return total;
+}
+
+bool VerifyDownloads(const std::vector<ArtifactSpec> &specs, const fs::path &targetRoot, std::string &errorMessage)
+{
+   for (const auto &spec : specs) {
+      std::size_t files       = 0;
+      const std::uint64_t got = DirectoryBytes(targetRoot / spec.artifactPath, files);
+      if (files != spec.files || got != spec.bytes) {
+         errorMessage = spec.artifactPath + ": expected " + std::to_string(spec.files) + " files/" +
+                        std::to_string(spec.bytes) + " bytes, found " + std::to_string(files) + "/" +
+                        std::to_string(got);
+         return false;
+      }
+   }
+   return true;
+}
+
+RunResult RunDirect(const MockNexusServer &server,
+    const confy::AuthCredentials &credentials,
+    const ArtifactSpec &spec,
+    const fs::path &targetRoot)
+{
+   confy::NexusClient client(credentials);
+   std::atomic<bool> cancel{false};
+   RunResult result;
+
+   const auto start = std::chrono::steady_clock::now();
+   result.ok        = client.DownloadArtifactTree(server.BrowseUrl(),
+       spec.artifactPath,
+       kVersion,
+       kBuildType,
+       (targetRoot / spec.artifactPath).string(),
+       {},
+       {},
+       cancel,
+       [](int, std::uint64_t, const std::string &) {},
+       result.errorMessage);
+   result.seconds   = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   return result;
+}
+
+// End to end through the worker queue, one job per artifact, the way the
+// progress dialog drives an Apply.
+RunResult RunQueue(const MockNexusServer &server,
+    const std::vector<ArtifactSpec> &specs,
+    std::size_t workers,
+    const fs::path &targetRoot)
+{
+   RunResult result;
+   const auto start = std::chrono::steady_clock::now();
+
+   confy::DownloadWorkerQueue queue(workers);
+   queue.Start();
+   std::uint64_t jobId = 1;
+   for (const auto &spec : specs) {
+      confy::NexusDownloadJob job;
+      job.jobId                = jobId;
+      job.componentIndex       = static_cast<std::size_t>(jobId - 1);
+      job.componentName        = spec.artifactPath;
+      job.componentDisplayName = spec.artifactPath;
+      job.repositoryUrl        = server.BrowseUrl();
+      job.artifactPath         = spec.artifactPath;
+      job.version              = kVersion;
+      job.buildType            = kBuildType;
+      job.targetDirectory      = (targetRoot / spec.artifactPath).string();
+      queue.Submit(confy::DownloadJob::FromArtifact(std::move(job)));
+      ++jobId;
+   }
+
+   std::size_t finished = 0;
+   result.ok            = true;
+   while (finished < specs.size()) {
+      confy::DownloadEvent event;
+      if (!queue.TryPopEvent(event)) {
+         std::this_thread::sleep_for(std::chrono::milliseconds(5));
+         continue;
+      }
+      if (event.type == confy::DownloadEventType::Completed) {
+         ++finished;
+      } else if (event.type == confy::DownloadEventType::Failed ||
+                 event.type == confy::DownloadEventType::Cancelled) {
+         ++finished;
+         result.ok = false;
+         if (result.errorMessage.empty()) {
+            result.errorMessage = "job " + std::to_string(event.jobId) + ": " + event.message;
+         }
+      }
+   }
+   queue.Stop();
+
+   result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   return result;
+}
+
+Json RunScenario(const std::string &name,
+    MockNexusServer &server,
+    const std::vector<ArtifactSpec> &specs,
+    const BenchOptions &options,
+    const fs::path &targetRoot,
+    const std::function<RunResult()> &run)
+{
+   std::size_t files   = 0;
+   std::uint64_t bytes = 0;
+   for (const auto &spec : specs) {
+      files += spec.files;
+      bytes += spec.bytes;
+   }
+
+   Json scenario;
+   scenario["name"]  = name;
+   scenario["files"] = files;
+   scenario["bytes"] = bytes;
+
+   std::vector<double> seconds;
+   std::uint64_t requests = 0;
+   std::string errorMessage;
+   for (std::size_t i = 0; i < options.repeat && errorMessage.empty(); ++i) {
+      std::error_code ec;
+      fs::remove_all(targetRoot, ec);
+      server.ResetCounters();
+
+      const auto result = run();
+      requests          = server.RequestCount();
+      if (!result.ok) {
+         errorMessage = result.errorMessage;
+      } else if (VerifyDownloads(specs, targetRoot, errorMessage)) {
+         seconds.push_back(result.seconds);
+      }
+      std::cerr << name << " run " << (i + 1) << "/" << options.repeat << ": "
+                << (errorMessage.empty() ? std::to_string(result.seconds) + " s" : "FAILED " + errorMessage)
+                << '\n';
+   }
+
+   scenario["ok"]             = errorMessage.empty();
+   scenario["error"]          = errorMessage;
+   scenario["runs"]           = seconds;
+   scenario["requestsPerRun"] = requests;
+   if (!seconds.empty()) {
+      std::sort(seconds.begin(), seconds.end());
+      const double best          = seconds.front();
+      scenario["bestSeconds"]    = best;
+      scenario["medianSeconds"]  = seconds[seconds.size() / 2];
+      scenario["mibPerSecond"]   = best > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / best : 0.0;
+      scenario["filesPerSecond"] = best > 0.0 ? static_cast<double>(files) / best : 0.0;
+   }
+
+   if (!options.keepFiles) {
+      std::error_code ec;
+      fs::remove_all(targetRoot, ec);
+   }
+   return scenario;
+}
+
+// DownloadWorkerQueue reads credentials from ~/.m2/settings.xml, so the
+// bench points the home directory at its own settings file.
+bool PrepareHome(const fs::path &homeDirectory, const std::string &settingsXml, std::string &errorMessage)
+{
+   std::error_code ec;
+   fs::create_directories(homeDirectory / ".m2", ec);
+   std::ofstream settings(homeDirectory / ".m2" / "settings.xml", std::ios::binary | std::ios::trunc);
+   settings << settingsXml;
+   if (!settings.good()) {
+      errorMessage = "Unable to write " + (homeDirectory / ".m2" / "settings.xml").string();
+      return false;
+   }
+#ifdef _WIN32
+   _putenv_s("USERPROFILE", homeDirectory.string().c_str());
+#else
+   setenv("HOME", homeDirectory.string().c_str(), 1);
+#endif
+   return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+   BenchOptions options;
+   bool showHelp = false;
+   std::string errorMessage;
+   if (!ParseArguments(std::vector<std::string>(argv + 1, argv + argc), options, showHelp, errorMessage)) {
+      std::cerr << errorMessage << "\n\n"
+                << Usage();
+      return 2;
+   }
+   if (showHelp) {
+      std::cout << Usage();
+      return 0;
+   }
+
+   confy::Log::SetLevel(confy::LogLevel::Warning);
+   curl_global_init(CURL_GLOBAL_DEFAULT);
+
+   confy::bench::MockNexusOptions serverOptions;
+   serverOptions.latency        = std::chrono::milliseconds(options.latencyMs);
+   serverOptions.bytesPerSecond = options.bandwidthKiBps * 1024;
+   MockNexusServer server(kRepository, serverOptions);
+
+   const std::uint64_t hugeBytes = options.hugeMiB * 1024 * 1024;
+   const auto smallTree          = AddSmallTree(server, "bench/small", 0, options.smallFiles, options.smallBytes);
+   const auto hugeTree           = AddHugeFiles(server, "bench/huge", 0, options.hugeFiles, hugeBytes);
+
+   // The queue scenarios split the same amount of data into one artifact
+   // per worker (small files) or per file (huge files).
+   std::vector<ArtifactSpec> queueSmall;
+   for (std::size_t j = 0, first = 0; j < options.workers; ++j) {
+      const auto count = options.smallFiles / options.workers + (j < options.smallFiles % options.workers ? 1 : 0);
+      queueSmall.push_back(
+          AddSmallTree(server, "bench/queue-small-" + std::to_string(j), first, count, options.smallBytes));
+      first += count;
+   }
+   std::vector<ArtifactSpec> queueHuge;
+   for (std::size_t j = 0; j < options.hugeFiles; ++j) {
+      queueHuge.push_back(AddHugeFiles(server, "bench/queue-huge-" + std::to_string(j), j, 1, hugeBytes));
+   }
+
+   if (!server.Start(errorMessage)) {
+      std::cerr << errorMessage << '\n';
+      return 1;
+   }
+
+   const fs::path workRoot   = options.workDirectory.empty() ? fs::temp_directory_path() / "confy-bench"
+                                                             : fs::path(options.workDirectory);
+   const fs::path targetRoot     = workRoot / "downloads";
+   const std::string settingsXml = "<settings><servers><server><id>" + server.HostPort() +
+                                   "</id><username>bench</username><password>bench</password>"
+                                   "</server></servers></settings>";
+
+   confy::AuthCredentials credentials;
+   if (!credentials.LoadFromM2SettingsXmlString(settingsXml, errorMessage) ||
+       !PrepareHome(workRoot / "home", settingsXml, errorMessage)) {
+      std::cerr << errorMessage << '\n';
+      return 1;
+   }
+
+   Json report;
+   report["config"] = {{"smallFiles", options.smallFiles},
+       {"smallBytes", options.smallBytes},
+       {"hugeFiles", options.hugeFiles},
+       {"hugeBytes", hugeBytes},
+       {"latencyMs", options.latencyMs},
+       {"bandwidthBytesPerSecond", serverOptions.bytesPerSecond},
+       {"workers", options.workers},
+       {"repeat", options.repeat}};
+   report["scenarios"] = Json::array();
+
+   const auto wanted = [&options](const std::string &name) {
+      return options.scenario == "all" || options.scenario == name;
+   };
+   if (wanted("small-tree")) {
+      report["scenarios"].push_back(RunScenario("small-tree", server, {smallTree}, options, targetRoot, [&]() {
+         return RunDirect(server, credentials, smallTree, targetRoot);
+      }));
+   }
+   if (wanted("huge-files") && options.hugeFiles > 0) {
+      report["scenarios"].push_back(RunScenario("huge-files", server, {hugeTree}, options, targetRoot, [&]() {
+         return RunDirect(server, credentials, hugeTree, targetRoot);
+      }));
+   }
+   if (wanted("queue-small-tree")) {
+      report["scenarios"].push_back(RunScenario("queue-small-tree", server, queueSmall, options, targetRoot, [&]() {
+         return RunQueue(server, queueSmall, options.workers, targetRoot);
+      }));
+   }
+   if (wanted("queue-huge-files") && options.hugeFiles > 0) {
+      report["scenarios"].push_back(RunScenario("queue-huge-files", server, queueHuge, options, targetRoot, [&]() {
+         return RunQueue(server, queueHuge, options.workers, targetRoot);
+      }));
+   }
+
+   server.Stop();
+   curl_global_cleanup();
+   if (!options.keepFiles) {
+      std::error_code ec;
+      fs::remove_all(workRoot / "home", ec);
+      fs::remove_all(targetRoot, ec);
+   }
+
+   bool allOk = true;
+   for (const auto &scenario : report["scenarios"]) {
+      allOk = allOk && scenario["ok"].get<bool>();
+   }
+
+   const auto serialized = report.dump(2) + "\n";
+   if (options.outputFile.empty()) {
+      std::cout << serialized;
+   } else {
+      std::ofstream output(options.outputFile, std::ios::binary | std::ios::trunc);
+      output << serialized;
+      if (!output.good()) {
+         std::cerr << "Unable to write " << options.outputFile << '\n';
+         return 1;
+      }
+   }
+   return allOk ? 0 : 1;
+}
@@ -0,0 +1,244 @@
+#include "ConfigLoader.h"
+#include "ConfigWriter.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+using Json   = nlohmann::json;
+
+// Opening a generated config should stay below this.
+constexpr double kTargetMilliseconds = 100.0;
+
+struct ConfigBenchOptions
+{
+   std::vector<std::size_t> componentCounts{10000, 50000, 100000};
+   std::size_t repeat{5};
+   std::string outputFile;
+};
+
+std::string Usage()
+{
+   return "Usage: confy_config_bench [options]\n"
+          "\n"
+          "Times ConfigLoader on generated configs of several sizes and prints the\n"
+          "results as JSON.\n"
+          "\n"
+          "Options:\n"
+          "  --components <list>     Component counts (default 10000,50000,100000)\n"
+          "  --repeat <n>            Runs per size and entry point (default 5)\n"
+          "  --output <file>         Write the JSON here instead of stdout\n";
+}
+
+bool ParseCount(const std::string &flag, const std::string &value, std::uint64_t &out, std::string &errorMessage)
+{
+   try {
+      std::size_t consumed = 0;
+      out                  = std::stoull(value, &consumed);
+      if (consumed == value.size()) {
+         return true;
+      }
+   } catch (const std::exception &) {
+   }
+   errorMessage = flag + " expects a non-negative number, got '" + value + "'";
+   return false;
+}
+
+bool ParseArguments(const std::vector<std::string> &args,
+    ConfigBenchOptions &options,
+    bool &showHelp,
+    std::string &errorMessage)
+{
+   for (std::size_t i = 0; i < args.size(); ++i) {
+      const auto &flag = args[i];
+      if (flag == "-h" || flag == "--help") {
+         showHelp = true;
+         return true;
+      }
+      if (i + 1 >= args.size()) {
+         errorMessage = "Missing value for " + flag;
+         return false;
+      }
+      const auto &value   = args[++i];
+      std::uint64_t count = 0;
+      if (flag == "--output") {
+         options.outputFile = value;
+      } else if (flag == "--components") {
+         options.componentCounts.clear();
+         std::stringstream stream(value);
+         std::string item;
+         while (std::getline(stream, item, ',')) {
+            if (!ParseCount(flag, item, count, errorMessage)) {
+               return false;
+            }
+            options.componentCounts.push_back(static_cast<std::size_t>(count));
+         }
+      } else if (flag == "--repeat") {
+         if (!ParseCount(flag, value, count, errorMessage)) {
+            return false;
+         }
+         options.repeat = static_cast<std::size_t>(std::max<std::uint64_t>(count, 1));
+      } else {
+         errorMessage = "Unknown option '" + flag + "'";
+         return false;
+      }
+   }
+   return true;
+}
+
+// Components cycle through source-only, artifact-only and both, with the
+// optional elements real configs use, so every lookup path is exercised.
+confy::ConfigModel GenerateConfig(std::size_t componentCount)
+{
+   confy::ConfigModel model;
+   model.version  = 1;
+   model.rootPath = "/work/products";
+   model.components.reserve(componentCount);
+   for (std::size_t i = 0; i < componentCount; ++i) {
+      const auto id = std::to_string(i);
+      confy::ComponentConfig component;
+      component.name        = "component_" + id;
+      component.displayName = "Component " + id;
+      component.path        = "%PATH%/group" + std::to_string(i % 50) + "/component_" + id;
+
+      if (i % 3 != 1) {
+         component.sourcePresent      = true;
+         component.source.enabled     = i % 2 == 0;
+         component.source.url         = "https://bitbucket.example.com/scm/prj/component_" + id + ".git";
+         component.source.branchOrTag = i % 5 == 0 ? "release/" + std::to_string(i % 7) + ".0" : "main";
+         component.source.shallow     = i % 4 != 0;
+         component.source.filter      = i % 6 == 0 ? "blob:none" : "";
+         if (i % 10 == 0) {
+            component.source.sparsePaths = {"libs/core", "tools"};
+         }
+         component.source.script = i % 8 == 0 ? "post_source.sh" : "";
+      }
+      if (i % 3 != 0) {
+         component.artifactPresent        = true;
+         component.artifact.enabled       = true;
+         component.artifact.url           = "https://nexus.example.com/#browse/browse:raw-hosted";
+         component.artifact.relativePath  = "products/component_" + id;
+         component.artifact.version       = std::to_string(1 + i % 9) + "." + std::to_string(i % 13) + ".0";
+         component.artifact.buildType     = i % 2 == 0 ? "Release" : "Debug";
+         component.artifact.regexIncludes = {"\\.dll$", "^bin/"};
+         component.artifact.regexExcludes = {"/tests?/"};
+      }
+      model.components.push_back(std::move(component));
+   }
+   return model;
+}
+
+Json Measure(const std::string &entryPoint,
+    std::size_t componentCount,
+    std::size_t bytes,
+    std::size_t repeat,
+    const std::function<confy::LoadResult()> &load)
+{
+   std::vector<double> milliseconds;
+   std::string errorMessage;
+   for (std::size_t i = 0; i < repeat && errorMessage.empty(); ++i) {
+      const auto start  = std::chrono::steady_clock::now();
+      const auto result = load();
+      const auto end    = std::chrono::steady_clock::now();
+      if (!result.success) {
+         errorMessage = result.errorMessage;
+      } else if (result.config.components.size() != componentCount) {
+         errorMessage = "loaded " + std::to_string(result.config.components.size()) + " components";
+      } else {
+         milliseconds.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+      }
+   }
+
+   Json scenario;
+   scenario["name"]       = entryPoint + "-" + std::to_string(componentCount);
+   scenario["entryPoint"] = entryPoint;
+   scenario["components"] = componentCount;
+   scenario["bytes"]      = bytes;
+   scenario["ok"]         = errorMessage.empty();
+   scenario["error"]      = errorMessage;
+   scenario["runsMs"]     = milliseconds;
+   if (!milliseconds.empty()) {
+      std::sort(milliseconds.begin(), milliseconds.end());
+      const double best        = milliseconds.front();
+      scenario["bestMs"]       = best;
+      scenario["medianMs"]     = milliseconds[milliseconds.size() / 2];
+      scenario["mibPerSecond"] = best > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / (best / 1000.0) : 0.0;
+      scenario["withinTarget"] = best <= kTargetMilliseconds;
+   }
+   std::cerr << scenario["name"].get<std::string>() << ": "
+             << (errorMessage.empty() ? std::to_string(milliseconds.front()) + " ms" : "FAILED " + errorMessage)
+             << '\n';
+   return scenario;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+   ConfigBenchOptions options;
+   bool showHelp = false;
+   std::string errorMessage;
+   if (!ParseArguments(std::vector<std::string>(argv + 1, argv + argc), options, showHelp, errorMessage)) {
+      std::cerr << errorMessage << "\n\n"
+                << Usage();
+      return 2;
+   }
+   if (showHelp) {
+      std::cout << Usage();
+      return 0;
+   }
+
+   Json report;
+   report["config"]    = {{"repeat", options.repeat}, {"targetMs", kTargetMilliseconds}};
+   report["scenarios"] = Json::array();
+
+   const confy::ConfigLoader loader;
+   const auto filePath = (fs::temp_directory_path() / "confy-config-bench.xml").string();
+   bool allOk          = true;
+   for (const auto componentCount : options.componentCounts) {
+      const auto model = GenerateConfig(componentCount);
+      const auto xml   = confy::SaveConfigToString(model);
+      const auto saved = confy::SaveConfigToFile(model, filePath);
+      if (!saved.success) {
+         std::cerr << saved.errorMessage << '\n';
+         return 1;
+      }
+
+      auto fromString = Measure("string", componentCount, xml.size(), options.repeat, [&]() {
+         return loader.LoadFromString(xml);
+      });
+      auto fromFile   = Measure("file", componentCount, xml.size(), options.repeat, [&]() {
+         return loader.LoadFromFile(filePath);
+      });
+      allOk = allOk && fromString["ok"].get<bool>() && fromFile["ok"].get<bool>();
+      report["scenarios"].push_back(std::move(fromString));
+      report["scenarios"].push_back(std::move(fromFile));
+   }
+   std::error_code ec;
+   fs::remove(filePath, ec);
+
+   const auto serialized = report.dump(2) + "\n";
+   if (options.outputFile.empty()) {
+      std::cout << serialized;
+   } else {
+      std::ofstream output(options.outputFile, std::ios::binary | std::ios::trunc);
+      output << serialized;
+      if (!output.good()) {
+         std::cerr << "Unable to write " << options.outputFile << '\n';
+         return 1;
+      }
+   }
+   return allOk ? 0 : 1;
+}
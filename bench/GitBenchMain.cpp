@@ -0,0 +1,733 @@
+#include "AuthCredentials.h"
+#include "GitClient.h"
+#include "Log.h"
+
+#include <nlohmann/json.hpp>
+#include <wx/init.h>
+#include <wx/log.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+using Json   = nlohmann::json;
+
+constexpr const char *kBranch = "main";
+// ls-remote calls per thread, so that spawn overhead dominates the timing.
+constexpr std::size_t kListingsPerThread = 10;
+
+struct GitBenchOptions
+{
+   std::size_t files{1000};
+   std::uint64_t fileBytes{4096};
+   std::size_t depth{20};
+   std::size_t submodules{2};
+   std::size_t refs{200};
+   std::vector<std::size_t> concurrency{1, 4, 8};
+   std::vector<std::string> modes{"shallow", "full", "mirror", "ls-remote"};
+   int gitJobs{0};
+   std::size_t repeat{1};
+   std::string outputFile;
+   std::string workDirectory;
+   bool keepFiles{false};
+};
+
+struct RunResult
+{
+   bool ok{false};
+   std::string errorMessage;
+   double seconds{0.0};
+};
+
+// CPU time and peak resident set of whatever ran a scenario: the forked
+// scenario process and every git process below it on POSIX, the bench
+// process alone on Windows.
+struct ResourceUsage
+{
+   double cpuSeconds{0.0};
+   std::uint64_t peakRssKiB{0};
+   bool includesChildProcesses{false};
+};
+
+std::string Usage()
+{
+   return "Usage: confy_git_bench [options]\n"
+          "\n"
+          "Generates local bare repositories and times GitClient clones and ref\n"
+          "listings against them through file:// URLs. Prints the results as JSON.\n"
+          "\n"
+          "Options:\n"
+          "  --files <n>             Files in the main repository (default 1000)\n"
+          "  --file-bytes <n>        Size of each file (default 4096)\n"
+          "  --depth <n>             Commits of history (default 20)\n"
+          "  --submodules <n>        Submodules of the main repository (default 2)\n"
+          "  --refs <n>              Extra branches and tags (default 200)\n"
+          "  --concurrency <list>    Parallel operations per scenario (default 1,4,8)\n"
+          "  --modes <list>          shallow, full, mirror, ls-remote (default all)\n"
+          "  --git-jobs <n>          GitCloneOptions::parallelJobs (default 0)\n"
+          "  --repeat <n>            Runs per scenario (default 1)\n"
+          "  --work-dir <dir>        Location of repositories and clones\n"
+          "                          (default <temp>/confy-git-bench)\n"
+          "  --output <file>         Write the JSON here instead of stdout\n"
+          "  --keep                  Keep the generated repositories and clones\n";
+}
+
+bool ParseCount(const std::string &flag, const std::string &value, std::uint64_t &out, std::string &errorMessage)
+{
+   try {
+      std::size_t consumed = 0;
+      out                  = std::stoull(value, &consumed);
+      if (consumed == value.size()) {
+         return true;
+      }
+   } catch (const std::exception &) {
+   }
+   errorMessage = flag + " expects a non-negative number, got '" + value + "'";
+   return false;
+}
+
+std::vector<std::string> SplitList(const std::string &value)
+{
+   std::vector<std::string> items;
+   std::stringstream stream(value);
+   std::string item;
+   while (std::getline(stream, item, ',')) {
+      if (!item.empty()) {
+         items.push_back(item);
+      }
+   }
+   return items;
+}
+
+bool ParseArguments(const std::vector<std::string> &args,
+    GitBenchOptions &options,
+    bool &showHelp,
+    std::string &errorMessage)
+{
+   for (std::size_t i = 0; i < args.size(); ++i) {
+      const auto &flag = args[i];
+      if (flag == "-h" || flag == "--help") {
+         showHelp = true;
+         return true;
+      }
+      if (flag == "--keep") {
+         options.keepFiles = true;
+         continue;
+      }
+      if (i + 1 >= args.size()) {
+         errorMessage = "Missing value for " + flag;
+         return false;
+      }
+      const auto &value   = args[++i];
+      std::uint64_t count = 0;
+      if (flag == "--work-dir") {
+         options.workDirectory = value;
+      } else if (flag == "--output") {
+         options.outputFile = value;
+      } else if (flag == "--modes") {
+         options.modes = SplitList(value);
+         for (const auto &mode : options.modes) {
+            if (mode != "shallow" && mode != "full" && mode != "mirror" && mode != "ls-remote") {
+               errorMessage = "Unknown mode '" + mode + "'";
+               return false;
+            }
+         }
+      } else if (flag == "--concurrency") {
+         options.concurrency.clear();
+         for (const auto &item : SplitList(value)) {
+            if (!ParseCount(flag, item, count, errorMessage)) {
+               return false;
+            }
+            options.concurrency.push_back(static_cast<std::size_t>(std::max<std::uint64_t>(count, 1)));
+         }
+      } else if (!ParseCount(flag, value, count, errorMessage)) {
+         return false;
+      } else if (flag == "--files") {
+         options.files = static_cast<std::size_t>(std::max<std::uint64_t>(count, 1));
+      } else if (flag == "--file-bytes") {
+         options.fileBytes = count;
+      } else if (flag == "--depth") {
+         options.depth = static_cast<std::size_t>(std::max<std::uint64_t>(count, 1));
+      } else if (flag == "--submodules") {
+         options.submodules = static_cast<std::size_t>(count);
+      } else if (flag == "--refs") {
+         options.refs = static_cast<std::size_t>(count);
+      } else if (flag == "--git-jobs") {
+         options.gitJobs = static_cast<int>(count);
+      } else if (flag == "--repeat") {
+         options.repeat = static_cast<std::size_t>(std::max<std::uint64_t>(count, 1));
+      } else {
+         errorMessage = "Unknown option '" + flag + "'";
+         return false;
+      }
+   }
+   return true;
+}
+
+std::string ShellQuote(const std::string &value)
+{
+#ifdef _WIN32
+   return "\"" + value + "\"";
+#else
+   std::string quoted = "'";
+   for (const char c : value) {
+      quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+   }
+   return quoted + "'";
+#endif
+}
+
+std::string FileUrl(const fs::path &path)
+{
+   auto generic = fs::absolute(path).generic_string();
+   if (!generic.empty() && generic.front() != '/') {
+      generic.insert(generic.begin(), '/');
+   }
+   return "file://" + generic;
+}
+
+bool RunShell(const std::string &command, std::string &errorMessage)
+{
+   if (std::system(command.c_str()) != 0) {
+      errorMessage = "Command failed: " + command;
+      return false;
+   }
+   return true;
+}
+
+bool ReadCommandOutput(const std::string &command, std::string &out, std::string &errorMessage)
+{
+#ifdef _WIN32
+   FILE *pipe = _popen(command.c_str(), "rb");
+#else
+   FILE *pipe = popen(command.c_str(), "r");
+#endif
+   if (!pipe) {
+      errorMessage = "Unable to run: " + command;
+      return false;
+   }
+   char buffer[256];
+   out.clear();
+   while (const auto read = std::fread(buffer, 1, sizeof(buffer), pipe)) {
+      out.append(buffer, read);
+   }
+#ifdef _WIN32
+   const int status = _pclose(pipe);
+#else
+   const int status = pclose(pipe);
+#endif
+   while (!out.empty() && (out.back() == '\n' || out.back() == '\r')) {
+      out.pop_back();
+   }
+   if (status != 0) {
+      errorMessage = "Command failed: " + command;
+      return false;
+   }
+   return true;
+}
+
+// Writes a git fast-import stream, which builds history far faster than
+// committing through a work tree.
+class FastImportWriter final
+{
+ public:
+   bool Open(const fs::path &bareRepository, std::string &errorMessage)
+   {
+      const auto init = "git -c init.defaultBranch=" + std::string(kBranch) + " init --quiet --bare " +
+                        ShellQuote(bareRepository.string());
+      if (!RunShell(init, errorMessage)) {
+         return false;
+      }
+      const auto command = "git -C " + ShellQuote(bareRepository.string()) + " fast-import --quiet";
+#ifdef _WIN32
+      pipe_ = _popen(command.c_str(), "wb");
+#else
+      pipe_ = popen(command.c_str(), "w");
+#endif
+      if (!pipe_) {
+         errorMessage = "Unable to run git fast-import";
+         return false;
+      }
+      return true;
+   }
+
+   void Write(const std::string &text) { std::fwrite(text.data(), 1, text.size(), pipe_); }
+
+   void WriteData(const std::string &payload)
+   {
+      Write("data " + std::to_string(payload.size()) + "\n");
+      Write(payload);
+      Write("\n");
+   }
+
+   bool Close(std::string &errorMessage)
+   {
+#ifdef _WIN32
+      const int status = _pclose(pipe_);
+#else
+      const int status = pclose(pipe_);
+#endif
+      pipe_ = nullptr;
+      if (status != 0) {
+         errorMessage = "git fast-import failed";
+         return false;
+      }
+      return true;
+   }
+
+ private:
+   FILE *pipe_{nullptr};
+};
+
+// Incompressible content, so pack sizes follow --file-bytes.
+std::string SyntheticContent(std::uint64_t seed, std::uint64_t size)
+{
+   std::string content(static_cast<std::size_t>(size), '\0');
+   std::uint64_t state = seed * 0x9E3779B97F4A7C15ULL + 1;
+   for (auto &c : content) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      c = static_cast<char>(state & 0xFF);
+   }
+   return content;
+}
+
+void WriteCommitHeader(FastImportWriter &writer, std::size_t mark, const std::string &message)
+{
+   writer.Write("commit refs/heads/" + std::string(kBranch) + "\nmark :" + std::to_string(mark) + "\n");
+   writer.Write("committer Bench <bench@example.com> " + std::to_string(1700000000 + mark * 60) + " +0000\n");
+   writer.WriteData(message);
+   if (mark > 1) {
+      writer.Write("from :" + std::to_string(mark - 1) + "\n");
+   }
+}
+
+void WriteFile(FastImportWriter &writer, const std::string &path, const std::string &content)
+{
+   writer.Write("M 100644 inline " + path + "\n");
+   writer.WriteData(content);
+}
+
+std::string FilePath(std::size_t index)
+{
+   return "src/d" + std::to_string(index / 100) + "/f" + std::to_string(index) + ".bin";
+}
+
+bool CreateSubmoduleRepository(const fs::path &bareRepository,
+    std::size_t index,
+    std::string &outCommit,
+    std::string &errorMessage)
+{
+   FastImportWriter writer;
+   if (!writer.Open(bareRepository, errorMessage)) {
+      return false;
+   }
+   WriteCommitHeader(writer, 1, "Submodule " + std::to_string(index));
+   for (std::size_t i = 0; i < 10; ++i) {
+      WriteFile(writer, "lib/f" + std::to_string(i) + ".bin", SyntheticContent(index * 1000 + i, 4096));
+   }
+   if (!writer.Close(errorMessage)) {
+      return false;
+   }
+   return ReadCommandOutput("git -C " + ShellQuote(bareRepository.string()) + " rev-parse refs/heads/" + kBranch,
+       outCommit,
+       errorMessage);
+}
+
+// The first commit adds every file and the submodules; each later commit
+// rewrites an equal share of the files, so history grows with --depth.
+// Extra refs alternate between branches and tags spread over the history.
+bool CreateMainRepository(const fs::path &root, const GitBenchOptions &options, std::string &errorMessage)
+{
+   std::vector<std::string> submoduleCommits;
+   for (std::size_t s = 0; s < options.submodules; ++s) {
+      std::string commit;
+      if (!CreateSubmoduleRepository(root / ("sub" + std::to_string(s) + ".git"), s, commit, errorMessage)) {
+         return false;
+      }
+      submoduleCommits.push_back(commit);
+   }
+
+   FastImportWriter writer;
+   if (!writer.Open(root / "main.git", errorMessage)) {
+      return false;
+   }
+
+   WriteCommitHeader(writer, 1, "Initial import");
+   for (std::size_t i = 0; i < options.files; ++i) {
+      WriteFile(writer, FilePath(i), SyntheticContent(i, options.fileBytes));
+   }
+   if (!submoduleCommits.empty()) {
+      std::string gitmodules;
+      for (std::size_t s = 0; s < submoduleCommits.size(); ++s) {
+         const auto name = "sub" + std::to_string(s);
+         gitmodules += "[submodule \"" + name + "\"]\n\tpath = external/" + name + "\n\turl = " +
+                       FileUrl(root / (name + ".git")) + "\n";
+         writer.Write("M 160000 " + submoduleCommits[s] + " external/" + name + "\n");
+      }
+      WriteFile(writer, ".gitmodules", gitmodules);
+   }
+
+   const std::size_t filesPerCommit = std::max<std::size_t>(1, options.files / options.depth);
+   for (std::size_t c = 2; c <= options.depth; ++c) {
+      WriteCommitHeader(writer, c, "Change " + std::to_string(c));
+      for (std::size_t k = 0; k < filesPerCommit; ++k) {
+         const auto index = ((c - 2) * filesPerCommit + k) % options.files;
+         WriteFile(writer, FilePath(index), SyntheticContent(c * options.files + index, options.fileBytes));
+      }
+   }
+
+   for (std::size_t r = 0; r < options.refs; ++r) {
+      const auto ref = r % 2 == 0 ? "refs/heads/feature/b" + std::to_string(r) : "refs/tags/v" + std::to_string(r);
+      writer.Write("reset " + ref + "\nfrom :" + std::to_string(1 + r % options.depth) + "\n\n");
+   }
+   return writer.Close(errorMessage);
+}
+
+template <typename Operation>
+RunResult RunConcurrently(std::size_t concurrency, Operation operation)
+{
+   std::vector<std::string> errors(concurrency);
+   std::vector<std::thread> threads;
+   const auto start = std::chrono::steady_clock::now();
+   for (std::size_t i = 0; i < concurrency; ++i) {
+      threads.emplace_back([&, i]() { operation(i, errors[i]); });
+   }
+   for (auto &thread : threads) {
+      thread.join();
+   }
+
+   RunResult result;
+   result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   result.ok      = true;
+   for (const auto &error : errors) {
+      if (!error.empty()) {
+         result.ok           = false;
+         result.errorMessage = error;
+         break;
+      }
+   }
+   return result;
+}
+
+// Runs one scenario `repeat` times. Called in the scenario process.
+Json RunScenario(const std::string &mode, std::size_t concurrency, const GitBenchOptions &options, const fs::path &root)
+{
+   const confy::GitClient client{confy::AuthCredentials{}};
+   const auto repositoryUrl = FileUrl(root / "main.git");
+   const auto cloneRoot     = root / "clones";
+   const auto expectedRefs  = options.refs + 1;
+
+   confy::GitCloneOptions cloneOptions;
+   cloneOptions.shallow      = mode == "shallow";
+   cloneOptions.parallelJobs = options.gitJobs;
+   if (mode == "mirror") {
+      cloneOptions.mirrorCacheDirectory = (root / "mirrors").string();
+   }
+
+   std::vector<double> seconds;
+   std::string errorMessage;
+   for (std::size_t run = 0; run < options.repeat && errorMessage.empty(); ++run) {
+      std::error_code ec;
+      fs::remove_all(cloneRoot, ec);
+
+      RunResult result;
+      if (mode == "ls-remote") {
+         result = RunConcurrently(concurrency, [&](std::size_t, std::string &error) {
+            for (std::size_t i = 0; i < kListingsPerThread && error.empty(); ++i) {
+               std::vector<std::string> refs;
+               if (!client.ListBranchesAndTags(repositoryUrl, refs, error)) {
+                  return;
+               }
+               if (refs.size() != expectedRefs) {
+                  error = "expected " + std::to_string(expectedRefs) + " refs, got " + std::to_string(refs.size());
+               }
+            }
+         });
+      } else {
+         result = RunConcurrently(concurrency, [&](std::size_t i, std::string &error) {
+            std::atomic<bool> cancel{false};
+            const auto target = cloneRoot / ("c" + std::to_string(i));
+            if (client.CloneRepository(repositoryUrl, kBranch, target.string(), cloneOptions, cancel, nullptr, error) &&
+                !fs::exists(target / FilePath(options.files - 1))) {
+               error = "clone " + target.string() + " is missing files";
+            }
+         });
+      }
+
+      if (result.ok) {
+         seconds.push_back(result.seconds);
+      } else {
+         errorMessage = result.errorMessage;
+      }
+   }
+
+   Json scenario;
+   scenario["ok"]    = errorMessage.empty();
+   scenario["error"] = errorMessage;
+   scenario["runs"]  = seconds;
+   return scenario;
+}
+
+void AddUsage(Json &scenario, const ResourceUsage &usage, std::size_t repeat)
+{
+   scenario["cpuSecondsPerRun"]       = usage.cpuSeconds / static_cast<double>(repeat);
+   scenario["peakRssKiB"]             = usage.peakRssKiB;
+   scenario["includesChildProcesses"] = usage.includesChildProcesses;
+}
+
+#ifdef _WIN32
+double FileTimeSeconds(const FILETIME &time)
+{
+   ULARGE_INTEGER value;
+   value.LowPart  = time.dwLowDateTime;
+   value.HighPart = time.dwHighDateTime;
+   return static_cast<double>(value.QuadPart) / 1e7;
+}
+
+double ProcessCpuSeconds()
+{
+   FILETIME creation;
+   FILETIME exit;
+   FILETIME kernel;
+   FILETIME user;
+   GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+   return FileTimeSeconds(kernel) + FileTimeSeconds(user);
+}
+
+// Without fork the scenario runs in the bench itself; git's own CPU time
+// and memory are not visible, and the peak covers the whole bench so far.
+Json MeasureScenario(const std::string &mode, std::size_t concurrency, const GitBenchOptions &options, const fs::path &root)
+{
+   const double cpuBefore = ProcessCpuSeconds();
+   auto scenario          = RunScenario(mode, concurrency, options, root);
+
+   ResourceUsage usage;
+   usage.cpuSeconds = ProcessCpuSeconds() - cpuBefore;
+   PROCESS_MEMORY_COUNTERS counters{};
+   if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+      usage.peakRssKiB = counters.PeakWorkingSetSize / 1024;
+   }
+   AddUsage(scenario, usage, options.repeat);
+   return scenario;
+}
+#else
+double TimevalSeconds(const timeval &time)
+{
+   return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_usec) / 1e6;
+}
+
+// Each scenario runs in a forked process so that wait4 reports the CPU
+// time and peak RSS of that scenario and all git processes it started,
+// untouched by earlier scenarios. The result comes back over a pipe.
+Json MeasureScenario(const std::string &mode, std::size_t concurrency, const GitBenchOptions &options, const fs::path &root)
+{
+   int fds[2];
+   if (pipe(fds) != 0) {
+      return Json{{"ok", false}, {"error", "pipe failed"}};
+   }
+
+   std::cout.flush();
+   std::cerr.flush();
+   const pid_t pid = fork();
+   if (pid < 0) {
+      close(fds[0]);
+      close(fds[1]);
+      return Json{{"ok", false}, {"error", "fork failed"}};
+   }
+   if (pid == 0) {
+      close(fds[0]);
+      const auto serialized = RunScenario(mode, concurrency, options, root).dump();
+      std::size_t written   = 0;
+      while (written < serialized.size()) {
+         const auto n = write(fds[1], serialized.data() + written, serialized.size() - written);
+         if (n <= 0) {
+            break;
+         }
+         written += static_cast<std::size_t>(n);
+      }
+      close(fds[1]);
+      confy::Log::Flush();
+      _exit(0);
+   }
+
+   close(fds[1]);
+   std::string serialized;
+   char buffer[4096];
+   ssize_t n = 0;
+   while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) {
+      serialized.append(buffer, static_cast<std::size_t>(n));
+   }
+   close(fds[0]);
+
+   int status = 0;
+   rusage resources{};
+   wait4(pid, &status, 0, &resources);
+
+   Json scenario = Json::parse(serialized, nullptr, false);
+   if (scenario.is_discarded() || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      scenario = Json{{"ok", false}, {"error", "scenario process failed"}, {"runs", Json::array()}};
+   }
+
+   ResourceUsage usage;
+   usage.cpuSeconds             = TimevalSeconds(resources.ru_utime) + TimevalSeconds(resources.ru_stime);
+   usage.peakRssKiB             = static_cast<std::uint64_t>(resources.ru_maxrss);
+   usage.includesChildProcesses = true;
+#ifdef __APPLE__
+   usage.peakRssKiB /= 1024;
+#endif
+   AddUsage(scenario, usage, options.repeat);
+   return scenario;
+}
+#endif
+
+void SetEnvironment(const char *name, const char *value)
+{
+#ifdef _WIN32
+   _putenv_s(name, value);
+#else
+   setenv(name, value, 1);
+#endif
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+   GitBenchOptions options;
+   bool showHelp = false;
+   std::string errorMessage;
+   if (!ParseArguments(std::vector<std::string>(argv + 1, argv + argc), options, showHelp, errorMessage)) {
+      std::cerr << errorMessage << "\n\n"
+                << Usage();
+      return 2;
+   }
+   if (showHelp) {
+      std::cout << Usage();
+      return 0;
+   }
+
+   wxInitializer wxInit;
+   if (!wxInit.IsOk()) {
+      std::cerr << "Failed to initialize the wx runtime\n";
+      return 1;
+   }
+   // GitClient reports each command through wxLog; keep that off stdout.
+   wxLog::SetActiveTarget(new wxLogStderr());
+   wxLog::SetLogLevel(wxLOG_Warning);
+   wxLog::DisableTimestamp();
+   confy::Log::SetLevel(confy::LogLevel::Warning);
+
+   // Submodules point at file:// URLs, which git refuses for submodules
+   // unless allowed. Passed through the environment so every git process
+   // the bench starts picks it up.
+   SetEnvironment("GIT_CONFIG_COUNT", "1");
+   SetEnvironment("GIT_CONFIG_KEY_0", "protocol.file.allow");
+   SetEnvironment("GIT_CONFIG_VALUE_0", "always");
+
+   const fs::path root = options.workDirectory.empty() ? fs::temp_directory_path() / "confy-git-bench"
+                                                       : fs::path(options.workDirectory);
+   std::error_code ec;
+   for (const auto *generated : {"main.git", "clones", "mirrors"}) {
+      fs::remove_all(root / generated, ec);
+   }
+   for (std::size_t s = 0; s < options.submodules; ++s) {
+      fs::remove_all(root / ("sub" + std::to_string(s) + ".git"), ec);
+   }
+   fs::create_directories(root, ec);
+
+   const auto generateStart = std::chrono::steady_clock::now();
+   if (!CreateMainRepository(root, options, errorMessage)) {
+      std::cerr << errorMessage << '\n';
+      return 1;
+   }
+   const double generateSeconds =
+       std::chrono::duration<double>(std::chrono::steady_clock::now() - generateStart).count();
+
+   Json report;
+   report["config"] = {{"files", options.files},
+       {"fileBytes", options.fileBytes},
+       {"depth", options.depth},
+       {"submodules", options.submodules},
+       {"refs", options.refs},
+       {"gitJobs", options.gitJobs},
+       {"repeat", options.repeat},
+       {"generateSeconds", generateSeconds}};
+   report["scenarios"] = Json::array();
+
+   bool allOk = true;
+   for (const auto &mode : options.modes) {
+      for (const auto concurrency : options.concurrency) {
+         fs::remove_all(root / "mirrors", ec);
+         auto scenario = MeasureScenario(mode, concurrency, options, root);
+
+         auto seconds = scenario["runs"].get<std::vector<double>>();
+         const auto operations =
+             mode == "ls-remote" ? concurrency * kListingsPerThread : concurrency;
+         scenario["name"]        = mode + "-c" + std::to_string(concurrency);
+         scenario["mode"]        = mode;
+         scenario["concurrency"] = concurrency;
+         scenario["operations"]  = operations;
+         if (!seconds.empty()) {
+            std::sort(seconds.begin(), seconds.end());
+            scenario["bestSeconds"]         = seconds.front();
+            scenario["medianSeconds"]       = seconds[seconds.size() / 2];
+            scenario["operationsPerSecond"] = seconds.front() > 0.0 ? operations / seconds.front() : 0.0;
+         }
+         allOk = allOk && scenario["ok"].get<bool>();
+
+         std::cerr << scenario["name"].get<std::string>() << ": "
+                   << (scenario["ok"].get<bool>() ? std::to_string(seconds.empty() ? 0.0 : seconds.front()) + " s"
+                                                  : "FAILED " + scenario["error"].get<std::string>())
+                   << '\n';
+         report["scenarios"].push_back(std::move(scenario));
+      }
+   }
+
+   if (!options.keepFiles) {
+      for (const auto *generated : {"main.git", "clones", "mirrors"}) {
+         fs::remove_all(root / generated, ec);
+      }
+      for (std::size_t s = 0; s < options.submodules; ++s) {
+         fs::remove_all(root / ("sub" + std::to_string(s) + ".git"), ec);
+      }
+   }
+
+   const auto serialized = report.dump(2) + "\n";
+   if (options.outputFile.empty()) {
+      std::cout << serialized;
+   } else {
+      std::ofstream output(options.outputFile, std::ios::binary | std::ios::trunc);
+      output << serialized;
+      if (!output.good()) {
+         std::cerr << "Unable to write " << options.outputFile << '\n';
+         return 1;
+      }
+   }
+   delete wxLog::SetActiveTarget(nullptr);
+   return allOk ? 0 : 1;
+}
@@ -0,0 +1,459 @@
+#include "MockNexusServer.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <utility>
+
+namespace confy::bench {
+
+namespace {
+
+#ifdef _WIN32
+using NativeSocket = SOCKET;
+#else
+using NativeSocket = int;
+#endif
+
+constexpr std::intptr_t kInvalidSocket = -1;
+constexpr std::size_t kSendChunkBytes  = 64 * 1024;
+constexpr std::size_t kMaxHeaderBytes  = 64 * 1024;
+
+NativeSocket ToNative(std::intptr_t socket)
+{
+   return static_cast<NativeSocket>(socket);
+}
+
+void CloseSocket(std::intptr_t socket)
+{
+#ifdef _WIN32
+   closesocket(ToNative(socket));
+#else
+   close(ToNative(socket));
+#endif
+}
+
+void ShutdownSocket(std::intptr_t socket)
+{
+#ifdef _WIN32
+   shutdown(ToNative(socket), SD_BOTH);
+#else
+   shutdown(ToNative(socket), SHUT_RDWR);
+#endif
+}
+
+int SendFlags()
+{
+#ifdef MSG_NOSIGNAL
+   return MSG_NOSIGNAL;
+#else
+   return 0;
+#endif
+}
+
+std::string DecodePercent(const std::string &value)
+{
+   std::string out;
+   out.reserve(value.size());
+   for (std::size_t i = 0; i < value.size(); ++i) {
+      if (value[i] == '%' && i + 2 < value.size()) {
+         const auto hex = value.substr(i + 1, 2);
+         char *end      = nullptr;
+         const long ch  = std::strtol(hex.c_str(), &end, 16);
+         if (end == hex.c_str() + 2) {
+            out.push_back(static_cast<char>(ch));
+            i += 2;
+            continue;
+         }
+      }
+      out.push_back(value[i]);
+   }
+   return out;
+}
+
+std::string EncodeSegment(const std::string &value)
+{
+   std::string out;
+   for (unsigned char c : value) {
+      if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' ||
+          c == '_' || c == '.' || c == '~' || c == '/') {
+         out.push_back(static_cast<char>(c));
+      } else {
+         constexpr char kHex[] = "0123456789ABCDEF";
+         out.push_back('%');
+         out.push_back(kHex[(c >> 4) & 0x0F]);
+         out.push_back(kHex[c & 0x0F]);
+      }
+   }
+   return out;
+}
+
+std::string StatusText(int status)
+{
+   switch (status) {
+   case 200:
+      return "OK";
+   case 400:
+      return "Bad Request";
+   case 404:
+      return "Not Found";
+   case 405:
+      return "Method Not Allowed";
+   default:
+      return "Error";
+   }
+}
+
+std::string ToLower(std::string value)
+{
+   std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) {
+      return static_cast<char>(std::tolower(c));
+   });
+   return value;
+}
+
+} // namespace
+
+MockNexusServer::MockNexusServer(std::string repository, MockNexusOptions options) :
+    repository_(std::move(repository)),
+    options_(options) {}
+
+MockNexusServer::~MockNexusServer()
+{
+   Stop();
+}
+
+void MockNexusServer::AddFile(const std::string &path, std::uint64_t sizeBytes)
+{
+   files_[path] = sizeBytes;
+
+   std::string parent;
+   std::size_t start = 0;
+   while (true) {
+      const auto slash = path.find('/', start);
+      if (slash == std::string::npos) {
+         children_[parent].insert(path.substr(start));
+         break;
+      }
+      const auto name = path.substr(start, slash - start + 1);
+      children_[parent].insert(name);
+      parent += name;
+      start = slash + 1;
+   }
+}
+
+bool MockNexusServer::Start(std::string &errorMessage)
+{
+#ifdef _WIN32
+   WSADATA wsaData;
+   if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+      errorMessage = "WSAStartup failed";
+      return false;
+   }
+#endif
+
+   const NativeSocket listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+   listenSocket_               = static_cast<std::intptr_t>(listener);
+   if (listenSocket_ == kInvalidSocket) {
+      errorMessage = "Unable to create listening socket";
+      return false;
+   }
+
+   const int reuse = 1;
+   setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+
+   sockaddr_in address{};
+   address.sin_family      = AF_INET;
+   address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   address.sin_port        = 0;
+   if (bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(listener, 128) != 0) {
+      errorMessage = "Unable to listen on 127.0.0.1";
+      CloseSocket(listenSocket_);
+      listenSocket_ = kInvalidSocket;
+      return false;
+   }
+
+   socklen_t addressLength = sizeof(address);
+   getsockname(listener, reinterpret_cast<sockaddr *>(&address), &addressLength);
+   port_ = ntohs(address.sin_port);
+
+   stopping_     = false;
+   acceptThread_ = std::thread([this]() { AcceptLoop(); });
+   return true;
+}
+
+void MockNexusServer::Stop()
+{
+   if (listenSocket_ == kInvalidSocket) {
+      return;
+   }
+
+   stopping_ = true;
+   ShutdownSocket(listenSocket_);
+   CloseSocket(listenSocket_);
+   listenSocket_ = kInvalidSocket;
+   if (acceptThread_.joinable()) {
+      acceptThread_.join();
+   }
+
+   std::unique_lock lock(connectionsMutex_);
+   for (const auto connection : openConnections_) {
+      ShutdownSocket(connection);
+   }
+   connectionsCv_.wait(lock, [this]() { return activeConnections_ == 0; });
+
+#ifdef _WIN32
+   WSACleanup();
+#endif
+}
+
+std::string MockNexusServer::HostPort() const
+{
+   return "127.0.0.1:" + std::to_string(port_);
+}
+
+std::string MockNexusServer::BaseUrl() const
+{
+   return "http://" + HostPort();
+}
+
+std::string MockNexusServer::BrowseUrl() const
+{
+   return BaseUrl() + "/#browse/browse:" + repository_;
+}
+
+void MockNexusServer::ResetCounters()
+{
+   requests_  = 0;
+   bytesSent_ = 0;
+}
+
+void MockNexusServer::AcceptLoop()
+{
+   while (!stopping_) {
+      const NativeSocket client = accept(ToNative(listenSocket_), nullptr, nullptr);
+      const auto connection     = static_cast<std::intptr_t>(client);
+      if (connection == kInvalidSocket) {
+         if (stopping_) {
+            break;
+         }
+         continue;
+      }
+
+      const int noDelay = 1;
+      setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&noDelay), sizeof(noDelay));
+
+      {
+         std::scoped_lock lock(connectionsMutex_);
+         openConnections_.insert(connection);
+         ++activeConnections_;
+      }
+      std::thread([this, connection]() {
+         ServeConnection(connection);
+         CloseSocket(connection);
+         std::scoped_lock lock(connectionsMutex_);
+         openConnections_.erase(connection);
+         --activeConnections_;
+         connectionsCv_.notify_all();
+      }).detach();
+   }
+}
+
+void MockNexusServer::ServeConnection(std::intptr_t socket)
+{
+   std::string buffer;
+   char chunk[4096];
+   while (!stopping_) {
+      auto headerEnd = buffer.find("\r\n\r\n");
+      while (headerEnd == std::string::npos) {
+         const auto received = recv(ToNative(socket), chunk, static_cast<int>(sizeof(chunk)), 0);
+         if (received <= 0 || buffer.size() > kMaxHeaderBytes) {
+            return;
+         }
+         buffer.append(chunk, static_cast<std::size_t>(received));
+         headerEnd = buffer.find("\r\n\r\n");
+      }
+
+      const std::string header = buffer.substr(0, headerEnd);
+      buffer.erase(0, headerEnd + 4);
+
+      std::istringstream lines(header);
+      std::string requestLine;
+      std::getline(lines, requestLine);
+      std::istringstream requestParts(requestLine);
+      std::string method;
+      std::string target;
+      std::string version;
+      requestParts >> method >> target >> version;
+
+      bool keepAlive = version == "HTTP/1.1";
+      std::string line;
+      while (std::getline(lines, line)) {
+         const auto lower = ToLower(line);
+         if (lower.rfind("connection:", 0) == 0) {
+            keepAlive = lower.find("close") == std::string::npos;
+         }
+      }
+
+      ++requests_;
+      if (options_.latency.count() > 0) {
+         std::this_thread::sleep_for(options_.latency);
+      }
+
+      Response response;
+      if (method != "GET" && method != "HEAD") {
+         response.status = 405;
+      } else {
+         response = Handle(method, target);
+      }
+      if (!SendResponse(socket, response, method == "HEAD", keepAlive) || !keepAlive) {
+         return;
+      }
+   }
+}
+
+MockNexusServer::Response MockNexusServer::Handle(const std::string &, const std::string &target) const
+{
+   auto path         = target.substr(0, target.find_first_of("?#"));
+   path              = DecodePercent(path);
+   const auto browse = "/service/rest/repository/browse/" + repository_ + "/";
+   const auto raw    = "/repository/" + repository_ + "/";
+
+   if (path + "/" == browse || path.rfind(browse, 0) == 0) {
+      auto directory = path.size() > browse.size() ? path.substr(browse.size()) : std::string();
+      if (!directory.empty() && directory.back() != '/') {
+         directory.push_back('/');
+      }
+      return BrowseListing(directory);
+   }
+
+   if (path.rfind(raw, 0) == 0) {
+      const auto it = files_.find(path.substr(raw.size()));
+      Response response;
+      if (it == files_.end()) {
+         response.status = 404;
+         return response;
+      }
+      response.contentType    = "application/octet-stream";
+      response.generated      = true;
+      response.generatedBytes = it->second;
+      return response;
+   }
+
+   Response response;
+   response.status = 404;
+   return response;
+}
+
+MockNexusServer::Response MockNexusServer::BrowseListing(const std::string &directory) const
+{
+   Response response;
+   const auto it = children_.find(directory);
+   if (it == children_.end()) {
+      response.status = 404;
+      return response;
+   }
+
+   // Same shape as Nexus 3: relative links for folders, absolute
+   // repository links for files, and a parent link.
+   std::string html = "<!DOCTYPE html>\n<html><head><title>Index of /" + directory +
+                      "</title></head><body>\n<table>\n<tr><td><a href=\"../\">Parent Directory</a></td></tr>\n";
+   for (const auto &name : it->second) {
+      const bool isDirectory = name.back() == '/';
+      const auto href        = isDirectory ? EncodeSegment(name)
+                                           : BaseUrl() + "/repository/" + repository_ + "/" +
+                                          EncodeSegment(directory + name);
+      html += "<tr><td><a href=\"" + href + "\">" + name + "</a></td></tr>\n";
+   }
+   html += "</table>\n</body></html>\n";
+
+   response.contentType = "text/html";
+   response.body        = std::move(html);
+   return response;
+}
+
+bool MockNexusServer::SendAll(std::intptr_t socket, const char *data, std::size_t size)
+{
+   while (size > 0) {
+      const auto sent = send(ToNative(socket), data, static_cast<int>(size), SendFlags());
+      if (sent <= 0) {
+         return false;
+      }
+      data += sent;
+      size -= static_cast<std::size_t>(sent);
+      bytesSent_ += static_cast<std::uint64_t>(sent);
+   }
+   return true;
+}
+
+bool MockNexusServer::SendResponse(std::intptr_t socket, const Response &response, bool headOnly, bool keepAlive)
+{
+   const std::uint64_t contentLength = response.generated ? response.generatedBytes : response.body.size();
+   std::string header                = "HTTP/1.1 " + std::to_string(response.status) + " " + StatusText(response.status) + "\r\n";
+   if (!response.contentType.empty()) {
+      header += "Content-Type: " + response.contentType + "\r\n";
+   }
+   header += "Content-Length: " + std::to_string(contentLength) + "\r\n";
+   header += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+   if (!SendAll(socket, header.data(), header.size())) {
+      return false;
+   }
+   if (headOnly || contentLength == 0) {
+      return true;
+   }
+
+   // Throttled bodies go out in slices of about 50 ms so the rate stays
+   // smooth for small files too.
+   std::size_t sliceBytes = kSendChunkBytes;
+   if (options_.bytesPerSecond > 0) {
+      sliceBytes = static_cast<std::size_t>(
+          std::clamp<std::uint64_t>(options_.bytesPerSecond / 20, 1024, kSendChunkBytes));
+   }
+
+   const auto start   = std::chrono::steady_clock::now();
+   std::uint64_t sent = 0;
+   std::string pattern;
+   if (response.generated) {
+      pattern.resize(sliceBytes);
+   }
+   while (sent < contentLength) {
+      if (stopping_) {
+         return false;
+      }
+      const auto slice = static_cast<std::size_t>(std::min<std::uint64_t>(sliceBytes, contentLength - sent));
+      const char *data = nullptr;
+      if (response.generated) {
+         for (std::size_t i = 0; i < slice; ++i) {
+            pattern[i] = static_cast<char>('a' + (sent + i) % 26);
+         }
+         data = pattern.data();
+      } else {
+         data = response.body.data() + sent;
+      }
+      if (!SendAll(socket, data, slice)) {
+         return false;
+      }
+      sent += slice;
+
+      if (options_.bytesPerSecond > 0) {
+         const auto due = start + std::chrono::microseconds(sent * 1000000 / options_.bytesPerSecond);
+         std::this_thread::sleep_until(due);
+      }
+   }
+   return true;
+}
+
+} // namespace confy::bench
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace confy::bench {
+
+struct MockNexusOptions
+{
+   // Added before every response.
+   std::chrono::milliseconds latency{0};
+   // Per connection; 0 sends as fast as the socket accepts.
+   std::uint64_t bytesPerSecond{0};
+};
+
+// In-process HTTP server on 127.0.0.1 that answers the requests
+// NexusClient makes: browse HTML under /service/rest/repository/browse/
+// and raw files (GET and HEAD) under /repository/. Files are synthetic,
+// so trees of any size cost no disk space on the server side. Basic auth
+// is accepted without checking. Add files before Start.
+class MockNexusServer final
+{
+ public:
+   MockNexusServer(std::string repository, MockNexusOptions options);
+   ~MockNexusServer();
+
+   MockNexusServer(const MockNexusServer &)            = delete;
+   MockNexusServer &operator=(const MockNexusServer &) = delete;
+
+   void AddFile(const std::string &path, std::uint64_t sizeBytes);
+
+   // Binds an ephemeral port.
+   bool Start(std::string &errorMessage);
+   void Stop();
+
+   // "127.0.0.1:<port>", the server id NexusClient looks up credentials by.
+   std::string HostPort() const;
+   std::string BaseUrl() const;
+   // "<base>/#browse/browse:<repository>", as used in configs.
+   std::string BrowseUrl() const;
+
+   std::uint64_t RequestCount() const { return requests_.load(); }
+   std::uint64_t BytesSent() const { return bytesSent_.load(); }
+   void ResetCounters();
+
+ private:
+   struct Response
+   {
+      int status{200};
+      std::string contentType;
+      std::string body;
+      // Synthetic file bodies are generated while sending.
+      std::uint64_t generatedBytes{0};
+      bool generated{false};
+   };
+
+   void AcceptLoop();
+   void ServeConnection(std::intptr_t socket);
+   Response Handle(const std::string &method, const std::string &target) const;
+   Response BrowseListing(const std::string &directory) const;
+   bool SendAll(std::intptr_t socket, const char *data, std::size_t size);
+   bool SendResponse(std::intptr_t socket, const Response &response, bool headOnly, bool keepAlive);
+
+   std::string repository_;
+   MockNexusOptions options_;
+   std::map<std::string, std::uint64_t> files_;
+   // Directory ("a/b/" or "" for the root) to its child names; directories
+   // end with '/'.
+   std::map<std::string, std::set<std::string>> children_;
+
+   std::intptr_t listenSocket_{-1};
+   int port_{0};
+   std::thread acceptThread_;
+   std::atomic<bool> stopping_{false};
+
+   std::mutex connectionsMutex_;
+   std::condition_variable connectionsCv_;
+   std::set<std::intptr_t> openConnections_;
+   std::size_t activeConnections_{0};
+
+   std::atomic<std::uint64_t> requests_{0};
+   std::atomic<std::uint64_t> bytesSent_{0};
+};
+
+} // namespace confy::bench
@@ -2,9 +2,11 @@
 
 #include <wx/fileconf.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <memory>
 #include <stdexcept>
+#include <thread>
 
 namespace confy {
 
@@ -25,7 +27,8 @@ AppSettings &AppSettings::Get()
    return *s_instance;
 }
 
-AppSettings::AppSettings(const std::string &executableDir)
+AppSettings::AppSettings(const std::string &executableDir) :
+    executableDir_(executableDir)
 {
    const auto configFilePath = (std::filesystem::path(executableDir) / "confy.conf").string();
    config_                   = std::make_unique<wxFileConfig>(
@@ -62,4 +65,138 @@ void AppSettings::SetXmlRepoUrl(const std::string &url)
    config_->Flush();
 }
 
+std::string AppSettings::GetCacheDirectory() const
+{
+   wxString value;
+   if (config_->Read("/CacheDirectory", &value) && !value.empty()) {
+      return value.ToStdString();
+   }
+   return (std::filesystem::path(executableDir_) / "cache").string();
+}
+
+bool AppSettings::IsGitMirrorCacheEnabled() const
+{
+   bool enabled = true;
+   config_->Read("/GitMirrorCache", &enabled, true);
+   return enabled;
+}
+
+std::string AppSettings::GetGitMirrorCacheDirectory() const
+{
+   if (!IsGitMirrorCacheEnabled()) {
+      return {};
+   }
+   return (std::filesystem::path(GetCacheDirectory()) / "git-mirrors").string();
+}
+
+bool AppSettings::IsGitRefuseDirtyRecloneEnabled() const
+{
+   bool enabled = false;
+   config_->Read("/GitRefuseDirtyReclone", &enabled, false);
+   return enabled;
+}
+
+int AppSettings::GetGitParallelJobs() const
+{
+   // Several clones already run side by side, so the default stays modest.
+   const int defaultJobs = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, 8);
+   long jobs             = 0;
+   config_->Read("/GitParallelJobs", &jobs, 0L);
+   return jobs > 0 ? static_cast<int>(jobs) : defaultJobs;
+}
+
+std::size_t AppSettings::GetGitOutputTailBytes() const
+{
+   long kibibytes = 64;
+   config_->Read("/GitOutputTailKiB", &kibibytes, 64L);
+   return kibibytes > 0 ? static_cast<std::size_t>(kibibytes) * 1024 : 0;
+}
+
+std::string AppSettings::GetGitLogDirectory() const
+{
+   wxString value;
+   if (config_->Read("/GitLogDirectory", &value) && !value.empty()) {
+      return value.ToStdString();
+   }
+   return {};
+}
+
+std::chrono::seconds AppSettings::GetMetadataCacheTtl() const
+{
+   long minutes = 15;
+   config_->Read("/MetadataCacheTtlMinutes", &minutes, 15L);
+   return std::chrono::minutes(std::max(0L, minutes));
+}
+
+std::size_t AppSettings::GetBuildTypePrefetchCount() const
+{
+   long count = 3;
+   config_->Read("/BuildTypePrefetchVersions", &count, 3L);
+   return static_cast<std::size_t>(std::max(0L, count));
+}
+
+std::size_t AppSettings::GetDebugConsoleLineLimit() const
+{
+   long lines = 100000;
+   config_->Read("/DebugConsoleLines", &lines, 100000L);
+   return static_cast<std::size_t>(std::max(1L, lines));
+}
+
+std::string AppSettings::GetLogLevels() const
+{
+   wxString value;
+   if (config_->Read("/LogLevels", &value) && !value.empty()) {
+      return value.ToStdString();
+   }
+   return "info";
+}
+
+std::string AppSettings::GetLogFile() const
+{
+   wxString value;
+   if (config_->Read("/LogFile", &value) && !value.empty()) {
+      return value.ToStdString();
+   }
+   return {};
+}
+
+std::uintmax_t AppSettings::GetLogFileMaxBytes() const
+{
+   long kibibytes = 10240;
+   config_->Read("/LogFileMaxKiB", &kibibytes, 10240L);
+   return kibibytes > 0 ? static_cast<std::uintmax_t>(kibibytes) * 1024 : 0;
+}
+
+std::size_t AppSettings::GetLogFileCount() const
+{
+   long count = 3;
+   config_->Read("/LogFileCount", &count, 3L);
+   return static_cast<std::size_t>(std::max(1L, count));
+}
+
+std::string AppSettings::GetEventStreamDestination() const
+{
+   wxString value;
+   if (config_->Read("/EventStream", &value) && !value.empty()) {
+      return value.ToStdString();
+   }
+   return {};
+}
+
+std::chrono::milliseconds AppSettings::GetEventStreamProgressInterval() const
+{
+   long milliseconds = 250;
+   config_->Read("/EventStreamProgressMs", &milliseconds, 250L);
+   return std::chrono::milliseconds(std::max(0L, milliseconds));
+}
+
+std::string AppSettings::GetHttpTimingsFile() const
+{
+   wxString value;
+   if (config_->Read("/HttpTimingsFile", &value) && !value.empty()) {
+      return value.ToStdString();
+   }
+   return (std::filesystem::path(GetCacheDirectory()) / "http-timings.txt").string();
+}
+
 } // namespace confy
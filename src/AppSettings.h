@@ -1,5 +1,8 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -17,10 +20,28 @@ class AppSettings
    void SetLastConfigPath(const std::string &path);
    std::string GetXmlRepoUrl() const;
    void SetXmlRepoUrl(const std::string &url);
+   std::string GetCacheDirectory() const;
+   bool IsGitMirrorCacheEnabled() const;
+   std::string GetGitMirrorCacheDirectory() const;
+   bool IsGitRefuseDirtyRecloneEnabled() const;
+   int GetGitParallelJobs() const;
+   std::size_t GetGitOutputTailBytes() const;
+   std::string GetGitLogDirectory() const;
+   std::chrono::seconds GetMetadataCacheTtl() const;
+   std::size_t GetBuildTypePrefetchCount() const;
+   std::size_t GetDebugConsoleLineLimit() const;
+   std::string GetLogLevels() const;
+   std::string GetLogFile() const;
+   std::uintmax_t GetLogFileMaxBytes() const;
+   std::size_t GetLogFileCount() const;
+   std::string GetEventStreamDestination() const;
+   std::chrono::milliseconds GetEventStreamProgressInterval() const;
+   std::string GetHttpTimingsFile() const;
 
  private:
    explicit AppSettings(const std::string &executableDir);
 
+   std::string executableDir_;
    std::unique_ptr<wxFileConfig> config_;
 };
 
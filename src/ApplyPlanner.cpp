@@ -0,0 +1,357 @@
+#include "ApplyPlanner.h"
+
+#include "FormatUtils.h"
+#include "Log.h"
+#include "ParallelTasks.h"
+#include "RefListingService.h"
+#include "TransferHistory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+#include <unordered_map>
+
+namespace confy {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr char kCancelledMessage[] = "Cancelled";
+
+bool IsCancelled(const std::atomic<bool> *cancelRequested)
+{
+   return cancelRequested != nullptr && cancelRequested->load();
+}
+
+std::string FormatSeconds(double seconds)
+{
+   const auto total = static_cast<long long>(std::ceil(std::max(seconds, 0.0)));
+   char buffer[32];
+   if (total >= 3600) {
+      std::snprintf(buffer, sizeof(buffer), "%lldh %02lldm", total / 3600, (total % 3600) / 60);
+   } else if (total >= 60) {
+      std::snprintf(buffer, sizeof(buffer), "%lldm %02llds", total / 60, total % 60);
+   } else {
+      std::snprintf(buffer, sizeof(buffer), "%llds", total);
+   }
+   return buffer;
+}
+
+// An empty ref clones the remote's default branch.
+bool RefExists(const std::vector<std::string> &refs, const std::string &branchOrTag)
+{
+   return branchOrTag.empty() || std::find(refs.begin(), refs.end(), branchOrTag) != refs.end();
+}
+
+std::string RefNotFoundMessage(const std::string &branchOrTag)
+{
+   return "Branch or tag '" + branchOrTag + "' not found";
+}
+
+void ResolveSource(const GitCloneJob &job, const ApplyPlanResolvers &resolvers, const TransferHistory *history, PlannedJob &outPlanned)
+{
+   std::error_code ec;
+   outPlanned.checkoutExists = fs::exists(fs::path(job.targetDirectory) / ".git", ec);
+
+   std::vector<std::string> refs;
+   if (!resolvers.listRefs(job.repositoryUrl, refs, outPlanned.errorMessage)) {
+      return;
+   }
+   outPlanned.refExists = RefExists(refs, job.branchOrTag);
+   if (!outPlanned.refExists) {
+      outPlanned.errorMessage = RefNotFoundMessage(job.branchOrTag);
+      return;
+   }
+   outPlanned.resolved      = true;
+   outPlanned.estimateKnown = history && history->EstimateSourceSeconds(job.repositoryUrl, outPlanned.estimatedSeconds);
+}
+
+void ResolveArtifact(const NexusDownloadJob &job,
+    const ApplyPlanResolvers &resolvers,
+    const TransferHistory *history,
+    PlannedJob &outPlanned)
+{
+   if (job.version.empty()) {
+      outPlanned.errorMessage = "No version selected";
+      return;
+   }
+   if (job.buildType.empty()) {
+      outPlanned.errorMessage = "No build type selected";
+      return;
+   }
+   if (!resolvers.listArtifactFiles(job, outPlanned.files, outPlanned.errorMessage)) {
+      return;
+   }
+   for (const auto &file : outPlanned.files) {
+      if (!file.sizeKnown) {
+         ++outPlanned.unknownSizeFiles;
+         continue;
+      }
+      outPlanned.totalBytes += file.sizeBytes;
+
+      std::error_code ec;
+      const auto localSize = fs::file_size(fs::path(job.targetDirectory) / file.relativePath, ec);
+      if (!ec && localSize == file.sizeBytes) {
+         ++outPlanned.presentFiles;
+         outPlanned.presentBytes += file.sizeBytes;
+      }
+   }
+   outPlanned.resolved = true;
+   outPlanned.estimateKnown =
+       history && history->EstimateArtifactSeconds(job.repositoryUrl, outPlanned.totalBytes, outPlanned.estimatedSeconds);
+}
+
+} // namespace
+
+ApplyPlanResolvers MakeApplyPlanResolvers(const AuthCredentials &credentials)
+{
+   ApplyPlanResolvers resolvers;
+   resolvers.listArtifactFiles = [credentials](const NexusDownloadJob &job,
+                                     std::vector<NexusArtifactFile> &outFiles,
+                                     std::string &errorMessage) {
+      NexusClient client(credentials);
+      return client.ListArtifactFiles(job.repositoryUrl,
+          job.artifactPath,
+          job.version,
+          job.buildType,
+          job.regexIncludes,
+          job.regexExcludes,
+          outFiles,
+          errorMessage);
+   };
+   resolvers.listRefs = [credentials](const std::string &repositoryUrl,
+                            std::vector<std::string> &outRefs,
+                            std::string &errorMessage) {
+      RefListingService refListing(credentials);
+      return refListing.ListBranchesAndTags(repositoryUrl, outRefs, errorMessage);
+   };
+   resolvers.checkArtifact = [credentials](const NexusDownloadJob &job, std::string &errorMessage) {
+      NexusClient client(credentials);
+      return client.CheckArtifactExists(job.repositoryUrl, job.artifactPath, job.version, job.buildType, errorMessage);
+   };
+   return resolvers;
+}
+
+ApplyPlan BuildApplyPlan(const std::vector<DownloadJob> &jobs,
+    const ApplyPlanResolvers &resolvers,
+    const TransferHistory *history,
+    std::size_t parallelJobs,
+    std::size_t maxConcurrency,
+    const std::atomic<bool> *cancelRequested)
+{
+   ApplyPlan plan;
+   plan.parallelJobs = std::max<std::size_t>(parallelJobs, 1);
+   plan.jobs.resize(jobs.size());
+
+   RunParallel(jobs.size(), maxConcurrency, [&](std::size_t i) {
+      const auto &job = jobs[i];
+      auto &planned   = plan.jobs[i];
+      planned.kind    = job.kind;
+      if (job.kind == DownloadJobKind::GitSource) {
+         planned.componentIndex       = job.source.componentIndex;
+         planned.componentName        = job.source.componentName;
+         planned.componentDisplayName = job.source.componentDisplayName;
+         planned.repositoryUrl        = job.source.repositoryUrl;
+         planned.target               = job.Target();
+         planned.targetDirectory      = job.source.targetDirectory;
+         if (IsCancelled(cancelRequested)) {
+            planned.errorMessage = kCancelledMessage;
+         } else {
+            ResolveSource(job.source, resolvers, history, planned);
+         }
+      } else {
+         const auto &artifact         = job.artifact;
+         planned.componentIndex       = artifact.componentIndex;
+         planned.componentName        = artifact.componentName;
+         planned.componentDisplayName = artifact.componentDisplayName;
+         planned.repositoryUrl        = artifact.repositoryUrl;
+         planned.target               = job.Target();
+         planned.targetDirectory      = artifact.targetDirectory;
+         if (IsCancelled(cancelRequested)) {
+            planned.errorMessage = kCancelledMessage;
+         } else {
+            ResolveArtifact(artifact, resolvers, history, planned);
+         }
+      }
+      if (!planned.resolved) {
+         CONFY_LOG(LogModule::General, LogLevel::Warning, "plan: component '%s' not resolved: %s",
+             planned.componentName.c_str(),
+             planned.errorMessage.c_str());
+      }
+   });
+
+   // Jobs run on parallelJobs workers: the run takes at least as long as
+   // the slowest job, and about the summed time spread over the workers.
+   double summedSeconds  = 0.0;
+   double slowestSeconds = 0.0;
+   for (const auto &planned : plan.jobs) {
+      if (!planned.resolved) {
+         ++plan.failedJobs;
+         continue;
+      }
+      plan.fileCount += planned.files.size();
+      plan.totalBytes += planned.totalBytes;
+      plan.unknownSizeFiles += planned.unknownSizeFiles;
+      plan.presentFiles += planned.presentFiles;
+      plan.presentBytes += planned.presentBytes;
+      if (!planned.estimateKnown) {
+         ++plan.jobsWithoutEstimate;
+         continue;
+      }
+      summedSeconds += planned.estimatedSeconds;
+      slowestSeconds = std::max(slowestSeconds, planned.estimatedSeconds);
+   }
+   plan.estimatedSeconds = std::max(slowestSeconds, summedSeconds / static_cast<double>(plan.parallelJobs));
+   return plan;
+}
+
+std::string BuildHumanReadablePlanSummary(const ApplyPlan &plan)
+{
+   std::ostringstream summary;
+   summary << "Confy apply plan\n";
+   summary << "================\n";
+
+   for (const auto &planned : plan.jobs) {
+      const bool isSource = planned.kind == DownloadJobKind::GitSource;
+      summary << "- " << planned.componentDisplayName << " (" << planned.componentName << ")"
+              << " | " << (isSource ? "source " : "artifact ") << planned.target;
+      if (!planned.resolved) {
+         summary << " | ERROR: " << planned.errorMessage << '\n';
+         continue;
+      }
+
+      if (isSource) {
+         summary << " | " << (planned.checkoutExists ? "update existing checkout" : "new clone");
+      } else {
+         summary << " | " << planned.files.size() << " files, " << FormatBytes(planned.totalBytes);
+         if (planned.unknownSizeFiles > 0) {
+            summary << " + " << planned.unknownSizeFiles << " of unknown size";
+         }
+         if (planned.presentFiles > 0) {
+            summary << " | " << planned.presentFiles << " present locally (" << FormatBytes(planned.presentBytes) << ")";
+         }
+      }
+      summary << " | " << (planned.estimateKnown ? "~" + FormatSeconds(planned.estimatedSeconds) : "no history") << '\n';
+   }
+
+   summary << '\n'
+           << "Jobs: " << plan.jobs.size();
+   if (plan.failedJobs > 0) {
+      summary << " (" << plan.failedJobs << " could not be resolved)";
+   }
+   summary << '\n'
+           << "Artifact files: " << plan.fileCount << ", " << FormatBytes(plan.totalBytes);
+   if (plan.unknownSizeFiles > 0) {
+      summary << " (" << plan.unknownSizeFiles << " files of unknown size not counted)";
+   }
+   summary << '\n';
+   if (plan.presentFiles > 0) {
+      summary << "Already present locally: " << plan.presentFiles << " files, " << FormatBytes(plan.presentBytes)
+              << " (Apply replaces artifact directories and downloads them again)\n";
+   }
+   summary << "Estimated time: ";
+   if (plan.jobsWithoutEstimate == plan.jobs.size() - plan.failedJobs) {
+      summary << "unknown, no earlier downloads recorded\n";
+   } else {
+      summary << "~" << FormatSeconds(plan.estimatedSeconds) << " with " << plan.parallelJobs << " parallel jobs";
+      if (plan.jobsWithoutEstimate > 0) {
+         summary << " (" << plan.jobsWithoutEstimate << " jobs without history not included)";
+      }
+      summary << '\n';
+   }
+   return summary.str();
+}
+
+std::vector<ApplyJobProblem> ValidateApplyJobs(const std::vector<DownloadJob> &jobs,
+    const ApplyPlanResolvers &resolvers,
+    std::size_t maxConcurrency,
+    const std::atomic<bool> *cancelRequested)
+{
+   struct RefListing
+   {
+      std::string repositoryUrl;
+      std::vector<std::string> refs;
+      bool ok{false};
+      std::string errorMessage;
+   };
+   std::vector<RefListing> refListings;
+   std::unordered_map<std::string, std::size_t> refListingByUrl;
+   for (const auto &job : jobs) {
+      if (job.kind == DownloadJobKind::GitSource &&
+          refListingByUrl.emplace(job.source.repositoryUrl, refListings.size()).second) {
+         refListings.push_back({job.source.repositoryUrl, {}, false, {}});
+      }
+   }
+
+   // Tasks [0, refListings.size()) list refs, the rest check artifact jobs.
+   std::vector<std::string> artifactErrors(jobs.size());
+   RunParallel(refListings.size() + jobs.size(), maxConcurrency, [&](std::size_t task) {
+      if (task < refListings.size()) {
+         auto &listing = refListings[task];
+         if (IsCancelled(cancelRequested)) {
+            listing.errorMessage = kCancelledMessage;
+            return;
+         }
+         listing.ok = resolvers.listRefs(listing.repositoryUrl, listing.refs, listing.errorMessage);
+         return;
+      }
+      const auto &job = jobs[task - refListings.size()];
+      if (job.kind != DownloadJobKind::NexusArtifact) {
+         return;
+      }
+      auto &errorMessage = artifactErrors[task - refListings.size()];
+      if (IsCancelled(cancelRequested)) {
+         errorMessage = kCancelledMessage;
+      } else if (job.artifact.version.empty()) {
+         errorMessage = "No version selected";
+      } else if (job.artifact.buildType.empty()) {
+         errorMessage = "No build type selected";
+      } else if (!resolvers.checkArtifact(job.artifact, errorMessage) && errorMessage.empty()) {
+         errorMessage = "Artifact check failed";
+      }
+   });
+
+   std::vector<ApplyJobProblem> problems;
+   for (std::size_t i = 0; i < jobs.size(); ++i) {
+      const auto &job = jobs[i];
+      ApplyJobProblem problem;
+      problem.jobIndex = i;
+      problem.kind     = job.kind;
+      if (job.kind == DownloadJobKind::GitSource) {
+         const auto &listing          = refListings[refListingByUrl.at(job.source.repositoryUrl)];
+         problem.componentName        = job.source.componentName;
+         problem.componentDisplayName = job.source.componentDisplayName;
+         if (!listing.ok) {
+            problem.message = listing.errorMessage.empty() ? "Listing branches and tags failed" : listing.errorMessage;
+         } else if (!RefExists(listing.refs, job.source.branchOrTag)) {
+            problem.message = RefNotFoundMessage(job.source.branchOrTag);
+         }
+      } else {
+         problem.componentName        = job.artifact.componentName;
+         problem.componentDisplayName = job.artifact.componentDisplayName;
+         problem.message              = artifactErrors[i];
+      }
+      if (!problem.message.empty()) {
+         CONFY_LOG(LogModule::General, LogLevel::Warning, "preflight: component '%s' rejected: %s",
+             problem.componentName.c_str(),
+             problem.message.c_str());
+         problems.push_back(std::move(problem));
+      }
+   }
+   return problems;
+}
+
+std::string BuildHumanReadablePreflightReport(const std::vector<ApplyJobProblem> &problems)
+{
+   std::ostringstream report;
+   for (const auto &problem : problems) {
+      report << "- " << problem.componentDisplayName << " (" << problem.componentName << ") "
+             << (problem.kind == DownloadJobKind::GitSource ? "source" : "artifact") << ": " << problem.message << '\n';
+   }
+   return report.str();
+}
+
+} // namespace confy
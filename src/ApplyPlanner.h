@@ -0,0 +1,116 @@
+#pragma once
+
+#include "AuthCredentials.h"
+#include "JobTypes.h"
+#include "NexusClient.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace confy {
+
+class TransferHistory;
+
+// What one download job of an Apply would do, resolved without touching the
+// target directory.
+struct PlannedJob
+{
+   DownloadJobKind kind{DownloadJobKind::GitSource};
+   std::size_t componentIndex{0};
+   std::string componentName;
+   std::string componentDisplayName;
+   std::string repositoryUrl;
+   // Branch/tag of a source job, version[/buildType] of an artifact job.
+   std::string target;
+   std::string targetDirectory;
+   bool resolved{false};
+   std::string errorMessage;
+
+   // Source jobs: whether the ref is listed by the remote, and whether a
+   // checkout is already there to be updated in place.
+   bool refExists{false};
+   bool checkoutExists{false};
+
+   // Artifact jobs, after include/exclude filtering.
+   std::vector<NexusArtifactFile> files;
+   std::uint64_t totalBytes{0};
+   std::size_t unknownSizeFiles{0};
+   // Local files with the same relative path and size.
+   std::size_t presentFiles{0};
+   std::uint64_t presentBytes{0};
+
+   bool estimateKnown{false};
+   double estimatedSeconds{0.0};
+};
+
+struct ApplyPlan
+{
+   std::vector<PlannedJob> jobs;
+   std::size_t parallelJobs{1};
+
+   std::size_t fileCount{0};
+   std::uint64_t totalBytes{0};
+   std::size_t unknownSizeFiles{0};
+   std::size_t presentFiles{0};
+   std::uint64_t presentBytes{0};
+   std::size_t failedJobs{0};
+   // Jobs spread over parallelJobs workers; only jobs with history count.
+   double estimatedSeconds{0.0};
+   std::size_t jobsWithoutEstimate{0};
+};
+
+// A job ValidateApplyJobs rejected; jobIndex refers to the validated jobs.
+struct ApplyJobProblem
+{
+   std::size_t jobIndex{0};
+   DownloadJobKind kind{DownloadJobKind::GitSource};
+   std::string componentName;
+   std::string componentDisplayName;
+   std::string message;
+};
+
+// Remote lookups used by BuildApplyPlan and ValidateApplyJobs; tests
+// substitute their own.
+struct ApplyPlanResolvers
+{
+   std::function<bool(const NexusDownloadJob &job, std::vector<NexusArtifactFile> &outFiles, std::string &errorMessage)>
+       listArtifactFiles;
+   std::function<bool(const std::string &repositoryUrl, std::vector<std::string> &outRefs, std::string &errorMessage)>
+       listRefs;
+   std::function<bool(const NexusDownloadJob &job, std::string &errorMessage)> checkArtifact;
+};
+
+// Resolvers backed by NexusClient and RefListingService.
+ApplyPlanResolvers MakeApplyPlanResolvers(const AuthCredentials &credentials);
+
+// Resolves the jobs concurrently, at most maxConcurrency at a time. history
+// may be null, which leaves every estimate unknown. Once cancelRequested is
+// set, jobs not started yet are skipped and reported as cancelled; lookups
+// already in flight still finish.
+ApplyPlan BuildApplyPlan(const std::vector<DownloadJob> &jobs,
+    const ApplyPlanResolvers &resolvers,
+    const TransferHistory *history,
+    std::size_t parallelJobs,
+    std::size_t maxConcurrency,
+    const std::atomic<bool> *cancelRequested = nullptr);
+
+std::string BuildHumanReadablePlanSummary(const ApplyPlan &plan);
+
+// Preflight for Apply: checks every job concurrently, at most maxConcurrency
+// at a time, so that a missing version, build type or ref, an unparsable
+// URL or missing credentials are all reported before any download starts.
+// Repositories shared by several source jobs are listed once. Returns the
+// problems in job order; jobs without one can be started. cancelRequested
+// works as for BuildApplyPlan.
+std::vector<ApplyJobProblem> ValidateApplyJobs(const std::vector<DownloadJob> &jobs,
+    const ApplyPlanResolvers &resolvers,
+    std::size_t maxConcurrency,
+    const std::atomic<bool> *cancelRequested = nullptr);
+
+std::string BuildHumanReadablePreflightReport(const std::vector<ApplyJobProblem> &problems);
+
+} // namespace confy
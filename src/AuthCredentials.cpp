@@ -2,6 +2,8 @@
 
 #include "rapidxml.hpp"
 
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
 #include <iterator>
 #include <vector>
@@ -46,6 +48,26 @@ std::string ReadAll(const std::string &filePath)
 
 namespace confy {
 
+std::string AuthCredentials::DefaultM2SettingsPath()
+{
+#ifdef _WIN32
+   std::string homeDir;
+   if (const char *h = std::getenv("USERPROFILE")) {
+      homeDir = h;
+   } else {
+      const char *drive    = std::getenv("HOMEDRIVE");
+      const char *homepath = std::getenv("HOMEPATH");
+      if (drive && homepath) {
+         homeDir = std::string(drive) + homepath;
+      }
+   }
+#else
+   const char *homeEnv       = std::getenv("HOME");
+   const std::string homeDir = homeEnv ? homeEnv : "";
+#endif
+   return homeDir.empty() ? "" : (std::filesystem::path(homeDir) / ".m2" / "settings.xml").string();
+}
+
 bool AuthCredentials::LoadFromM2SettingsXml(const std::string &filePath, std::string &errorMessage)
 {
    const auto xml = ReadAll(filePath);
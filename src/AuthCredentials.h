@@ -14,6 +14,10 @@ struct ServerCredentials
 class AuthCredentials final
 {
  public:
+   // ~/.m2/settings.xml (%USERPROFILE% on Windows); empty when the home
+   // directory is unknown.
+   static std::string DefaultM2SettingsPath();
+
    bool LoadFromM2SettingsXml(const std::string &filePath, std::string &errorMessage);
    bool LoadFromM2SettingsXmlString(const std::string &xml, std::string &errorMessage);
    bool TryGetByServerId(const std::string &serverId, ServerCredentials &out) const;
@@ -1,4 +1,8 @@
 #include "BitbucketClient.h"
+#include "HttpTimings.h"
+#include "Log.h"
+
+#include "ParallelTasks.h"
 
 #include <curl/curl.h>
 
@@ -11,37 +15,6 @@
 
 #include <nlohmann/json.hpp>
 
-#if defined(__has_include)
-#if __has_include(<wx/log.h>)
-#include <wx/log.h>
-#define CONFY_HAS_WX_LOG 1
-#endif
-#endif
-
-#ifndef CONFY_HAS_WX_LOG
-#include <cstdarg>
-#include <cstdio>
-namespace {
-
-void FallbackLog(const char *level, const char *format, ...)
-{
-   std::fprintf(stderr, "[bitbucket-client][%s] ", level);
-
-   va_list args;
-   va_start(args, format);
-   std::vfprintf(stderr, format, args);
-   va_end(args);
-
-   std::fprintf(stderr, "\n");
-}
-
-} // namespace
-
-#define wxLogMessage(...) FallbackLog("INFO", __VA_ARGS__)
-#define wxLogWarning(...) FallbackLog("WARN", __VA_ARGS__)
-#define wxLogError(...)   FallbackLog("ERROR", __VA_ARGS__)
-#endif
-
 namespace {
 
 using Json = nlohmann::json;
@@ -62,6 +35,9 @@ size_t WriteToFile(void *contents, size_t size, size_t nmemb, void *userp)
    return total;
 }
 
+constexpr int kRefPageLimit                 = 1000;
+constexpr std::size_t kMaxConcurrentRefPages = 4;
+
 std::string ToLower(std::string value)
 {
    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) {
@@ -97,6 +73,18 @@ bool ParsePagedResponse(const std::string &body,
    return true;
 }
 
+// Captures scheme, host[:port], project key and repository slug.
+bool MatchRepositoryUrl(const std::string &repositoryUrl, std::smatch &match)
+{
+   static const std::regex kScmPattern(R"(^\s*(https?)://([^/]+)/scm/([^/]+)/([^/]+?)(?:\.git)?/?\s*$)",
+       std::regex::icase);
+   static const std::regex kProjectsPattern(
+       R"(^\s*(https?)://([^/]+)/projects/([^/]+)/repos/([^/]+?)(?:\.git)?(?:/.*)?\s*$)", std::regex::icase);
+
+   return std::regex_match(repositoryUrl, match, kScmPattern) ||
+          std::regex_match(repositoryUrl, match, kProjectsPattern);
+}
+
 } // namespace
 
 namespace confy {
@@ -109,69 +97,177 @@ bool BitbucketClient::ListBranches(const std::string &repositoryUrl,
     std::string &errorMessage) const
 {
    outBranches.clear();
-   wxLogMessage("[bitbucket] ListBranches start repo=%s", repositoryUrl.c_str());
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Info, "ListBranches start repo=%s", repositoryUrl.c_str());
 
    RepoCoordinates repo;
    if (!ParseRepositoryUrl(repositoryUrl, repo, errorMessage)) {
-      wxLogError("[bitbucket] ListBranches failed parse url: %s", errorMessage.c_str());
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "ListBranches failed parse url: %s", errorMessage.c_str());
       return false;
    }
 
    ServerCredentials creds;
    if (!GetCredentialsForRepo(repo, creds, errorMessage)) {
-      wxLogError("[bitbucket] ListBranches credentials lookup failed host=%s: %s",
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "ListBranches credentials lookup failed host=%s: %s",
           repo.hostPort.c_str(),
           errorMessage.c_str());
       return false;
    }
-   wxLogMessage("[bitbucket] ListBranches using host=%s user=%s",
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Debug, "ListBranches using host=%s user=%s",
        repo.hostPort.c_str(),
        creds.username.empty() ? "<empty>" : creds.username.c_str());
 
-   constexpr int kPageLimit = 100;
-   int start                = 0;
-   bool isLastPage          = false;
-   std::set<std::string> uniqueBranches;
+   std::vector<std::string> branches;
+   if (!ListRefDisplayIds(repo, creds, "branches", branches, errorMessage)) {
+      return false;
+   }
+   const std::set<std::string> uniqueBranches(branches.begin(), branches.end());
 
-   while (!isLastPage) {
-      const auto endpoint = repo.baseUrl + "/rest/api/1.0/projects/" + UrlEncode(repo.projectKey) +
-                            "/repos/" + UrlEncode(repo.repositorySlug) + "/branches?limit=" + std::to_string(kPageLimit) +
-                            "&start=" + std::to_string(start);
+   outBranches.assign(uniqueBranches.begin(), uniqueBranches.end());
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Info, "ListBranches success count=%zu", outBranches.size());
+   return true;
+}
 
-      std::string body;
-      if (!HttpGetText(endpoint, creds, body, errorMessage)) {
-         wxLogError("[bitbucket] ListBranches request failed url=%s: %s", endpoint.c_str(), errorMessage.c_str());
+bool BitbucketClient::ListBranchesAndTags(const std::string &repositoryUrl,
+    std::vector<std::string> &outRefs,
+    std::string &errorMessage) const
+{
+   outRefs.clear();
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Info, "ListBranchesAndTags start repo=%s", repositoryUrl.c_str());
+
+   RepoCoordinates repo;
+   if (!ParseRepositoryUrl(repositoryUrl, repo, errorMessage)) {
+      return false;
+   }
+
+   ServerCredentials creds;
+   if (!GetCredentialsForRepo(repo, creds, errorMessage)) {
+      return false;
+   }
+
+   // Branches and tags are independent listings; fetch both at once.
+   const std::string collections[] = {"branches", "tags"};
+   std::vector<std::string> displayIds[2];
+   std::string errors[2];
+   bool succeeded[2] = {false, false};
+   RunParallel(2, 2, [&](std::size_t i) {
+      succeeded[i] = ListRefDisplayIds(repo, creds, collections[i], displayIds[i], errors[i]);
+   });
+   for (std::size_t i = 0; i < 2; ++i) {
+      if (!succeeded[i]) {
+         errorMessage = errors[i];
          return false;
       }
+   }
 
-      Json json;
-      int nextPageStart = -1;
-      if (!ParsePagedResponse(body, json, isLastPage, nextPageStart, errorMessage)) {
+   std::set<std::string> uniqueRefs(displayIds[0].begin(), displayIds[0].end());
+   uniqueRefs.insert(displayIds[1].begin(), displayIds[1].end());
+   outRefs.assign(uniqueRefs.begin(), uniqueRefs.end());
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Info, "ListBranchesAndTags success branches=%zu tags=%zu",
+       displayIds[0].size(),
+       displayIds[1].size());
+   return true;
+}
+
+bool BitbucketClient::SearchBranchesAndTags(const std::string &repositoryUrl,
+    const std::string &filterText,
+    int limit,
+    std::vector<std::string> &outRefs,
+    bool &outHasMore,
+    std::string &errorMessage) const
+{
+   outRefs.clear();
+   outHasMore = false;
+
+   RepoCoordinates repo;
+   if (!ParseRepositoryUrl(repositoryUrl, repo, errorMessage)) {
+      return false;
+   }
+
+   ServerCredentials creds;
+   if (!GetCredentialsForRepo(repo, creds, errorMessage)) {
+      return false;
+   }
+
+   const std::string collections[] = {"branches", "tags"};
+   Page pages[2];
+   std::string errors[2];
+   bool succeeded[2] = {false, false};
+   RunParallel(2, 2, [&](std::size_t i) {
+      succeeded[i] = FetchRefPage(repo, creds, collections[i], filterText, 0, limit, pages[i], errors[i]);
+   });
+
+   std::set<std::string> uniqueRefs;
+   for (std::size_t i = 0; i < 2; ++i) {
+      if (!succeeded[i]) {
+         errorMessage = errors[i];
          return false;
       }
+      uniqueRefs.insert(pages[i].values.begin(), pages[i].values.end());
+      outHasMore = outHasMore || !pages[i].isLastPage;
+   }
+   outRefs.assign(uniqueRefs.begin(), uniqueRefs.end());
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Info, "SearchBranchesAndTags filter='%s' count=%zu more=%d",
+       filterText.c_str(),
+       outRefs.size(),
+       outHasMore ? 1 : 0);
+   return true;
+}
 
-      for (const auto &item : json["values"]) {
-         if (!item.is_object()) {
-            continue;
-         }
-         const auto displayId = item.value("displayId", std::string());
-         if (!displayId.empty()) {
-            uniqueBranches.insert(displayId);
-         }
-      }
+bool BitbucketClient::FetchRefPage(const RepoCoordinates &repo,
+    const ServerCredentials &creds,
+    const std::string &collection,
+    const std::string &filterText,
+    int start,
+    int limit,
+    Page &outPage,
+    std::string &errorMessage) const
+{
+   auto endpoint = repo.baseUrl + "/rest/api/1.0/projects/" + UrlEncode(repo.projectKey) +
+                   "/repos/" + UrlEncode(repo.repositorySlug) + "/" + collection +
+                   "?limit=" + std::to_string(limit) + "&start=" + std::to_string(start);
+   if (!filterText.empty()) {
+      endpoint += "&filterText=" + UrlEncode(filterText);
+   }
 
-      if (isLastPage) {
-         break;
+   std::string body;
+   if (!HttpGetText(endpoint, creds, body, errorMessage)) {
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "%s request failed url=%s: %s", collection.c_str(), endpoint.c_str(), errorMessage.c_str());
+      return false;
+   }
+
+   Json json;
+   if (!ParsePagedResponse(body, json, outPage.isLastPage, outPage.nextPageStart, errorMessage)) {
+      return false;
+   }
+   outPage.limit = json.value("limit", 0);
+   for (const auto &item : json["values"]) {
+      if (!item.is_object()) {
+         continue;
       }
-      if (nextPageStart < 0) {
-         errorMessage = "Bitbucket response pagination is invalid for branch listing.";
-         return false;
+      auto displayId = item.value("displayId", std::string());
+      if (!displayId.empty()) {
+         outPage.values.push_back(std::move(displayId));
       }
-      start = nextPageStart;
    }
+   return true;
+}
 
-   outBranches.assign(uniqueBranches.begin(), uniqueBranches.end());
-   wxLogMessage("[bitbucket] ListBranches success count=%zu", outBranches.size());
+bool BitbucketClient::ListRefDisplayIds(const RepoCoordinates &repo,
+    const ServerCredentials &creds,
+    const std::string &collection,
+    std::vector<std::string> &outDisplayIds,
+    std::string &errorMessage) const
+{
+   const auto fetchPage = [&](int start, Page &outPage, std::string &pageError) {
+      return FetchRefPage(repo, creds, collection, {}, start, kRefPageLimit, outPage, pageError);
+   };
+
+   if (!CollectPages(fetchPage, kMaxConcurrentRefPages, outDisplayIds, errorMessage)) {
+      if (errorMessage.empty()) {
+         errorMessage = "Bitbucket response pagination is invalid for " + collection + " listing.";
+      }
+      return false;
+   }
    return true;
 }
 
@@ -181,19 +277,19 @@ bool BitbucketClient::ListTopLevelXmlFiles(const std::string &repositoryUrl,
     std::string &errorMessage) const
 {
    outFiles.clear();
-   wxLogMessage("[bitbucket] ListTopLevelXmlFiles start repo=%s branch=%s",
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Info, "ListTopLevelXmlFiles start repo=%s branch=%s",
        repositoryUrl.c_str(),
        branch.c_str());
 
    RepoCoordinates repo;
    if (!ParseRepositoryUrl(repositoryUrl, repo, errorMessage)) {
-      wxLogError("[bitbucket] ListTopLevelXmlFiles failed parse url: %s", errorMessage.c_str());
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "ListTopLevelXmlFiles failed parse url: %s", errorMessage.c_str());
       return false;
    }
 
    ServerCredentials creds;
    if (!GetCredentialsForRepo(repo, creds, errorMessage)) {
-      wxLogError("[bitbucket] ListTopLevelXmlFiles credentials lookup failed host=%s: %s",
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "ListTopLevelXmlFiles credentials lookup failed host=%s: %s",
           repo.hostPort.c_str(),
           errorMessage.c_str());
       return false;
@@ -212,7 +308,7 @@ bool BitbucketClient::ListTopLevelXmlFiles(const std::string &repositoryUrl,
 
       std::string body;
       if (!HttpGetText(endpoint, creds, body, errorMessage)) {
-         wxLogError("[bitbucket] ListTopLevelXmlFiles request failed url=%s: %s",
+         CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "ListTopLevelXmlFiles request failed url=%s: %s",
              endpoint.c_str(),
              errorMessage.c_str());
          return false;
@@ -245,7 +341,7 @@ bool BitbucketClient::ListTopLevelXmlFiles(const std::string &repositoryUrl,
    }
 
    outFiles.assign(uniqueFiles.begin(), uniqueFiles.end());
-   wxLogMessage("[bitbucket] ListTopLevelXmlFiles success branch=%s xml_count=%zu",
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Info, "ListTopLevelXmlFiles success branch=%s xml_count=%zu",
        branchRef.c_str(),
        outFiles.size());
    return true;
@@ -257,20 +353,20 @@ bool BitbucketClient::DownloadFile(const std::string &repositoryUrl,
     const std::string &outputPath,
     std::string &errorMessage) const
 {
-   wxLogMessage("[bitbucket] DownloadFile start repo=%s branch=%s file=%s out=%s",
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Info, "DownloadFile start repo=%s branch=%s file=%s out=%s",
        repositoryUrl.c_str(),
        branch.c_str(),
        filePath.c_str(),
        outputPath.c_str());
    RepoCoordinates repo;
    if (!ParseRepositoryUrl(repositoryUrl, repo, errorMessage)) {
-      wxLogError("[bitbucket] DownloadFile failed parse url: %s", errorMessage.c_str());
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "DownloadFile failed parse url: %s", errorMessage.c_str());
       return false;
    }
 
    ServerCredentials creds;
    if (!GetCredentialsForRepo(repo, creds, errorMessage)) {
-      wxLogError("[bitbucket] DownloadFile credentials lookup failed host=%s: %s",
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "DownloadFile credentials lookup failed host=%s: %s",
           repo.hostPort.c_str(),
           errorMessage.c_str());
       return false;
@@ -283,10 +379,10 @@ bool BitbucketClient::DownloadFile(const std::string &repositoryUrl,
 
    const auto ok = HttpDownloadBinary(endpoint, creds, outputPath, errorMessage);
    if (!ok) {
-      wxLogError("[bitbucket] DownloadFile request failed url=%s: %s", endpoint.c_str(), errorMessage.c_str());
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "DownloadFile request failed url=%s: %s", endpoint.c_str(), errorMessage.c_str());
       return false;
    }
-   wxLogMessage("[bitbucket] DownloadFile success file=%s", filePath.c_str());
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Info, "DownloadFile success file=%s", filePath.c_str());
    return true;
 }
 
@@ -294,16 +390,10 @@ bool BitbucketClient::ParseRepositoryUrl(const std::string &repositoryUrl,
     RepoCoordinates &out,
     std::string &errorMessage)
 {
-   static const std::regex kScmPattern(R"(^\s*(https?)://([^/]+)/scm/([^/]+)/([^/]+?)(?:\.git)?/?\s*$)",
-       std::regex::icase);
-   static const std::regex kProjectsPattern(
-       R"(^\s*(https?)://([^/]+)/projects/([^/]+)/repos/([^/]+?)(?:\.git)?(?:/.*)?\s*$)", std::regex::icase);
-
    std::smatch match;
-   if (!std::regex_match(repositoryUrl, match, kScmPattern) &&
-       !std::regex_match(repositoryUrl, match, kProjectsPattern)) {
+   if (!MatchRepositoryUrl(repositoryUrl, match)) {
       errorMessage = "Unsupported Bitbucket repository URL. Expected /scm/<project>/<repo>.git or /projects/<project>/repos/<repo>.";
-      wxLogError("[bitbucket] ParseRepositoryUrl unsupported url=%s", repositoryUrl.c_str());
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "ParseRepositoryUrl unsupported url=%s", repositoryUrl.c_str());
       return false;
    }
 
@@ -313,10 +403,10 @@ bool BitbucketClient::ParseRepositoryUrl(const std::string &repositoryUrl,
    out.repositorySlug = match[4].str();
    if (out.projectKey.empty() || out.repositorySlug.empty()) {
       errorMessage = "Bitbucket repository URL is missing project or repository segment.";
-      wxLogError("[bitbucket] ParseRepositoryUrl missing segments url=%s", repositoryUrl.c_str());
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "ParseRepositoryUrl missing segments url=%s", repositoryUrl.c_str());
       return false;
    }
-   wxLogMessage("[bitbucket] ParseRepositoryUrl success host=%s project=%s repo=%s",
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Debug, "ParseRepositoryUrl success host=%s project=%s repo=%s",
        out.hostPort.c_str(),
        out.projectKey.c_str(),
        out.repositorySlug.c_str());
@@ -329,10 +419,10 @@ bool BitbucketClient::GetCredentialsForRepo(const RepoCoordinates &repo,
 {
    if (!credentials_.TryGetForHost(repo.hostPort, outCredentials) || outCredentials.password.empty()) {
       errorMessage = "No credentials found in ~/.m2/settings.xml for host '" + repo.hostPort + "'.";
-      wxLogError("[bitbucket] Credentials not found for host=%s", repo.hostPort.c_str());
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "Credentials not found for host=%s", repo.hostPort.c_str());
       return false;
    }
-   wxLogMessage("[bitbucket] Credentials found for host=%s user=%s",
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Debug, "Credentials found for host=%s user=%s",
        repo.hostPort.c_str(),
        outCredentials.username.empty() ? "<empty>" : outCredentials.username.c_str());
    return true;
@@ -344,7 +434,7 @@ bool BitbucketClient::HttpGetText(const std::string &url,
     std::string &errorMessage) const
 {
    outBody.clear();
-   wxLogMessage("[bitbucket] HTTP GET %s", url.c_str());
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Debug, "HTTP GET %s", url.c_str());
 
    CURL *curl = curl_easy_init();
    if (!curl) {
@@ -369,12 +459,13 @@ bool BitbucketClient::HttpGetText(const std::string &url,
    const auto result = curl_easy_perform(curl);
    long statusCode   = 0;
    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &statusCode);
+   HttpTimings::RecordTransfer(LogModule::Bitbucket, curl, result);
    curl_slist_free_all(headers);
    curl_easy_cleanup(curl);
 
    if (result != CURLE_OK) {
       errorMessage = "HTTP request failed: " + std::string(curl_easy_strerror(result));
-      wxLogError("[bitbucket] HTTP GET transport error url=%s error=%s",
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "HTTP GET transport error url=%s error=%s",
           url.c_str(),
           errorMessage.c_str());
       return false;
@@ -383,14 +474,14 @@ bool BitbucketClient::HttpGetText(const std::string &url,
       const auto snippetLength = std::min<std::size_t>(outBody.size(), 256);
       const auto bodySnippet   = outBody.substr(0, snippetLength);
       errorMessage             = "Bitbucket API request failed with status " + std::to_string(statusCode) + ".";
-      wxLogError("[bitbucket] HTTP GET non-success status=%ld url=%s body=%s",
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "HTTP GET non-success status=%ld url=%s body=%s",
           statusCode,
           url.c_str(),
           bodySnippet.c_str());
       return false;
    }
 
-   wxLogMessage("[bitbucket] HTTP GET status=%ld bytes=%zu", statusCode, outBody.size());
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Debug, "HTTP GET status=%ld bytes=%zu", statusCode, outBody.size());
 
    return true;
 }
@@ -400,18 +491,18 @@ bool BitbucketClient::HttpDownloadBinary(const std::string &url,
     const std::string &outFile,
     std::string &errorMessage) const
 {
-   wxLogMessage("[bitbucket] HTTP DOWNLOAD %s -> %s", url.c_str(), outFile.c_str());
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Debug, "HTTP DOWNLOAD %s -> %s", url.c_str(), outFile.c_str());
    std::ofstream output(outFile, std::ios::binary | std::ios::trunc);
    if (!output) {
       errorMessage = "Unable to open output file: " + outFile;
-      wxLogError("[bitbucket] Download open file failed path=%s", outFile.c_str());
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "Download open file failed path=%s", outFile.c_str());
       return false;
    }
 
    CURL *curl = curl_easy_init();
    if (!curl) {
       errorMessage = "Unable to initialize HTTP client.";
-      wxLogError("[bitbucket] Download curl init failed");
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "Download curl init failed");
       return false;
    }
 
@@ -428,27 +519,97 @@ bool BitbucketClient::HttpDownloadBinary(const std::string &url,
    const auto result = curl_easy_perform(curl);
    long statusCode   = 0;
    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &statusCode);
+   HttpTimings::RecordTransfer(LogModule::Bitbucket, curl, result);
    curl_easy_cleanup(curl);
    output.close();
 
    if (result != CURLE_OK) {
       errorMessage = "File download failed: " + std::string(curl_easy_strerror(result));
-      wxLogError("[bitbucket] HTTP DOWNLOAD transport error url=%s error=%s",
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "HTTP DOWNLOAD transport error url=%s error=%s",
           url.c_str(),
           errorMessage.c_str());
       return false;
    }
    if (statusCode < 200 || statusCode >= 300) {
       errorMessage = "Bitbucket raw file request failed with status " + std::to_string(statusCode) + ".";
-      wxLogError("[bitbucket] HTTP DOWNLOAD non-success status=%ld url=%s", statusCode, url.c_str());
+      CONFY_LOG(LogModule::Bitbucket, LogLevel::Error, "HTTP DOWNLOAD non-success status=%ld url=%s", statusCode, url.c_str());
       return false;
    }
 
-   wxLogMessage("[bitbucket] HTTP DOWNLOAD success status=%ld", statusCode);
+   CONFY_LOG(LogModule::Bitbucket, LogLevel::Debug, "HTTP DOWNLOAD success status=%ld", statusCode);
 
    return true;
 }
 
+bool BitbucketClient::CollectPages(const PageFetcher &fetchPage,
+    std::size_t maxConcurrency,
+    std::vector<std::string> &outValues,
+    std::string &errorMessage)
+{
+   outValues.clear();
+
+   Page first;
+   if (!fetchPage(0, first, errorMessage)) {
+      return false;
+   }
+   outValues = std::move(first.values);
+   if (first.isLastPage) {
+      return true;
+   }
+
+   // Bitbucket reports no total count, so following pages are requested
+   // speculatively in windows; requests past the end just come back empty.
+   const int pageSize = first.limit > 0 ? first.limit : static_cast<int>(outValues.size());
+   int nextStart      = first.nextPageStart;
+   if (pageSize <= 0 || nextStart < 0) {
+      errorMessage.clear();
+      return false;
+   }
+
+   const auto windowSize = std::max<std::size_t>(maxConcurrency, 1);
+   while (true) {
+      std::vector<Page> pages(windowSize);
+      std::vector<std::string> errors(windowSize);
+      std::vector<char> succeeded(windowSize, 0);
+      RunParallel(windowSize, windowSize, [&](std::size_t i) {
+         const auto start = nextStart + static_cast<int>(i) * pageSize;
+         succeeded[i]     = fetchPage(start, pages[i], errors[i]) ? 1 : 0;
+      });
+
+      // Consume pages in order. If the server's paging deviates from the
+      // assumed page size, the rest of the window is discarded and paging
+      // resumes from the last consistent page.
+      for (std::size_t i = 0; i < windowSize; ++i) {
+         if (!succeeded[i]) {
+            errorMessage = errors[i];
+            return false;
+         }
+         auto &page = pages[i];
+         outValues.insert(outValues.end(),
+             std::make_move_iterator(page.values.begin()),
+             std::make_move_iterator(page.values.end()));
+         if (page.isLastPage) {
+            return true;
+         }
+         if (page.nextPageStart < 0) {
+            errorMessage.clear();
+            return false;
+         }
+         const auto expectedNext = nextStart + static_cast<int>(i + 1) * pageSize;
+         if (page.nextPageStart != expectedNext || i + 1 == windowSize) {
+            nextStart = page.nextPageStart;
+            break;
+         }
+      }
+   }
+}
+
+bool BitbucketClient::IsRepositoryUrl(const std::string &repositoryUrl)
+{
+   std::smatch match;
+   return MatchRepositoryUrl(repositoryUrl, match);
+}
+
 std::string BitbucketClient::BuildCurlUserPwd(const ServerCredentials &creds)
 {
    return creds.username + ":" + creds.password;
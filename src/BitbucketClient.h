@@ -2,6 +2,8 @@
 
 #include "AuthCredentials.h"
 
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -18,12 +20,37 @@ class BitbucketClient final
       std::string repositorySlug;
    };
 
+   struct Page
+   {
+      std::vector<std::string> values;
+      bool isLastPage{true};
+      int nextPageStart{-1};
+      int limit{0};
+   };
+   using PageFetcher = std::function<bool(int start, Page &outPage, std::string &errorMessage)>;
+
    explicit BitbucketClient(AuthCredentials credentials);
 
    bool ListBranches(const std::string &repositoryUrl,
        std::vector<std::string> &outBranches,
        std::string &errorMessage) const;
 
+   // Branch and tag display names, sorted and de-duplicated like
+   // GitClient::ListBranchesAndTags.
+   bool ListBranchesAndTags(const std::string &repositoryUrl,
+       std::vector<std::string> &outRefs,
+       std::string &errorMessage) const;
+
+   // First page of branches and tags whose names contain filterText, using
+   // Bitbucket's server-side filterText matching. outHasMore is set when
+   // either listing has further matches.
+   bool SearchBranchesAndTags(const std::string &repositoryUrl,
+       const std::string &filterText,
+       int limit,
+       std::vector<std::string> &outRefs,
+       bool &outHasMore,
+       std::string &errorMessage) const;
+
    bool ListTopLevelXmlFiles(const std::string &repositoryUrl,
        const std::string &branch,
        std::vector<std::string> &outFiles,
@@ -38,12 +65,36 @@ class BitbucketClient final
    static bool ParseRepositoryUrl(const std::string &repositoryUrl,
        RepoCoordinates &out,
        std::string &errorMessage);
+   static bool IsRepositoryUrl(const std::string &repositoryUrl);
+
+   // Fetches the first page, then requests up to maxConcurrency following
+   // pages at once using the page size the server reported. Values are
+   // appended in page order.
+   static bool CollectPages(const PageFetcher &fetchPage,
+       std::size_t maxConcurrency,
+       std::vector<std::string> &outValues,
+       std::string &errorMessage);
 
  private:
    bool GetCredentialsForRepo(const RepoCoordinates &repo,
        ServerCredentials &outCredentials,
        std::string &errorMessage) const;
 
+   bool FetchRefPage(const RepoCoordinates &repo,
+       const ServerCredentials &creds,
+       const std::string &collection,
+       const std::string &filterText,
+       int start,
+       int limit,
+       Page &outPage,
+       std::string &errorMessage) const;
+
+   bool ListRefDisplayIds(const RepoCoordinates &repo,
+       const ServerCredentials &creds,
+       const std::string &collection,
+       std::vector<std::string> &outDisplayIds,
+       std::string &errorMessage) const;
+
    bool HttpGetText(const std::string &url,
        const ServerCredentials &creds,
        std::string &outBody,
@@ -0,0 +1,117 @@
+#include "AppSettings.h"
+#include "Log.h"
+#include "SyncCommand.h"
+#include "TransferHistory.h"
+
+#include <wx/filename.h>
+#include <wx/init.h>
+#include <wx/log.h>
+#include <wx/stdpaths.h>
+
+#include <atomic>
+#include <csignal>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<bool> g_cancelRequested{false};
+
+extern "C" void HandleTerminationSignal(int)
+{
+   g_cancelRequested.store(true);
+}
+
+std::string ExecutableDirectory()
+{
+   wxString executableDir;
+   const auto executablePath = wxStandardPaths::Get().GetExecutablePath();
+   if (!executablePath.empty()) {
+      wxFileName executableFile(executablePath);
+      if (executableFile.IsOk()) {
+         executableDir = executableFile.GetPath();
+      }
+   }
+   if (executableDir.empty()) {
+      executableDir = wxFileName::GetCwd();
+   }
+   return executableDir.ToStdString();
+}
+
+} // namespace
+
+// Headless entry point for build agents: only wxBase is initialized, no
+// display connection or GUI toolkit is touched.
+int main(int argc, char **argv)
+{
+   using namespace confy;
+
+   const std::vector<std::string> args(argv + 1, argv + argc);
+   if (args.empty() || args[0] == "-h" || args[0] == "--help") {
+      std::cout << SyncUsage();
+      return args.empty() ? kExitUsageError : kExitSuccess;
+   }
+   if (args[0] != "sync") {
+      std::cerr << "Unknown command '" << args[0] << "'\n\n"
+                << SyncUsage();
+      return kExitUsageError;
+   }
+
+   SyncOptions options;
+   bool showHelp = false;
+   std::string errorMessage;
+   if (!ParseSyncArguments(std::vector<std::string>(args.begin() + 1, args.end()), options, showHelp, errorMessage)) {
+      std::cerr << errorMessage << "\n\n"
+                << SyncUsage();
+      return kExitUsageError;
+   }
+   if (showHelp) {
+      std::cout << SyncUsage();
+      return kExitSuccess;
+   }
+
+   // Log records go to stderr so stdout only carries progress.
+   const auto logLevels = !options.logLevels.empty() ? options.logLevels : (options.verbose ? "info" : "warning");
+   if (!Log::Configure(logLevels, errorMessage)) {
+      std::cerr << "--log-level: " << errorMessage << '\n';
+      return kExitUsageError;
+   }
+
+   wxInitializer wxInit;
+   if (!wxInit.IsOk()) {
+      std::cerr << "Failed to initialize the wx runtime\n";
+      return kExitConfigError;
+   }
+   wxLog::SetActiveTarget(new wxLogStderr());
+   wxLog::SetLogLevel(options.verbose ? wxLOG_Info : wxLOG_Warning);
+   wxLog::DisableTimestamp();
+
+   AppSettings::Initialize(ExecutableDirectory());
+   const auto &settings = AppSettings::Get();
+   SourceJobSettings sourceSettings;
+   sourceSettings.mirrorCacheDirectory = settings.GetGitMirrorCacheDirectory();
+   sourceSettings.refuseDirtyReclone   = settings.IsGitRefuseDirtyRecloneEnabled();
+   sourceSettings.parallelJobs         = settings.GetGitParallelJobs();
+   sourceSettings.outputTailBytes      = settings.GetGitOutputTailBytes();
+   sourceSettings.logDirectory         = settings.GetGitLogDirectory();
+
+   // Shared with the GUI, so both learn from each other's downloads.
+   auto history = std::make_shared<TransferHistory>(
+       (std::filesystem::path(settings.GetCacheDirectory()) / "transfer-history.json").string());
+   if (!history->Load(errorMessage)) {
+      std::cerr << errorMessage << '\n';
+   }
+
+   std::signal(SIGINT, HandleTerminationSignal);
+   std::signal(SIGTERM, HandleTerminationSignal);
+
+   const auto exitCode = RunSync(options, sourceSettings, history, g_cancelRequested, std::cout, std::cerr);
+   if (!history->SaveIfModified(errorMessage)) {
+      std::cerr << errorMessage << '\n';
+   }
+   delete wxLog::SetActiveTarget(nullptr);
+   return exitCode;
+}
@@ -2,99 +2,269 @@
 
 #include "rapidxml.hpp"
 
-#include <cctype>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <array>
 #include <fstream>
-#include <iterator>
-#include <optional>
 #include <regex>
+#include <string_view>
+#include <unordered_set>
 #include <vector>
 
 namespace {
 
+using confy::ComponentConfig;
+using confy::ConfigModel;
+using confy::LoadResult;
 using rapidxml::xml_document;
 using rapidxml::xml_node;
 
-std::optional<std::string> ReadAllText(const std::string &filePath)
+// Text of a config file, null-terminated and writable so that rapidxml can
+// parse it in place. The file is mapped copy-on-write, so nothing is
+// copied up front and only the pages the parser writes to are duplicated.
+// Files that cannot be mapped, or whose last page has no room for the
+// terminating zero, are read into memory instead.
+class ConfigFileText final
 {
-   std::ifstream input(filePath, std::ios::binary);
-   if (!input) {
-      return std::nullopt;
+ public:
+   ConfigFileText() = default;
+   ~ConfigFileText() { Unmap(); }
+
+   ConfigFileText(const ConfigFileText &)            = delete;
+   ConfigFileText &operator=(const ConfigFileText &) = delete;
+
+   bool Open(const std::string &filePath)
+   {
+      if (Map(filePath)) {
+         return true;
+      }
+
+      std::ifstream input(filePath, std::ios::binary | std::ios::ate);
+      if (!input) {
+         return false;
+      }
+      const auto size = static_cast<std::size_t>(input.tellg());
+      buffer_.assign(size + 1, '\0');
+      input.seekg(0);
+      return static_cast<bool>(input.read(buffer_.data(), static_cast<std::streamsize>(size)));
    }
 
-   return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
-}
+   char *Data() { return mapping_ ? static_cast<char *>(mapping_) : buffer_.data(); }
 
-std::string ToLower(std::string value)
-{
-   for (char &c : value) {
-      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+ private:
+#ifdef _WIN32
+   bool Map(const std::string &filePath)
+   {
+      const HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+          FILE_ATTRIBUTE_NORMAL, nullptr);
+      if (file == INVALID_HANDLE_VALUE) {
+         return false;
+      }
+      LARGE_INTEGER size{};
+      SYSTEM_INFO system{};
+      GetSystemInfo(&system);
+      if (!GetFileSizeEx(file, &size) || size.QuadPart == 0 || size.QuadPart % system.dwPageSize == 0) {
+         CloseHandle(file);
+         return false;
+      }
+      const HANDLE section = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+      CloseHandle(file);
+      if (!section) {
+         return false;
+      }
+      mapping_ = MapViewOfFile(section, FILE_MAP_COPY, 0, 0, 0);
+      CloseHandle(section);
+      return mapping_ != nullptr;
    }
-   return value;
-}
 
-bool NameEqualsCI(const xml_node<> *node, const std::string &name)
+   void Unmap()
+   {
+      if (mapping_) {
+         UnmapViewOfFile(mapping_);
+         mapping_ = nullptr;
+      }
+   }
+#else
+   bool Map(const std::string &filePath)
+   {
+      const int fd = open(filePath.c_str(), O_RDONLY);
+      if (fd < 0) {
+         return false;
+      }
+      struct stat info{};
+      const auto pageSize = static_cast<off_t>(sysconf(_SC_PAGESIZE));
+      if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0 || pageSize <= 0 ||
+          info.st_size % pageSize == 0) {
+         close(fd);
+         return false;
+      }
+      // The rest of the last page reads as zeros, which terminates the text.
+      void *mapping = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if (mapping == MAP_FAILED) {
+         return false;
+      }
+      mapping_     = mapping;
+      mappedBytes_ = static_cast<std::size_t>(info.st_size);
+      return true;
+   }
+
+   void Unmap()
+   {
+      if (mapping_) {
+         munmap(mapping_, mappedBytes_);
+         mapping_ = nullptr;
+      }
+   }
+
+   std::size_t mappedBytes_{0};
+#endif
+
+   void *mapping_{nullptr};
+   std::vector<char> buffer_;
+};
+
+// Compares an element name with a lowercase ASCII name without allocating.
+bool NameIs(const xml_node<> *node, std::string_view lowercaseName)
 {
-   if (!node) {
+   if (!node || node->name_size() != lowercaseName.size()) {
       return false;
    }
-   return ToLower(node->name()) == ToLower(name);
+   const char *name = node->name();
+   for (std::size_t i = 0; i < lowercaseName.size(); ++i) {
+      char c = name[i];
+      if (c >= 'A' && c <= 'Z') {
+         c = static_cast<char>(c - 'A' + 'a');
+      }
+      if (c != lowercaseName[i]) {
+         return false;
+      }
+   }
+   return true;
 }
 
-xml_node<> *FindChildCI(xml_node<> *parent, const std::string &name)
+// Looks up several children in one pass over parent's children instead of
+// one pass per name. As with a search from the front, the first of several
+// children with the same name wins.
+template <std::size_t N>
+std::array<xml_node<> *, N> FindChildrenCI(xml_node<> *parent, const std::array<std::string_view, N> &names)
 {
+   std::array<xml_node<> *, N> found{};
    if (!parent) {
-      return nullptr;
+      return found;
    }
 
    for (auto *child = parent->first_node(); child != nullptr; child = child->next_sibling()) {
-      if (NameEqualsCI(child, name)) {
-         return child;
+      for (std::size_t i = 0; i < N; ++i) {
+         if (!found[i] && NameIs(child, names[i])) {
+            found[i] = child;
+            break;
+         }
       }
    }
-
-   return nullptr;
-}
-
-std::string GetChildValueCI(xml_node<> *parent, const std::string &name)
-{
-   if (auto *child = FindChildCI(parent, name)) {
-      return child->value();
-   }
-   return {};
+   return found;
 }
 
-bool HasChildCI(xml_node<> *parent, const std::string &name)
+std::string ValueOf(const xml_node<> *node)
 {
-   return FindChildCI(parent, name) != nullptr;
+   return node ? std::string(node->value(), node->value_size()) : std::string();
 }
 
-std::vector<std::string> CollectRegexFiltersCI(xml_node<> *parent, const std::string &sectionName)
+std::vector<std::string> CollectSectionValuesCI(const xml_node<> *section, std::string_view itemName)
 {
-   std::vector<std::string> filters;
-   auto *section = FindChildCI(parent, sectionName);
+   std::vector<std::string> values;
    if (!section) {
-      return filters;
+      return values;
    }
 
    for (auto *node = section->first_node(); node != nullptr; node = node->next_sibling()) {
-      if (!NameEqualsCI(node, "regex")) {
+      if (!NameIs(node, itemName) || node->value_size() == 0) {
          continue;
       }
-
-      const std::string pattern = node->value();
-      if (!pattern.empty()) {
-         filters.push_back(pattern);
-      }
+      values.push_back(ValueOf(node));
    }
 
-   return filters;
+   return values;
+}
+
+enum RootField
+{
+   kRootVersion,
+   kRootPath,
+   kRootComponents,
+   kRootFieldCount
+};
+constexpr std::array<std::string_view, kRootFieldCount> kRootFields = {"version", "path", "components"};
+
+enum ComponentField
+{
+   kComponentName,
+   kComponentDisplayName,
+   kComponentPath,
+   kComponentSource,
+   kComponentArtifact,
+   kComponentFieldCount
+};
+constexpr std::array<std::string_view, kComponentFieldCount> kComponentFields = {
+    "name", "displayname", "path", "source", "artifact"};
+
+enum SourceField
+{
+   kSourceIsEnabled,
+   kSourceUrl,
+   kSourceBranchOrTag,
+   kSourceNoShallow,
+   kSourceFilter,
+   kSourceSparseCheckout,
+   kSourceScript,
+   kSourceFieldCount
+};
+constexpr std::array<std::string_view, kSourceFieldCount> kSourceFields = {
+    "isenabled", "url", "branchortag", "noshallow", "filter", "sparsecheckout", "script"};
+
+enum ArtifactField
+{
+   kArtifactIsEnabled,
+   kArtifactUrl,
+   kArtifactRelativePath,
+   kArtifactVersion,
+   kArtifactBuildType,
+   kArtifactScript,
+   kArtifactRegexInclude,
+   kArtifactRegexExclude,
+   kArtifactFieldCount
+};
+constexpr std::array<std::string_view, kArtifactFieldCount> kArtifactFields = {
+    "isenabled", "url", "relativepath", "version", "buildtype", "script", "regex-include", "regex-exclude"};
+
+bool ValidateCloneFilter(const std::string &filter, std::string &errorMessage)
+{
+   static const std::regex kFilterPattern(R"(blob:none|blob:limit=[0-9]+[kKmMgG]?|tree:[0-9]+)");
+   if (filter.empty() || std::regex_match(filter, kFilterPattern)) {
+      return true;
+   }
+   errorMessage = "Invalid <Filter> '" + filter + "' (expected blob:none, blob:limit=<n> or tree:<depth>)";
+   return false;
 }
 
+// Large configs repeat the same few patterns; validPatterns remembers the
+// ones already compiled during this load.
 bool ValidateRegexFilters(const std::vector<std::string> &filters,
     const std::string &sectionName,
+    std::unordered_set<std::string> &validPatterns,
     std::string &errorMessage)
 {
    for (const auto &pattern : filters) {
+      if (validPatterns.count(pattern) != 0) {
+         continue;
+      }
       try {
          std::regex compiled(pattern);
          (void)compiled;
@@ -102,6 +272,7 @@ bool ValidateRegexFilters(const std::vector<std::string> &filters,
          errorMessage = "Invalid regex in <" + sectionName + ">: '" + pattern + "' (" + ex.what() + ")";
          return false;
       }
+      validPatterns.insert(pattern);
    }
    return true;
 }
@@ -120,81 +291,92 @@ std::string ExpandComponentPathMacro(const std::string &componentPath, const std
    return expanded;
 }
 
-} // namespace
-
-namespace confy {
-
-LoadResult ConfigLoader::LoadFromString(const std::string &xml) const
+// Parses text in place; it must be null-terminated and stay alive until
+// the model is built.
+LoadResult ParseConfig(char *text)
 {
    LoadResult result;
 
    try {
-      std::vector<char> xmlBuffer(xml.begin(), xml.end());
-      xmlBuffer.push_back('\0');
-
+      // Element text still lands in value(); only the separate nodes for
+      // text (mostly the indentation between elements) are skipped.
       xml_document<> document;
-      document.parse<0>(xmlBuffer.data());
+      document.parse<rapidxml::parse_no_data_nodes>(text);
 
       auto *root = document.first_node();
-      if (!NameEqualsCI(root, "config")) {
+      if (!NameIs(root, "config")) {
          result.errorMessage = "Root <Config> node not found.";
          return result;
       }
 
       ConfigModel model;
 
-      const auto versionText = GetChildValueCI(root, "version");
+      const auto rootFields  = FindChildrenCI(root, kRootFields);
+      const auto versionText = ValueOf(rootFields[kRootVersion]);
       if (!versionText.empty()) {
          model.version = std::stoi(versionText);
       }
-      model.rootPath = GetChildValueCI(root, "path");
+      model.rootPath = ValueOf(rootFields[kRootPath]);
 
-      auto *componentsNode = FindChildCI(root, "components");
-      if (componentsNode) {
+      std::unordered_set<std::string> validPatterns;
+      if (auto *componentsNode = rootFields[kRootComponents]) {
+         std::size_t componentCount = 0;
          for (auto *node = componentsNode->first_node(); node != nullptr; node = node->next_sibling()) {
-            if (!NameEqualsCI(node, "component")) {
+            componentCount += NameIs(node, "component") ? 1 : 0;
+         }
+         model.components.reserve(componentCount);
+
+         for (auto *node = componentsNode->first_node(); node != nullptr; node = node->next_sibling()) {
+            if (!NameIs(node, "component")) {
                continue;
             }
 
+            const auto fields = FindChildrenCI(node, kComponentFields);
             ComponentConfig component;
-            component.name        = GetChildValueCI(node, "name");
-            component.displayName = GetChildValueCI(node, "displayname");
+            component.name        = ValueOf(fields[kComponentName]);
+            component.displayName = ValueOf(fields[kComponentDisplayName]);
             if (component.displayName.empty()) {
                component.displayName = component.name;
             }
-            component.path = ExpandComponentPathMacro(GetChildValueCI(node, "path"), model.rootPath);
+            component.path = ExpandComponentPathMacro(ValueOf(fields[kComponentPath]), model.rootPath);
 
-            auto *sourceNode = FindChildCI(node, "source");
-            if (sourceNode) {
+            if (fields[kComponentSource]) {
+               const auto source            = FindChildrenCI(fields[kComponentSource], kSourceFields);
                component.sourcePresent      = true;
-               component.source.enabled     = HasChildCI(sourceNode, "isenabled");
-               component.source.url         = GetChildValueCI(sourceNode, "url");
-               component.source.branchOrTag = GetChildValueCI(sourceNode, "branchortag");
-               component.source.shallow     = !HasChildCI(sourceNode, "noshallow");
-               component.source.script      = GetChildValueCI(sourceNode, "script");
+               component.source.enabled     = source[kSourceIsEnabled] != nullptr;
+               component.source.url         = ValueOf(source[kSourceUrl]);
+               component.source.branchOrTag = ValueOf(source[kSourceBranchOrTag]);
+               component.source.shallow     = source[kSourceNoShallow] == nullptr;
+               component.source.filter      = ValueOf(source[kSourceFilter]);
+               component.source.sparsePaths = CollectSectionValuesCI(source[kSourceSparseCheckout], "path");
+               component.source.script      = ValueOf(source[kSourceScript]);
+
+               if (!ValidateCloneFilter(component.source.filter, result.errorMessage)) {
+                  return result;
+               }
             }
 
-            auto *artifactNode = FindChildCI(node, "artifact");
-            if (artifactNode) {
-               component.artifactPresent       = true;
-               component.artifact.enabled      = HasChildCI(artifactNode, "isenabled");
-               component.artifact.url          = GetChildValueCI(artifactNode, "url");
-               component.artifact.relativePath = GetChildValueCI(artifactNode, "relativepath");
-               component.artifact.version      = GetChildValueCI(artifactNode, "version");
-               component.artifact.buildType    = GetChildValueCI(artifactNode, "buildtype");
-               component.artifact.script       = GetChildValueCI(artifactNode, "script");
-               component.artifact.regexIncludes =
-                   CollectRegexFiltersCI(artifactNode, "regex-include");
-               component.artifact.regexExcludes =
-                   CollectRegexFiltersCI(artifactNode, "regex-exclude");
+            if (fields[kComponentArtifact]) {
+               const auto artifact              = FindChildrenCI(fields[kComponentArtifact], kArtifactFields);
+               component.artifactPresent        = true;
+               component.artifact.enabled       = artifact[kArtifactIsEnabled] != nullptr;
+               component.artifact.url           = ValueOf(artifact[kArtifactUrl]);
+               component.artifact.relativePath  = ValueOf(artifact[kArtifactRelativePath]);
+               component.artifact.version       = ValueOf(artifact[kArtifactVersion]);
+               component.artifact.buildType     = ValueOf(artifact[kArtifactBuildType]);
+               component.artifact.script        = ValueOf(artifact[kArtifactScript]);
+               component.artifact.regexIncludes = CollectSectionValuesCI(artifact[kArtifactRegexInclude], "regex");
+               component.artifact.regexExcludes = CollectSectionValuesCI(artifact[kArtifactRegexExclude], "regex");
 
                if (!ValidateRegexFilters(component.artifact.regexIncludes,
                        "regex-include",
+                       validPatterns,
                        result.errorMessage)) {
                   return result;
                }
                if (!ValidateRegexFilters(component.artifact.regexExcludes,
                        "regex-exclude",
+                       validPatterns,
                        result.errorMessage)) {
                   return result;
                }
@@ -216,14 +398,28 @@ LoadResult ConfigLoader::LoadFromString(const std::string &xml) const
    }
 }
 
+} // namespace
+
+namespace confy {
+
+LoadResult ConfigLoader::LoadFromString(const std::string &xml) const
+{
+   // rapidxml writes into the text it parses, so it gets a copy.
+   std::vector<char> xmlBuffer;
+   xmlBuffer.reserve(xml.size() + 1);
+   xmlBuffer.assign(xml.begin(), xml.end());
+   xmlBuffer.push_back('\0');
+   return ParseConfig(xmlBuffer.data());
+}
+
 LoadResult ConfigLoader::LoadFromFile(const std::string &filePath) const
 {
-   const auto xml = ReadAllText(filePath);
-   if (!xml.has_value()) {
+   ConfigFileText text;
+   if (!text.Open(filePath)) {
       return LoadResult{false, "Could not read file.", {}};
    }
 
-   return LoadFromString(*xml);
+   return ParseConfig(text.Data());
 }
 
 } // namespace confy
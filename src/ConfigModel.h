@@ -11,12 +11,22 @@ struct SourceConfig
    std::string url;
    std::string branchOrTag;
    bool shallow{true};
+   // Partial clone object filter passed to `git clone --filter`, e.g. "blob:none" or "tree:0".
+   std::string filter;
+   // Directories checked out in cone-mode sparse checkout; empty checks out everything.
+   std::vector<std::string> sparsePaths;
    std::string script;
 };
 
 inline bool operator==(const SourceConfig &lhs, const SourceConfig &rhs)
 {
-   return lhs.enabled == rhs.enabled && lhs.url == rhs.url && lhs.branchOrTag == rhs.branchOrTag && lhs.shallow == rhs.shallow && lhs.script == rhs.script;
+   return lhs.enabled == rhs.enabled &&
+          lhs.url == rhs.url &&
+          lhs.branchOrTag == rhs.branchOrTag &&
+          lhs.shallow == rhs.shallow &&
+          lhs.filter == rhs.filter &&
+          lhs.sparsePaths == rhs.sparsePaths &&
+          lhs.script == rhs.script;
 }
 
 struct ArtifactConfig
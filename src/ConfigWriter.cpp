@@ -82,6 +82,16 @@ std::string SaveConfigToString(const ConfigModel &config)
          if (!component.source.shallow) {
             xml << "                <NoShallow/>\n";
          }
+         if (!component.source.filter.empty()) {
+            WriteTag(xml, "                ", "Filter", component.source.filter);
+         }
+         if (!component.source.sparsePaths.empty()) {
+            xml << "                <SparseCheckout>\n";
+            for (const auto &path : component.source.sparsePaths) {
+               WriteTag(xml, "                    ", "path", path);
+            }
+            xml << "                </SparseCheckout>\n";
+         }
          WriteTag(xml, "                ", "Script", component.source.script);
          xml << "            </Source>\n";
       }
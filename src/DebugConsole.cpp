@@ -1,22 +1,129 @@
 #include "DebugConsole.h"
 
+#include "AppSettings.h"
+#include "HttpTimings.h"
+#include "Log.h"
+#include "RingBuffer.h"
+
 #include <wx/app.h>
+#include <wx/arrstr.h>
 #include <wx/button.h>
 #include <wx/checkbox.h>
 #include <wx/frame.h>
+#include <wx/listctrl.h>
 #include <wx/log.h>
 #include <wx/sizer.h>
-#include <wx/textctrl.h>
 #include <wx/thread.h>
+#include <wx/timer.h>
 #include <wx/weakref.h>
 #include <wx/window.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <mutex>
-#include <vector>
+#include <string>
 
 namespace confy {
 namespace {
 
+// Lines logged from workers are rendered at most this often.
+constexpr int kFlushIntervalMs = 100;
+
+class DebugConsoleFrame;
+
+class DebugLogTarget final : public wxLog
+{
+ public:
+   struct LineStats
+   {
+      std::size_t count{0};
+      std::size_t longestLength{0};
+   };
+
+   explicit DebugLogTarget(std::size_t capacity) : lines_(capacity) {}
+
+   void AttachConsole(DebugConsoleFrame *consoleFrame);
+
+   bool IsConsoleVisible() const;
+
+   // Index 0 is the oldest line still kept.
+   wxString GetLine(std::size_t index) const
+   {
+      std::scoped_lock lock(mutex_);
+      return index < lines_.Size() ? wxString::FromUTF8(lines_.At(index)) : wxString();
+   }
+
+   // Called by the console when it renders; lines logged from now on
+   // schedule the next render.
+   LineStats BeginFlush()
+   {
+      std::scoped_lock lock(mutex_);
+      flushPending_ = false;
+      return {lines_.Size(), longestLineLength_};
+   }
+
+   void ClearLines()
+   {
+      std::scoped_lock lock(mutex_);
+      lines_.Clear();
+      longestLineLength_ = 0;
+   }
+
+ protected:
+   void DoLogText(const wxString &msg) override;
+
+ private:
+   mutable std::mutex mutex_;
+   RingBuffer<std::string> lines_;
+   std::size_t longestLineLength_{0};
+   bool flushPending_{false};
+   DebugConsoleFrame *consoleFrame_{nullptr};
+};
+
+DebugLogTarget *g_debugLogTarget  = nullptr;
+wxLog *g_previousLogTarget        = nullptr;
+DebugConsoleFrame *g_consoleFrame = nullptr;
+
+// Virtual list: rows are fetched from the log buffer only when painted, so
+// the number of lines kept does not affect how fast the console opens.
+class DebugLogListCtrl final : public wxListCtrl
+{
+ public:
+   explicit DebugLogListCtrl(wxWindow *parent) :
+       wxListCtrl(parent,
+           wxID_ANY,
+           wxDefaultPosition,
+           wxDefaultSize,
+           wxLC_REPORT | wxLC_VIRTUAL | wxLC_NO_HEADER | wxLC_SINGLE_SEL)
+   {
+      AppendColumn(wxString());
+   }
+
+ protected:
+   wxString OnGetItemText(long item, long) const override
+   {
+      return g_debugLogTarget != nullptr ? g_debugLogTarget->GetLine(static_cast<std::size_t>(item)) : wxString();
+   }
+};
+
+// Writes the report straight to wxLog rather than through HttpTimings::
+// LogReport, so that the button works whatever the general log level is.
+void ShowHttpTimings()
+{
+   const wxString tag = wxString::Format("[%s] ", Log::ModuleName(LogModule::General));
+   const auto report  = HttpTimings::BuildReport();
+   if (report.empty()) {
+      wxLogMessage("%shttp timings: no requests recorded", tag);
+      return;
+   }
+   wxLogMessage("%shttp timings per host:", tag);
+   for (const auto &line : wxSplit(wxString::FromUTF8(report), '\n', '\0')) {
+      if (!line.empty()) {
+         wxLogMessage("%s%s", tag, line);
+      }
+   }
+}
+
 class DebugConsoleFrame final : public wxFrame
 {
  public:
@@ -25,13 +132,8 @@ class DebugConsoleFrame final : public wxFrame
    {
       auto *rootSizer = new wxBoxSizer(wxVERTICAL);
 
-      logText_ = new wxTextCtrl(this,
-          wxID_ANY,
-          "",
-          wxDefaultPosition,
-          wxDefaultSize,
-          wxTE_MULTILINE | wxTE_READONLY | wxTE_RICH2 | wxHSCROLL);
-      rootSizer->Add(logText_, 1, wxALL | wxEXPAND, 8);
+      logList_ = new DebugLogListCtrl(this);
+      rootSizer->Add(logList_, 1, wxALL | wxEXPAND, 8);
 
       auto *controlsSizer = new wxBoxSizer(wxHORIZONTAL);
       autoScrollCheck_    = new wxCheckBox(this, wxID_ANY, "Auto-scroll");
@@ -39,7 +141,11 @@ class DebugConsoleFrame final : public wxFrame
       controlsSizer->Add(autoScrollCheck_, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 8);
 
       auto *clearButton = new wxButton(this, wxID_CLEAR, "Clear");
-      controlsSizer->Add(clearButton, 0, wxALIGN_CENTER_VERTICAL);
+      controlsSizer->Add(clearButton, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 8);
+
+      auto *timingsButton = new wxButton(this, wxID_ANY, "HTTP Timings");
+      timingsButton->SetToolTip("Show p50/p95/p99 request timings per host since the last Apply");
+      controlsSizer->Add(timingsButton, 0, wxALIGN_CENTER_VERTICAL);
       controlsSizer->AddStretchSpacer();
 
       rootSizer->Add(controlsSizer, 0, wxLEFT | wxRIGHT | wxBOTTOM | wxEXPAND, 8);
@@ -47,9 +153,20 @@ class DebugConsoleFrame final : public wxFrame
       SetSizer(rootSizer);
 
       clearButton->Bind(wxEVT_BUTTON, [this](wxCommandEvent &) {
-         logText_->Clear();
+         if (g_debugLogTarget != nullptr) {
+            g_debugLogTarget->ClearLines();
+         }
+         Flush();
+      });
+      timingsButton->Bind(wxEVT_BUTTON, [](wxCommandEvent &) { ShowHttpTimings(); });
+
+      logList_->Bind(wxEVT_SIZE, [this](wxSizeEvent &event) {
+         event.Skip();
+         UpdateColumnWidth();
       });
 
+      flushTimer_.Bind(wxEVT_TIMER, [this](wxTimerEvent &) { Flush(); });
+
       Bind(wxEVT_CLOSE_WINDOW, [this](wxCloseEvent &event) {
          if (event.CanVeto()) {
             Hide();
@@ -60,104 +177,97 @@ class DebugConsoleFrame final : public wxFrame
       });
    }
 
-   void AppendLogLine(const wxString &line)
-   {
-      if (logText_ == nullptr) {
-         return;
-      }
-      logText_->AppendText(line);
-      logText_->AppendText("\n");
+   ~DebugConsoleFrame() override { flushTimer_.Stop(); }
 
-      if (autoScrollCheck_ != nullptr && autoScrollCheck_->GetValue()) {
-         const auto lastPosition = logText_->GetLastPosition();
-         logText_->ShowPosition(lastPosition);
+   void ScheduleFlush()
+   {
+      if (!flushTimer_.IsRunning()) {
+         flushTimer_.StartOnce(kFlushIntervalMs);
       }
    }
 
-   void SetLogLines(const std::vector<wxString> &lines)
+   // Renders everything logged since the previous flush in one update.
+   void Flush()
    {
-      if (logText_ == nullptr) {
+      if (g_debugLogTarget == nullptr || logList_ == nullptr) {
          return;
       }
-      logText_->Clear();
-      for (const auto &line : lines) {
-         logText_->AppendText(line);
-         logText_->AppendText("\n");
-      }
-
-      if (autoScrollCheck_ != nullptr && autoScrollCheck_->GetValue()) {
-         const auto lastPosition = logText_->GetLastPosition();
-         logText_->ShowPosition(lastPosition);
+      const auto stats   = g_debugLogTarget->BeginFlush();
+      longestLineLength_ = stats.longestLength;
+      logList_->SetItemCount(static_cast<long>(stats.count));
+      // Once the buffer is full every row shifts up, so the visible rows are
+      // repainted even if the count did not change.
+      logList_->Refresh();
+      UpdateColumnWidth();
+
+      if (stats.count > 0 && autoScrollCheck_ != nullptr && autoScrollCheck_->GetValue()) {
+         logList_->EnsureVisible(static_cast<long>(stats.count - 1));
       }
    }
 
  private:
-   wxTextCtrl *logText_{nullptr};
+   void UpdateColumnWidth()
+   {
+      const auto contentWidth = static_cast<int>(longestLineLength_ + 2) * logList_->GetCharWidth();
+      logList_->SetColumnWidth(0, std::max(logList_->GetClientSize().GetWidth(), contentWidth));
+   }
+
+   DebugLogListCtrl *logList_{nullptr};
    wxCheckBox *autoScrollCheck_{nullptr};
+   wxTimer flushTimer_;
+   std::size_t longestLineLength_{0};
 };
 
-class DebugLogTarget final : public wxLog
+void DebugLogTarget::AttachConsole(DebugConsoleFrame *consoleFrame)
 {
- public:
-   void AttachConsole(DebugConsoleFrame *consoleFrame)
-   {
-      std::vector<wxString> snapshot;
-      {
-         std::scoped_lock lock(mutex_);
-         consoleFrame_ = consoleFrame;
-         snapshot      = lines_;
-      }
-
-      if (consoleFrame != nullptr) {
-         consoleFrame->SetLogLines(snapshot);
-      }
-   }
-
-   bool IsConsoleVisible() const
    {
       std::scoped_lock lock(mutex_);
-      return consoleFrame_ != nullptr && consoleFrame_->IsShown();
+      consoleFrame_ = consoleFrame;
    }
 
- protected:
-   void DoLogText(const wxString &msg) override
-   {
-      wxWeakRef<DebugConsoleFrame> consoleFrame;
-      {
-         std::scoped_lock lock(mutex_);
-         lines_.push_back(msg);
-         consoleFrame = consoleFrame_;
-      }
-
-      if (consoleFrame == nullptr) {
-         return;
-      }
+   if (consoleFrame != nullptr) {
+      consoleFrame->Flush();
+   }
+}
 
-      if (wxIsMainThread()) {
-         consoleFrame->AppendLogLine(msg);
-         return;
-      }
+bool DebugLogTarget::IsConsoleVisible() const
+{
+   std::scoped_lock lock(mutex_);
+   return consoleFrame_ != nullptr && consoleFrame_->IsShown();
+}
 
-      if (wxTheApp == nullptr) {
+void DebugLogTarget::DoLogText(const wxString &msg)
+{
+   wxWeakRef<DebugConsoleFrame> consoleFrame;
+   {
+      std::scoped_lock lock(mutex_);
+      std::string line(msg.ToUTF8());
+      longestLineLength_ = std::max(longestLineLength_, line.size());
+      lines_.Push(std::move(line));
+      // Only the first line after a render schedules the next one; the rest
+      // are picked up by that render.
+      if (consoleFrame_ == nullptr || flushPending_) {
          return;
       }
+      flushPending_ = true;
+      consoleFrame  = consoleFrame_;
+   }
 
-      wxTheApp->CallAfter([consoleFrame, msg]() {
-         if (consoleFrame != nullptr) {
-            consoleFrame->AppendLogLine(msg);
-         }
-      });
+   if (wxIsMainThread()) {
+      consoleFrame->ScheduleFlush();
+      return;
    }
 
- private:
-   mutable std::mutex mutex_;
-   std::vector<wxString> lines_;
-   DebugConsoleFrame *consoleFrame_{nullptr};
-};
+   if (wxTheApp == nullptr) {
+      return;
+   }
 
-DebugLogTarget *g_debugLogTarget  = nullptr;
-wxLog *g_previousLogTarget        = nullptr;
-DebugConsoleFrame *g_consoleFrame = nullptr;
+   wxTheApp->CallAfter([consoleFrame]() {
+      if (consoleFrame != nullptr) {
+         consoleFrame->ScheduleFlush();
+      }
+   });
+}
 
 void EnsureConsoleFrame(wxWindow *parent)
 {
@@ -183,8 +293,36 @@ void InitializeDebugLogging()
       return;
    }
 
-   g_debugLogTarget    = new DebugLogTarget();
-   g_previousLogTarget = wxLog::SetActiveTarget(g_debugLogTarget);
+   const auto &settings = AppSettings::Get();
+   g_debugLogTarget     = new DebugLogTarget(settings.GetDebugConsoleLineLimit());
+   g_previousLogTarget  = wxLog::SetActiveTarget(g_debugLogTarget);
+
+   // Records from Log arrive on its writer thread; wxLog is thread safe and
+   // hands them to the console target like any other message.
+   Log::SetSink([](LogLevel level, LogModule module, const std::string &message) {
+      const auto text = wxString::Format("[%s] %s", Log::ModuleName(module), wxString::FromUTF8(message));
+      switch (level) {
+         case LogLevel::Error:
+            wxLogGeneric(wxLOG_Error, "%s", text);
+            break;
+         case LogLevel::Warning:
+            wxLogGeneric(wxLOG_Warning, "%s", text);
+            break;
+         default:
+            wxLogGeneric(wxLOG_Message, "%s", text);
+            break;
+      }
+   });
+
+   std::string errorMessage;
+   if (!Log::Configure(settings.GetLogLevels(), errorMessage)) {
+      wxLogWarning("[log] ignoring LogLevels setting: %s", errorMessage.c_str());
+   }
+   const auto logFile = settings.GetLogFile();
+   if (!logFile.empty() &&
+       !Log::OpenFile(logFile, settings.GetLogFileMaxBytes(), settings.GetLogFileCount(), errorMessage)) {
+      wxLogWarning("[log] cannot open log file: %s", errorMessage.c_str());
+   }
 }
 
 void ShutdownDebugLogging()
@@ -193,11 +331,17 @@ void ShutdownDebugLogging()
       return;
    }
 
+   Log::Flush();
+   Log::SetSink(nullptr);
+   Log::CloseFile();
+
    wxLog::SetActiveTarget(g_previousLogTarget);
    g_previousLogTarget = nullptr;
 
-   delete g_debugLogTarget;
-   g_debugLogTarget = nullptr;
+   // Cleared before deletion: the console's list reads lines through it.
+   auto *debugLogTarget = g_debugLogTarget;
+   g_debugLogTarget     = nullptr;
+   delete debugLogTarget;
 
    if (g_consoleFrame != nullptr) {
       g_consoleFrame->Destroy();
@@ -0,0 +1,295 @@
+#include "DownloadEventStream.h"
+
+#include "Log.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <utility>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace confy {
+
+namespace {
+
+using Json = nlohmann::json;
+
+std::int64_t ElapsedMs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+   return std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count();
+}
+
+std::string ToLine(const Json &object)
+{
+   // Messages come from git and HTTP output; invalid UTF-8 must not abort
+   // the stream.
+   return object.dump(-1, ' ', false, Json::error_handler_t::replace) + "\n";
+}
+
+DownloadEventStream::LineWriter MakeFileWriter(std::FILE *file, bool ownsFile)
+{
+   std::shared_ptr<std::FILE> handle(file, [ownsFile](std::FILE *f) {
+      if (ownsFile) {
+         std::fclose(f);
+      }
+   });
+   return [handle](const std::string &line) {
+      return std::fwrite(line.data(), 1, line.size(), handle.get()) == line.size() && std::fflush(handle.get()) == 0;
+   };
+}
+
+#ifndef _WIN32
+// The stream is written from the GUI thread, so a reader that stops
+// draining the socket must not block it: the socket is non-blocking and a
+// line that cannot be sent within this time disconnects the reader.
+constexpr int kSocketStallTimeoutMs = 100;
+
+DownloadEventStream::LineWriter MakeSocketWriter(int socketFd)
+{
+   std::shared_ptr<int> handle(new int(socketFd), [](int *fd) {
+      ::close(*fd);
+      delete fd;
+   });
+   return [handle](const std::string &line) {
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kSocketStallTimeoutMs);
+      std::size_t written = 0;
+      while (written < line.size()) {
+#ifdef MSG_NOSIGNAL
+         const auto result = ::send(*handle, line.data() + written, line.size() - written, MSG_NOSIGNAL);
+#else
+         const auto result = ::send(*handle, line.data() + written, line.size() - written, 0);
+#endif
+         if (result >= 0) {
+            written += static_cast<std::size_t>(result);
+            continue;
+         }
+         if (errno == EINTR) {
+            continue;
+         }
+         if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            return false;
+         }
+         const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+             deadline - std::chrono::steady_clock::now());
+         if (remaining.count() <= 0) {
+            CONFY_LOG(LogModule::DownloadWorker, LogLevel::Warning,
+                "event stream reader stalled for %d ms; disconnecting",
+                kSocketStallTimeoutMs);
+            return false;
+         }
+         pollfd writable{*handle, POLLOUT, 0};
+         ::poll(&writable, 1, static_cast<int>(remaining.count()));
+      }
+      return true;
+   };
+}
+#endif
+
+} // namespace
+
+DownloadEventStream::DownloadEventStream(LineWriter writeLine, std::chrono::milliseconds progressInterval) :
+    writeLine_(std::move(writeLine)),
+    progressInterval_(progressInterval),
+    createdAt_(Clock::now())
+{
+}
+
+std::unique_ptr<DownloadEventStream> DownloadEventStream::Open(const std::string &destination,
+    std::chrono::milliseconds progressInterval,
+    std::string &errorMessage)
+{
+   if (destination.empty()) {
+      errorMessage = "No event stream destination given";
+      return nullptr;
+   }
+
+   if (destination == "-") {
+      return std::make_unique<DownloadEventStream>(MakeFileWriter(stdout, false), progressInterval);
+   }
+
+   static const std::string kUnixPrefix = "unix:";
+   if (destination.compare(0, kUnixPrefix.size(), kUnixPrefix) == 0) {
+      const auto socketPath = destination.substr(kUnixPrefix.size());
+#ifdef _WIN32
+      errorMessage = "Unix socket event streams are not supported on this platform";
+      return nullptr;
+#else
+      sockaddr_un address{};
+      if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+         errorMessage = "Invalid Unix socket path '" + socketPath + "'";
+         return nullptr;
+      }
+      const int socketFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+      if (socketFd < 0) {
+         errorMessage = std::string("socket() failed: ") + std::strerror(errno);
+         return nullptr;
+      }
+#ifdef SO_NOSIGPIPE
+      const int noSigPipe = 1;
+      ::setsockopt(socketFd, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+      address.sun_family = AF_UNIX;
+      std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+      if (::connect(socketFd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+         errorMessage = "Cannot connect to '" + socketPath + "': " + std::strerror(errno);
+         ::close(socketFd);
+         return nullptr;
+      }
+      ::fcntl(socketFd, F_SETFL, ::fcntl(socketFd, F_GETFL) | O_NONBLOCK);
+      return std::make_unique<DownloadEventStream>(MakeSocketWriter(socketFd), progressInterval);
+#endif
+   }
+
+   std::FILE *file = std::fopen(destination.c_str(), "ab");
+   if (file == nullptr) {
+      errorMessage = "Cannot open '" + destination + "' for writing";
+      return nullptr;
+   }
+   return std::make_unique<DownloadEventStream>(MakeFileWriter(file, true), progressInterval);
+}
+
+void DownloadEventStream::AddJobs(const std::vector<DownloadJob> &jobs)
+{
+   for (const auto &job : jobs) {
+      JobState state;
+      if (job.kind == DownloadJobKind::GitSource) {
+         state.componentName = job.source.componentName;
+         state.kind          = "source";
+      } else {
+         state.componentName = job.artifact.componentName;
+         state.kind          = "artifact";
+      }
+      state.target       = job.Target();
+      jobs_[job.JobId()] = std::move(state);
+   }
+}
+
+void DownloadEventStream::Write(const DownloadEvent &event, Clock::time_point now)
+{
+   auto &job = jobs_[event.jobId];
+
+   switch (event.type) {
+      case DownloadEventType::Started:
+         // Retried jobs start over.
+         job.status          = JobStatus::Running;
+         job.started         = true;
+         job.startedAt       = now;
+         job.progressWritten = false;
+         job.downloadedBytes = 0;
+         break;
+      case DownloadEventType::Progress:
+         job.downloadedBytes = std::max(job.downloadedBytes, event.downloadedBytes);
+         if (job.progressWritten && now - job.lastProgressAt < progressInterval_) {
+            ++droppedProgress_;
+            return;
+         }
+         job.progressWritten = true;
+         job.lastProgressAt  = now;
+         break;
+      case DownloadEventType::PostDownloadScriptRunning:
+         break;
+      case DownloadEventType::Completed:
+         // Artifact jobs report the size of the whole tree here.
+         job.status          = JobStatus::Completed;
+         job.downloadedBytes = std::max(job.downloadedBytes, event.downloadedBytes);
+         break;
+      case DownloadEventType::Failed:
+         job.status = JobStatus::Failed;
+         break;
+      case DownloadEventType::Cancelled:
+         job.status = JobStatus::Cancelled;
+         break;
+   }
+
+   const bool finalEvent = event.type == DownloadEventType::Completed || event.type == DownloadEventType::Failed ||
+                           event.type == DownloadEventType::Cancelled;
+   if (finalEvent) {
+      job.durationMs = job.started ? ElapsedMs(job.startedAt, now) : 0;
+   }
+
+   Json line;
+   line["event"]     = DownloadEventTypeName(event.type);
+   line["jobId"]     = event.jobId;
+   line["component"] = job.componentName;
+   line["kind"]      = job.kind;
+   line["target"]    = job.target;
+   line["elapsedMs"] = ElapsedMs(createdAt_, now);
+   if (event.type == DownloadEventType::Progress) {
+      line["percent"] = event.percent;
+      line["bytes"]   = event.downloadedBytes;
+   }
+   if (finalEvent) {
+      line["status"]     = DownloadEventTypeName(event.type);
+      line["bytes"]      = job.downloadedBytes;
+      line["durationMs"] = job.durationMs;
+   }
+   if (!event.message.empty()) {
+      line["message"] = event.message;
+   }
+   WriteLine(ToLine(line));
+}
+
+void DownloadEventStream::WriteSummary(Clock::time_point now)
+{
+   std::size_t completed    = 0;
+   std::size_t failed       = 0;
+   std::size_t cancelled    = 0;
+   std::size_t unfinished   = 0;
+   std::uint64_t totalBytes = 0;
+   for (const auto &[jobId, job] : jobs_) {
+      (void)jobId;
+      totalBytes += job.downloadedBytes;
+      switch (job.status) {
+         case JobStatus::Completed:
+            ++completed;
+            break;
+         case JobStatus::Failed:
+            ++failed;
+            break;
+         case JobStatus::Cancelled:
+            ++cancelled;
+            break;
+         case JobStatus::Queued:
+         case JobStatus::Running:
+            ++unfinished;
+            break;
+      }
+   }
+
+   Json line;
+   line["event"]           = "summary";
+   line["jobs"]            = jobs_.size();
+   line["completed"]       = completed;
+   line["failed"]          = failed;
+   line["cancelled"]       = cancelled;
+   line["unfinished"]      = unfinished;
+   line["bytes"]           = totalBytes;
+   line["durationMs"]      = ElapsedMs(createdAt_, now);
+   line["droppedProgress"] = droppedProgress_;
+   WriteLine(ToLine(line));
+}
+
+void DownloadEventStream::WriteLine(const std::string &line)
+{
+   if (broken_) {
+      return;
+   }
+   if (!writeLine_(line)) {
+      broken_ = true;
+      CONFY_LOG(LogModule::DownloadWorker, LogLevel::Warning, "event stream closed by the reader; further events are dropped");
+   }
+}
+
+} // namespace confy
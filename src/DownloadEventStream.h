@@ -0,0 +1,83 @@
+#pragma once
+
+#include "JobTypes.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace confy {
+
+// Serializes DownloadEvents as newline-delimited JSON for dashboards and
+// build orchestration. Each line carries the job's component, kind and
+// target. Final events (completed/failed/cancelled) add the job's duration
+// and downloaded bytes, and WriteSummary closes a run with the totals.
+// Progress lines are rate-limited per job. Not thread-safe: feed it from the
+// thread that pops the worker queue's events.
+class DownloadEventStream final
+{
+ public:
+   using Clock      = std::chrono::steady_clock;
+   using LineWriter = std::function<bool(const std::string &line)>;
+
+   static constexpr std::chrono::milliseconds kDefaultProgressInterval{250};
+
+   // writeLine receives one JSON object including the trailing newline and
+   // returns false once the destination is gone; later lines are dropped.
+   explicit DownloadEventStream(LineWriter writeLine,
+       std::chrono::milliseconds progressInterval = kDefaultProgressInterval);
+
+   // destination is "-" for stdout, "unix:<path>" for a Unix domain stream
+   // socket (POSIX only) or a file path, which is appended to. A socket
+   // reader that does not accept a line within 100 ms is disconnected, so
+   // a stalled reader never blocks the caller.
+   static std::unique_ptr<DownloadEventStream> Open(const std::string &destination,
+       std::chrono::milliseconds progressInterval,
+       std::string &errorMessage);
+
+   void AddJobs(const std::vector<DownloadJob> &jobs);
+   void Write(const DownloadEvent &event, Clock::time_point now = Clock::now());
+   void WriteSummary(Clock::time_point now = Clock::now());
+
+   std::size_t DroppedProgressCount() const { return droppedProgress_; }
+
+ private:
+   enum class JobStatus
+   {
+      Queued,
+      Running,
+      Completed,
+      Failed,
+      Cancelled
+   };
+
+   struct JobState
+   {
+      std::string componentName;
+      const char *kind{""};
+      std::string target;
+      JobStatus status{JobStatus::Queued};
+      Clock::time_point startedAt;
+      bool started{false};
+      Clock::time_point lastProgressAt;
+      bool progressWritten{false};
+      std::uint64_t downloadedBytes{0};
+      std::int64_t durationMs{0};
+   };
+
+   void WriteLine(const std::string &line);
+
+   LineWriter writeLine_;
+   std::chrono::milliseconds progressInterval_;
+   std::unordered_map<std::uint64_t, JobState> jobs_;
+   Clock::time_point createdAt_;
+   std::size_t droppedProgress_{0};
+   bool broken_{false};
+};
+
+} // namespace confy
@@ -0,0 +1,67 @@
+#include "DownloadJobBuilder.h"
+
+#include <filesystem>
+#include <utility>
+
+namespace confy {
+
+std::string BuildArtifactPath(const ComponentConfig &component)
+{
+   return component.artifact.relativePath.empty() ? component.name
+                                                  : component.artifact.relativePath + "/" + component.name;
+}
+
+std::vector<DownloadJob> BuildDownloadJobs(const ConfigModel &config,
+    const SourceJobSettings &sourceSettings,
+    std::uint64_t &nextJobId)
+{
+   std::vector<DownloadJob> jobs;
+   jobs.reserve(config.components.size());
+
+   for (std::size_t i = 0; i < config.components.size(); ++i) {
+      const auto &component      = config.components[i];
+      const auto targetDirectory = (std::filesystem::path(config.rootPath) / component.path).string();
+
+      if (component.sourcePresent && component.source.enabled && !component.source.url.empty()) {
+         GitCloneJob sourceJob;
+         sourceJob.jobId                = nextJobId++;
+         sourceJob.componentIndex       = i;
+         sourceJob.componentName        = component.name;
+         sourceJob.componentDisplayName = component.displayName;
+         sourceJob.repositoryUrl        = component.source.url;
+         sourceJob.branchOrTag          = component.source.branchOrTag;
+         sourceJob.targetDirectory      = targetDirectory;
+         sourceJob.postDownloadScript   = component.source.script;
+         sourceJob.shallow              = component.source.shallow;
+         sourceJob.mirrorCacheDirectory = sourceSettings.mirrorCacheDirectory;
+         sourceJob.refuseDirtyReclone   = sourceSettings.refuseDirtyReclone;
+         sourceJob.filter               = component.source.filter;
+         sourceJob.sparsePaths          = component.source.sparsePaths;
+         sourceJob.parallelJobs         = sourceSettings.parallelJobs;
+         sourceJob.outputTailBytes      = sourceSettings.outputTailBytes;
+         sourceJob.logDirectory         = sourceSettings.logDirectory;
+         jobs.push_back(DownloadJob::FromSource(std::move(sourceJob)));
+      }
+
+      if (component.artifactPresent && component.artifact.enabled) {
+         NexusDownloadJob artifactJob;
+         artifactJob.jobId                = nextJobId++;
+         artifactJob.componentIndex       = i;
+         artifactJob.componentName        = component.name;
+         artifactJob.componentDisplayName = component.displayName;
+         artifactJob.repositoryUrl        = component.artifact.url;
+         artifactJob.artifactPath         = BuildArtifactPath(component);
+         artifactJob.version              = component.artifact.version;
+         artifactJob.buildType            = component.artifact.buildType;
+         artifactJob.targetDirectory      = targetDirectory;
+         artifactJob.postDownloadScript   = component.artifact.script;
+         artifactJob.regexIncludes        = component.artifact.regexIncludes;
+         artifactJob.regexExcludes        = component.artifact.regexExcludes;
+         jobs.push_back(DownloadJob::FromArtifact(std::move(artifactJob)));
+      }
+   }
+
+   return jobs;
+}
+
+} // namespace confy
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "ConfigModel.h"
+#include "JobTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace confy {
+
+// Settings that apply to every source job; the GUI and the command line
+// fill them from AppSettings.
+struct SourceJobSettings
+{
+   std::string mirrorCacheDirectory;
+   bool refuseDirtyReclone{false};
+   int parallelJobs{0};
+   std::size_t outputTailBytes{0};
+   std::string logDirectory;
+};
+
+// Nexus path of a component's artifacts: <relativePath>/<name>, or just the
+// name when the artifact has no relative path.
+std::string BuildArtifactPath(const ComponentConfig &component);
+
+// One job per enabled source and artifact section, in component order. Job
+// ids are taken from nextJobId, which is advanced past the last one used.
+std::vector<DownloadJob> BuildDownloadJobs(const ConfigModel &config,
+    const SourceJobSettings &sourceSettings,
+    std::uint64_t &nextJobId);
+
+} // namespace confy
@@ -1,5 +1,7 @@
 #include "DownloadProgressDialog.h"
 
+#include "AppSettings.h"
+
 #include <algorithm>
 #include <cmath>
 
@@ -7,6 +9,7 @@
 #include <wx/control.h>
 #include <wx/dcclient.h>
 #include <wx/gauge.h>
+#include <wx/log.h>
 #include <wx/panel.h>
 #include <wx/scrolwin.h>
 #include <wx/sizer.h>
@@ -101,7 +104,9 @@ bool DownloadProgressDialog::IsRetriableState(RowState state)
    return state == RowState::Failed || state == RowState::Cancelled;
 }
 
-DownloadProgressDialog::DownloadProgressDialog(wxWindow *parent, std::vector<DownloadJob> jobs) :
+DownloadProgressDialog::DownloadProgressDialog(wxWindow *parent,
+    std::vector<DownloadJob> jobs,
+    std::shared_ptr<TransferHistory> history) :
     wxDialog(parent,
         wxID_ANY,
         "Download Progress",
@@ -212,6 +217,20 @@ DownloadProgressDialog::DownloadProgressDialog(wxWindow *parent, std::vector<Dow
    timer_ = new wxTimer(this, kTimerId);
    Bind(wxEVT_TIMER, &DownloadProgressDialog::OnTimer, this, kTimerId);
 
+   const auto eventStreamDestination = AppSettings::Get().GetEventStreamDestination();
+   if (!eventStreamDestination.empty()) {
+      std::string errorMessage;
+      eventStream_ = DownloadEventStream::Open(eventStreamDestination,
+          AppSettings::Get().GetEventStreamProgressInterval(),
+          errorMessage);
+      if (eventStream_) {
+         eventStream_->AddJobs(jobs_);
+      } else {
+         wxLogWarning("[download-worker] event stream disabled: %s", errorMessage.c_str());
+      }
+   }
+
+   worker_.SetTransferHistory(std::move(history));
    worker_.Start();
    for (const auto &job : jobs_) {
       worker_.Submit(job);
@@ -227,6 +246,15 @@ DownloadProgressDialog::~DownloadProgressDialog()
       timer_->Stop();
    }
    worker_.Stop();
+   if (eventStream_) {
+      // Jobs may have finished after the last timer tick; their final
+      // events belong in the stream before the summary.
+      DownloadEvent event;
+      while (worker_.TryPopEvent(event)) {
+         eventStream_->Write(event);
+      }
+      eventStream_->WriteSummary();
+   }
 }
 
 void DownloadProgressDialog::OnTimer(wxTimerEvent &)
@@ -303,6 +331,9 @@ void DownloadProgressDialog::ConsumeWorkerEvents()
    std::size_t processed = 0;
    while (processed < kMaxEventsPerTick && worker_.TryPopEvent(event)) {
       ++processed;
+      if (eventStream_) {
+         eventStream_->Write(event);
+      }
       switch (event.type) {
          case DownloadEventType::Started:
             SetRowState(event.jobId, RowState::Running, "Starting", 0);
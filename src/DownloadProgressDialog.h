@@ -1,9 +1,12 @@
 #pragma once
 
+#include "DownloadEventStream.h"
 #include "DownloadWorkerQueue.h"
 #include "JobTypes.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -18,10 +21,17 @@ class wxTimerEvent;
 
 namespace confy {
 
+class TransferHistory;
+
 class DownloadProgressDialog final : public wxDialog
 {
  public:
-   DownloadProgressDialog(wxWindow *parent, std::vector<DownloadJob> jobs);
+   static constexpr std::size_t kWorkerCount = 6;
+
+   // history may be null; otherwise completed downloads are recorded in it.
+   DownloadProgressDialog(wxWindow *parent,
+       std::vector<DownloadJob> jobs,
+       std::shared_ptr<TransferHistory> history = nullptr);
    ~DownloadProgressDialog() override;
 
  private:
@@ -70,7 +80,9 @@ class DownloadProgressDialog final : public wxDialog
    std::vector<ProgressRow> rows_;
    std::unordered_map<std::uint64_t, std::size_t> rowIndexByJobId_;
 
-   DownloadWorkerQueue worker_{6};
+   DownloadWorkerQueue worker_{kWorkerCount};
+   // Optional JSON lines copy of every worker event (EventStream setting).
+   std::unique_ptr<DownloadEventStream> eventStream_;
    wxTimer *timer_{nullptr};
    wxButton *cancelButton_{nullptr};
    wxButton *retryFailedButton_{nullptr};
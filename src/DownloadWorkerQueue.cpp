@@ -2,10 +2,14 @@
 
 #include "AuthCredentials.h"
 #include "GitClient.h"
+#include "Log.h"
 #include "NexusClient.h"
+#include "TransferHistory.h"
 
+#include <cctype>
 #include <chrono>
-#include <cstdlib>
+#include <cstdint>
+#include <ctime>
 #include <filesystem>
 #include <fstream>
 #include <functional>
@@ -13,7 +17,6 @@
 #include <vector>
 
 #include <wx/init.h>
-#include <wx/log.h>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -37,6 +40,50 @@ std::string TrimScript(const std::string &script)
    return script.substr(first, last - first + 1);
 }
 
+std::chrono::milliseconds ElapsedSince(std::chrono::steady_clock::time_point start)
+{
+   return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+}
+
+// DownloadArtifactTree replaces the target directory, so afterwards it holds
+// exactly the downloaded files.
+std::uint64_t DirectorySizeBytes(const std::string &directory)
+{
+   std::uint64_t total = 0;
+   std::error_code ec;
+   for (std::filesystem::recursive_directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+      std::error_code sizeError;
+      if (it->is_regular_file(sizeError)) {
+         const auto size = it->file_size(sizeError);
+         total += sizeError ? 0 : size;
+      }
+   }
+   return total;
+}
+
+std::string BuildJobLogFilePath(const std::string &logDirectory,
+    const std::string &componentName,
+    std::uint64_t jobId)
+{
+   const std::time_t now = std::time(nullptr);
+   std::tm localTime{};
+#ifdef _WIN32
+   localtime_s(&localTime, &now);
+#else
+   localtime_r(&now, &localTime);
+#endif
+   char timestamp[32]{};
+   std::strftime(timestamp, sizeof(timestamp), "%Y%m%d-%H%M%S", &localTime);
+
+   std::string fileName;
+   for (const char c : componentName) {
+      const bool safe = std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_' || c == '.';
+      fileName.push_back(safe ? c : '_');
+   }
+   fileName += std::string("-") + timestamp + "-" + std::to_string(jobId) + ".log";
+   return (std::filesystem::path(logDirectory) / fileName).string();
+}
+
 std::string EscapeShArg(const std::string &value)
 {
    std::string escaped;
@@ -76,6 +123,11 @@ DownloadWorkerQueue::~DownloadWorkerQueue()
    Stop();
 }
 
+void DownloadWorkerQueue::SetTransferHistory(std::shared_ptr<TransferHistory> history)
+{
+   transferHistory_ = std::move(history);
+}
+
 void DownloadWorkerQueue::Start()
 {
    std::scoped_lock lock(queueMutex_);
@@ -92,7 +144,7 @@ void DownloadWorkerQueue::Start()
       workers_.emplace_back(&DownloadWorkerQueue::WorkerLoop, this);
    }
 
-   wxLogMessage("[download-worker] started with workerCount=%zu", workerCount_);
+   CONFY_LOG(LogModule::DownloadWorker, LogLevel::Info, "started with workerCount=%zu", workerCount_);
 }
 
 void DownloadWorkerQueue::Stop()
@@ -105,6 +157,7 @@ void DownloadWorkerQueue::Stop()
       stopping_ = true;
       cancelAllRequested_.store(true);
    }
+   GitClient::NotifyCancelRequested(cancelAllRequested_);
 
    queueCv_.notify_all();
 
@@ -124,19 +177,19 @@ void DownloadWorkerQueue::Stop()
       pendingJobs_.swap(empty);
    }
 
-   wxLogMessage("[download-worker] stopped");
+   CONFY_LOG(LogModule::DownloadWorker, LogLevel::Info, "stopped");
 }
 
 void DownloadWorkerQueue::Submit(DownloadJob job)
 {
    if (job.kind == DownloadJobKind::NexusArtifact) {
-      wxLogMessage("[download-worker] enqueue artifact jobId=%llu component='%s' version='%s' buildType='%s'",
+      CONFY_LOG(LogModule::DownloadWorker, LogLevel::Info, "enqueue artifact jobId=%llu component='%s' version='%s' buildType='%s'",
           static_cast<unsigned long long>(job.artifact.jobId),
           job.artifact.componentName.c_str(),
           job.artifact.version.c_str(),
           job.artifact.buildType.c_str());
    } else {
-      wxLogMessage("[download-worker] enqueue source jobId=%llu component='%s' ref='%s' shallow=%d",
+      CONFY_LOG(LogModule::DownloadWorker, LogLevel::Info, "enqueue source jobId=%llu component='%s' ref='%s' shallow=%d",
           static_cast<unsigned long long>(job.source.jobId),
           job.source.componentName.c_str(),
           job.source.branchOrTag.c_str(),
@@ -162,12 +215,14 @@ void DownloadWorkerQueue::RequestCancelAll()
       }
    }
 
+   GitClient::NotifyCancelRequested(cancelAllRequested_);
+
    for (const auto &job : cancelledJobs) {
       PushEvent({job.JobId(), job.ComponentIndex(), DownloadEventType::Cancelled, 0, 0, "Cancelled"});
    }
 
    queueCv_.notify_all();
-   wxLogWarning("[download-worker] cancel-all requested; drained %zu queued job(s)", cancelledJobs.size());
+   CONFY_LOG(LogModule::DownloadWorker, LogLevel::Warning, "cancel-all requested; drained %zu queued job(s)", cancelledJobs.size());
 }
 
 bool DownloadWorkerQueue::TryPopEvent(DownloadEvent &outEvent)
@@ -186,7 +241,7 @@ void DownloadWorkerQueue::WorkerLoop()
 {
    wxInitializer wxInit;
    if (!wxInit.IsOk()) {
-      wxLogError("[download-worker] wx runtime init failed in worker thread");
+      CONFY_LOG(LogModule::DownloadWorker, LogLevel::Error, "wx runtime init failed in worker thread");
       while (true) {
          DownloadJob job;
          {
@@ -206,7 +261,7 @@ void DownloadWorkerQueue::WorkerLoop()
       }
    }
 
-   wxLogMessage("[download-worker] worker thread started");
+   CONFY_LOG(LogModule::DownloadWorker, LogLevel::Info, "worker thread started");
 
    while (true) {
       DownloadJob job;
@@ -216,7 +271,7 @@ void DownloadWorkerQueue::WorkerLoop()
          queueCv_.wait(lock, [this]() { return stopping_ || !pendingJobs_.empty(); });
 
          if (stopping_ && pendingJobs_.empty()) {
-            wxLogMessage("[download-worker] worker thread exiting");
+            CONFY_LOG(LogModule::DownloadWorker, LogLevel::Info, "worker thread exiting");
             return;
          }
 
@@ -225,7 +280,7 @@ void DownloadWorkerQueue::WorkerLoop()
       }
 
       if (cancelAllRequested_.load()) {
-         wxLogWarning("[download-worker] skip jobId=%llu due to cancellation",
+         CONFY_LOG(LogModule::DownloadWorker, LogLevel::Warning, "skip jobId=%llu due to cancellation",
              static_cast<unsigned long long>(job.JobId()));
          PushEvent({job.JobId(), job.ComponentIndex(), DownloadEventType::Cancelled, 0, 0, "Cancelled"});
          continue;
@@ -255,30 +310,16 @@ void DownloadWorkerQueue::PushEvent(DownloadEvent event)
 
 void DownloadWorkerQueue::ProcessJob(const NexusDownloadJob &job)
 {
-   wxLogMessage("[download-worker] start jobId=%llu component='%s' repoUrl='%s' target='%s'",
+   CONFY_LOG(LogModule::DownloadWorker, LogLevel::Info, "start jobId=%llu component='%s' repoUrl='%s' target='%s'",
        static_cast<unsigned long long>(job.jobId),
        job.componentName.c_str(),
        job.repositoryUrl.c_str(),
        job.targetDirectory.c_str());
    PushEvent({job.jobId, job.componentIndex, DownloadEventType::Started, 0, 0, "Starting"});
 
-#ifdef _WIN32
-   std::string homeDir;
-   if (const char *h = std::getenv("USERPROFILE")) {
-      homeDir = h;
-   } else {
-      const char *drive    = std::getenv("HOMEDRIVE");
-      const char *homepath = std::getenv("HOMEPATH");
-      if (drive && homepath) {
-         homeDir = std::string(drive) + homepath;
-      }
-   }
-#else
-   const char *homeEnv       = std::getenv("HOME");
-   const std::string homeDir = homeEnv ? homeEnv : "";
-#endif
-   if (homeDir.empty()) {
-      wxLogError("[download-worker] jobId=%llu failed: home directory not available",
+   const std::string settingsPath = AuthCredentials::DefaultM2SettingsPath();
+   if (settingsPath.empty()) {
+      CONFY_LOG(LogModule::DownloadWorker, LogLevel::Error, "jobId=%llu failed: home directory not available",
           static_cast<unsigned long long>(job.jobId));
       PushEvent({job.jobId, job.componentIndex, DownloadEventType::Failed, 0, 0, "Missing home directory"});
       return;
@@ -286,23 +327,23 @@ void DownloadWorkerQueue::ProcessJob(const NexusDownloadJob &job)
 
    AuthCredentials credentials;
    std::string credentialError;
-   const std::string settingsPath = (std::filesystem::path(homeDir) / ".m2" / "settings.xml").string();
    if (!credentials.LoadFromM2SettingsXml(settingsPath, credentialError)) {
-      wxLogError("[download-worker] jobId=%llu auth load failed: %s",
+      CONFY_LOG(LogModule::DownloadWorker, LogLevel::Error, "jobId=%llu auth load failed: %s",
           static_cast<unsigned long long>(job.jobId),
           credentialError.c_str());
       PushEvent({job.jobId, job.componentIndex, DownloadEventType::Failed, 0, 0, credentialError});
       return;
    }
 
-   wxLogMessage("[download-worker] jobId=%llu using m2 settings: %s",
+   CONFY_LOG(LogModule::DownloadWorker, LogLevel::Info, "jobId=%llu using m2 settings: %s",
        static_cast<unsigned long long>(job.jobId),
        settingsPath.c_str());
 
    NexusClient client(std::move(credentials));
    std::string error;
 
-   const auto ok = client.DownloadArtifactTree(
+   const auto downloadStart = std::chrono::steady_clock::now();
+   const auto ok            = client.DownloadArtifactTree(
        job.repositoryUrl,
        job.artifactPath,
        job.version,
@@ -313,7 +354,7 @@ void DownloadWorkerQueue::ProcessJob(const NexusDownloadJob &job)
        cancelAllRequested_,
        // Progress callback
        [this, &job](int percent, std::uint64_t downloadedBytes, const std::string &message) {
-          wxLogMessage("[download-worker] progress jobId=%llu percent=%d message='%s'",
+          CONFY_LOG(LogModule::DownloadWorker, LogLevel::Debug, "progress jobId=%llu percent=%d message='%s'",
               static_cast<unsigned long long>(job.jobId),
               percent,
               message.c_str());
@@ -328,11 +369,11 @@ void DownloadWorkerQueue::ProcessJob(const NexusDownloadJob &job)
 
    if (!ok) {
       if (cancelAllRequested_.load()) {
-         wxLogWarning("[download-worker] cancelled jobId=%llu",
+         CONFY_LOG(LogModule::DownloadWorker, LogLevel::Warning, "cancelled jobId=%llu",
              static_cast<unsigned long long>(job.jobId));
          PushEvent({job.jobId, job.componentIndex, DownloadEventType::Cancelled, 0, 0, "Cancelled"});
       } else {
-         wxLogError("[download-worker] failed jobId=%llu error='%s'",
+         CONFY_LOG(LogModule::DownloadWorker, LogLevel::Error, "failed jobId=%llu error='%s'",
              static_cast<unsigned long long>(job.jobId),
              error.c_str());
          PushEvent({job.jobId, job.componentIndex, DownloadEventType::Failed, 0, 0, error});
@@ -340,6 +381,13 @@ void DownloadWorkerQueue::ProcessJob(const NexusDownloadJob &job)
       return;
    }
 
+   // Progress events carry the current file's bytes; the completed event
+   // reports the whole tree.
+   const auto downloadedBytes = DirectorySizeBytes(job.targetDirectory);
+   if (transferHistory_) {
+      transferHistory_->RecordArtifact(job.repositoryUrl, downloadedBytes, ElapsedSince(downloadStart));
+   }
+
    PushEvent({job.jobId,
        job.componentIndex,
        DownloadEventType::PostDownloadScriptRunning,
@@ -349,7 +397,7 @@ void DownloadWorkerQueue::ProcessJob(const NexusDownloadJob &job)
 
    std::string scriptError;
    if (!ExecutePostDownloadScript(job.postDownloadScript, job.targetDirectory, scriptError)) {
-      wxLogError("[download-worker] script failed jobId=%llu error='%s'",
+      CONFY_LOG(LogModule::DownloadWorker, LogLevel::Error, "script failed jobId=%llu error='%s'",
           static_cast<unsigned long long>(job.jobId),
           scriptError.c_str());
       PushEvent({job.jobId,
@@ -361,8 +409,10 @@ void DownloadWorkerQueue::ProcessJob(const NexusDownloadJob &job)
       return;
    }
 
-   wxLogMessage("[download-worker] completed jobId=%llu", static_cast<unsigned long long>(job.jobId));
-   PushEvent({job.jobId, job.componentIndex, DownloadEventType::Completed, 100, 0, "Completed"});
+   CONFY_LOG(LogModule::DownloadWorker, LogLevel::Info, "completed jobId=%llu bytes=%llu",
+       static_cast<unsigned long long>(job.jobId),
+       static_cast<unsigned long long>(downloadedBytes));
+   PushEvent({job.jobId, job.componentIndex, DownloadEventType::Completed, 100, downloadedBytes, "Completed"});
 }
 
 void DownloadWorkerQueue::ProcessJob(const DownloadJob &job)
@@ -373,7 +423,7 @@ void DownloadWorkerQueue::ProcessJob(const DownloadJob &job)
    }
 
    const auto &source = job.source;
-   wxLogMessage("[download-worker] start source jobId=%llu component='%s' repoUrl='%s' target='%s' shallow=%d",
+   CONFY_LOG(LogModule::DownloadWorker, LogLevel::Info, "start source jobId=%llu component='%s' repoUrl='%s' target='%s' shallow=%d",
        static_cast<unsigned long long>(source.jobId),
        source.componentName.c_str(),
        source.repositoryUrl.c_str(),
@@ -382,23 +432,9 @@ void DownloadWorkerQueue::ProcessJob(const DownloadJob &job)
 
    PushEvent({source.jobId, source.componentIndex, DownloadEventType::Started, 0, 0, "Starting"});
 
-#ifdef _WIN32
-   std::string homeDir;
-   if (const char *h = std::getenv("USERPROFILE")) {
-      homeDir = h;
-   } else {
-      const char *drive    = std::getenv("HOMEDRIVE");
-      const char *homepath = std::getenv("HOMEPATH");
-      if (drive && homepath) {
-         homeDir = std::string(drive) + homepath;
-      }
-   }
-#else
-   const char *homeEnv       = std::getenv("HOME");
-   const std::string homeDir = homeEnv ? homeEnv : "";
-#endif
-   if (homeDir.empty()) {
-      wxLogError("[download-worker] failed source jobId=%llu component='%s' reason='Missing home directory'",
+   const std::string settingsPath = AuthCredentials::DefaultM2SettingsPath();
+   if (settingsPath.empty()) {
+      CONFY_LOG(LogModule::DownloadWorker, LogLevel::Error, "failed source jobId=%llu component='%s' reason='Missing home directory'",
           static_cast<unsigned long long>(source.jobId),
           source.componentName.c_str());
       PushEvent({source.jobId, source.componentIndex, DownloadEventType::Failed, 0, 0, "Missing home directory"});
@@ -407,9 +443,8 @@ void DownloadWorkerQueue::ProcessJob(const DownloadJob &job)
 
    AuthCredentials credentials;
    std::string credentialError;
-   const std::string settingsPath = (std::filesystem::path(homeDir) / ".m2" / "settings.xml").string();
    if (!credentials.LoadFromM2SettingsXml(settingsPath, credentialError)) {
-      wxLogError("[download-worker] failed source jobId=%llu component='%s' reason='Credential load failed: %s'",
+      CONFY_LOG(LogModule::DownloadWorker, LogLevel::Error, "failed source jobId=%llu component='%s' reason='Credential load failed: %s'",
           static_cast<unsigned long long>(source.jobId),
           source.componentName.c_str(),
           credentialError.c_str());
@@ -422,13 +457,26 @@ void DownloadWorkerQueue::ProcessJob(const DownloadJob &job)
       return;
    }
 
+   GitCloneOptions cloneOptions;
+   cloneOptions.shallow              = source.shallow;
+   cloneOptions.mirrorCacheDirectory = source.mirrorCacheDirectory;
+   cloneOptions.refuseDirtyReclone   = source.refuseDirtyReclone;
+   cloneOptions.filter               = source.filter;
+   cloneOptions.sparsePaths          = source.sparsePaths;
+   cloneOptions.parallelJobs         = source.parallelJobs;
+   cloneOptions.outputTailBytes      = source.outputTailBytes;
+   if (!source.logDirectory.empty()) {
+      cloneOptions.logFilePath = BuildJobLogFilePath(source.logDirectory, source.componentName, source.jobId);
+   }
+
    GitClient client(std::move(credentials));
    std::string error;
-   const auto ok = client.CloneRepository(
+   const auto cloneStart = std::chrono::steady_clock::now();
+   const auto ok         = client.CloneRepository(
        source.repositoryUrl,
        source.branchOrTag,
        source.targetDirectory,
-       source.shallow,
+       cloneOptions,
        cancelAllRequested_,
        [this, &source](int percent, const std::string &message) {
           PushEvent({source.jobId, source.componentIndex, DownloadEventType::Progress, percent, 0, message});
@@ -437,12 +485,12 @@ void DownloadWorkerQueue::ProcessJob(const DownloadJob &job)
 
    if (!ok) {
       if (cancelAllRequested_.load() || error == "Cancelled") {
-         wxLogWarning("[download-worker] cancelled source jobId=%llu component='%s'",
+         CONFY_LOG(LogModule::DownloadWorker, LogLevel::Warning, "cancelled source jobId=%llu component='%s'",
              static_cast<unsigned long long>(source.jobId),
              source.componentName.c_str());
          PushEvent({source.jobId, source.componentIndex, DownloadEventType::Cancelled, 0, 0, "Cancelled"});
       } else {
-         wxLogError("[download-worker] failed source jobId=%llu component='%s' error='%s'",
+         CONFY_LOG(LogModule::DownloadWorker, LogLevel::Error, "failed source jobId=%llu component='%s' error='%s'",
              static_cast<unsigned long long>(source.jobId),
              source.componentName.c_str(),
              error.c_str());
@@ -450,6 +498,9 @@ void DownloadWorkerQueue::ProcessJob(const DownloadJob &job)
       }
       return;
    }
+   if (transferHistory_) {
+      transferHistory_->RecordSource(source.repositoryUrl, ElapsedSince(cloneStart));
+   }
 
    PushEvent({source.jobId,
        source.componentIndex,
@@ -460,7 +511,7 @@ void DownloadWorkerQueue::ProcessJob(const DownloadJob &job)
 
    std::string scriptError;
    if (!ExecutePostDownloadScript(source.postDownloadScript, source.targetDirectory, scriptError)) {
-      wxLogError("[download-worker] source script failed jobId=%llu error='%s'",
+      CONFY_LOG(LogModule::DownloadWorker, LogLevel::Error, "source script failed jobId=%llu error='%s'",
           static_cast<unsigned long long>(source.jobId),
           scriptError.c_str());
       PushEvent({source.jobId,
@@ -472,7 +523,7 @@ void DownloadWorkerQueue::ProcessJob(const DownloadJob &job)
       return;
    }
 
-   wxLogMessage("[download-worker] completed source jobId=%llu component='%s'",
+   CONFY_LOG(LogModule::DownloadWorker, LogLevel::Info, "completed source jobId=%llu component='%s'",
        static_cast<unsigned long long>(source.jobId),
        source.componentName.c_str());
    PushEvent({source.jobId, source.componentIndex, DownloadEventType::Completed, 100, 0, "Completed"});
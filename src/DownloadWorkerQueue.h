@@ -5,6 +5,7 @@
 #include <atomic>
 #include <condition_variable>
 #include <cstddef>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
@@ -12,12 +13,18 @@
 
 namespace confy {
 
+class TransferHistory;
+
 class DownloadWorkerQueue final
 {
  public:
    explicit DownloadWorkerQueue(std::size_t workerCount);
    ~DownloadWorkerQueue();
 
+   // Successful downloads are recorded here for plan estimates. Set it
+   // before Start.
+   void SetTransferHistory(std::shared_ptr<TransferHistory> history);
+
    void Start();
    void Stop();
    void Submit(DownloadJob job);
@@ -46,6 +53,7 @@ class DownloadWorkerQueue final
    bool started_{false};
    bool stopping_{false};
    std::atomic<bool> cancelAllRequested_{false};
+   std::shared_ptr<TransferHistory> transferHistory_;
 };
 
 } // namespace confy
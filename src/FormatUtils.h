@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <string>
+
+namespace confy {
+
+// Byte count for display in binary units: "512 B", "1.5 KiB", "100.0 MiB".
+inline std::string FormatBytes(std::uint64_t bytes)
+{
+   static const char *const kUnits[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+   auto value                        = static_cast<double>(bytes);
+   std::size_t unit                  = 0;
+   while (value >= 1024.0 && unit + 1 < std::size(kUnits)) {
+      value /= 1024.0;
+      ++unit;
+   }
+   char buffer[32];
+   if (unit == 0) {
+      std::snprintf(buffer, sizeof(buffer), "%llu B", static_cast<unsigned long long>(bytes));
+   } else {
+      std::snprintf(buffer, sizeof(buffer), "%.1f %s", value, kUnits[unit]);
+   }
+   return buffer;
+}
+
+} // namespace confy
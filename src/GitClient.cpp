@@ -1,67 +1,162 @@
 #include "GitClient.h"
 
+#include "GitProgress.h"
+#include "Log.h"
+#include "TailBuffer.h"
+
+#include <algorithm>
 #include <array>
 #include <cctype>
-#include <cstdarg>
-#include <cstdio>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <string_view>
+#include <thread>
 #include <vector>
 
-#if defined(__has_include)
-#if __has_include(<wx/log.h>)
-#include <wx/log.h>
-#define CONFY_HAS_WX_LOG 1
-#endif
-#endif
-
-#ifndef CONFY_HAS_WX_LOG
-namespace {
-
-void FallbackLog(const char *level, const char *format, ...)
-{
-   std::fprintf(stderr, "[git-client][%s] ", level);
-   va_list args;
-   va_start(args, format);
-   std::vfprintf(stderr, format, args);
-   va_end(args);
-   std::fprintf(stderr, "\n");
-}
-
-} // namespace
-
-#define wxLogMessage(...) FallbackLog("INFO", __VA_ARGS__)
-#define wxLogError(...)   FallbackLog("ERROR", __VA_ARGS__)
-#endif
-
 #ifdef _WIN32
 #include <windows.h>
 #else
 #include <cerrno>
 #include <csignal>
+#include <cstring>
 #include <fcntl.h>
 #include <poll.h>
+#include <spawn.h>
+#include <sys/file.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+extern char **environ;
 #endif
 
 namespace fs = std::filesystem;
 
 namespace {
 
+constexpr std::size_t kReadBufferSize     = 64 * 1024;
+constexpr int kExitPollIntervalMs         = 200;
+constexpr std::size_t kMaxLoggedOutputSize = 16 * 1024;
+
+// Routes a command's output to the caller's string (in full, or only its
+// tail when bounded), to an optional per-job log stream, and to a compact
+// copy for the debug log in which `\r` progress updates are collapsed into
+// the final state of each line.
+class CommandOutputCapture final
+{
+ public:
+   CommandOutputCapture(std::string &output, std::size_t tailBytes, std::ostream *logStream) :
+       output_(output),
+       tailBytes_(tailBytes),
+       tail_(tailBytes),
+       logStream_(logStream),
+       logTail_(kMaxLoggedOutputSize)
+   {
+      output_.clear();
+   }
+
+   void Append(std::string_view chunk)
+   {
+      if (tailBytes_ == 0) {
+         output_.append(chunk.data(), chunk.size());
+      } else {
+         tail_.Append(chunk);
+      }
+      if (logStream_ != nullptr) {
+         logStream_->write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+      }
+
+      for (const char c : chunk) {
+         if (c == '\r') {
+            currentLine_.clear();
+         } else if (c == '\n') {
+            currentLine_.push_back('\n');
+            logTail_.Append(currentLine_);
+            currentLine_.clear();
+            hasLoggedText_ = true;
+         } else {
+            currentLine_.push_back(c);
+         }
+      }
+   }
+
+   void Finish()
+   {
+      if (tailBytes_ != 0) {
+         output_ = tail_.Str();
+      }
+      if (!currentLine_.empty()) {
+         logTail_.Append(currentLine_);
+         currentLine_.clear();
+         hasLoggedText_ = true;
+      }
+      if (logStream_ != nullptr) {
+         logStream_->flush();
+      }
+   }
+
+   std::string LogText() const
+   {
+      return hasLoggedText_ ? logTail_.Str() : std::string();
+   }
+
+ private:
+   std::string &output_;
+   std::size_t tailBytes_;
+   confy::TailBuffer tail_;
+   std::ostream *logStream_;
+   confy::TailBuffer logTail_;
+   std::string currentLine_;
+   bool hasLoggedText_{false};
+};
+
 #ifdef _WIN32
-bool RunCommandCaptureWindows(const std::string &command,
+// Quotes one argument following the rules of CommandLineToArgvW, which is
+// what git.exe's runtime uses to split its command line.
+std::string QuoteWindowsArgument(const std::string &argument)
+{
+   if (!argument.empty() && argument.find_first_of(" \t\n\v\"") == std::string::npos) {
+      return argument;
+   }
+
+   std::string quoted = "\"";
+   std::size_t backslashes = 0;
+   for (char c : argument) {
+      if (c == '\\') {
+         ++backslashes;
+         continue;
+      }
+      if (c == '"') {
+         quoted.append(backslashes * 2 + 1, '\\');
+      } else {
+         quoted.append(backslashes, '\\');
+      }
+      backslashes = 0;
+      quoted.push_back(c);
+   }
+   quoted.append(backslashes * 2, '\\');
+   quoted.push_back('"');
+   return quoted;
+}
+
+bool RunCommandCaptureWindows(const std::vector<std::string> &arguments,
+    const std::string &displayCommand,
+    CommandOutputCapture &capture,
     std::string &output,
     std::string &errorMessage,
     const confy::GitClient::CommandOutputCallback &outputCallback,
     const std::atomic<bool> *cancelRequested)
 {
-   output.clear();
-   wxLogMessage("[git-client] exec: %s", command.c_str());
-
    SECURITY_ATTRIBUTES securityAttributes{};
    securityAttributes.nLength        = sizeof(securityAttributes);
    securityAttributes.bInheritHandle = TRUE;
@@ -70,7 +165,7 @@ bool RunCommandCaptureWindows(const std::string &command,
    HANDLE writePipe = nullptr;
    if (!CreatePipe(&readPipe, &writePipe, &securityAttributes, 0)) {
       errorMessage = "Failed to create process output pipe.";
-      wxLogError("[git-client] create pipe failed");
+      CONFY_LOG(confy::LogModule::Git, confy::LogLevel::Error, "create pipe failed");
       return false;
    }
 
@@ -78,7 +173,7 @@ bool RunCommandCaptureWindows(const std::string &command,
       CloseHandle(readPipe);
       CloseHandle(writePipe);
       errorMessage = "Failed to configure process output pipe.";
-      wxLogError("[git-client] set handle information failed");
+      CONFY_LOG(confy::LogModule::Git, confy::LogLevel::Error, "set handle information failed");
       return false;
    }
 
@@ -88,8 +183,17 @@ bool RunCommandCaptureWindows(const std::string &command,
    startupInfo.hStdOutput = writePipe;
    startupInfo.hStdError  = writePipe;
 
+   // git.exe is started directly (CreateProcess searches PATH), so no
+   // cmd.exe is spawned and no shell quoting applies.
+   std::string commandLine;
+   for (const auto &argument : arguments) {
+      if (!commandLine.empty()) {
+         commandLine.push_back(' ');
+      }
+      commandLine += QuoteWindowsArgument(argument);
+   }
+
    PROCESS_INFORMATION processInfo{};
-   std::string commandLine = "cmd.exe /d /s /c \"" + command + "\"";
    std::vector<char> commandLineBuffer(commandLine.begin(), commandLine.end());
    commandLineBuffer.push_back('\0');
    if (!CreateProcessA(nullptr,
@@ -104,14 +208,14 @@ bool RunCommandCaptureWindows(const std::string &command,
            &processInfo)) {
       CloseHandle(readPipe);
       CloseHandle(writePipe);
-      errorMessage = "Failed to start process: " + command;
-      wxLogError("[git-client] failed to start process");
+      errorMessage = "Failed to start process: " + displayCommand;
+      CONFY_LOG(confy::LogModule::Git, confy::LogLevel::Error, "failed to start process");
       return false;
    }
 
    CloseHandle(writePipe);
 
-   std::array<char, 512> buffer{};
+   std::vector<char> buffer(kReadBufferSize);
    bool cancelled = false;
    while (true) {
       DWORD availableBytes = 0;
@@ -125,7 +229,7 @@ bool RunCommandCaptureWindows(const std::string &command,
                                   ? availableBytes
                                   : static_cast<DWORD>(buffer.size());
          if (ReadFile(readPipe, buffer.data(), toRead, &bytesRead, nullptr) && bytesRead > 0) {
-            output.append(buffer.data(), bytesRead);
+            capture.Append(std::string_view(buffer.data(), bytesRead));
             if (outputCallback) {
                outputCallback(std::string_view(buffer.data(), bytesRead));
             }
@@ -147,44 +251,46 @@ bool RunCommandCaptureWindows(const std::string &command,
    DWORD bytesRead = 0;
    while (ReadFile(readPipe, buffer.data(), static_cast<DWORD>(buffer.size()), &bytesRead, nullptr) &&
           bytesRead > 0) {
-      output.append(buffer.data(), bytesRead);
+      capture.Append(std::string_view(buffer.data(), bytesRead));
       if (outputCallback) {
          outputCallback(std::string_view(buffer.data(), bytesRead));
       }
    }
 
    CloseHandle(readPipe);
+   capture.Finish();
 
    WaitForSingleObject(processInfo.hProcess, INFINITE);
    DWORD exitCode = 1;
    if (!GetExitCodeProcess(processInfo.hProcess, &exitCode)) {
       CloseHandle(processInfo.hThread);
       CloseHandle(processInfo.hProcess);
-      errorMessage = "Failed to read process exit code: " + command;
-      wxLogError("[git-client] failed to read process exit code");
+      errorMessage = "Failed to read process exit code: " + displayCommand;
+      CONFY_LOG(confy::LogModule::Git, confy::LogLevel::Error, "failed to read process exit code");
       return false;
    }
    CloseHandle(processInfo.hThread);
    CloseHandle(processInfo.hProcess);
 
-   wxLogMessage("[git-client] exit=%lu", static_cast<unsigned long>(exitCode));
-   if (!output.empty()) {
-      wxLogMessage("[git-client] output:\n%s", output.c_str());
+   CONFY_LOG(confy::LogModule::Git, confy::LogLevel::Debug, "exit=%lu", static_cast<unsigned long>(exitCode));
+   const std::string loggedOutput = capture.LogText();
+   if (!loggedOutput.empty()) {
+      CONFY_LOG(confy::LogModule::Git, confy::LogLevel::Debug, "output:\n%s", loggedOutput.c_str());
    }
 
    if (cancelled) {
       errorMessage = "Cancelled";
-      wxLogMessage("[git-client] command cancelled");
+      CONFY_LOG(confy::LogModule::Git, confy::LogLevel::Info, "command cancelled");
       return false;
    }
 
    if (exitCode != 0) {
       if (output.empty()) {
-         errorMessage = "Command failed with exit code " + std::to_string(exitCode) + ": " + command;
+         errorMessage = "Command failed with exit code " + std::to_string(exitCode) + ": " + displayCommand;
       } else {
          errorMessage = output;
       }
-      wxLogError("[git-client] command failed");
+      CONFY_LOG(confy::LogModule::Git, confy::LogLevel::Warning, "command failed exit=%lu", static_cast<unsigned long>(exitCode));
       return false;
    }
 
@@ -193,6 +299,100 @@ bool RunCommandCaptureWindows(const std::string &command,
 #endif
 
 #ifndef _WIN32
+// Creates a pipe whose ends are not inherited by spawned commands.
+bool OpenCloseOnExecPipe(int (&fds)[2])
+{
+#ifdef __linux__
+   return ::pipe2(fds, O_CLOEXEC) == 0;
+#else
+   if (::pipe(fds) != 0) {
+      return false;
+   }
+   ::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+   ::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+   return true;
+#endif
+}
+
+// Write ends of the wakeup pipes of the commands running with each cancel
+// flag; GitClient::NotifyCancelRequested writes to them.
+struct CancelWakeupRegistry
+{
+   std::mutex mutex;
+   std::multimap<const std::atomic<bool> *, int> fds;
+};
+
+CancelWakeupRegistry &GetCancelWakeupRegistry()
+{
+   static CancelWakeupRegistry registry;
+   return registry;
+}
+
+void WriteWakeup(int fd)
+{
+   // The write end is non-blocking; a full pipe already holds a wakeup.
+   const char byte                    = 1;
+   [[maybe_unused]] const auto result = ::write(fd, &byte, 1);
+}
+
+// A self-pipe that becomes readable once cancelRequested is set and
+// notified, so that a running command can block in poll until its output,
+// its exit or its cancellation. ReadFd() is -1 without a cancel flag or
+// when the pipe could not be created.
+class CancelWakeup final
+{
+ public:
+   explicit CancelWakeup(const std::atomic<bool> *cancelRequested) :
+       cancelRequested_(cancelRequested)
+   {
+      if (cancelRequested_ == nullptr || !OpenCloseOnExecPipe(fds_)) {
+         return;
+      }
+      const int flags = ::fcntl(fds_[1], F_GETFL, 0);
+      if (flags >= 0) {
+         ::fcntl(fds_[1], F_SETFL, flags | O_NONBLOCK);
+      }
+      {
+         auto &registry = GetCancelWakeupRegistry();
+         std::scoped_lock lock(registry.mutex);
+         registry.fds.emplace(cancelRequested_, fds_[1]);
+      }
+      // A cancel requested before the registration was not notified here.
+      if (cancelRequested_->load()) {
+         WriteWakeup(fds_[1]);
+      }
+   }
+
+   ~CancelWakeup()
+   {
+      if (fds_[0] < 0) {
+         return;
+      }
+      {
+         auto &registry = GetCancelWakeupRegistry();
+         std::scoped_lock lock(registry.mutex);
+         const auto [first, last] = registry.fds.equal_range(cancelRequested_);
+         for (auto it = first; it != last; ++it) {
+            if (it->second == fds_[1]) {
+               registry.fds.erase(it);
+               break;
+            }
+         }
+      }
+      ::close(fds_[0]);
+      ::close(fds_[1]);
+   }
+
+   CancelWakeup(const CancelWakeup &)            = delete;
+   CancelWakeup &operator=(const CancelWakeup &) = delete;
+
+   int ReadFd() const { return fds_[0]; }
+
+ private:
+   const std::atomic<bool> *cancelRequested_;
+   int fds_[2]{-1, -1};
+};
+
 bool TerminateProcessGroupGracefully(pid_t processGroupId)
 {
    if (processGroupId <= 0) {
@@ -212,143 +412,172 @@ bool TerminateProcessGroupGracefully(pid_t processGroupId)
 }
 #endif
 
-bool TryParsePercent(std::string_view line, int &outPercent)
+std::string TrimWhitespace(const std::string &value)
 {
-   for (std::size_t i = 0; i < line.size(); ++i) {
-      if (!std::isdigit(static_cast<unsigned char>(line[i]))) {
-         continue;
-      }
-
-      int value     = 0;
-      std::size_t j = i;
-      while (j < line.size() && std::isdigit(static_cast<unsigned char>(line[j]))) {
-         value = value * 10 + (line[j] - '0');
-         ++j;
-      }
-      if (j < line.size() && line[j] == '%') {
-         outPercent = value;
-         return true;
-      }
-      i = j;
+   const auto first = value.find_first_not_of(" \t\r\n");
+   if (first == std::string::npos) {
+      return {};
    }
-   return false;
+   const auto last = value.find_last_not_of(" \t\r\n");
+   return value.substr(first, last - first + 1);
 }
 
-void ReportMappedProgress(const confy::GitClient::ProgressCallback &progress,
-    int stageMin,
-    int stageMax,
-    int stagePercent,
-    const std::string &message,
-    int &lastReportedPercent)
+std::vector<std::string> BuildGitCommand(const std::vector<std::string> &configArgs,
+    const std::string &workingDirectory,
+    std::initializer_list<std::string> arguments)
 {
-   if (!progress) {
-      return;
-   }
-
-   if (stagePercent < 0) {
-      stagePercent = 0;
-   }
-   if (stagePercent > 100) {
-      stagePercent = 100;
+   std::vector<std::string> command{"git"};
+   command.insert(command.end(), configArgs.begin(), configArgs.end());
+   if (!workingDirectory.empty()) {
+      command.insert(command.end(), {"-C", workingDirectory});
    }
+   command.insert(command.end(), arguments);
+   return command;
+}
 
-   const int mapped = stageMin + ((stageMax - stageMin) * stagePercent) / 100;
-   if (mapped <= lastReportedPercent) {
-      return;
+// Config for commands that check out files, letting git populate the work
+// tree with several workers. Older git versions ignore the unknown key.
+std::vector<std::string> BuildParallelCheckoutArgs(int parallelJobs)
+{
+   if (parallelJobs <= 1) {
+      return {};
    }
-
-   lastReportedPercent = mapped;
-   progress(mapped, message);
+   return {"-c", "checkout.workers=" + std::to_string(parallelJobs)};
 }
 
-void ProcessGitProgressLine(const std::string &line,
-    const confy::GitClient::ProgressCallback &progress,
-    bool submodulePhase,
-    int &lastReportedPercent)
+std::string BuildFileUrl(const fs::path &path)
 {
-   int stagePercent = 0;
-
-   if (line.find("Counting objects:") != std::string::npos && TryParsePercent(line, stagePercent)) {
-      const int stageMin = submodulePhase ? 80 : 10;
-      const int stageMax = submodulePhase ? 86 : 28;
-      ReportMappedProgress(progress, stageMin, stageMax, stagePercent, "Counting objects", lastReportedPercent);
-      return;
+   std::error_code ec;
+   auto absolutePath = fs::absolute(path, ec);
+   if (ec) {
+      absolutePath = path;
    }
-
-   if (line.find("Compressing objects:") != std::string::npos && TryParsePercent(line, stagePercent)) {
-      const int stageMin = submodulePhase ? 86 : 28;
-      const int stageMax = submodulePhase ? 90 : 44;
-      ReportMappedProgress(progress,
-          stageMin,
-          stageMax,
-          stagePercent,
-          "Compressing objects",
-          lastReportedPercent);
-      return;
-   }
-
-   if (line.find("Receiving objects:") != std::string::npos && TryParsePercent(line, stagePercent)) {
-      const int stageMin = submodulePhase ? 90 : 44;
-      const int stageMax = submodulePhase ? 96 : 80;
-      ReportMappedProgress(progress, stageMin, stageMax, stagePercent, "Receiving objects", lastReportedPercent);
-      return;
+   std::string generic = absolutePath.generic_string();
+   if (!generic.empty() && generic.front() != '/') {
+      generic.insert(generic.begin(), '/');
    }
+   return "file://" + generic;
+}
 
-   if (line.find("Resolving deltas:") != std::string::npos && TryParsePercent(line, stagePercent)) {
-      const int stageMin = submodulePhase ? 96 : 80;
-      const int stageMax = submodulePhase ? 99 : 94;
-      ReportMappedProgress(progress, stageMin, stageMax, stagePercent, "Resolving deltas", lastReportedPercent);
-      return;
-   }
+std::shared_ptr<std::timed_mutex> MirrorMutexFor(const std::string &lockPath)
+{
+   static std::mutex registryMutex;
+   static std::map<std::string, std::shared_ptr<std::timed_mutex>> mutexes;
 
-   if (line.find("Checking out files:") != std::string::npos && TryParsePercent(line, stagePercent)) {
-      const int stageMin = submodulePhase ? 99 : 94;
-      const int stageMax = submodulePhase ? 100 : 99;
-      ReportMappedProgress(progress, stageMin, stageMax, stagePercent, "Checking out files", lastReportedPercent);
-      return;
+   std::scoped_lock lock(registryMutex);
+   auto &entry = mutexes[lockPath];
+   if (!entry) {
+      entry = std::make_shared<std::timed_mutex>();
    }
+   return entry;
 }
 
-void PumpProgressFromChunk(const confy::GitClient::ProgressCallback &progress,
-    std::string_view chunk,
-    bool submodulePhase,
-    std::string &partialLine,
-    int &lastReportedPercent)
+// Serializes the use of one mirror: its fetch and the clone made from it.
+// The in-process mutex keeps download workers apart; the OS file lock does
+// the same for other confy instances sharing the cache directory. Waiting
+// honours cancellation.
+class MirrorLock final
 {
-   if (!progress || chunk.empty()) {
-      return;
-   }
+ public:
+   explicit MirrorLock(std::string lockPath) :
+       lockPath_(std::move(lockPath)),
+       mutex_(MirrorMutexFor(lockPath_)) {}
 
-   partialLine.append(chunk.data(), chunk.size());
-   std::size_t consumed = 0;
+   MirrorLock(const MirrorLock &)            = delete;
+   MirrorLock &operator=(const MirrorLock &) = delete;
 
-   for (std::size_t i = 0; i < partialLine.size(); ++i) {
-      if (partialLine[i] != '\n' && partialLine[i] != '\r') {
-         continue;
+   ~MirrorLock()
+   {
+#ifdef _WIN32
+      if (fileHandle_ != INVALID_HANDLE_VALUE) {
+         OVERLAPPED overlapped{};
+         UnlockFileEx(fileHandle_, 0, 1, 0, &overlapped);
+         CloseHandle(fileHandle_);
       }
+#else
+      if (fileDescriptor_ != -1) {
+         ::flock(fileDescriptor_, LOCK_UN);
+         ::close(fileDescriptor_);
+      }
+#endif
+      if (ownsMutex_) {
+         mutex_->unlock();
+      }
+   }
 
-      const std::string line = partialLine.substr(consumed, i - consumed);
-      ProcessGitProgressLine(line, progress, submodulePhase, lastReportedPercent);
+   bool Acquire(const std::atomic<bool> &cancelRequested, std::string &errorMessage)
+   {
+      const auto cacheDirectory = fs::path(lockPath_).parent_path();
+      std::error_code fsError;
+      fs::create_directories(cacheDirectory, fsError);
+      if (fsError) {
+         errorMessage = "Failed to create mirror cache directory '" + cacheDirectory.string() + "': " + fsError.message();
+         return false;
+      }
 
-      while (i + 1 < partialLine.size() &&
-             (partialLine[i + 1] == '\n' || partialLine[i + 1] == '\r')) {
-         ++i;
+      constexpr auto kPollInterval = std::chrono::milliseconds(100);
+      while (!mutex_->try_lock_for(kPollInterval)) {
+         if (cancelRequested.load()) {
+            errorMessage = "Cancelled";
+            return false;
+         }
       }
-      consumed = i + 1;
-   }
+      ownsMutex_ = true;
 
-   if (consumed > 0) {
-      partialLine.erase(0, consumed);
+#ifdef _WIN32
+      fileHandle_ = CreateFileA(lockPath_.c_str(),
+          GENERIC_READ | GENERIC_WRITE,
+          FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+          nullptr,
+          OPEN_ALWAYS,
+          FILE_ATTRIBUTE_NORMAL,
+          nullptr);
+      if (fileHandle_ == INVALID_HANDLE_VALUE) {
+         errorMessage = "Failed to open mirror lock file: " + lockPath_;
+         return false;
+      }
+      while (true) {
+         OVERLAPPED overlapped{};
+         if (LockFileEx(fileHandle_, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0, 1, 0, &overlapped)) {
+            return true;
+         }
+         if (cancelRequested.load()) {
+            errorMessage = "Cancelled";
+            return false;
+         }
+         std::this_thread::sleep_for(kPollInterval);
+      }
+#else
+      fileDescriptor_ = ::open(lockPath_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+      if (fileDescriptor_ == -1) {
+         errorMessage = "Failed to open mirror lock file: " + lockPath_;
+         return false;
+      }
+      while (::flock(fileDescriptor_, LOCK_EX | LOCK_NB) != 0) {
+         if (errno != EWOULDBLOCK && errno != EINTR) {
+            errorMessage = "Failed to lock mirror: " + lockPath_;
+            return false;
+         }
+         if (cancelRequested.load()) {
+            errorMessage = "Cancelled";
+            return false;
+         }
+         std::this_thread::sleep_for(kPollInterval);
+      }
+      return true;
+#endif
    }
-}
 
-std::string NormalizeRepositoryUrl(std::string repositoryUrl)
-{
-   while (repositoryUrl.size() > 1 && repositoryUrl.back() == '/') {
-      repositoryUrl.pop_back();
-   }
-   return repositoryUrl;
-}
+ private:
+   std::string lockPath_;
+   std::shared_ptr<std::timed_mutex> mutex_;
+   bool ownsMutex_{false};
+#ifdef _WIN32
+   HANDLE fileHandle_{INVALID_HANDLE_VALUE};
+#else
+   int fileDescriptor_{-1};
+#endif
+};
 
 #ifdef _WIN32
 void ClearReadOnlyAttributeRecursive(const fs::path &rootPath)
@@ -384,6 +613,20 @@ namespace confy {
 GitClient::GitClient(AuthCredentials credentials) :
     credentials_(std::move(credentials)) {}
 
+void GitClient::NotifyCancelRequested(const std::atomic<bool> &cancelRequested)
+{
+#ifdef _WIN32
+   (void)cancelRequested;
+#else
+   auto &registry = GetCancelWakeupRegistry();
+   std::scoped_lock lock(registry.mutex);
+   const auto [first, last] = registry.fds.equal_range(&cancelRequested);
+   for (auto it = first; it != last; ++it) {
+      WriteWakeup(it->second);
+   }
+#endif
+}
+
 bool GitClient::ExtractHostPort(const std::string &repositoryUrl, std::string &outHostPort)
 {
    const auto schemePos = repositoryUrl.find("://");
@@ -434,39 +677,96 @@ std::vector<std::string> GitClient::ParseLsRemoteRefs(const std::string &lsRemot
    return std::vector<std::string>(refs.begin(), refs.end());
 }
 
-std::string GitClient::EscapeShellArg(const std::string &value)
+std::string GitClient::ParseLsRemoteHead(const std::string &lsRemoteOutput)
 {
-#ifdef _WIN32
-   std::string escaped;
-   escaped.reserve(value.size() * 2 + 2);
-   escaped.push_back('"');
-   for (char c : value) {
-      if (c == '"') {
-         escaped += "\\\"";
+   std::istringstream stream(lsRemoteOutput);
+   std::string line;
+   while (std::getline(stream, line)) {
+      // "ref: refs/heads/main\tHEAD"
+      const auto tabPos = line.find('\t');
+      if (line.rfind("ref: ", 0) != 0 || tabPos == std::string::npos || line.compare(tabPos + 1, std::string::npos, "HEAD") != 0) {
          continue;
       }
-      if (c == '%') {
-         escaped += "%%";
-         continue;
+      return TrimWhitespace(line.substr(5, tabPos - 5));
+   }
+   return {};
+}
+
+std::string GitClient::NormalizeRepositoryUrl(std::string repositoryUrl)
+{
+   while (repositoryUrl.size() > 1 && repositoryUrl.back() == '/') {
+      repositoryUrl.pop_back();
+   }
+   return repositoryUrl;
+}
+
+std::string GitClient::BuildMirrorDirectoryName(const std::string &repositoryUrl)
+{
+   const std::string normalized = NormalizeRepositoryUrl(repositoryUrl);
+
+   // FNV-1a keeps the name stable across runs and builds, unlike std::hash.
+   std::uint64_t hash = 14695981039346656037ULL;
+   for (unsigned char c : normalized) {
+      hash ^= c;
+      hash *= 1099511628211ULL;
+   }
+
+   std::string readable = normalized;
+   const auto schemePos = readable.find("://");
+   if (schemePos != std::string::npos) {
+      readable.erase(0, schemePos + 3);
+   }
+   if (readable.size() > 4 && readable.compare(readable.size() - 4, 4, ".git") == 0) {
+      readable.erase(readable.size() - 4);
+   }
+
+   constexpr std::size_t kMaxReadableLength = 64;
+   std::string name;
+   name.reserve(kMaxReadableLength + 22);
+   for (char c : readable) {
+      if (name.size() >= kMaxReadableLength) {
+         break;
       }
-      escaped.push_back(c);
+      const bool safe = std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '-' || c == '_';
+      name.push_back(safe ? c : '_');
    }
-   escaped.push_back('"');
-   return escaped;
-#else
-   std::string escaped;
-   escaped.reserve(value.size() + 2);
-   escaped.push_back('\'');
-   for (char c : value) {
-      if (c == '\'') {
-         escaped += "'\\''";
+
+   constexpr char kHex[] = "0123456789abcdef";
+   name.push_back('-');
+   for (int shift = 60; shift >= 0; shift -= 4) {
+      name.push_back(kHex[(hash >> shift) & 0x0F]);
+   }
+   name += ".git";
+   return name;
+}
+
+std::string GitClient::FormatCommandForLog(const std::vector<std::string> &arguments)
+{
+   static const std::string kAuthorizationHeader = "http.extraHeader=Authorization:";
+
+   std::string formatted;
+   for (const auto &argument : arguments) {
+      if (!formatted.empty()) {
+         formatted.push_back(' ');
+      }
+      if (argument.rfind(kAuthorizationHeader, 0) == 0) {
+         formatted += kAuthorizationHeader + " <redacted>";
          continue;
       }
-      escaped.push_back(c);
+      if (!argument.empty() && argument.find_first_of(" \t\n\"'\\$") == std::string::npos) {
+         formatted += argument;
+         continue;
+      }
+      formatted.push_back('"');
+      for (char c : argument) {
+         if (c == '"' || c == '\\') {
+            formatted.push_back('\\');
+         }
+         formatted.push_back(c);
+      }
+      formatted.push_back('"');
    }
-   escaped.push_back('\'');
-   return escaped;
-#endif
+   return formatted;
 }
 
 int GitClient::DecodeExitCode(int rawExitCode)
@@ -484,126 +784,190 @@ int GitClient::DecodeExitCode(int rawExitCode)
    return rawExitCode;
 }
 
-bool GitClient::RunCommandCapture(const std::string &command,
+bool GitClient::RunCommandCapture(const std::vector<std::string> &arguments,
     std::string &output,
     std::string &errorMessage,
     CommandOutputCallback outputCallback,
-    const std::atomic<bool> *cancelRequested)
+    const std::atomic<bool> *cancelRequested,
+    std::size_t outputTailBytes,
+    std::ostream *outputLog)
 {
-#ifdef _WIN32
-   return RunCommandCaptureWindows(command, output, errorMessage, outputCallback, cancelRequested);
-#else
-   output.clear();
    errorMessage.clear();
-   wxLogMessage("[git-client] exec: %s", command.c_str());
+   const std::string displayCommand = FormatCommandForLog(arguments);
+   CONFY_LOG(LogModule::Git, LogLevel::Info, "exec: %s", displayCommand.c_str());
+   if (outputLog != nullptr) {
+      *outputLog << "$ " << displayCommand << '\n';
+   }
+   CommandOutputCapture capture(output, outputTailBytes, outputLog);
 
-   int outputPipe[2]{-1, -1};
-   if (pipe(outputPipe) != 0) {
-      errorMessage = "Failed to create process output pipe.";
-      wxLogError("[git-client] failed to create process output pipe");
+   if (arguments.empty()) {
+      errorMessage = "No command to run.";
       return false;
    }
 
-   const pid_t childPid = fork();
-   if (childPid == -1) {
-      close(outputPipe[0]);
-      close(outputPipe[1]);
-      errorMessage = "Failed to start process: " + command;
-      wxLogError("[git-client] failed to fork process");
+#ifdef _WIN32
+   return RunCommandCaptureWindows(arguments,
+       displayCommand,
+       capture,
+       output,
+       errorMessage,
+       outputCallback,
+       cancelRequested);
+#else
+   // Close-on-exec keeps the pipes of concurrently running commands from
+   // leaking into each other's children and delaying their EOF.
+   int outputPipe[2]{-1, -1};
+   if (!OpenCloseOnExecPipe(outputPipe)) {
+      errorMessage = "Failed to create process output pipe.";
+      CONFY_LOG(LogModule::Git, LogLevel::Error, "failed to create process output pipe");
       return false;
    }
 
-   if (childPid == 0) {
-      ::setpgid(0, 0);
-      ::dup2(outputPipe[1], STDOUT_FILENO);
-      ::dup2(outputPipe[1], STDERR_FILENO);
-      close(outputPipe[0]);
-      close(outputPipe[1]);
-      execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char *>(nullptr));
-      _exit(127);
+   posix_spawn_file_actions_t fileActions;
+   posix_spawn_file_actions_init(&fileActions);
+   posix_spawn_file_actions_adddup2(&fileActions, outputPipe[1], STDOUT_FILENO);
+   posix_spawn_file_actions_adddup2(&fileActions, outputPipe[1], STDERR_FILENO);
+
+   // Each command gets its own process group so cancellation can stop the
+   // helpers git starts (remote-https, index-pack, submodule clones).
+   posix_spawnattr_t spawnAttributes;
+   posix_spawnattr_init(&spawnAttributes);
+   posix_spawnattr_setflags(&spawnAttributes, POSIX_SPAWN_SETPGROUP);
+   posix_spawnattr_setpgroup(&spawnAttributes, 0);
+
+   std::vector<char *> argv;
+   argv.reserve(arguments.size() + 1);
+   for (const auto &argument : arguments) {
+      argv.push_back(const_cast<char *>(argument.c_str()));
    }
+   argv.push_back(nullptr);
+
+   pid_t childPid        = -1;
+   const int spawnResult = posix_spawnp(&childPid, argv[0], &fileActions, &spawnAttributes, argv.data(), environ);
+   posix_spawn_file_actions_destroy(&fileActions);
+   posix_spawnattr_destroy(&spawnAttributes);
+   ::close(outputPipe[1]);
 
-   ::setpgid(childPid, childPid);
-   close(outputPipe[1]);
+   if (spawnResult != 0) {
+      ::close(outputPipe[0]);
+      errorMessage = "Failed to start process: " + displayCommand + " (" + std::strerror(spawnResult) + ")";
+      CONFY_LOG(LogModule::Git, LogLevel::Error, "failed to spawn process");
+      return false;
+   }
 
    const int flags = fcntl(outputPipe[0], F_GETFL, 0);
    if (flags >= 0) {
       fcntl(outputPipe[0], F_SETFL, flags | O_NONBLOCK);
    }
 
+   // A pidfd becomes readable when the child exits, so the loop below can
+   // block on both the output pipe and the exit instead of polling waitpid.
+   int childExitFd = -1;
+#if defined(__linux__) && defined(SYS_pidfd_open)
+   childExitFd = static_cast<int>(::syscall(SYS_pidfd_open, childPid, 0));
+#endif
+
+   const CancelWakeup cancelWakeup(cancelRequested);
+   bool pipeOpen    = true;
    bool childExited = false;
    bool cancelled   = false;
    int rawExit      = -1;
-   std::array<char, 512> buffer{};
-   pollfd pfd{};
-   pfd.fd     = outputPipe[0];
-   pfd.events = POLLIN;
+   std::vector<char> buffer(kReadBufferSize);
 
-   while (!childExited) {
-      const int pollResult = poll(&pfd, 1, 50);
-      if (pollResult > 0 && (pfd.revents & (POLLIN | POLLHUP))) {
-         while (true) {
-            const ssize_t readCount = read(outputPipe[0], buffer.data(), buffer.size());
-            if (readCount > 0) {
-               output.append(buffer.data(), static_cast<std::size_t>(readCount));
-               if (outputCallback) {
-                  outputCallback(std::string_view(buffer.data(), static_cast<std::size_t>(readCount)));
-               }
-               continue;
-            }
-            if (readCount == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-               break;
+   auto drainPipe = [&]() {
+      while (pipeOpen) {
+         const ssize_t readCount = ::read(outputPipe[0], buffer.data(), buffer.size());
+         if (readCount > 0) {
+            capture.Append(std::string_view(buffer.data(), static_cast<std::size_t>(readCount)));
+            if (outputCallback) {
+               outputCallback(std::string_view(buffer.data(), static_cast<std::size_t>(readCount)));
             }
-            break;
+            continue;
          }
+         if (readCount == 0) {
+            pipeOpen = false;
+         } else if (errno == EINTR) {
+            continue;
+         }
+         return;
       }
+   };
 
-      if (cancelRequested != nullptr && cancelRequested->load()) {
-         cancelled = true;
-         TerminateProcessGroupGracefully(childPid);
-      }
-
+   auto reapChild = [&](int waitOptions) {
       int status         = 0;
-      const pid_t waited = waitpid(childPid, &status, WNOHANG);
+      const pid_t waited = ::waitpid(childPid, &status, waitOptions);
       if (waited == childPid) {
          rawExit     = status;
          childExited = true;
+      } else if (waited == -1 && errno != EINTR) {
+         childExited = true;
       }
-   }
+   };
 
-   while (true) {
-      const ssize_t readCount = read(outputPipe[0], buffer.data(), buffer.size());
-      if (readCount > 0) {
-         output.append(buffer.data(), static_cast<std::size_t>(readCount));
-         if (outputCallback) {
-            outputCallback(std::string_view(buffer.data(), static_cast<std::size_t>(readCount)));
-         }
+   while (!childExited) {
+      pollfd pollFds[3]{};
+      nfds_t pollCount = 0;
+      if (pipeOpen) {
+         pollFds[pollCount++] = pollfd{outputPipe[0], POLLIN, 0};
+      }
+      if (childExitFd >= 0) {
+         pollFds[pollCount++] = pollfd{childExitFd, POLLIN, 0};
+      }
+      if (!cancelled && cancelWakeup.ReadFd() >= 0) {
+         pollFds[pollCount++] = pollfd{cancelWakeup.ReadFd(), POLLIN, 0};
+      }
+
+      if (pollCount == 0 && (cancelRequested == nullptr || cancelled)) {
+         reapChild(0);
          continue;
       }
-      break;
+      // Output, the exit and cancellation all wake the poll. Without a
+      // pidfd an exited child whose grandchildren still hold the pipe open
+      // is only noticed on a timed wakeup, as is a cancellation when the
+      // wakeup pipe could not be created.
+      const bool needsTimedWakeup = childExitFd < 0 || (cancelRequested != nullptr && cancelWakeup.ReadFd() < 0);
+      if (::poll(pollFds, pollCount, needsTimedWakeup ? kExitPollIntervalMs : -1) < 0 && errno != EINTR) {
+         reapChild(0);
+         break;
+      }
+
+      drainPipe();
+
+      if (!cancelled && cancelRequested != nullptr && cancelRequested->load()) {
+         cancelled = true;
+         TerminateProcessGroupGracefully(childPid);
+      }
+
+      reapChild(WNOHANG);
    }
 
-   close(outputPipe[0]);
+   drainPipe();
+   if (childExitFd >= 0) {
+      ::close(childExitFd);
+   }
+   ::close(outputPipe[0]);
+   capture.Finish();
 
    const int exitCode = DecodeExitCode(rawExit);
-   wxLogMessage("[git-client] exit=%d", exitCode);
-   if (!output.empty()) {
-      wxLogMessage("[git-client] output:\n%s", output.c_str());
+   CONFY_LOG(LogModule::Git, LogLevel::Debug, "exit=%d", exitCode);
+   const std::string loggedOutput = capture.LogText();
+   if (!loggedOutput.empty()) {
+      CONFY_LOG(LogModule::Git, LogLevel::Debug, "output:\n%s", loggedOutput.c_str());
    }
 
    if (cancelled) {
       errorMessage = "Cancelled";
-      wxLogMessage("[git-client] command cancelled");
+      CONFY_LOG(LogModule::Git, LogLevel::Info, "command cancelled");
       return false;
    }
 
    if (exitCode != 0) {
       if (output.empty()) {
-         errorMessage = "Command failed with exit code " + std::to_string(exitCode) + ": " + command;
+         errorMessage = "Command failed with exit code " + std::to_string(exitCode) + ": " + displayCommand;
       } else {
          errorMessage = output;
       }
-      wxLogError("[git-client] command failed");
+      CONFY_LOG(LogModule::Git, LogLevel::Warning, "command failed exit=%d", exitCode);
       return false;
    }
 
@@ -611,11 +975,11 @@ bool GitClient::RunCommandCapture(const std::string &command,
 #endif
 }
 
-bool GitClient::BuildAuthConfigArg(const std::string &repositoryUrl,
-    std::string &outConfigArg,
+bool GitClient::BuildAuthConfigArgs(const std::string &repositoryUrl,
+    std::vector<std::string> &outConfigArgs,
     std::string &errorMessage) const
 {
-   outConfigArg.clear();
+   outConfigArgs.clear();
 
    if (repositoryUrl.rfind("http://", 0) != 0 && repositoryUrl.rfind("https://", 0) != 0) {
       return true;
@@ -638,7 +1002,7 @@ bool GitClient::BuildAuthConfigArg(const std::string &repositoryUrl,
       return false;
    }
 
-   outConfigArg = "-c " + EscapeShellArg("http.extraHeader=Authorization: Bearer " + creds.password);
+   outConfigArgs = {"-c", "http.extraHeader=Authorization: Bearer " + creds.password};
    return true;
 }
 
@@ -649,18 +1013,21 @@ bool GitClient::ListBranchesAndTags(const std::string &repositoryUrl,
    outRefs.clear();
    const std::string normalizedRepositoryUrl = NormalizeRepositoryUrl(repositoryUrl);
 
-   std::string authConfigArg;
-   if (!BuildAuthConfigArg(normalizedRepositoryUrl, authConfigArg, errorMessage)) {
+   std::vector<std::string> authConfigArgs;
+   if (!BuildAuthConfigArgs(normalizedRepositoryUrl, authConfigArgs, errorMessage)) {
       return false;
    }
 
+   // With protocol v2 --heads/--tags are sent as ref-prefix filters, so the
+   // server only advertises branches and tags instead of every ref it has.
+   auto configArgs = authConfigArgs;
+   configArgs.insert(configArgs.end(), {"-c", "protocol.version=2"});
+
    std::string output;
-   std::string command = "git ";
-   if (!authConfigArg.empty()) {
-      command += authConfigArg + " ";
-   }
-   command += "ls-remote --heads --tags " + EscapeShellArg(normalizedRepositoryUrl);
-   if (!RunCommandCapture(command, output, errorMessage)) {
+   if (!RunCommandCapture(
+           BuildGitCommand(configArgs, {}, {"ls-remote", "--heads", "--tags", normalizedRepositoryUrl}),
+           output,
+           errorMessage)) {
       return false;
    }
 
@@ -668,10 +1035,196 @@ bool GitClient::ListBranchesAndTags(const std::string &repositoryUrl,
    return true;
 }
 
+bool GitClient::TryUpdateExistingCheckout(const std::string &repositoryUrl,
+    const std::string &branchOrTag,
+    const std::string &targetDirectory,
+    const GitCloneOptions &options,
+    const std::vector<std::string> &authConfigArgs,
+    std::atomic<bool> &cancelRequested,
+    const CommandOutputCallback &outputCallback,
+    std::ostream *outputLog,
+    bool &outHasLocalChanges,
+    std::string &errorMessage) const
+{
+   outHasLocalChanges = false;
+
+   std::error_code fsError;
+   if (!fs::exists(fs::path(targetDirectory) / ".git", fsError)) {
+      return false;
+   }
+
+   const auto checkoutConfigArgs = BuildParallelCheckoutArgs(options.parallelJobs);
+   std::string output;
+   if (!RunCommandCapture(BuildGitCommand({}, targetDirectory, {"remote", "get-url", "origin"}), output, errorMessage) ||
+       NormalizeRepositoryUrl(TrimWhitespace(output)) != repositoryUrl) {
+      CONFY_LOG(LogModule::Git, LogLevel::Info, "'%s' is not a checkout of %s", targetDirectory.c_str(), repositoryUrl.c_str());
+      return false;
+   }
+
+   if (!RunCommandCapture(BuildGitCommand({}, targetDirectory, {"status", "--porcelain", "--ignore-submodules=none"}),
+           output,
+           errorMessage)) {
+      return false;
+   }
+   if (!TrimWhitespace(output).empty()) {
+      outHasLocalChanges = true;
+      errorMessage       = "Target directory '" + targetDirectory + "' has local changes.";
+      CONFY_LOG(LogModule::Git, LogLevel::Info, "existing checkout has local changes: %s", targetDirectory.c_str());
+      return false;
+   }
+
+   // A checkout cloned with a different partial clone filter cannot be
+   // converted by a fetch; re-clone it instead.
+   std::string existingFilter;
+   if (RunCommandCapture(BuildGitCommand({}, targetDirectory, {"config", "--get", "remote.origin.partialclonefilter"}),
+           output,
+           errorMessage)) {
+      existingFilter = TrimWhitespace(output);
+   }
+   if (existingFilter != options.filter) {
+      CONFY_LOG(LogModule::Git, LogLevel::Info, "existing checkout filter '%s' differs from '%s'",
+          existingFilter.c_str(),
+          options.filter.c_str());
+      return false;
+   }
+
+   if (!ApplySparseCheckout(targetDirectory, options, authConfigArgs, errorMessage)) {
+      return false;
+   }
+
+   auto fetch = [&](const std::string &refspec) {
+      auto command = BuildGitCommand(authConfigArgs, targetDirectory, {"fetch", "--progress"});
+      if (options.shallow) {
+         command.insert(command.end(), {"--depth", "1"});
+      }
+      command.insert(command.end(), {"origin", refspec});
+      return RunCommandCapture(command,
+          output,
+          errorMessage,
+          outputCallback,
+          &cancelRequested,
+          options.outputTailBytes,
+          outputLog);
+   };
+   auto checkout = [&](std::initializer_list<std::string> checkoutArgs) {
+      auto command = BuildGitCommand(checkoutConfigArgs, targetDirectory, {"checkout", "--force"});
+      command.insert(command.end(), checkoutArgs);
+      return RunCommandCapture(command, output, errorMessage);
+   };
+
+   // The requested ref may be a branch or a tag. Branches are checked out as a
+   // local branch tracking the fetched commit, matching `clone --branch`;
+   // tags and the remote default branch leave HEAD detached.
+   if (branchOrTag.empty()) {
+      return fetch("HEAD") && checkout({"--detach", "FETCH_HEAD"});
+   }
+
+   const std::string remoteBranchRef = "refs/remotes/origin/" + branchOrTag;
+   if (fetch("+refs/heads/" + branchOrTag + ":" + remoteBranchRef)) {
+      return checkout({"-B", branchOrTag, remoteBranchRef});
+   }
+   if (cancelRequested.load()) {
+      return false;
+   }
+
+   const std::string tagRef = "refs/tags/" + branchOrTag;
+   return fetch("+" + tagRef + ":" + tagRef) && checkout({"--detach", tagRef});
+}
+
+bool GitClient::ApplySparseCheckout(const std::string &targetDirectory,
+    const GitCloneOptions &options,
+    const std::vector<std::string> &authConfigArgs,
+    std::string &errorMessage) const
+{
+   std::string output;
+   if (options.sparsePaths.empty()) {
+      const bool isSparse =
+          RunCommandCapture(BuildGitCommand({}, targetDirectory, {"config", "--get", "core.sparseCheckout"}),
+              output,
+              errorMessage) &&
+          TrimWhitespace(output) == "true";
+      return !isSparse ||
+             RunCommandCapture(BuildGitCommand({}, targetDirectory, {"sparse-checkout", "disable"}),
+                 output,
+                 errorMessage);
+   }
+
+   // Filtered clones fetch the blobs of newly included paths on demand.
+   auto command = BuildGitCommand(authConfigArgs, targetDirectory, {"sparse-checkout", "set", "--cone", "--"});
+   command.insert(command.end(), options.sparsePaths.begin(), options.sparsePaths.end());
+   return RunCommandCapture(command, output, errorMessage);
+}
+
+bool GitClient::UpdateMirror(const std::string &repositoryUrl,
+    const std::vector<std::string> &authConfigArgs,
+    const std::string &mirrorDirectory,
+    std::size_t outputTailBytes,
+    std::ostream *outputLog,
+    std::atomic<bool> &cancelRequested,
+    const CommandOutputCallback &outputCallback,
+    std::string &errorMessage) const
+{
+   const fs::path mirrorPath(mirrorDirectory);
+   std::error_code fsError;
+   std::string output;
+   if (!fs::exists(mirrorPath / "HEAD", fsError)) {
+      CONFY_LOG(LogModule::Git, LogLevel::Info, "creating mirror '%s' for %s", mirrorDirectory.c_str(), repositoryUrl.c_str());
+      fs::remove_all(mirrorPath, fsError);
+
+      // Only branches and tags are mirrored; hosts such as Bitbucket publish
+      // pull-request refs that would otherwise dominate the mirror.
+      if (!RunCommandCapture(BuildGitCommand({}, {}, {"init", "--bare", mirrorDirectory}), output, errorMessage) ||
+          !RunCommandCapture(BuildGitCommand({}, mirrorDirectory, {"config", "remote.origin.url", repositoryUrl}),
+              output,
+              errorMessage) ||
+          !RunCommandCapture(
+              BuildGitCommand({}, mirrorDirectory, {"config", "remote.origin.fetch", "+refs/heads/*:refs/heads/*"}),
+              output,
+              errorMessage) ||
+          !RunCommandCapture(BuildGitCommand({},
+                                 mirrorDirectory,
+                                 {"config", "--add", "remote.origin.fetch", "+refs/tags/*:refs/tags/*"}),
+              output,
+              errorMessage)) {
+         return false;
+      }
+   }
+
+   if (!RunCommandCapture(
+           BuildGitCommand(authConfigArgs, mirrorDirectory, {"fetch", "--prune", "--progress", "origin"}),
+           output,
+           errorMessage,
+           outputCallback,
+           &cancelRequested,
+           outputTailBytes,
+           outputLog)) {
+      return false;
+   }
+
+   // `init --bare` points HEAD at master and the fetch does not move it, so
+   // without this a clone that relies on the default branch checks out
+   // nothing when the remote's default branch has another name.
+   if (!RunCommandCapture(BuildGitCommand(authConfigArgs, mirrorDirectory, {"ls-remote", "--symref", "origin", "HEAD"}),
+           output,
+           errorMessage,
+           nullptr,
+           &cancelRequested,
+           outputTailBytes,
+           outputLog)) {
+      return false;
+   }
+   const std::string headRef = ParseLsRemoteHead(output);
+   if (headRef.rfind("refs/heads/", 0) != 0) {
+      errorMessage = "Remote '" + repositoryUrl + "' did not report a default branch";
+      return false;
+   }
+   return RunCommandCapture(BuildGitCommand({}, mirrorDirectory, {"symbolic-ref", "HEAD", headRef}), output, errorMessage);
+}
+
 bool GitClient::CloneRepository(const std::string &repositoryUrl,
     const std::string &branchOrTag,
     const std::string &targetDirectory,
-    bool shallow,
+    const GitCloneOptions &options,
     std::atomic<bool> &cancelRequested,
     ProgressCallback progress,
     std::string &errorMessage) const
@@ -683,66 +1236,182 @@ bool GitClient::CloneRepository(const std::string &repositoryUrl,
       return false;
    }
 
-   std::string authConfigArg;
-   if (!BuildAuthConfigArg(normalizedRepositoryUrl, authConfigArg, errorMessage)) {
+   std::vector<std::string> authConfigArgs;
+   if (!BuildAuthConfigArgs(normalizedRepositoryUrl, authConfigArgs, errorMessage)) {
       return false;
    }
 
    const fs::path targetPath(targetDirectory);
-   std::error_code fsError;
+   auto clearTarget = [&]() {
+      std::error_code fsError;
 #ifdef _WIN32
-   ClearReadOnlyAttributeRecursive(targetPath);
+      ClearReadOnlyAttributeRecursive(targetPath);
 #endif
-   fs::remove_all(targetPath, fsError);
-   if (fsError) {
-      errorMessage = "Failed to clear target directory '" + targetDirectory + "': " + fsError.message();
-      return false;
-   }
+      fs::remove_all(targetPath, fsError);
+      if (fsError) {
+         errorMessage = "Failed to clear target directory '" + targetDirectory + "': " + fsError.message();
+         return false;
+      }
 
-   fs::create_directories(targetPath.parent_path(), fsError);
-   if (fsError) {
-      errorMessage = "Failed to create parent directory for '" + targetDirectory + "': " + fsError.message();
-      return false;
+      fs::create_directories(targetPath.parent_path(), fsError);
+      if (fsError) {
+         errorMessage = "Failed to create parent directory for '" + targetDirectory + "': " + fsError.message();
+         return false;
+      }
+      return true;
+   };
+
+   std::ofstream logFile;
+   std::ostream *logStream = nullptr;
+   if (!options.logFilePath.empty()) {
+      std::error_code logDirError;
+      fs::create_directories(fs::path(options.logFilePath).parent_path(), logDirError);
+      logFile.open(options.logFilePath, std::ios::binary | std::ios::app);
+      if (logFile) {
+         logStream = &logFile;
+         CONFY_LOG(LogModule::Git, LogLevel::Info, "writing git output to %s", options.logFilePath.c_str());
+      } else {
+         CONFY_LOG(LogModule::Git, LogLevel::Warning, "could not open log file %s", options.logFilePath.c_str());
+      }
    }
 
-   if (progress) {
-      progress(5, "Cloning repository");
+   GitProgressState progressState;
+   progressState.lastReportedPercent = 5;
+   auto pumpProgress = [&](std::string_view chunk) { PumpGitProgress(progress, chunk, progressState); };
+
+   std::error_code existsError;
+   if (progress && fs::exists(targetPath / ".git", existsError)) {
+      progress(5, "Updating existing checkout");
    }
 
-   int lastReportedPercent = 5;
-   std::string clonePartialLine;
+   bool hasLocalChanges = false;
+   std::string updateError;
+   const bool updatedInPlace = TryUpdateExistingCheckout(normalizedRepositoryUrl,
+       branchOrTag,
+       targetDirectory,
+       options,
+       authConfigArgs,
+       cancelRequested,
+       pumpProgress,
+       logStream,
+       hasLocalChanges,
+       updateError);
+   if (cancelRequested.load()) {
+      errorMessage = "Cancelled";
+      return false;
+   }
+   if (!updatedInPlace && hasLocalChanges && options.refuseDirtyReclone) {
+      errorMessage = updateError + " Refusing to discard them; commit, stash or clean the checkout first.";
+      return false;
+   }
 
    std::string output;
-   std::string command = "git ";
-   if (!authConfigArg.empty()) {
-      command += authConfigArg + " ";
-   }
-   command += "clone --recursive --progress ";
-   if (shallow) {
-      command += "--depth 1 --shallow-submodules ";
+   bool clonedFromMirror = false;
+   if (!updatedInPlace) {
+      if (!clearTarget()) {
+         return false;
+      }
+      progressState.partialLine.clear();
+      if (progress) {
+         progress(5, "Cloning repository");
+      }
    }
-   if (!branchOrTag.empty()) {
-      command += "--branch " + EscapeShellArg(branchOrTag) + " ";
+
+   const bool sparse             = !options.sparsePaths.empty();
+   const auto checkoutConfigArgs = BuildParallelCheckoutArgs(options.parallelJobs);
+   auto buildCloneCommand        = [&](const std::vector<std::string> &configArgs, const std::string &source) {
+      auto command = BuildGitCommand(configArgs, {}, {"clone", "--progress"});
+      if (options.shallow) {
+         command.insert(command.end(), {"--depth", "1"});
+      }
+      if (!options.filter.empty()) {
+         command.push_back("--filter=" + options.filter);
+      }
+      if (sparse) {
+         command.push_back("--sparse");
+      }
+      if (!branchOrTag.empty()) {
+         command.insert(command.end(), {"--branch", branchOrTag});
+      }
+      command.insert(command.end(), {"--", source, targetDirectory});
+      return command;
+   };
+
+   // The mirror holds every object, so it would defeat a partial clone.
+   if (!updatedInPlace && !options.mirrorCacheDirectory.empty() && options.filter.empty()) {
+      const std::string mirrorDirectory =
+          (fs::path(options.mirrorCacheDirectory) / BuildMirrorDirectoryName(normalizedRepositoryUrl)).string();
+
+      if (progress) {
+         progress(5, "Updating mirror");
+      }
+
+      // Held until the clone is done: another job's fetch --prune on the
+      // same mirror could otherwise remove refs or packs it still reads.
+      MirrorLock mirrorLock(mirrorDirectory + ".lock");
+      std::string mirrorError;
+      if (mirrorLock.Acquire(cancelRequested, mirrorError) &&
+          UpdateMirror(normalizedRepositoryUrl,
+              authConfigArgs,
+              mirrorDirectory,
+              options.outputTailBytes,
+              logStream,
+              cancelRequested,
+              pumpProgress,
+              mirrorError)) {
+         progressState.partialLine.clear();
+
+         // Shallow clones go through file:// so --depth is honoured; full
+         // clones use a plain path so git hardlinks the mirror's objects.
+         if (RunCommandCapture(
+                 buildCloneCommand(checkoutConfigArgs,
+                     options.shallow ? BuildFileUrl(mirrorDirectory) : mirrorDirectory),
+                 output,
+                 mirrorError,
+                 pumpProgress,
+                 &cancelRequested,
+                 options.outputTailBytes,
+                 logStream) &&
+             RunCommandCapture(
+                 BuildGitCommand({}, targetDirectory, {"remote", "set-url", "origin", normalizedRepositoryUrl}),
+                 output,
+                 mirrorError)) {
+            clonedFromMirror = true;
+         }
+      }
+
+      if (cancelRequested.load()) {
+         errorMessage = "Cancelled";
+         return false;
+      }
+      if (!clonedFromMirror) {
+         CONFY_LOG(LogModule::Git, LogLevel::Warning, "mirror clone failed, cloning from remote: %s", mirrorError.c_str());
+         if (!clearTarget()) {
+            return false;
+         }
+      }
    }
-   command += EscapeShellArg(normalizedRepositoryUrl) + " " + EscapeShellArg(targetDirectory);
 
-   if (!RunCommandCapture(
-           command,
-           output,
-           errorMessage,
-           [&](std::string_view chunk) {
-              PumpProgressFromChunk(progress,
-                  chunk,
-                  false,
-                  clonePartialLine,
-                  lastReportedPercent);
-           },
-           &cancelRequested)) {
-      return false;
+   if (!updatedInPlace && !clonedFromMirror) {
+      auto configArgs = checkoutConfigArgs;
+      configArgs.insert(configArgs.end(), authConfigArgs.begin(), authConfigArgs.end());
+
+      // Submodules are left to the update below, which fetches them in
+      // parallel and limits them to the sparse directories.
+      if (!RunCommandCapture(buildCloneCommand(configArgs, normalizedRepositoryUrl),
+              output,
+              errorMessage,
+              pumpProgress,
+              &cancelRequested,
+              options.outputTailBytes,
+              logStream)) {
+         return false;
+      }
    }
-   if (!clonePartialLine.empty()) {
-      ProcessGitProgressLine(clonePartialLine, progress, false, lastReportedPercent);
+   if (!updatedInPlace && sparse && !ApplySparseCheckout(targetDirectory, options, authConfigArgs, errorMessage)) {
+      return false;
    }
+   FlushGitProgress(progress, progressState);
 
    if (cancelRequested.load()) {
       errorMessage = "Cancelled";
@@ -750,40 +1419,47 @@ bool GitClient::CloneRepository(const std::string &repositoryUrl,
    }
 
    if (progress) {
-      const int kickoff = lastReportedPercent < 80 ? 80 : lastReportedPercent;
+      const int kickoff = progressState.lastReportedPercent < 80 ? 80 : progressState.lastReportedPercent;
       progress(kickoff, "Updating submodules");
-      lastReportedPercent = kickoff;
+      progressState.lastReportedPercent = kickoff;
    }
+   progressState.submodulePhase = true;
 
-   std::string submodulePartialLine;
+   if (updatedInPlace &&
+       !RunCommandCapture(BuildGitCommand({}, targetDirectory, {"submodule", "sync", "--recursive"}),
+           output,
+           errorMessage)) {
+      return false;
+   }
 
-   std::string submoduleCommand = "git ";
-   if (!authConfigArg.empty()) {
-      submoduleCommand += authConfigArg + " ";
+   auto submoduleConfigArgs = checkoutConfigArgs;
+   submoduleConfigArgs.insert(submoduleConfigArgs.end(), authConfigArgs.begin(), authConfigArgs.end());
+   auto submoduleCommand =
+       BuildGitCommand(submoduleConfigArgs, targetDirectory, {"submodule", "update", "--init", "--recursive", "--progress"});
+   if (options.shallow) {
+      submoduleCommand.insert(submoduleCommand.end(), {"--depth", "1"});
+   }
+   if (options.parallelJobs > 1) {
+      submoduleCommand.insert(submoduleCommand.end(), {"--jobs", std::to_string(options.parallelJobs)});
+   }
+   if (!options.filter.empty()) {
+      submoduleCommand.push_back("--filter=" + options.filter);
    }
-   submoduleCommand +=
-       "-C " + EscapeShellArg(targetDirectory) + " submodule update --init --recursive --progress";
-   if (shallow) {
-      submoduleCommand += " --depth 1";
+   if (sparse) {
+      submoduleCommand.push_back("--");
+      submoduleCommand.insert(submoduleCommand.end(), options.sparsePaths.begin(), options.sparsePaths.end());
    }
 
-   if (!RunCommandCapture(
-           submoduleCommand,
+   if (!RunCommandCapture(submoduleCommand,
            output,
            errorMessage,
-           [&](std::string_view chunk) {
-              PumpProgressFromChunk(progress,
-                  chunk,
-                  true,
-                  submodulePartialLine,
-                  lastReportedPercent);
-           },
-           &cancelRequested)) {
+           pumpProgress,
+           &cancelRequested,
+           options.outputTailBytes,
+           logStream)) {
       return false;
    }
-   if (!submodulePartialLine.empty()) {
-      ProcessGitProgressLine(submodulePartialLine, progress, true, lastReportedPercent);
-   }
+   FlushGitProgress(progress, progressState);
 
    if (progress) {
       progress(100, "Completed");
@@ -3,13 +3,44 @@
 #include "AuthCredentials.h"
 
 #include <atomic>
+#include <cstddef>
 #include <functional>
+#include <iosfwd>
 #include <string>
 #include <string_view>
 #include <vector>
 
 namespace confy {
 
+struct GitCloneOptions
+{
+   bool shallow{true};
+   // When set, a bare mirror of each repository is kept below this directory,
+   // refreshed with an incremental fetch and used as the clone source. The
+   // mirror holds full history even for shallow jobs, so its first fetch
+   // costs more than a shallow clone; later clones of the repository only
+   // fetch what changed.
+   std::string mirrorCacheDirectory;
+   // An existing checkout of the same remote is normally updated in place and
+   // only re-cloned when that fails or it has local changes. When set, a
+   // checkout with local changes fails the job instead of being discarded.
+   bool refuseDirtyReclone{false};
+   // Partial clone filter ("blob:none", "tree:0", ...) for the clone and its
+   // submodules. Filtered clones bypass the mirror cache.
+   std::string filter;
+   // Cone-mode sparse-checkout directories; empty checks out the whole tree.
+   // Only submodules below these directories are initialized.
+   std::vector<std::string> sparsePaths;
+   // Only this many trailing bytes of each git command's output are kept in
+   // memory (for error messages); 0 keeps everything.
+   std::size_t outputTailBytes{64 * 1024};
+   // When set, the complete output of every git command is appended here.
+   std::string logFilePath;
+   // Submodules fetched concurrently and checkout.workers for populating the
+   // work tree; 0 or 1 keeps git's sequential defaults.
+   int parallelJobs{0};
+};
+
 class GitClient final
 {
  public:
@@ -25,25 +56,67 @@ class GitClient final
    bool CloneRepository(const std::string &repositoryUrl,
        const std::string &branchOrTag,
        const std::string &targetDirectory,
-       bool shallow,
+       const GitCloneOptions &options,
        std::atomic<bool> &cancelRequested,
        ProgressCallback progress,
        std::string &errorMessage) const;
 
+   // Wakes the commands running with cancelRequested so that they stop
+   // without waiting for their next output; call it after setting the flag.
+   static void NotifyCancelRequested(const std::atomic<bool> &cancelRequested);
+
    static bool ExtractHostPort(const std::string &repositoryUrl, std::string &outHostPort);
    static std::vector<std::string> ParseLsRemoteRefs(const std::string &lsRemoteOutput);
-
- private:
-   static std::string EscapeShellArg(const std::string &value);
-   static bool RunCommandCapture(const std::string &command,
+   // Branch HEAD points to in `ls-remote --symref <remote> HEAD` output, e.g.
+   // "refs/heads/main"; empty when the remote reports no symbolic HEAD.
+   static std::string ParseLsRemoteHead(const std::string &lsRemoteOutput);
+   // Canonical form used to compare repository URLs (trailing slashes removed).
+   static std::string NormalizeRepositoryUrl(std::string repositoryUrl);
+   static std::string BuildMirrorDirectoryName(const std::string &repositoryUrl);
+   // Joins a command line for logging, masking credentials passed via -c.
+   static std::string FormatCommandForLog(const std::vector<std::string> &arguments);
+   // Runs arguments[0] (resolved via PATH) without a shell. A non-zero
+   // outputTailBytes keeps only the end of the output (see TailBuffer),
+   // which is what error messages need; outputLog receives all of it.
+   static bool RunCommandCapture(const std::vector<std::string> &arguments,
        std::string &output,
        std::string &errorMessage,
        CommandOutputCallback outputCallback     = nullptr,
-       const std::atomic<bool> *cancelRequested = nullptr);
+       const std::atomic<bool> *cancelRequested = nullptr,
+       std::size_t outputTailBytes              = 0,
+       std::ostream *outputLog                  = nullptr);
+
+ private:
    static int DecodeExitCode(int rawExitCode);
 
-   bool BuildAuthConfigArg(const std::string &repositoryUrl,
-       std::string &outConfigArg,
+   bool BuildAuthConfigArgs(const std::string &repositoryUrl,
+       std::vector<std::string> &outConfigArgs,
+       std::string &errorMessage) const;
+   bool TryUpdateExistingCheckout(const std::string &repositoryUrl,
+       const std::string &branchOrTag,
+       const std::string &targetDirectory,
+       const GitCloneOptions &options,
+       const std::vector<std::string> &authConfigArgs,
+       std::atomic<bool> &cancelRequested,
+       const CommandOutputCallback &outputCallback,
+       std::ostream *outputLog,
+       bool &outHasLocalChanges,
+       std::string &errorMessage) const;
+   bool ApplySparseCheckout(const std::string &targetDirectory,
+       const GitCloneOptions &options,
+       const std::vector<std::string> &authConfigArgs,
+       std::string &errorMessage) const;
+   // Creates the bare mirror if needed, fetches into it and points its HEAD
+   // at the remote's default branch, so that a clone without --branch checks
+   // that out. The caller holds the mirror's lock until it is done cloning
+   // from it.
+   bool UpdateMirror(const std::string &repositoryUrl,
+       const std::vector<std::string> &authConfigArgs,
+       const std::string &mirrorDirectory,
+       std::size_t outputTailBytes,
+       std::ostream *outputLog,
+       std::atomic<bool> &cancelRequested,
+       const CommandOutputCallback &outputCallback,
        std::string &errorMessage) const;
 
    AuthCredentials credentials_;
@@ -0,0 +1,178 @@
+#include "GitProgress.h"
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+namespace confy {
+
+namespace {
+
+bool TryParsePercent(std::string_view line, int &outPercent)
+{
+   for (std::size_t i = 0; i < line.size(); ++i) {
+      if (!std::isdigit(static_cast<unsigned char>(line[i]))) {
+         continue;
+      }
+
+      int value     = 0;
+      std::size_t j = i;
+      while (j < line.size() && std::isdigit(static_cast<unsigned char>(line[j]))) {
+         value = value * 10 + (line[j] - '0');
+         ++j;
+      }
+      if (j < line.size() && line[j] == '%') {
+         outPercent = value;
+         return true;
+      }
+      i = j;
+   }
+   return false;
+}
+
+void ReportMappedProgress(const GitClient::ProgressCallback &progress,
+    int stageMin,
+    int stageMax,
+    int stagePercent,
+    const std::string &message,
+    int &lastReportedPercent)
+{
+   if (!progress) {
+      return;
+   }
+
+   if (stagePercent < 0) {
+      stagePercent = 0;
+   }
+   if (stagePercent > 100) {
+      stagePercent = 100;
+   }
+
+   const int mapped = stageMin + ((stageMax - stageMin) * stagePercent) / 100;
+   if (mapped <= lastReportedPercent) {
+      return;
+   }
+
+   lastReportedPercent = mapped;
+   progress(mapped, message);
+}
+
+} // namespace
+
+void ProcessGitProgressLine(const std::string &line,
+    const GitClient::ProgressCallback &progress,
+    GitProgressState &state)
+{
+   if (state.submodulePhase) {
+      if (line.rfind("Submodule '", 0) == 0 && line.find("registered for path") != std::string::npos) {
+         ++state.submodulesRegistered;
+         return;
+      }
+      if (line.rfind("Submodule path '", 0) == 0 && line.find("': checked out") != std::string::npos) {
+         ++state.submodulesCompleted;
+         if (state.submodulesRegistered > 0) {
+            const int completed = std::min(state.submodulesCompleted, state.submodulesRegistered);
+            ReportMappedProgress(progress,
+                80,
+                99,
+                (completed * 100) / state.submodulesRegistered,
+                "Updating submodules (" + std::to_string(completed) + "/" +
+                    std::to_string(state.submodulesRegistered) + ")",
+                state.lastReportedPercent);
+         }
+         return;
+      }
+   }
+
+   struct Stage
+   {
+      const char *marker;
+      const char *message;
+      int cloneMin;
+      int cloneMax;
+      int submoduleMin;
+      int submoduleMax;
+   };
+   static constexpr Stage kStages[] = {
+       {"Counting objects:", "Counting objects", 10, 28, 80, 86},
+       {"Compressing objects:", "Compressing objects", 28, 44, 86, 90},
+       {"Receiving objects:", "Receiving objects", 44, 80, 90, 96},
+       {"Resolving deltas:", "Resolving deltas", 80, 94, 96, 99},
+       {"Checking out files:", "Checking out files", 94, 99, 99, 100},
+   };
+
+   for (const auto &stage : kStages) {
+      int stagePercent = 0;
+      if (line.find(stage.marker) == std::string::npos || !TryParsePercent(line, stagePercent)) {
+         continue;
+      }
+
+      if (!state.submodulePhase) {
+         ReportMappedProgress(progress,
+             stage.cloneMin,
+             stage.cloneMax,
+             stagePercent,
+             stage.message,
+             state.lastReportedPercent);
+      } else if (state.submodulesRegistered == 0) {
+         ReportMappedProgress(progress,
+             stage.submoduleMin,
+             stage.submoduleMax,
+             stagePercent,
+             stage.message,
+             state.lastReportedPercent);
+      } else {
+         // Advance within the slot of the next submodule to complete; lines
+         // from other submodules running in parallel can only move it forward.
+         const int total     = state.submodulesRegistered;
+         const int completed = std::min(state.submodulesCompleted, total - 1);
+         const int slotMin   = 80 + (19 * completed) / total;
+         const int slotMax   = 80 + (19 * (completed + 1)) / total;
+         const int withinSlot =
+             ((stage.submoduleMin - 80) * 100 + (stage.submoduleMax - stage.submoduleMin) * stagePercent) / 20;
+         ReportMappedProgress(progress, slotMin, slotMax, withinSlot, stage.message, state.lastReportedPercent);
+      }
+      return;
+   }
+}
+
+void PumpGitProgress(const GitClient::ProgressCallback &progress, std::string_view chunk, GitProgressState &state)
+{
+   if (!progress || chunk.empty()) {
+      return;
+   }
+
+   std::string &partialLine = state.partialLine;
+   partialLine.append(chunk.data(), chunk.size());
+   std::size_t consumed = 0;
+
+   for (std::size_t i = 0; i < partialLine.size(); ++i) {
+      if (partialLine[i] != '\n' && partialLine[i] != '\r') {
+         continue;
+      }
+
+      const std::string line = partialLine.substr(consumed, i - consumed);
+      ProcessGitProgressLine(line, progress, state);
+
+      while (i + 1 < partialLine.size() &&
+             (partialLine[i + 1] == '\n' || partialLine[i + 1] == '\r')) {
+         ++i;
+      }
+      consumed = i + 1;
+   }
+
+   if (consumed > 0) {
+      partialLine.erase(0, consumed);
+   }
+}
+
+void FlushGitProgress(const GitClient::ProgressCallback &progress, GitProgressState &state)
+{
+   if (!state.partialLine.empty()) {
+      const std::string line = std::move(state.partialLine);
+      state.partialLine.clear();
+      ProcessGitProgressLine(line, progress, state);
+   }
+}
+
+} // namespace confy
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "GitClient.h"
+
+#include <string>
+#include <string_view>
+
+namespace confy {
+
+// Turns git's progress output into the single 0-100 percentage that
+// GitClient::CloneRepository reports. Only exposed for the tests; nothing
+// outside GitClient should need it.
+struct GitProgressState
+{
+   // Set once the superproject is checked out and `submodule update` runs.
+   bool submodulePhase{false};
+   int lastReportedPercent{0};
+   // Counted from `submodule update --init` output. With --jobs the per-stage
+   // lines of several submodules interleave, so submodule progress is driven by
+   // completed/registered instead of by whichever submodule printed last.
+   int submodulesRegistered{0};
+   int submodulesCompleted{0};
+   std::string partialLine;
+};
+
+// Handles one complete line. Reported percentages never go backwards.
+void ProcessGitProgressLine(const std::string &line,
+    const GitClient::ProgressCallback &progress,
+    GitProgressState &state);
+// Splits a chunk of raw output into lines at `\n` and at the `\r` git
+// uses to redraw a progress line, keeping an unfinished line for the next
+// chunk.
+void PumpGitProgress(const GitClient::ProgressCallback &progress, std::string_view chunk, GitProgressState &state);
+// Handles the unfinished line left when the output ends.
+void FlushGitProgress(const GitClient::ProgressCallback &progress, GitProgressState &state);
+
+} // namespace confy
@@ -0,0 +1,260 @@
+#include "HttpTimings.h"
+
+#include "FormatUtils.h"
+#include "UrlUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+namespace confy {
+
+namespace {
+
+constexpr double kSmallestBound = 1e-6;
+constexpr double kBucketGrowth  = 1.1;
+
+struct Registry
+{
+   std::mutex mutex;
+   std::map<std::string, HttpHostTimings> hosts;
+};
+
+Registry &GetRegistry()
+{
+   static Registry registry;
+   return registry;
+}
+
+double Seconds(CURL *curl, CURLINFO info)
+{
+   curl_off_t microseconds = 0;
+   if (curl_easy_getinfo(curl, info, &microseconds) != CURLE_OK || microseconds < 0) {
+      return 0.0;
+   }
+   return static_cast<double>(microseconds) / 1e6;
+}
+
+void AppendRow(std::string &out, const char *label, const LatencyHistogram &histogram, double scale)
+{
+   char line[160];
+   if (histogram.Count() == 0) {
+      std::snprintf(line, sizeof(line), "  %-16s %10s\n", label, "-");
+   } else {
+      std::snprintf(line,
+          sizeof(line),
+          "  %-16s %10.1f %10.1f %10.1f %10.1f %8llu\n",
+          label,
+          histogram.Percentile(0.50) * scale,
+          histogram.Percentile(0.95) * scale,
+          histogram.Percentile(0.99) * scale,
+          histogram.Max() * scale,
+          static_cast<unsigned long long>(histogram.Count()));
+   }
+   out += line;
+}
+
+} // namespace
+
+void LatencyHistogram::Add(double value)
+{
+   if (!(value >= 0.0)) {
+      return;
+   }
+   ++count_;
+   sum_ += value;
+   max_ = std::max(max_, value);
+   if (value == 0.0) {
+      ++zeros_;
+   } else {
+      ++buckets_[BucketOf(value)];
+   }
+}
+
+double LatencyHistogram::Percentile(double fraction) const
+{
+   if (count_ == 0) {
+      return 0.0;
+   }
+   const auto clamped = std::min(std::max(fraction, 0.0), 1.0);
+   const auto rank    = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(clamped * count_)));
+   std::uint64_t seen = zeros_;
+   if (seen >= rank) {
+      return 0.0;
+   }
+   for (std::size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+      seen += buckets_[bucket];
+      if (seen >= rank) {
+         return std::min(UpperBoundOf(bucket), max_);
+      }
+   }
+   return max_;
+}
+
+std::size_t LatencyHistogram::BucketOf(double value)
+{
+   if (value <= kSmallestBound) {
+      return 0;
+   }
+   const auto bucket = std::ceil(std::log(value / kSmallestBound) / std::log(kBucketGrowth));
+   return std::min(static_cast<std::size_t>(bucket), kBucketCount - 1);
+}
+
+double LatencyHistogram::UpperBoundOf(std::size_t bucket)
+{
+   return kSmallestBound * std::pow(kBucketGrowth, static_cast<double>(bucket));
+}
+
+void HttpTimings::Record(const HttpRequestTiming &timing)
+{
+   auto &registry = GetRegistry();
+   std::lock_guard<std::mutex> lock(registry.mutex);
+   auto &host = registry.hosts[timing.host];
+   host.host  = timing.host;
+   ++host.requests;
+   if (timing.failed) {
+      ++host.failures;
+   }
+   host.downloadBytes += timing.downloadBytes;
+   host.nameLookup.Add(timing.nameLookupSeconds);
+   host.connect.Add(timing.connectSeconds);
+   host.tls.Add(timing.tlsSeconds);
+   host.firstByte.Add(timing.firstByteSeconds);
+   host.total.Add(timing.totalSeconds);
+   if (timing.downloadBytes > 0) {
+      host.bytesPerSecond.Add(timing.bytesPerSecond);
+   }
+}
+
+void HttpTimings::RecordTransfer(LogModule module, CURL *curl, CURLcode result)
+{
+   // libcurl reports each phase as the time from the start of the request
+   // until the phase ended; the differences are what each phase took.
+   const auto nameLookup    = Seconds(curl, CURLINFO_NAMELOOKUP_TIME_T);
+   const auto connect       = Seconds(curl, CURLINFO_CONNECT_TIME_T);
+   const auto appConnect    = Seconds(curl, CURLINFO_APPCONNECT_TIME_T);
+   const auto startTransfer = Seconds(curl, CURLINFO_STARTTRANSFER_TIME_T);
+   const auto connected     = std::max(connect, appConnect);
+
+   HttpRequestTiming timing;
+   char *effectiveUrl = nullptr;
+   if (curl_easy_getinfo(curl, CURLINFO_EFFECTIVE_URL, &effectiveUrl) == CURLE_OK && effectiveUrl) {
+      timing.host = UrlHost(effectiveUrl);
+   }
+   timing.nameLookupSeconds = nameLookup;
+   timing.connectSeconds    = std::max(connect - nameLookup, 0.0);
+   timing.tlsSeconds        = appConnect > 0.0 ? std::max(appConnect - connect, 0.0) : 0.0;
+   timing.firstByteSeconds  = startTransfer > 0.0 ? std::max(startTransfer - connected, 0.0) : 0.0;
+   timing.totalSeconds      = Seconds(curl, CURLINFO_TOTAL_TIME_T);
+   timing.failed            = result != CURLE_OK;
+
+   curl_off_t downloadBytes = 0;
+   curl_off_t speed         = 0;
+   curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &downloadBytes);
+   curl_easy_getinfo(curl, CURLINFO_SPEED_DOWNLOAD_T, &speed);
+   timing.downloadBytes  = static_cast<std::uint64_t>(std::max<curl_off_t>(downloadBytes, 0));
+   timing.bytesPerSecond = static_cast<double>(std::max<curl_off_t>(speed, 0));
+
+   CONFY_LOG(module, LogLevel::Debug,
+       "http timing host='%s' dns_ms=%.1f connect_ms=%.1f tls_ms=%.1f first_byte_ms=%.1f total_ms=%.1f bytes=%llu "
+       "kib_per_s=%.1f result=%d",
+       timing.host.c_str(),
+       timing.nameLookupSeconds * 1000.0,
+       timing.connectSeconds * 1000.0,
+       timing.tlsSeconds * 1000.0,
+       timing.firstByteSeconds * 1000.0,
+       timing.totalSeconds * 1000.0,
+       static_cast<unsigned long long>(timing.downloadBytes),
+       timing.bytesPerSecond / 1024.0,
+       static_cast<int>(result));
+   Record(timing);
+}
+
+std::vector<HttpHostTimings> HttpTimings::Snapshot()
+{
+   auto &registry = GetRegistry();
+   std::lock_guard<std::mutex> lock(registry.mutex);
+   std::vector<HttpHostTimings> hosts;
+   hosts.reserve(registry.hosts.size());
+   for (const auto &entry : registry.hosts) {
+      hosts.push_back(entry.second);
+   }
+   return hosts;
+}
+
+void HttpTimings::Reset()
+{
+   auto &registry = GetRegistry();
+   std::lock_guard<std::mutex> lock(registry.mutex);
+   registry.hosts.clear();
+}
+
+std::string HttpTimings::BuildReport(const std::vector<HttpHostTimings> &hosts)
+{
+   std::string out;
+   for (const auto &host : hosts) {
+      char heading[256];
+      std::snprintf(heading,
+          sizeof(heading),
+          "%s: %llu request(s), %llu failed, %s downloaded\n",
+          host.host.empty() ? "<unknown host>" : host.host.c_str(),
+          static_cast<unsigned long long>(host.requests),
+          static_cast<unsigned long long>(host.failures),
+          FormatBytes(host.downloadBytes).c_str());
+      if (!out.empty()) {
+         out += '\n';
+      }
+      out += heading;
+      char columns[160];
+      std::snprintf(columns, sizeof(columns), "  %-16s %10s %10s %10s %10s %8s\n", "", "p50", "p95", "p99", "max", "count");
+      out += columns;
+      AppendRow(out, "dns ms", host.nameLookup, 1000.0);
+      AppendRow(out, "connect ms", host.connect, 1000.0);
+      AppendRow(out, "tls ms", host.tls, 1000.0);
+      AppendRow(out, "first byte ms", host.firstByte, 1000.0);
+      AppendRow(out, "total ms", host.total, 1000.0);
+      AppendRow(out, "download KiB/s", host.bytesPerSecond, 1.0 / 1024.0);
+   }
+   return out;
+}
+
+void HttpTimings::LogReport()
+{
+   const auto report = BuildReport();
+   if (report.empty()) {
+      CONFY_LOG(LogModule::General, LogLevel::Info, "http timings: no requests recorded");
+      return;
+   }
+   CONFY_LOG(LogModule::General, LogLevel::Info, "http timings per host:");
+   std::size_t start = 0;
+   while (start < report.size()) {
+      const auto end  = report.find('\n', start);
+      const auto line = report.substr(start, end - start);
+      if (!line.empty()) {
+         CONFY_LOG(LogModule::General, LogLevel::Info, "%s", line.c_str());
+      }
+      start = end == std::string::npos ? report.size() : end + 1;
+   }
+}
+
+bool HttpTimings::WriteReport(const std::string &filePath, std::string &errorMessage)
+{
+   const auto parent = std::filesystem::path(filePath).parent_path();
+   if (!parent.empty()) {
+      std::error_code fsError;
+      std::filesystem::create_directories(parent, fsError);
+   }
+   std::ofstream output(filePath, std::ios::binary | std::ios::trunc);
+   output << BuildReport();
+   if (!output.good()) {
+      errorMessage = "Unable to write " + filePath;
+      return false;
+   }
+   return true;
+}
+
+} // namespace confy
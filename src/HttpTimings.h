@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Log.h"
+
+#include <curl/curl.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace confy {
+
+// One finished HTTP request, split into the phases libcurl measures. All
+// durations are in seconds. Connection setup phases are 0 when libcurl
+// reused a connection, and tlsSeconds is 0 for plain HTTP.
+struct HttpRequestTiming
+{
+   std::string host;
+   double nameLookupSeconds{0.0};
+   double connectSeconds{0.0};
+   double tlsSeconds{0.0};
+   // From the end of connection setup to the first response byte, i.e.
+   // mostly server time.
+   double firstByteSeconds{0.0};
+   double totalSeconds{0.0};
+   std::uint64_t downloadBytes{0};
+   double bytesPerSecond{0.0};
+   bool failed{false};
+};
+
+// Histogram of non-negative values with log-scale buckets, each 10% wider
+// than the previous one, from 1e-6 to beyond 1e11. Percentiles are accurate
+// to a bucket's width whatever the spread of the values, so seconds and
+// bytes per second share the type. Not thread-safe.
+class LatencyHistogram final
+{
+ public:
+   void Add(double value);
+
+   std::uint64_t Count() const { return count_; }
+   double Max() const { return max_; }
+   double Mean() const { return count_ == 0 ? 0.0 : sum_ / static_cast<double>(count_); }
+   // fraction in [0, 1], e.g. 0.95 for p95. Returns the upper bound of the
+   // bucket holding that rank, capped at the largest value seen; 0 when
+   // empty.
+   double Percentile(double fraction) const;
+
+ private:
+   static constexpr std::size_t kBucketCount = 440;
+
+   static std::size_t BucketOf(double value);
+   static double UpperBoundOf(std::size_t bucket);
+
+   std::array<std::uint64_t, kBucketCount> buckets_{};
+   // Exact zeros, e.g. the DNS time of a reused connection.
+   std::uint64_t zeros_{0};
+   std::uint64_t count_{0};
+   double sum_{0.0};
+   double max_{0.0};
+};
+
+struct HttpHostTimings
+{
+   std::string host;
+   std::uint64_t requests{0};
+   std::uint64_t failures{0};
+   std::uint64_t downloadBytes{0};
+   LatencyHistogram nameLookup;
+   LatencyHistogram connect;
+   LatencyHistogram tls;
+   LatencyHistogram firstByte;
+   LatencyHistogram total;
+   // Only requests that downloaded a body.
+   LatencyHistogram bytesPerSecond;
+};
+
+// Process-wide per-host aggregation of every request NexusClient and
+// BitbucketClient make, for telling DNS, connection setup, TLS, server
+// time and bandwidth apart when downloads are slow. All methods are
+// thread-safe.
+class HttpTimings final
+{
+ public:
+   static void Record(const HttpRequestTiming &timing);
+   // Reads the timing of a request curl_easy_perform just finished, logs it
+   // at debug level under module and records it. Call before
+   // curl_easy_cleanup.
+   static void RecordTransfer(LogModule module, CURL *curl, CURLcode result);
+
+   // Sorted by host.
+   static std::vector<HttpHostTimings> Snapshot();
+   static void Reset();
+
+   // One block per host with count, p50, p95, p99 and max of each phase.
+   // Empty when nothing was recorded.
+   static std::string BuildReport(const std::vector<HttpHostTimings> &hosts);
+   static std::string BuildReport() { return BuildReport(Snapshot()); }
+   // Logs BuildReport() line by line at info level under General, so it is
+   // dropped when that module logs only warnings.
+   static void LogReport();
+   // Writes BuildReport() to filePath, replacing it.
+   static bool WriteReport(const std::string &filePath, std::string &errorMessage);
+};
+
+} // namespace confy
@@ -33,6 +33,13 @@ struct GitCloneJob
    std::string targetDirectory;
    std::string postDownloadScript;
    bool shallow{true};
+   std::string mirrorCacheDirectory;
+   bool refuseDirtyReclone{false};
+   std::string filter;
+   std::vector<std::string> sparsePaths;
+   int parallelJobs{0};
+   std::size_t outputTailBytes{0};
+   std::string logDirectory;
 };
 
 enum class DownloadJobKind
@@ -72,6 +79,16 @@ struct DownloadJob
    {
       return kind == DownloadJobKind::NexusArtifact ? artifact.componentIndex : source.componentIndex;
    }
+
+   // What the job fetches, for display: the branch or tag of a source job,
+   // "version/buildType" (or just the version) of an artifact job.
+   std::string Target() const
+   {
+      if (kind == DownloadJobKind::GitSource) {
+         return source.branchOrTag;
+      }
+      return artifact.buildType.empty() ? artifact.version : artifact.version + "/" + artifact.buildType;
+   }
 };
 
 enum class DownloadEventType
@@ -84,6 +101,26 @@ enum class DownloadEventType
    Cancelled,
 };
 
+// Lower-case event name used by the event stream and `confy sync` output.
+inline const char *DownloadEventTypeName(DownloadEventType type)
+{
+   switch (type) {
+      case DownloadEventType::Started:
+         return "started";
+      case DownloadEventType::Progress:
+         return "progress";
+      case DownloadEventType::PostDownloadScriptRunning:
+         return "script";
+      case DownloadEventType::Completed:
+         return "completed";
+      case DownloadEventType::Failed:
+         return "failed";
+      case DownloadEventType::Cancelled:
+         return "cancelled";
+   }
+   return "unknown";
+}
+
 struct DownloadEvent
 {
    std::uint64_t jobId{0};
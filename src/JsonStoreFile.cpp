@@ -0,0 +1,121 @@
+#include "JsonStoreFile.h"
+
+#include <nlohmann/json.hpp>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+namespace confy {
+
+namespace {
+
+using Json = nlohmann::json;
+
+long CurrentProcessId()
+{
+#ifdef _WIN32
+   return static_cast<long>(_getpid());
+#else
+   return static_cast<long>(getpid());
+#endif
+}
+
+} // namespace
+
+JsonStoreFile::JsonStoreFile(std::string filePath, int formatVersion, std::string description) :
+    filePath_(std::move(filePath)),
+    formatVersion_(formatVersion),
+    description_(std::move(description)) {}
+
+bool JsonStoreFile::Read(const EntriesReader &readEntries, std::string &errorMessage) const
+{
+   std::ifstream input(filePath_, std::ios::binary);
+   if (!input) {
+      return true;
+   }
+
+   try {
+      const auto document = Json::parse(input);
+      if (document.value("version", 0) != formatVersion_) {
+         return true;
+      }
+      readEntries(document.at("entries"));
+   } catch (const std::exception &ex) {
+      errorMessage = "Failed to parse " + description_ + " '" + filePath_ + "': " + ex.what();
+      return false;
+   }
+   return true;
+}
+
+bool JsonStoreFile::Write(const Json &entries, std::uint64_t revision, std::string &errorMessage) const
+{
+   Json document;
+   document["version"]          = formatVersion_;
+   document["entries"]          = entries;
+   const std::string serialized = document.dump();
+
+   std::scoped_lock fileLock(fileMutex_);
+   const std::filesystem::path path(filePath_);
+   std::error_code fsError;
+   if (path.has_parent_path()) {
+      std::filesystem::create_directories(path.parent_path(), fsError);
+   }
+
+   const std::filesystem::path temporaryPath = path.string() + "." + std::to_string(CurrentProcessId()) + ".tmp";
+   {
+      std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+      if (!output) {
+         errorMessage = "Could not open " + description_ + " for writing: " + temporaryPath.string();
+         return false;
+      }
+      output << serialized;
+      if (!output.good()) {
+         errorMessage = "Failed to write " + description_ + ": " + temporaryPath.string();
+         return false;
+      }
+   }
+
+   std::filesystem::rename(temporaryPath, path, fsError);
+   if (fsError) {
+      errorMessage = "Failed to replace " + description_ + " '" + filePath_ + "': " + fsError.message();
+      std::filesystem::remove(temporaryPath, fsError);
+      return false;
+   }
+
+   MarkSaved(revision);
+   return true;
+}
+
+void JsonStoreFile::MarkChanged()
+{
+   std::scoped_lock lock(revisionMutex_);
+   ++revision_;
+}
+
+std::uint64_t JsonStoreFile::Revision() const
+{
+   std::scoped_lock lock(revisionMutex_);
+   return revision_;
+}
+
+void JsonStoreFile::MarkSaved(std::uint64_t revision) const
+{
+   std::scoped_lock lock(revisionMutex_);
+   savedRevision_ = std::max(savedRevision_, revision);
+}
+
+bool JsonStoreFile::IsModified() const
+{
+   std::scoped_lock lock(revisionMutex_);
+   return revision_ != savedRevision_;
+}
+
+} // namespace confy
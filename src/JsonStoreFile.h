@@ -0,0 +1,53 @@
+#pragma once
+
+#include <nlohmann/json_fwd.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace confy {
+
+// The file behind a small persistent store such as MetadataCache or
+// TransferHistory: a JSON document {"version": N, "entries": {...}} that is
+// replaced atomically, and a revision count that tells whether the store
+// changed since it was last loaded or saved. All methods are thread-safe.
+class JsonStoreFile final
+{
+ public:
+   using EntriesReader = std::function<void(const nlohmann::json &entries)>;
+
+   // description names the store in error messages, e.g. "metadata cache".
+   JsonStoreFile(std::string filePath, int formatVersion, std::string description);
+
+   // Passes the file's "entries" object to readEntries. A missing file or
+   // one of another format version is not an error and reads nothing. An
+   // exception thrown by readEntries fails the read like a parse error.
+   bool Read(const EntriesReader &readEntries, std::string &errorMessage) const;
+   // Writes the document to a temporary file named after the process id, so
+   // that two processes saving the same store do not share it, and renames
+   // it over the file, so that readers never see a partial write. On success
+   // revision is marked saved.
+   bool Write(const nlohmann::json &entries, std::uint64_t revision, std::string &errorMessage) const;
+
+   // The owner calls MarkChanged for every change and reads Revision while
+   // taking the snapshot it writes, both under its own lock, so that changes
+   // made during a Write, or lost to a failed one, stay unsaved.
+   void MarkChanged();
+   std::uint64_t Revision() const;
+   // After Read, to mark the loaded entries as matching the file.
+   void MarkSaved(std::uint64_t revision) const;
+   bool IsModified() const;
+
+ private:
+   std::string filePath_;
+   int formatVersion_;
+   std::string description_;
+   mutable std::mutex fileMutex_;
+   mutable std::mutex revisionMutex_;
+   std::uint64_t revision_{0};
+   mutable std::uint64_t savedRevision_{0};
+};
+
+} // namespace confy
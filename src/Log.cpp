@@ -0,0 +1,459 @@
+#include "Log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace confy {
+
+std::atomic<int> Log::levels_[kLogModuleCount] = {static_cast<int>(LogLevel::Info),
+    static_cast<int>(LogLevel::Info),
+    static_cast<int>(LogLevel::Info),
+    static_cast<int>(LogLevel::Info),
+    static_cast<int>(LogLevel::Info),
+    static_cast<int>(LogLevel::Info),
+    static_cast<int>(LogLevel::Info)};
+
+namespace {
+
+constexpr const char *kModuleNames[kLogModuleCount] =
+    {"general", "download-worker", "nexus", "git", "bitbucket", "metadata", "refs"};
+constexpr const char *kLevelNames[] = {"trace", "debug", "info", "warning", "error", "off"};
+// Upper bound for how long a record can wait when its wake-up was missed.
+constexpr auto kWriterPollInterval = std::chrono::milliseconds(50);
+
+struct LogRecord
+{
+   LogLevel level{LogLevel::Info};
+   LogModule module{LogModule::General};
+   std::chrono::system_clock::time_point time;
+   std::string message;
+};
+
+// Multi-producer single-consumer queue (Vyukov): producers only exchange the
+// head pointer, so logging threads never block on each other or the writer.
+class LogQueue final
+{
+ public:
+   LogQueue() : head_(&stub_), tail_(&stub_) {}
+
+   ~LogQueue()
+   {
+      LogRecord record;
+      while (Pop(record)) {
+      }
+      if (tail_ != &stub_) {
+         delete tail_;
+      }
+   }
+
+   void Push(LogRecord record)
+   {
+      auto *node   = new Node;
+      node->record = std::move(record);
+      auto *prev   = head_.exchange(node, std::memory_order_acq_rel);
+      prev->next.store(node, std::memory_order_release);
+   }
+
+   // Consumer side only.
+   bool Pop(LogRecord &outRecord)
+   {
+      auto *tail = tail_;
+      auto *next = tail->next.load(std::memory_order_acquire);
+      if (next == nullptr) {
+         return false;
+      }
+      outRecord = std::move(next->record);
+      tail_     = next;
+      if (tail != &stub_) {
+         delete tail;
+      }
+      return true;
+   }
+
+ private:
+   struct Node
+   {
+      std::atomic<Node *> next{nullptr};
+      LogRecord record;
+   };
+
+   Node stub_;
+   std::atomic<Node *> head_;
+   Node *tail_;
+};
+
+std::string FormatTimestamp(std::chrono::system_clock::time_point time)
+{
+   const auto seconds = std::chrono::system_clock::to_time_t(time);
+   const auto millis =
+       std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000;
+   std::tm localTime{};
+#ifdef _WIN32
+   localtime_s(&localTime, &seconds);
+#else
+   localtime_r(&seconds, &localTime);
+#endif
+   char buffer[32]{};
+   const auto length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &localTime);
+   std::snprintf(buffer + length, sizeof(buffer) - length, ".%03d", static_cast<int>(millis));
+   return buffer;
+}
+
+class LogWriter final
+{
+ public:
+   ~LogWriter()
+   {
+      {
+         std::scoped_lock lock(mutex_);
+         stop_ = true;
+      }
+      wakeCv_.notify_all();
+      if (thread_.joinable()) {
+         thread_.join();
+      }
+   }
+
+   void Push(LogRecord record)
+   {
+      std::call_once(started_, [this]() { thread_ = std::thread(&LogWriter::Run, this); });
+      pushed_.fetch_add(1, std::memory_order_relaxed);
+      queue_.Push(std::move(record));
+      if (!wakeRequested_.exchange(true, std::memory_order_acq_rel)) {
+         wakeCv_.notify_one();
+      }
+   }
+
+   void Flush()
+   {
+      const auto target = pushed_.load();
+      std::unique_lock lock(mutex_);
+      wakeRequested_ = true;
+      wakeCv_.notify_one();
+      flushedCv_.wait(lock, [this, target]() { return written_ >= target; });
+   }
+
+   void SetSink(Log::Sink sink)
+   {
+      std::scoped_lock lock(outputMutex_);
+      sink_ = std::move(sink);
+   }
+
+   bool OpenFile(const std::string &filePath, std::uintmax_t maxBytes, std::size_t maxFiles, std::string &errorMessage)
+   {
+      std::scoped_lock lock(outputMutex_);
+      file_.close();
+      file_.clear();
+      std::error_code ec;
+      const auto parent = std::filesystem::path(filePath).parent_path();
+      if (!parent.empty()) {
+         std::filesystem::create_directories(parent, ec);
+      }
+      file_.open(filePath, std::ios::binary | std::ios::app);
+      if (!file_) {
+         errorMessage = "Failed to open log file: " + filePath;
+         return false;
+      }
+      filePath_ = filePath;
+      maxBytes_ = maxBytes;
+      maxFiles_ = maxFiles;
+      fileSize_ = std::filesystem::file_size(filePath, ec);
+      if (ec) {
+         fileSize_ = 0;
+      }
+      return true;
+   }
+
+   void CloseFile()
+   {
+      std::scoped_lock lock(outputMutex_);
+      file_.close();
+      filePath_.clear();
+   }
+
+ private:
+   void Run()
+   {
+      std::vector<LogRecord> batch;
+      while (true) {
+         LogRecord record;
+         while (queue_.Pop(record)) {
+            batch.push_back(std::move(record));
+         }
+         if (!batch.empty()) {
+            WriteBatch(batch);
+            {
+               std::scoped_lock lock(mutex_);
+               written_ += batch.size();
+            }
+            flushedCv_.notify_all();
+            batch.clear();
+         }
+
+         std::unique_lock lock(mutex_);
+         if (stop_) {
+            // Records pushed after the last drain still get written.
+            lock.unlock();
+            while (queue_.Pop(record)) {
+               batch.push_back(std::move(record));
+            }
+            WriteBatch(batch);
+            return;
+         }
+         wakeCv_.wait_for(lock, kWriterPollInterval, [this]() { return stop_ || wakeRequested_.load(); });
+         wakeRequested_ = false;
+      }
+   }
+
+   void WriteBatch(const std::vector<LogRecord> &batch)
+   {
+      std::scoped_lock lock(outputMutex_);
+      for (const auto &record : batch) {
+         if (sink_) {
+            sink_(record.level, record.module, record.message);
+         } else {
+            std::fprintf(stderr,
+                "[%s][%s] %s\n",
+                Log::ModuleName(record.module),
+                Log::LevelName(record.level),
+                record.message.c_str());
+         }
+         if (file_.is_open()) {
+            WriteToFile(record);
+         }
+      }
+      if (file_.is_open()) {
+         file_.flush();
+      }
+   }
+
+   void WriteToFile(const LogRecord &record)
+   {
+      std::string line = FormatTimestamp(record.time);
+      line += ' ';
+      line += Log::LevelName(record.level);
+      line += " [";
+      line += Log::ModuleName(record.module);
+      line += "] ";
+      line += record.message;
+      line += '\n';
+
+      if (maxBytes_ > 0 && fileSize_ > 0 && fileSize_ + line.size() > maxBytes_) {
+         RotateFile();
+      }
+      file_.write(line.data(), static_cast<std::streamsize>(line.size()));
+      fileSize_ += line.size();
+   }
+
+   void RotateFile()
+   {
+      file_.close();
+      std::error_code ec;
+      if (maxFiles_ == 0) {
+         std::filesystem::remove(filePath_, ec);
+      } else {
+         std::filesystem::remove(filePath_ + "." + std::to_string(maxFiles_), ec);
+         for (auto index = maxFiles_; index > 1; --index) {
+            std::filesystem::rename(
+                filePath_ + "." + std::to_string(index - 1), filePath_ + "." + std::to_string(index), ec);
+         }
+         std::filesystem::rename(filePath_, filePath_ + ".1", ec);
+      }
+      file_.clear();
+      file_.open(filePath_, std::ios::binary | std::ios::trunc);
+      fileSize_ = 0;
+   }
+
+   LogQueue queue_;
+   std::once_flag started_;
+   std::thread thread_;
+   std::atomic<bool> wakeRequested_{false};
+   std::atomic<std::uint64_t> pushed_{0};
+
+   // Guards stop_ and written_; wakeCv_ and flushedCv_ wait on it.
+   std::mutex mutex_;
+   std::condition_variable wakeCv_;
+   std::condition_variable flushedCv_;
+   bool stop_{false};
+   std::uint64_t written_{0};
+
+   // Guards the outputs, which only the writer thread uses otherwise.
+   std::mutex outputMutex_;
+   Log::Sink sink_;
+   std::ofstream file_;
+   std::string filePath_;
+   std::uintmax_t maxBytes_{0};
+   std::size_t maxFiles_{0};
+   std::uintmax_t fileSize_{0};
+};
+
+LogWriter &Writer()
+{
+   static LogWriter writer;
+   return writer;
+}
+
+std::string ToLower(std::string value)
+{
+   std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) {
+      return static_cast<char>(std::tolower(c));
+   });
+   return value;
+}
+
+std::string Trim(const std::string &value)
+{
+   const auto first = value.find_first_not_of(" \t");
+   if (first == std::string::npos) {
+      return "";
+   }
+   const auto last = value.find_last_not_of(" \t");
+   return value.substr(first, last - first + 1);
+}
+
+bool ParseLevel(const std::string &text, LogLevel &outLevel)
+{
+   const auto name = ToLower(Trim(text));
+   for (std::size_t i = 0; i < std::size(kLevelNames); ++i) {
+      if (name == kLevelNames[i]) {
+         outLevel = static_cast<LogLevel>(i);
+         return true;
+      }
+   }
+   // Accept the short form printed by the default sink.
+   if (name == "warn") {
+      outLevel = LogLevel::Warning;
+      return true;
+   }
+   return false;
+}
+
+} // namespace
+
+void Log::Write(LogModule module, LogLevel level, const char *format, ...)
+{
+   LogRecord record;
+   record.level  = level;
+   record.module = module;
+   record.time   = std::chrono::system_clock::now();
+
+   char buffer[512];
+   va_list args;
+   va_start(args, format);
+   va_list argsCopy;
+   va_copy(argsCopy, args);
+   const int length = std::vsnprintf(buffer, sizeof(buffer), format, args);
+   va_end(args);
+   if (length >= 0 && static_cast<std::size_t>(length) < sizeof(buffer)) {
+      record.message.assign(buffer, static_cast<std::size_t>(length));
+   } else if (length >= 0) {
+      record.message.resize(static_cast<std::size_t>(length) + 1);
+      std::vsnprintf(record.message.data(), record.message.size(), format, argsCopy);
+      record.message.resize(static_cast<std::size_t>(length));
+   }
+   va_end(argsCopy);
+
+   Writer().Push(std::move(record));
+}
+
+void Log::SetLevel(LogLevel level)
+{
+   for (auto &moduleLevel : levels_) {
+      moduleLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+   }
+}
+
+void Log::SetLevel(LogModule module, LogLevel level)
+{
+   levels_[static_cast<std::size_t>(module)].store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+bool Log::Configure(const std::string &spec, std::string &errorMessage)
+{
+   // Parse everything first so a bad spec leaves the levels untouched.
+   std::vector<std::pair<int, LogLevel>> assignments;
+   std::size_t start = 0;
+   while (start <= spec.size()) {
+      auto end = spec.find(',', start);
+      if (end == std::string::npos) {
+         end = spec.size();
+      }
+      const auto item = Trim(spec.substr(start, end - start));
+      start           = end + 1;
+      if (item.empty()) {
+         continue;
+      }
+
+      const auto equals = item.find('=');
+      LogLevel level    = LogLevel::Info;
+      if (!ParseLevel(equals == std::string::npos ? item : item.substr(equals + 1), level)) {
+         errorMessage = "Unknown log level in '" + item + "'";
+         return false;
+      }
+      if (equals == std::string::npos) {
+         assignments.emplace_back(-1, level);
+         continue;
+      }
+
+      const auto moduleName = ToLower(Trim(item.substr(0, equals)));
+      const auto found      = std::find(std::begin(kModuleNames), std::end(kModuleNames), moduleName);
+      if (found == std::end(kModuleNames)) {
+         errorMessage = "Unknown log module '" + moduleName + "'";
+         return false;
+      }
+      assignments.emplace_back(static_cast<int>(found - std::begin(kModuleNames)), level);
+   }
+
+   for (const auto &[module, level] : assignments) {
+      if (module < 0) {
+         SetLevel(level);
+      } else {
+         SetLevel(static_cast<LogModule>(module), level);
+      }
+   }
+   return true;
+}
+
+void Log::SetSink(Sink sink)
+{
+   Writer().SetSink(std::move(sink));
+}
+
+bool Log::OpenFile(const std::string &filePath, std::uintmax_t maxBytes, std::size_t maxFiles, std::string &errorMessage)
+{
+   return Writer().OpenFile(filePath, maxBytes, maxFiles, errorMessage);
+}
+
+void Log::CloseFile()
+{
+   Writer().CloseFile();
+}
+
+void Log::Flush()
+{
+   Writer().Flush();
+}
+
+const char *Log::ModuleName(LogModule module)
+{
+   return kModuleNames[static_cast<std::size_t>(module)];
+}
+
+const char *Log::LevelName(LogLevel level)
+{
+   return kLevelNames[static_cast<std::size_t>(level)];
+}
+
+} // namespace confy
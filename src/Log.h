@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CONFY_PRINTF_FORMAT(formatIndex, firstArgIndex) __attribute__((format(printf, formatIndex, firstArgIndex)))
+#else
+#define CONFY_PRINTF_FORMAT(formatIndex, firstArgIndex)
+#endif
+
+namespace confy {
+
+enum class LogLevel
+{
+   Trace,
+   Debug,
+   Info,
+   Warning,
+   Error,
+   Off
+};
+
+// One entry per subsystem; the name doubles as the "[tag]" of each line.
+enum class LogModule
+{
+   General,
+   DownloadWorker,
+   Nexus,
+   Git,
+   Bitbucket,
+   Metadata,
+   Refs
+};
+constexpr std::size_t kLogModuleCount = 7;
+
+// Leveled, asynchronous logging. Callers go through CONFY_LOG, which checks
+// the module's level before any argument is formatted. Enabled records are
+// formatted on the calling thread, pushed onto a lock-free queue and written
+// by a background thread to the sink (stderr unless replaced) and, when
+// opened, a size-rotated log file.
+class Log final
+{
+ public:
+   using Sink = std::function<void(LogLevel level, LogModule module, const std::string &message)>;
+
+   static bool IsEnabled(LogModule module, LogLevel level)
+   {
+      return static_cast<int>(level) >= levels_[static_cast<std::size_t>(module)].load(std::memory_order_relaxed);
+   }
+
+   static void Write(LogModule module, LogLevel level, const char *format, ...) CONFY_PRINTF_FORMAT(3, 4);
+
+   static void SetLevel(LogLevel level);
+   static void SetLevel(LogModule module, LogLevel level);
+   // Applies a spec such as "info,nexus=debug,download-worker=warning": a
+   // bare level applies to every module, module=level overrides one.
+   static bool Configure(const std::string &spec, std::string &errorMessage);
+
+   // Records are passed to the sink on the writer thread; an empty sink
+   // restores the stderr default.
+   static void SetSink(Sink sink);
+   // Appends to filePath. Once it exceeds maxBytes it is renamed to
+   // filePath.1 (older files shift up, keeping maxFiles of them) and a new
+   // file is started. maxBytes == 0 disables rotation.
+   static bool OpenFile(const std::string &filePath,
+       std::uintmax_t maxBytes,
+       std::size_t maxFiles,
+       std::string &errorMessage);
+   static void CloseFile();
+   // Blocks until every record written before the call has been handled.
+   static void Flush();
+
+   static const char *ModuleName(LogModule module);
+   static const char *LevelName(LogLevel level);
+
+ private:
+   static std::atomic<int> levels_[kLogModuleCount];
+};
+
+} // namespace confy
+
+#define CONFY_LOG(module, level, ...)                                                                                  \
+   do {                                                                                                                \
+      if (::confy::Log::IsEnabled((module), (level))) {                                                                \
+         ::confy::Log::Write((module), (level), __VA_ARGS__);                                                          \
+      }                                                                                                                \
+   } while (false)
@@ -2,37 +2,51 @@
 
 #include "AppInfo.h"
 #include "AppSettings.h"
+#include "ApplyPlanner.h"
 #include "AuthCredentials.h"
 #include "ConfigLoader.h"
 #include "ConfigWriter.h"
 #include "DebugConsole.h"
+#include "DownloadJobBuilder.h"
 #include "DownloadProgressDialog.h"
 #include "GitClient.h"
+#include "HttpTimings.h"
+#include "Log.h"
+#include "MetadataCache.h"
 #include "NexusClient.h"
+#include "RefListingService.h"
+#include "TransferHistory.h"
 
 #include <wx/app.h>
+#include <wx/arrstr.h>
 #include <wx/button.h>
 #include <wx/checkbox.h>
 #include <wx/clipbrd.h>
 #include <wx/combobox.h>
 #include <wx/dataobj.h>
+#include <wx/dialog.h>
 #include <wx/filedlg.h>
 #include <wx/filename.h>
+#include <wx/font.h>
 #include <wx/log.h>
 #include <wx/menu.h>
 #include <wx/msgdlg.h>
 #include <wx/panel.h>
-#include <wx/scrolwin.h>
+#include <wx/scrolbar.h>
 #include <wx/sizer.h>
 #include <wx/statbox.h>
 #include <wx/stattext.h>
 #include <wx/stdpaths.h>
+#include <wx/textctrl.h>
+#include <wx/timer.h>
 #include <wx/utils.h>
 
 #include <algorithm>
-#include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <map>
 #include <thread>
+#include <unordered_set>
 
 namespace {
 
@@ -43,8 +57,21 @@ constexpr int kIdViewDebugConsole = wxID_HIGHEST + 4;
 constexpr int kIdCloseConfig      = wxID_HIGHEST + 5;
 constexpr int kIdSaveAs           = wxID_HIGHEST + 6;
 constexpr int kIdCopyConfig       = wxID_HIGHEST + 7;
+constexpr int kIdRefSearchTimer   = wxID_HIGHEST + 8;
+constexpr int kIdUiUpdateTimer    = wxID_HIGHEST + 9;
+constexpr int kIdPlanApply        = wxID_HIGHEST + 10;
 constexpr int kSectionLabelWidth  = 64;
 constexpr int kFieldLabelWidth    = 72;
+constexpr int kRowSpacing         = 6;
+// Longer ref lists are not loaded into a combo in full; the user narrows
+// them down by typing, one page of matches at a time.
+constexpr std::size_t kMaxComboRefs      = 200;
+constexpr std::size_t kRefSearchPageSize = 50;
+constexpr int kRefSearchDebounceMs       = 250;
+// Worker results are applied in batches, at most about 30 times a second.
+constexpr int kUiUpdateIntervalMs = 33;
+// Jobs checked at the same time by Plan Apply and the Apply preflight.
+constexpr std::size_t kMaxConcurrentJobChecks = 8;
 const wxColour kModifiedIndicatorActiveColour(255, 140, 0);
 
 bool HasSource(const confy::ComponentConfig &component)
@@ -57,6 +84,23 @@ bool HasArtifact(const confy::ComponentConfig &component)
    return component.artifactPresent;
 }
 
+std::string BuildSourceRefsCacheKey(const std::string &normalizedRepositoryUrl)
+{
+   return confy::MetadataCache::BuildKey("git-refs", normalizedRepositoryUrl);
+}
+
+// Artifact requests are (repository browse URL, artifact path); the browse URL
+// identifies both the Nexus server and the repository.
+std::string BuildVersionsCacheKey(const std::pair<std::string, std::string> &request)
+{
+   return confy::MetadataCache::BuildKey("nexus-versions", request.first + "|" + request.second);
+}
+
+std::string BuildBuildTypesCacheKey(const std::pair<std::string, std::string> &request, const std::string &version)
+{
+   return confy::MetadataCache::BuildKey("nexus-buildtypes", request.first + "|" + request.second + "|" + version);
+}
+
 } // namespace
 
 namespace confy {
@@ -74,6 +118,8 @@ MainFrame::MainFrame(const wxString &initialConfigPath, std::function<void()> on
    fileMenu->AppendSeparator();
    fileMenu->Append(kIdSaveAs, "Save &As...\tCtrl+Shift+S");
    fileMenu->AppendSeparator();
+   fileMenu->Append(kIdPlanApply, "&Plan Apply...\tCtrl+P");
+   fileMenu->AppendSeparator();
    fileMenu->Append(wxID_EXIT, "E&xit");
 
    auto *editMenu = new wxMenu();
@@ -93,18 +139,35 @@ MainFrame::MainFrame(const wxString &initialConfigPath, std::function<void()> on
 
    auto *rootSizer = new wxBoxSizer(wxVERTICAL);
 
-   componentScroll_ = new wxScrolledWindow(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxVSCROLL);
-   componentScroll_->SetScrollRate(0, 6);
-
-   componentContentPanel_ = new wxPanel(componentScroll_);
-   componentListSizer_    = new wxBoxSizer(wxVERTICAL);
-   componentContentPanel_->SetSizer(componentListSizer_);
-
-   auto *scrollSizer = new wxBoxSizer(wxVERTICAL);
-   scrollSizer->Add(componentContentPanel_, 1, wxEXPAND);
-   componentScroll_->SetSizer(scrollSizer);
+   // Rows are drawn by a fixed pool of slots inside a plain panel; the
+   // separate scroll bar moves through the component list row by row.
+   auto *componentAreaSizer = new wxBoxSizer(wxHORIZONTAL);
+   componentViewport_       = new wxPanel(this);
+   componentListSizer_      = new wxBoxSizer(wxVERTICAL);
+   componentViewport_->SetSizer(componentListSizer_);
+   // The slots must not make the viewport ask for more room; its height is
+   // whatever the frame leaves, and that decides how many slots exist.
+   componentViewport_->SetMinSize(wxSize(-1, 1));
+   componentViewport_->Bind(wxEVT_SIZE, &MainFrame::OnComponentAreaSize, this);
+   componentViewport_->Bind(wxEVT_MOUSEWHEEL, &MainFrame::OnComponentMouseWheel, this);
+   componentAreaSizer->Add(componentViewport_, 1, wxEXPAND);
+
+   componentScrollBar_ = new wxScrollBar(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxSB_VERTICAL);
+   for (const auto &eventType : {wxEVT_SCROLL_TOP,
+            wxEVT_SCROLL_BOTTOM,
+            wxEVT_SCROLL_LINEUP,
+            wxEVT_SCROLL_LINEDOWN,
+            wxEVT_SCROLL_PAGEUP,
+            wxEVT_SCROLL_PAGEDOWN,
+            wxEVT_SCROLL_THUMBTRACK,
+            wxEVT_SCROLL_THUMBRELEASE}) {
+      componentScrollBar_->Bind(eventType, [this](wxScrollEvent &event) {
+         ScrollComponentRows(event.GetPosition() - static_cast<int>(firstVisibleComponent_));
+      });
+   }
+   componentAreaSizer->Add(componentScrollBar_, 0, wxEXPAND);
 
-   rootSizer->Add(componentScroll_, 1, wxLEFT | wxRIGHT | wxBOTTOM | wxEXPAND, 8);
+   rootSizer->Add(componentAreaSizer, 1, wxLEFT | wxRIGHT | wxBOTTOM | wxEXPAND, 8);
 
    applyButton_ = new wxButton(this, kIdApply, "Apply");
    applyButton_->Disable();
@@ -115,6 +178,7 @@ MainFrame::MainFrame(const wxString &initialConfigPath, std::function<void()> on
    Bind(wxEVT_MENU, &MainFrame::OnCloseConfig, this, kIdCloseConfig);
    Bind(wxEVT_MENU, &MainFrame::OnReloadConfig, this, kIdReloadConfig);
    Bind(wxEVT_MENU, &MainFrame::OnSaveAs, this, kIdSaveAs);
+   Bind(wxEVT_MENU, &MainFrame::OnPlanApply, this, kIdPlanApply);
    Bind(wxEVT_MENU, &MainFrame::OnSelectAll, this, wxID_SELECTALL);
    Bind(wxEVT_MENU, &MainFrame::OnDeselectAll, this, kIdDeselectAll);
    Bind(wxEVT_MENU, &MainFrame::OnCopyConfig, this, kIdCopyConfig);
@@ -122,12 +186,32 @@ MainFrame::MainFrame(const wxString &initialConfigPath, std::function<void()> on
    Bind(wxEVT_MENU, &MainFrame::OnExit, this, wxID_EXIT);
    Bind(wxEVT_CLOSE_WINDOW, &MainFrame::OnCloseWindow, this);
    Bind(wxEVT_UPDATE_UI, &MainFrame::OnUpdateSaveAs, this, kIdSaveAs);
+   Bind(wxEVT_UPDATE_UI, &MainFrame::OnUpdateReloadConfig, this, kIdReloadConfig);
+   Bind(wxEVT_UPDATE_UI, &MainFrame::OnUpdatePlanApply, this, kIdPlanApply);
+   Bind(wxEVT_UPDATE_UI, &MainFrame::OnUpdateApply, this, kIdApply);
    Bind(wxEVT_UPDATE_UI, &MainFrame::OnUpdateSelectAll, this, wxID_SELECTALL);
    Bind(wxEVT_UPDATE_UI, &MainFrame::OnUpdateDeselectAll, this, kIdDeselectAll);
    Bind(wxEVT_UPDATE_UI, &MainFrame::OnUpdateCopyConfig, this, kIdCopyConfig);
    Bind(wxEVT_UPDATE_UI, &MainFrame::OnUpdateDebugConsole, this, kIdViewDebugConsole);
    Bind(wxEVT_BUTTON, &MainFrame::OnApply, this, kIdApply);
-   Bind(wxEVT_SIZE, &MainFrame::OnFrameSize, this);
+
+   refSearchTimer_ = new wxTimer(this, kIdRefSearchTimer);
+   Bind(wxEVT_TIMER, &MainFrame::OnRefSearchTimer, this, kIdRefSearchTimer);
+   uiUpdateTimer_ = new wxTimer(this, kIdUiUpdateTimer);
+   Bind(wxEVT_TIMER, &MainFrame::OnUiUpdateTimer, this, kIdUiUpdateTimer);
+
+   metadataCache_ = std::make_unique<MetadataCache>(
+       (std::filesystem::path(AppSettings::Get().GetCacheDirectory()) / "metadata-cache.json").string(),
+       AppSettings::Get().GetMetadataCacheTtl());
+   std::string cacheError;
+   if (!metadataCache_->Load(cacheError)) {
+      CONFY_LOG(LogModule::Metadata, LogLevel::Warning, "%s", cacheError.c_str());
+   }
+   transferHistory_ = std::make_shared<TransferHistory>(
+       (std::filesystem::path(AppSettings::Get().GetCacheDirectory()) / "transfer-history.json").string());
+   if (!transferHistory_->Load(cacheError)) {
+      wxLogWarning("[plan] %s", cacheError.c_str());
+   }
 
    if (!LoadConfigFromPath(initialConfigPath)) {
       CallAfter([this]() { Close(); });
@@ -136,7 +220,17 @@ MainFrame::MainFrame(const wxString &initialConfigPath, std::function<void()> on
 
 MainFrame::~MainFrame()
 {
+   if (refSearchTimer_ != nullptr) {
+      refSearchTimer_->Stop();
+   }
+   if (uiUpdateTimer_ != nullptr) {
+      uiUpdateTimer_->Stop();
+   }
    StopMetadataWorkers();
+   checkCancelRequested_ = true;
+   if (checkThread_.joinable()) {
+      checkThread_.join();
+   }
 }
 
 void MainFrame::OnCloseConfig(wxCommandEvent &)
@@ -146,10 +240,10 @@ void MainFrame::OnCloseConfig(wxCommandEvent &)
 
 void MainFrame::OnReloadConfig(wxCommandEvent &)
 {
-   if (loadedConfigPath_.empty()) {
+   if (loadedConfigPath_.empty() || checkRunning_) {
       return;
    }
-   LoadConfigFromPath(wxString(loadedConfigPath_));
+   ReloadConfigFromPath(wxString(loadedConfigPath_));
 }
 
 void MainFrame::OnExit(wxCommandEvent &)
@@ -163,6 +257,7 @@ void MainFrame::OnExit(wxCommandEvent &)
 
 void MainFrame::OnCloseWindow(wxCloseEvent &event)
 {
+   checkCancelRequested_ = true;
    if (!exitRequested_ && onReturnToPicker_) {
       onReturnToPicker_();
    }
@@ -233,57 +328,347 @@ bool MainFrame::LoadConfigFromPath(const wxString &path)
    return true;
 }
 
-void MainFrame::OnApply(wxCommandEvent &)
+bool MainFrame::ReloadConfigFromPath(const wxString &path)
 {
-   std::vector<DownloadJob> jobs;
-   jobs.reserve(config_.components.size());
+   ConfigLoader loader;
+   auto result = loader.LoadFromFile(path.ToStdString());
+   if (!result.success) {
+      wxMessageBox(result.errorMessage, "Config reload failed", wxOK | wxICON_ERROR, this);
+      return false;
+   }
 
-   static std::uint64_t nextJobId = 1;
+   MergeReloadedConfig(std::move(result.config));
+   return true;
+}
 
+void MainFrame::MergeReloadedConfig(ConfigModel config)
+{
+   // Components are matched by name. A matched component keeps the metadata
+   // fetched for it as long as its repository or artifact location is the
+   // same; only rows that differ from what is shown are rebound.
+   std::unordered_map<std::string, std::size_t> previousIndexByName;
+   for (std::size_t i = 0; i < config_.components.size(); ++i) {
+      previousIndexByName.emplace(config_.components[i].name, i);
+   }
+
+   const auto count = config.components.size();
+   std::vector<ComponentRowItems> rowItems(count);
+   std::vector<ComponentRowBaseline> rowBaselines(count);
+   std::vector<ComponentMetadataState> metadataState(count);
+   std::vector<std::string> sourceRequests(count);
+   std::vector<std::pair<std::string, std::string>> artifactRequests(count);
+   std::vector<char> changed(count, 1);
+   // Set when a component index now refers to another request, which makes
+   // queued and in-flight index-based work meaningless.
+   bool remapped = count != config_.components.size();
+   for (std::size_t i = 0; i < count; ++i) {
+      const auto &component = config.components[i];
+      sourceRequests[i]     = component.source.url;
+      artifactRequests[i]   = {component.artifact.url, BuildArtifactPath(component)};
+      rowBaselines[i]       = MakeRowBaseline(component);
+      rowItems[i]           = MakeInitialRowItems(component);
+
+      const auto found = previousIndexByName.find(component.name);
+      if (found == previousIndexByName.end()) {
+         remapped = true;
+         continue;
+      }
+      const auto previous = found->second;
+      previousIndexByName.erase(found);
+      remapped = remapped || previous != i || sourceRequests[i] != componentSourceRequests_[previous] ||
+                 artifactRequests[i] != componentArtifactRequests_[previous];
+      changed[i] = previous != i || !(component == config_.components[previous]);
+
+      // Loading flags are not carried over: anything still missing is
+      // queued again below.
+      auto &previousState = metadataState_[previous];
+      if (sourceRequests[i] == componentSourceRequests_[previous]) {
+         metadataState[i].sourceRefsLoaded    = previousState.sourceRefsLoaded;
+         metadataState[i].sourceRefsTruncated = previousState.sourceRefsTruncated;
+         rowItems[i].sourceRefs               = std::move(rowItems_[previous].sourceRefs);
+      }
+      if (artifactRequests[i] == componentArtifactRequests_[previous]) {
+         metadataState[i].versionsLoaded      = previousState.versionsLoaded;
+         metadataState[i].buildTypesByVersion = std::move(previousState.buildTypesByVersion);
+         rowItems[i].versions                 = std::move(rowItems_[previous].versions);
+         const auto hit                       = metadataState[i].buildTypesByVersion.find(component.artifact.version);
+         if (hit != metadataState[i].buildTypesByVersion.end()) {
+            rowItems[i].buildTypes = hit->second;
+         }
+      }
+   }
+
+   if (remapped) {
+      std::scoped_lock lock(metadataMutex_);
+      ++metadataGeneration_;
+      // Queued tasks name components by their old index; whatever is still
+      // missing is queued again below.
+      metadataTasks_.clear();
+      metadataTaskKeys_.clear();
+      componentSourceRequests_   = std::move(sourceRequests);
+      componentArtifactRequests_ = std::move(artifactRequests);
+   }
+   ++refSearchGeneration_;
+   refSearchTimer_->Stop();
+
+   config_        = std::move(config);
+   rowItems_      = std::move(rowItems);
+   rowBaselines_  = std::move(rowBaselines);
+   metadataState_ = std::move(metadataState);
+   rowChangeState_.assign(count, ComponentRowChangeState{});
+
+   for (auto &slot : rowSlots_) {
+      if (slot.componentIndex != kNoComponent && (slot.componentIndex >= count || changed[slot.componentIndex])) {
+         slot.componentIndex = kNoComponent;
+      }
+   }
+   uiUpdating_ = true;
+   RelayoutComponentArea();
+   uiUpdating_ = false;
+   // Rows that kept their slot get a new baseline from the file.
+   for (const auto &slot : rowSlots_) {
+      if (slot.componentIndex != kNoComponent) {
+         RefreshRowModifiedIndicator(slot.componentIndex);
+      }
+   }
+
+   SetStatusText(wxString::Format("Config: %s", loadedConfigPath_));
+   applyButton_->Enable(!config_.components.empty());
+
+   PopulateFromMetadataCache();
+   StartMetadataWorkers();
    for (std::size_t i = 0; i < config_.components.size(); ++i) {
       const auto &component = config_.components[i];
+      if (HasSource(component) && !component.source.url.empty()) {
+         EnqueueSourceRefsFetch(i, false);
+      }
+      if (HasArtifact(component) && !component.artifact.url.empty()) {
+         EnqueueVersionFetch(i, false);
+         if (metadataState_[i].versionsLoaded) {
+            EnqueueBuildTypeFetch(i, component.artifact.version);
+         }
+      }
+   }
+}
+
+std::vector<DownloadJob> MainFrame::BuildApplyJobs() const
+{
+   static std::uint64_t nextJobId = 1;
+   const auto &settings           = AppSettings::Get();
+   SourceJobSettings sourceSettings;
+   sourceSettings.mirrorCacheDirectory = settings.GetGitMirrorCacheDirectory();
+   sourceSettings.refuseDirtyReclone   = settings.IsGitRefuseDirtyRecloneEnabled();
+   sourceSettings.parallelJobs         = settings.GetGitParallelJobs();
+   sourceSettings.outputTailBytes      = settings.GetGitOutputTailBytes();
+   sourceSettings.logDirectory         = settings.GetGitLogDirectory();
+   return BuildDownloadJobs(config_, sourceSettings, nextJobId);
+}
 
-      if (HasSource(component) && component.source.enabled && !component.source.url.empty()) {
-         GitCloneJob sourceJob;
-         sourceJob.jobId                = nextJobId++;
-         sourceJob.componentIndex       = i;
-         sourceJob.componentName        = component.name;
-         sourceJob.componentDisplayName = component.displayName;
-         sourceJob.repositoryUrl        = component.source.url;
-         sourceJob.branchOrTag          = component.source.branchOrTag;
-         sourceJob.targetDirectory      = (std::filesystem::path(config_.rootPath) / component.path).string();
-         sourceJob.postDownloadScript   = component.source.script;
-         sourceJob.shallow              = component.source.shallow;
-         jobs.push_back(DownloadJob::FromSource(std::move(sourceJob)));
+void MainFrame::OnApply(wxCommandEvent &)
+{
+   if (checkRunning_) {
+      return;
+   }
+   auto jobs = BuildApplyJobs();
+   if (jobs.empty()) {
+      wxMessageBox("No source/artifact jobs are enabled.", "Nothing to do", wxOK | wxICON_INFORMATION, this);
+      return;
+   }
+   if (checkThread_.joinable()) {
+      checkThread_.join();
+   }
+
+   // Preflight: a missing version or ref would otherwise only fail once its
+   // job reaches a worker, possibly long into the apply.
+   checkRunning_ = true;
+   SetStatusText(wxString::Format("Checking %zu job(s) before applying...", jobs.size()));
+   checkThread_ = std::thread([this, jobs = std::move(jobs)]() mutable {
+      std::vector<ApplyJobProblem> problems;
+      AuthCredentials credentials;
+      std::string errorMessage;
+      if (credentials.LoadFromM2SettingsXml(AuthCredentials::DefaultM2SettingsPath(), errorMessage)) {
+         problems = ValidateApplyJobs(jobs, MakeApplyPlanResolvers(credentials), kMaxConcurrentJobChecks, &checkCancelRequested_);
+      } else {
+         // The workers load the same file and would fail every job.
+         for (std::size_t i = 0; i < jobs.size(); ++i) {
+            const bool isSource = jobs[i].kind == DownloadJobKind::GitSource;
+            ApplyJobProblem problem;
+            problem.jobIndex             = i;
+            problem.kind                 = jobs[i].kind;
+            problem.componentName        = isSource ? jobs[i].source.componentName : jobs[i].artifact.componentName;
+            problem.componentDisplayName = isSource ? jobs[i].source.componentDisplayName
+                                                    : jobs[i].artifact.componentDisplayName;
+            problem.message              = "Credential load failed: " + errorMessage;
+            problems.push_back(std::move(problem));
+         }
+      }
+      PostUiUpdate([this, jobs = std::move(jobs), problems = std::move(problems)]() mutable {
+         checkRunning_ = false;
+         if (checkCancelRequested_) {
+            return;
+         }
+         SetStatusText(problems.empty() ? wxString("Preflight passed")
+                                        : wxString::Format("Preflight found %zu problem(s)", problems.size()));
+         // The progress dialog is modal; open it outside the update batch.
+         CallAfter([this, jobs = std::move(jobs), problems = std::move(problems)]() mutable {
+            StartApply(std::move(jobs), problems);
+         });
+      });
+   });
+}
+
+void MainFrame::StartApply(std::vector<DownloadJob> jobs, const std::vector<ApplyJobProblem> &problems)
+{
+   if (!problems.empty()) {
+      // Every problem is also in the debug console; the message box keeps
+      // only the first ones.
+      constexpr std::size_t kMaxReportedProblems = 20;
+      const std::vector<ApplyJobProblem> reported(
+          problems.begin(), problems.begin() + static_cast<std::ptrdiff_t>(std::min(problems.size(), kMaxReportedProblems)));
+      auto report = BuildHumanReadablePreflightReport(reported);
+      if (problems.size() > reported.size()) {
+         report += "... and " + std::to_string(problems.size() - reported.size()) + " more\n";
+      }
+
+      std::vector<char> rejected(jobs.size(), 0);
+      for (const auto &problem : problems) {
+         rejected[problem.jobIndex] = 1;
+      }
+      std::vector<DownloadJob> validJobs;
+      for (std::size_t i = 0; i < jobs.size(); ++i) {
+         if (!rejected[i]) {
+            validJobs.push_back(std::move(jobs[i]));
+         }
       }
 
-      if (HasArtifact(component) && component.artifact.enabled) {
-         NexusDownloadJob artifactJob;
-         artifactJob.jobId                = nextJobId++;
-         artifactJob.componentIndex       = i;
-         artifactJob.componentName        = component.name;
-         artifactJob.componentDisplayName = component.displayName;
-         artifactJob.repositoryUrl        = component.artifact.url;
-         artifactJob.artifactPath         = component.artifact.relativePath.empty()
-                                                ? component.name
-                                                : component.artifact.relativePath + "/" + component.name;
-         artifactJob.version              = component.artifact.version;
-         artifactJob.buildType            = component.artifact.buildType;
-         artifactJob.targetDirectory      = (std::filesystem::path(config_.rootPath) / component.path).string();
-         artifactJob.postDownloadScript   = component.artifact.script;
-         artifactJob.regexIncludes        = component.artifact.regexIncludes;
-         artifactJob.regexExcludes        = component.artifact.regexExcludes;
-
-         jobs.push_back(DownloadJob::FromArtifact(std::move(artifactJob)));
+      if (validJobs.empty()) {
+         wxMessageBox("No job passed the checks:\n\n" + report, "Apply", wxOK | wxICON_ERROR, this);
+         return;
+      }
+      const auto question = wxString::Format("%zu of %zu job(s) failed the checks:\n\n%s\nStart the %zu job(s) that passed?",
+          problems.size(),
+          jobs.size(),
+          wxString::FromUTF8(report.c_str()),
+          validJobs.size());
+      if (wxMessageBox(question, "Apply", wxYES_NO | wxICON_WARNING, this) != wxYES) {
+         return;
       }
+      jobs = std::move(validJobs);
+   }
+
+   // The HTTP timing summary covers one Apply, including any version or ref
+   // listing that runs in the background meanwhile.
+   HttpTimings::Reset();
+   {
+      DownloadProgressDialog dialog(this, std::move(jobs), transferHistory_);
+      dialog.ShowModal();
    }
+   std::string historyError;
+   if (!transferHistory_->SaveIfModified(historyError)) {
+      wxLogWarning("[plan] %s", historyError.c_str());
+   }
+   HttpTimings::LogReport();
+   std::string timingsError;
+   if (!HttpTimings::WriteReport(AppSettings::Get().GetHttpTimingsFile(), timingsError)) {
+      wxLogWarning("[apply] %s", timingsError.c_str());
+   }
+}
+
+void MainFrame::OnUpdateApply(wxUpdateUIEvent &event)
+{
+   event.Enable(!config_.components.empty() && !checkRunning_);
+}
 
+void MainFrame::OnPlanApply(wxCommandEvent &)
+{
+   if (checkRunning_) {
+      return;
+   }
+   auto jobs = BuildApplyJobs();
    if (jobs.empty()) {
       wxMessageBox("No source/artifact jobs are enabled.", "Nothing to do", wxOK | wxICON_INFORMATION, this);
       return;
    }
+   if (checkThread_.joinable()) {
+      checkThread_.join();
+   }
+
+   // Listing files and refs takes a request per job and a HEAD request per
+   // artifact file, so the plan is resolved off the GUI thread.
+   checkRunning_ = true;
+   SetStatusText("Planning apply...");
+   checkThread_ = std::thread([this, jobs = std::move(jobs), history = transferHistory_]() {
+      std::string summary;
+      AuthCredentials credentials;
+      std::string errorMessage;
+      if (credentials.LoadFromM2SettingsXml(AuthCredentials::DefaultM2SettingsPath(), errorMessage)) {
+         const auto plan =
+             BuildApplyPlan(jobs, MakeApplyPlanResolvers(credentials), history.get(), DownloadProgressDialog::kWorkerCount, kMaxConcurrentJobChecks, &checkCancelRequested_);
+         summary = BuildHumanReadablePlanSummary(plan);
+      } else {
+         summary = "Could not load credentials: " + errorMessage + "\n";
+      }
+      PostUiUpdate([this, summary = std::move(summary)]() {
+         checkRunning_ = false;
+         if (checkCancelRequested_) {
+            return;
+         }
+         SetStatusText("Apply plan ready");
+         // Not modal inside the update batch, which would hold back the rest of it.
+         CallAfter([this, summary]() { ShowPlanSummary(summary); });
+      });
+   });
+}
 
-   DownloadProgressDialog dialog(this, std::move(jobs));
+void MainFrame::OnUpdateReloadConfig(wxUpdateUIEvent &event)
+{
+   // A running check reports on jobs built from the loaded config.
+   event.Enable(!loadedConfigPath_.empty() && !checkRunning_);
+}
+
+void MainFrame::OnUpdatePlanApply(wxUpdateUIEvent &event)
+{
+   event.Enable(!config_.components.empty() && !checkRunning_);
+}
+
+void MainFrame::ShowPlanSummary(const std::string &summary)
+{
+   wxDialog dialog(this, wxID_ANY, "Apply Plan", wxDefaultPosition, wxSize(760, 480), wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER);
+   auto *sizer = new wxBoxSizer(wxVERTICAL);
+   auto *text  = new wxTextCtrl(&dialog,
+       wxID_ANY,
+       wxString::FromUTF8(summary.c_str()),
+       wxDefaultPosition,
+       wxDefaultSize,
+       wxTE_MULTILINE | wxTE_READONLY | wxTE_DONTWRAP);
+   text->SetFont(wxFont(wxFontInfo().Family(wxFONTFAMILY_TELETYPE)));
+   sizer->Add(text, 1, wxEXPAND | wxALL, 8);
+
+   auto *buttons = new wxBoxSizer(wxHORIZONTAL);
+   buttons->AddStretchSpacer();
+   buttons->Add(new wxButton(&dialog, wxID_SAVE, "&Save..."), 0, wxRIGHT, 8);
+   buttons->Add(new wxButton(&dialog, wxID_CLOSE, "&Close"), 0);
+   sizer->Add(buttons, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 8);
+   dialog.SetSizer(sizer);
+   dialog.SetEscapeId(wxID_CLOSE);
+
+   dialog.Bind(wxEVT_BUTTON, [&dialog](wxCommandEvent &) { dialog.EndModal(wxID_CLOSE); }, wxID_CLOSE);
+   dialog.Bind(wxEVT_BUTTON, [&dialog, &summary](wxCommandEvent &) {
+      wxFileDialog fileDialog(&dialog,
+          "Save apply plan",
+          wxEmptyString,
+          "apply-plan.txt",
+          "Text files (*.txt)|*.txt|All files (*.*)|*.*",
+          wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+      if (fileDialog.ShowModal() != wxID_OK) {
+         return;
+      }
+      std::ofstream output(fileDialog.GetPath().ToStdString(), std::ios::binary | std::ios::trunc);
+      output << summary;
+      if (!output.good()) {
+         wxMessageBox("Failed to write " + fileDialog.GetPath(), "Save failed", wxOK | wxICON_ERROR, &dialog);
+      }
+   }, wxID_SAVE);
    dialog.ShowModal();
 }
 
@@ -370,26 +755,107 @@ void MainFrame::OnUpdateDebugConsole(wxUpdateUIEvent &event)
    event.Check(IsDebugConsoleVisible());
 }
 
-void MainFrame::OnFrameSize(wxSizeEvent &event)
+void MainFrame::OnComponentAreaSize(wxSizeEvent &event)
 {
    event.Skip();
    RelayoutComponentArea();
 }
 
+void MainFrame::OnComponentMouseWheel(wxMouseEvent &event)
+{
+   int wheelDelta = event.GetWheelDelta();
+   if (wheelDelta == 0) {
+      wheelDelta = 120;
+   }
+   int wheelSteps = event.GetWheelRotation() / wheelDelta;
+   if (wheelSteps == 0) {
+      wheelSteps = (event.GetWheelRotation() > 0) ? 1 : -1;
+   }
+   ScrollComponentRows(-wheelSteps);
+}
+
 void MainFrame::RelayoutComponentArea()
 {
-   componentContentPanel_->Layout();
-   componentScroll_->Layout();
-   componentScroll_->FitInside();
+   if (rowSlots_.empty()) {
+      // The first slot also provides the row height; every row has the same
+      // layout, so one measurement holds for all of them.
+      AddRowSlot();
+   }
+
+   const auto componentCount = static_cast<int>(config_.components.size());
+   const int viewportHeight  = std::max(componentViewport_->GetClientSize().GetHeight(), 0);
+   const int fullRows        = std::max(viewportHeight / rowHeight_, 1);
+   // Slots also cover the partially visible row at the bottom.
+   const int shownRows = std::min((viewportHeight + rowHeight_ - 1) / rowHeight_, componentCount);
+   while (rowSlots_.size() < static_cast<std::size_t>(shownRows)) {
+      AddRowSlot();
+   }
+
+   const int maxFirst     = std::max(componentCount - fullRows, 0);
+   firstVisibleComponent_ = static_cast<std::size_t>(std::min(static_cast<int>(firstVisibleComponent_), maxFirst));
+   visibleRowCount_       = static_cast<std::size_t>(std::max(shownRows, 0));
+   componentScrollBar_->SetScrollbar(static_cast<int>(firstVisibleComponent_),
+       fullRows,
+       componentCount,
+       std::max(fullRows - 1, 1));
+   BindVisibleRows();
+}
+
+void MainFrame::ScrollComponentRows(int rowDelta)
+{
+   const auto componentCount = static_cast<int>(config_.components.size());
+   const int maxFirst        = std::max(componentCount - componentScrollBar_->GetThumbSize(), 0);
+   const int first           = std::clamp(static_cast<int>(firstVisibleComponent_) + rowDelta, 0, maxFirst);
+   if (static_cast<std::size_t>(first) == firstVisibleComponent_) {
+      return;
+   }
+
+   firstVisibleComponent_ = static_cast<std::size_t>(first);
+   componentScrollBar_->SetThumbPosition(first);
+   BindVisibleRows();
+}
+
+void MainFrame::BindVisibleRows()
+{
+   componentViewport_->Freeze();
+   for (std::size_t slotIndex = 0; slotIndex < rowSlots_.size(); ++slotIndex) {
+      auto &slot                = rowSlots_[slotIndex];
+      const auto componentIndex = firstVisibleComponent_ + slotIndex;
+      if (slotIndex < visibleRowCount_ && componentIndex < config_.components.size()) {
+         if (slot.componentIndex != componentIndex) {
+            BindRowSlot(slotIndex, componentIndex);
+         }
+         slot.card->Show();
+      } else {
+         slot.componentIndex = kNoComponent;
+         slot.card->Hide();
+      }
+   }
+   componentViewport_->Layout();
+   componentViewport_->Thaw();
+   UpdateVisibleComponents();
+}
+
+MainFrame::ComponentRowWidgets *MainFrame::FindRowSlot(std::size_t componentIndex)
+{
+   if (componentIndex < firstVisibleComponent_ || componentIndex - firstVisibleComponent_ >= rowSlots_.size()) {
+      return nullptr;
+   }
+   auto &slot = rowSlots_[componentIndex - firstVisibleComponent_];
+   return slot.componentIndex == componentIndex ? &slot : nullptr;
 }
 
 void MainFrame::RenderConfig()
 {
    StopMetadataWorkers();
+   {
+      // Results of the stopped workers may still be waiting in the event loop.
+      std::scoped_lock lock(metadataMutex_);
+      ++metadataGeneration_;
+   }
    uiUpdating_ = true;
-   componentListSizer_->Clear(true);
-   rows_.clear();
-   rows_.reserve(config_.components.size());
+   rowItems_.clear();
+   rowItems_.resize(config_.components.size());
    rowBaselines_.clear();
    rowBaselines_.resize(config_.components.size());
    rowChangeState_.clear();
@@ -406,14 +872,18 @@ void MainFrame::RenderConfig()
    // vectors are refreshed as a batch for the current config view and are not
    // mutated again until workers are stopped and the next RenderConfig() runs.
    for (std::size_t i = 0; i < config_.components.size(); ++i) {
-      componentSourceRequests_[i]   = config_.components[i].source.url;
-      componentArtifactRequests_[i] = {config_.components[i].artifact.url,
-          config_.components[i].artifact.relativePath.empty()
-              ? config_.components[i].name
-              : config_.components[i].artifact.relativePath + "/" + config_.components[i].name};
-      AddComponentRow(i);
+      const auto &component         = config_.components[i];
+      componentSourceRequests_[i]   = component.source.url;
+      componentArtifactRequests_[i] = {component.artifact.url, BuildArtifactPath(component)};
+      rowBaselines_[i]              = MakeRowBaseline(component);
+      rowItems_[i]                  = MakeInitialRowItems(component);
    }
 
+   // Slots still show rows of the previous config; force them to rebind.
+   for (auto &slot : rowSlots_) {
+      slot.componentIndex = kNoComponent;
+   }
+   firstVisibleComponent_ = 0;
    RelayoutComponentArea();
    uiUpdating_ = false;
 
@@ -425,6 +895,7 @@ void MainFrame::RenderConfig()
    applyButton_->Enable(!config_.components.empty());
    Layout();
 
+   PopulateFromMetadataCache();
    StartMetadataWorkers();
    for (std::size_t i = 0; i < config_.components.size(); ++i) {
       if (HasSource(config_.components[i]) && !config_.components[i].source.url.empty()) {
@@ -436,27 +907,54 @@ void MainFrame::RenderConfig()
    }
 }
 
-void MainFrame::AddComponentRow(std::size_t componentIndex)
+MainFrame::ComponentRowBaseline MainFrame::MakeRowBaseline(const ComponentConfig &component)
 {
-   auto &component = config_.components[componentIndex];
+   ComponentRowBaseline baseline;
+   baseline.sourceBranch      = component.source.branchOrTag;
+   baseline.artifactVersion   = component.artifact.version;
+   baseline.artifactBuildType = component.artifact.buildType;
+   return baseline;
+}
+
+MainFrame::ComponentRowItems MainFrame::MakeInitialRowItems(const ComponentConfig &component)
+{
+   // Until metadata arrives each dropdown offers just the configured value.
+   ComponentRowItems items;
+   if (!component.source.branchOrTag.empty()) {
+      items.sourceRefs = {component.source.branchOrTag};
+   }
+   if (!component.artifact.version.empty()) {
+      items.versions = {component.artifact.version};
+   }
+   if (!component.artifact.buildType.empty()) {
+      items.buildTypes = {component.artifact.buildType};
+   }
+   return items;
+}
 
-   const auto displayName = component.displayName;
-   auto *rowBox           = new wxStaticBoxSizer(wxVERTICAL,
-                 componentContentPanel_,
-                 wxString::Format("%s  (%s)", displayName, component.path));
-   auto *rowParent        = rowBox->GetStaticBox();
+void MainFrame::AddRowSlot()
+{
+   const auto slotIndex = rowSlots_.size();
+
+   auto *card = new wxPanel(componentViewport_);
+   // The label is replaced when the slot is bound; it only has to give the
+   // box its real height for measuring.
+   auto *rowBox    = new wxStaticBoxSizer(wxVERTICAL, card, "Component");
+   auto *rowParent = rowBox->GetStaticBox();
 
    auto *detailsSizer = new wxBoxSizer(wxVERTICAL);
 
    auto *componentCardSizer = new wxBoxSizer(wxHORIZONTAL);
-   auto *modifiedIndicator  = new wxPanel(componentContentPanel_, wxID_ANY, wxDefaultPosition, wxSize(6, -1));
+   auto *modifiedIndicator  = new wxPanel(card, wxID_ANY, wxDefaultPosition, wxSize(6, -1));
    modifiedIndicator->SetMinSize(wxSize(6, -1));
-   modifiedIndicator->SetBackgroundColour(componentContentPanel_->GetBackgroundColour());
+   modifiedIndicator->SetBackgroundColour(componentViewport_->GetBackgroundColour());
    componentCardSizer->Add(modifiedIndicator, 0, wxEXPAND | wxRIGHT, 6);
 
-   auto makeFixedLabel = [rowParent](const wxString &text, int width) {
+   std::vector<wxWindow *> wheelTargets{card, rowParent, modifiedIndicator};
+   auto makeFixedLabel = [rowParent, &wheelTargets](const wxString &text, int width) {
       auto *label = new wxStaticText(rowParent, wxID_ANY, text);
       label->SetMinSize(wxSize(width, -1));
+      wheelTargets.push_back(label);
       return label;
    };
 
@@ -485,24 +983,40 @@ void MainFrame::AddComponentRow(std::size_t componentIndex)
 
    rowBox->Add(detailsSizer, 1, wxEXPAND);
    componentCardSizer->Add(rowBox, 1, wxEXPAND);
+   card->SetSizer(componentCardSizer);
 
-   componentListSizer_->Add(componentCardSizer, 0, wxBOTTOM | wxEXPAND, 6);
+   componentListSizer_->Add(card, 0, wxBOTTOM | wxEXPAND, kRowSpacing);
+   if (rowHeight_ == 0) {
+      rowHeight_ = std::max(card->GetBestSize().GetHeight(), 1) + kRowSpacing;
+   }
 
    ComponentRowWidgets row;
+   row.card              = card;
+   row.box               = rowParent;
+   row.modifiedIndicator = modifiedIndicator;
    row.sourceEnabled     = sourceEnabled;
    row.sourceShallow     = sourceShallow;
    row.sourceBranch      = sourceBranch;
    row.artifactEnabled   = artifactEnabled;
    row.artifactVersion   = artifactVersion;
    row.artifactBuildType = artifactBuildType;
-   rows_.push_back(row);
-
-   rowBaselines_[componentIndex].sourceBranch        = component.source.branchOrTag;
-   rowBaselines_[componentIndex].artifactVersion     = component.artifact.version;
-   rowBaselines_[componentIndex].artifactBuildType   = component.artifact.buildType;
-   rowChangeState_[componentIndex].modifiedIndicator = modifiedIndicator;
+   rowSlots_.push_back(row);
+
+   // Handlers resolve the component through the slot at event time, as the
+   // slot is rebound while scrolling. rowSlots_ may reallocate, so they keep
+   // the slot index rather than a reference.
+   wheelTargets.push_back(sourceEnabled);
+   wheelTargets.push_back(sourceShallow);
+   wheelTargets.push_back(artifactEnabled);
+   for (auto *target : wheelTargets) {
+      target->Bind(wxEVT_MOUSEWHEEL, &MainFrame::OnComponentMouseWheel, this);
+   }
 
-   auto bindComboWheelProtection = [this](wxComboBox *combo) {
+   auto bindComboWheelProtection = [this, slotIndex](wxComboBox *combo) {
+      combo->Bind(wxEVT_SET_FOCUS, [this, slotIndex](wxFocusEvent &event) {
+         event.Skip();
+         PromoteComponentMetadataTasks(rowSlots_[slotIndex].componentIndex);
+      });
       combo->Bind(wxEVT_COMBOBOX_DROPDOWN, [this, combo](wxCommandEvent &) { openComboDropdowns_.insert(combo); });
       combo->Bind(wxEVT_COMBOBOX_CLOSEUP, [this, combo](wxCommandEvent &) { openComboDropdowns_.erase(combo); });
       combo->Bind(wxEVT_MOUSEWHEEL, [this, combo](wxMouseEvent &event) {
@@ -510,145 +1024,145 @@ void MainFrame::AddComponentRow(std::size_t componentIndex)
             event.Skip();
             return;
          }
-
-         if (componentScroll_) {
-            int wheelDelta = event.GetWheelDelta();
-            if (wheelDelta == 0) {
-               wheelDelta = 120;
-            }
-            int wheelSteps = event.GetWheelRotation() / wheelDelta;
-            if (wheelSteps == 0) {
-               wheelSteps = (event.GetWheelRotation() > 0) ? 1 : -1;
-            }
-            int linesPerAction = event.GetLinesPerAction();
-            if (linesPerAction <= 0) {
-               linesPerAction = 3;
-            }
-            componentScroll_->ScrollLines(-wheelSteps * linesPerAction);
-         }
+         OnComponentMouseWheel(event);
       });
    };
 
-   bindComboWheelProtection(row.sourceBranch);
-   bindComboWheelProtection(row.artifactVersion);
-   bindComboWheelProtection(row.artifactBuildType);
+   bindComboWheelProtection(sourceBranch);
+   bindComboWheelProtection(artifactVersion);
+   bindComboWheelProtection(artifactBuildType);
 
-   if (!component.source.branchOrTag.empty()) {
-      row.sourceBranch->Append(component.source.branchOrTag);
-   }
-   row.sourceBranch->SetValue(component.source.branchOrTag);
-   row.sourceShallow->SetValue(component.source.shallow);
-
-   if (!component.artifact.version.empty()) {
-      row.artifactVersion->Append(component.artifact.version);
-   }
-   row.artifactVersion->SetValue(component.artifact.version);
-
-   if (!component.artifact.buildType.empty()) {
-      row.artifactBuildType->Append(component.artifact.buildType);
-   }
-   row.artifactBuildType->SetValue(component.artifact.buildType);
-   UpdateRowTooltips(componentIndex);
-
-   row.sourceEnabled->Bind(wxEVT_CHECKBOX, [this, componentIndex](wxCommandEvent &) {
-      if (uiUpdating_) {
+   sourceEnabled->Bind(wxEVT_CHECKBOX, [this, slotIndex](wxCommandEvent &) {
+      const auto componentIndex = rowSlots_[slotIndex].componentIndex;
+      if (uiUpdating_ || componentIndex >= config_.components.size()) {
          return;
       }
-      config_.components[componentIndex].source.enabled = rows_[componentIndex].sourceEnabled->GetValue();
+      config_.components[componentIndex].source.enabled = rowSlots_[slotIndex].sourceEnabled->GetValue();
       RefreshRowEnabledState(componentIndex);
    });
 
-   row.sourceShallow->Bind(wxEVT_CHECKBOX, [this, componentIndex](wxCommandEvent &) {
-      if (uiUpdating_) {
+   sourceShallow->Bind(wxEVT_CHECKBOX, [this, slotIndex](wxCommandEvent &) {
+      const auto componentIndex = rowSlots_[slotIndex].componentIndex;
+      if (uiUpdating_ || componentIndex >= config_.components.size()) {
          return;
       }
-      config_.components[componentIndex].source.shallow = rows_[componentIndex].sourceShallow->GetValue();
+      config_.components[componentIndex].source.shallow = rowSlots_[slotIndex].sourceShallow->GetValue();
    });
 
-   row.artifactEnabled->Bind(wxEVT_CHECKBOX, [this, componentIndex](wxCommandEvent &) {
-      if (uiUpdating_) {
+   artifactEnabled->Bind(wxEVT_CHECKBOX, [this, slotIndex](wxCommandEvent &) {
+      const auto componentIndex = rowSlots_[slotIndex].componentIndex;
+      if (uiUpdating_ || componentIndex >= config_.components.size()) {
          return;
       }
-      config_.components[componentIndex].artifact.enabled = rows_[componentIndex].artifactEnabled->GetValue();
+      config_.components[componentIndex].artifact.enabled = rowSlots_[slotIndex].artifactEnabled->GetValue();
       RefreshRowEnabledState(componentIndex);
    });
 
-   row.sourceBranch->Bind(wxEVT_TEXT, [this, componentIndex](wxCommandEvent &) {
-      UpdateComboTooltip(*rows_[componentIndex].sourceBranch);
-      if (uiUpdating_) {
+   sourceBranch->Bind(wxEVT_TEXT, [this, slotIndex](wxCommandEvent &) {
+      UpdateComboTooltip(*rowSlots_[slotIndex].sourceBranch);
+      const auto componentIndex = rowSlots_[slotIndex].componentIndex;
+      if (uiUpdating_ || componentIndex >= config_.components.size()) {
          return;
       }
       rowChangeState_[componentIndex].sourceBranchTouched = true;
       config_.components[componentIndex].source.branchOrTag =
-          rows_[componentIndex].sourceBranch->GetValue().ToStdString();
+          rowSlots_[slotIndex].sourceBranch->GetValue().ToStdString();
       RefreshRowModifiedIndicator(componentIndex);
+      ScheduleRefSearch(componentIndex);
    });
-   row.sourceBranch->Bind(wxEVT_COMBOBOX, [this, componentIndex](wxCommandEvent &) {
-      UpdateComboTooltip(*rows_[componentIndex].sourceBranch);
-      if (uiUpdating_) {
+   sourceBranch->Bind(wxEVT_COMBOBOX, [this, slotIndex](wxCommandEvent &) {
+      UpdateComboTooltip(*rowSlots_[slotIndex].sourceBranch);
+      const auto componentIndex = rowSlots_[slotIndex].componentIndex;
+      if (uiUpdating_ || componentIndex >= config_.components.size()) {
          return;
       }
       rowChangeState_[componentIndex].sourceBranchTouched = true;
       config_.components[componentIndex].source.branchOrTag =
-          rows_[componentIndex].sourceBranch->GetValue().ToStdString();
+          rowSlots_[slotIndex].sourceBranch->GetValue().ToStdString();
       RefreshRowModifiedIndicator(componentIndex);
    });
-   row.sourceBranch->Bind(wxEVT_COMBOBOX_DROPDOWN, [this, componentIndex](wxCommandEvent &) {
+   sourceBranch->Bind(wxEVT_COMBOBOX_DROPDOWN, [this, slotIndex](wxCommandEvent &event) {
+      event.Skip();
       if (uiUpdating_) {
          return;
       }
-      EnqueueSourceRefsFetch(componentIndex, true);
+      EnqueueSourceRefsFetch(rowSlots_[slotIndex].componentIndex, true);
    });
 
-   row.artifactVersion->Bind(wxEVT_TEXT, [this, componentIndex](wxCommandEvent &) {
-      UpdateComboTooltip(*rows_[componentIndex].artifactVersion);
-      if (uiUpdating_) {
+   artifactVersion->Bind(wxEVT_TEXT, [this, slotIndex](wxCommandEvent &) {
+      UpdateComboTooltip(*rowSlots_[slotIndex].artifactVersion);
+      const auto componentIndex = rowSlots_[slotIndex].componentIndex;
+      if (uiUpdating_ || componentIndex >= config_.components.size()) {
          return;
       }
       rowChangeState_[componentIndex].artifactVersionTouched = true;
       config_.components[componentIndex].artifact.version =
-          rows_[componentIndex].artifactVersion->GetValue().ToStdString();
+          rowSlots_[slotIndex].artifactVersion->GetValue().ToStdString();
       RefreshRowModifiedIndicator(componentIndex);
    });
-   row.artifactVersion->Bind(wxEVT_COMBOBOX, [this, componentIndex](wxCommandEvent &) {
-      UpdateComboTooltip(*rows_[componentIndex].artifactVersion);
-      if (uiUpdating_) {
+   artifactVersion->Bind(wxEVT_COMBOBOX, [this, slotIndex](wxCommandEvent &) {
+      UpdateComboTooltip(*rowSlots_[slotIndex].artifactVersion);
+      const auto componentIndex = rowSlots_[slotIndex].componentIndex;
+      if (uiUpdating_ || componentIndex >= config_.components.size()) {
          return;
       }
       rowChangeState_[componentIndex].artifactVersionTouched = true;
-      const auto version                                     = rows_[componentIndex].artifactVersion->GetValue().ToStdString();
+      const auto version                                     = rowSlots_[slotIndex].artifactVersion->GetValue().ToStdString();
       config_.components[componentIndex].artifact.version    = version;
       RefreshRowModifiedIndicator(componentIndex);
       EnqueueBuildTypeFetch(componentIndex, version);
    });
-   row.artifactVersion->Bind(wxEVT_COMBOBOX_DROPDOWN, [this, componentIndex](wxCommandEvent &) {
+   artifactVersion->Bind(wxEVT_COMBOBOX_DROPDOWN, [this, slotIndex](wxCommandEvent &event) {
+      event.Skip();
       if (uiUpdating_) {
          return;
       }
-      EnqueueVersionFetch(componentIndex, true);
+      EnqueueVersionFetch(rowSlots_[slotIndex].componentIndex, true);
    });
 
-   row.artifactBuildType->Bind(wxEVT_TEXT, [this, componentIndex](wxCommandEvent &) {
-      UpdateComboTooltip(*rows_[componentIndex].artifactBuildType);
-      if (uiUpdating_) {
+   artifactBuildType->Bind(wxEVT_TEXT, [this, slotIndex](wxCommandEvent &) {
+      UpdateComboTooltip(*rowSlots_[slotIndex].artifactBuildType);
+      const auto componentIndex = rowSlots_[slotIndex].componentIndex;
+      if (uiUpdating_ || componentIndex >= config_.components.size()) {
          return;
       }
       rowChangeState_[componentIndex].artifactBuildTypeTouched = true;
       config_.components[componentIndex].artifact.buildType =
-          rows_[componentIndex].artifactBuildType->GetValue().ToStdString();
+          rowSlots_[slotIndex].artifactBuildType->GetValue().ToStdString();
       RefreshRowModifiedIndicator(componentIndex);
    });
-   row.artifactBuildType->Bind(wxEVT_COMBOBOX, [this, componentIndex](wxCommandEvent &) {
-      UpdateComboTooltip(*rows_[componentIndex].artifactBuildType);
-      if (uiUpdating_) {
+   artifactBuildType->Bind(wxEVT_COMBOBOX, [this, slotIndex](wxCommandEvent &) {
+      UpdateComboTooltip(*rowSlots_[slotIndex].artifactBuildType);
+      const auto componentIndex = rowSlots_[slotIndex].componentIndex;
+      if (uiUpdating_ || componentIndex >= config_.components.size()) {
          return;
       }
       rowChangeState_[componentIndex].artifactBuildTypeTouched = true;
       config_.components[componentIndex].artifact.buildType =
-          rows_[componentIndex].artifactBuildType->GetValue().ToStdString();
+          rowSlots_[slotIndex].artifactBuildType->GetValue().ToStdString();
       RefreshRowModifiedIndicator(componentIndex);
    });
+}
 
+void MainFrame::BindRowSlot(std::size_t slotIndex, std::size_t componentIndex)
+{
+   auto &row             = rowSlots_[slotIndex];
+   const auto &component = config_.components[componentIndex];
+   const auto &items     = rowItems_[componentIndex];
+   row.componentIndex    = componentIndex;
+
+   const bool wasUpdating = uiUpdating_;
+   uiUpdating_            = true;
+   row.box->SetLabel(wxString::Format("%s  (%s)", component.displayName, component.path));
+   ReplaceComboItems(*row.sourceBranch, items.sourceRefs);
+   row.sourceBranch->SetValue(component.source.branchOrTag);
+   ReplaceComboItems(*row.artifactVersion, items.versions);
+   row.artifactVersion->SetValue(component.artifact.version);
+   ReplaceComboItems(*row.artifactBuildType, items.buildTypes);
+   row.artifactBuildType->SetValue(component.artifact.buildType);
+   uiUpdating_ = wasUpdating;
+
+   UpdateRowTooltips(componentIndex);
    RefreshRowModifiedIndicator(componentIndex);
    RefreshRowEnabledState(componentIndex);
 }
@@ -664,16 +1178,45 @@ void MainFrame::UpdateComboTooltip(wxComboBox &comboBox)
    comboBox.SetToolTip(value);
 }
 
+bool MainFrame::ReplaceComboItems(wxComboBox &comboBox, const std::vector<std::string> &items)
+{
+   // Revalidations usually return what is already shown; leaving those combos
+   // alone avoids flicker and the cost of rebuilding long lists.
+   bool unchanged = comboBox.GetCount() == items.size();
+   for (std::size_t i = 0; unchanged && i < items.size(); ++i) {
+      unchanged = comboBox.GetString(static_cast<unsigned int>(i)).ToStdString() == items[i];
+   }
+   if (unchanged) {
+      return false;
+   }
+
+   wxArrayString values;
+   values.Alloc(items.size());
+   for (const auto &item : items) {
+      values.Add(item);
+   }
+   const auto previousSelection = comboBox.GetValue().ToStdString();
+   const bool wasUpdating       = uiUpdating_;
+   uiUpdating_                  = true;
+   comboBox.Set(values);
+   if (!previousSelection.empty()) {
+      comboBox.SetValue(previousSelection);
+   }
+   uiUpdating_ = wasUpdating;
+   UpdateComboTooltip(comboBox);
+   return true;
+}
+
 void MainFrame::UpdateRowTooltips(std::size_t componentIndex)
 {
-   if (componentIndex >= rows_.size()) {
+   const auto *row = FindRowSlot(componentIndex);
+   if (row == nullptr) {
       return;
    }
 
-   const auto &row = rows_[componentIndex];
-   UpdateComboTooltip(*row.sourceBranch);
-   UpdateComboTooltip(*row.artifactVersion);
-   UpdateComboTooltip(*row.artifactBuildType);
+   UpdateComboTooltip(*row->sourceBranch);
+   UpdateComboTooltip(*row->artifactVersion);
+   UpdateComboTooltip(*row->artifactBuildType);
 }
 
 void MainFrame::RefreshRowModifiedIndicator(std::size_t componentIndex)
@@ -685,7 +1228,7 @@ void MainFrame::RefreshRowModifiedIndicator(std::size_t componentIndex)
 
    const auto &component = config_.components[componentIndex];
    const auto &baseline  = rowBaselines_[componentIndex];
-   auto &state           = rowChangeState_[componentIndex];
+   const auto &state     = rowChangeState_[componentIndex];
 
    const bool sourceModified =
        state.sourceBranchTouched && component.source.branchOrTag != baseline.sourceBranch;
@@ -696,29 +1239,31 @@ void MainFrame::RefreshRowModifiedIndicator(std::size_t componentIndex)
 
    const bool isModified = sourceModified || versionModified || buildTypeModified;
 
-   if (!state.modifiedIndicator) {
+   const auto *row = FindRowSlot(componentIndex);
+   if (row == nullptr) {
       return;
    }
 
-   const auto inactiveColour = componentContentPanel_ ? componentContentPanel_->GetBackgroundColour() : wxNullColour;
-   state.modifiedIndicator->SetBackgroundColour(isModified ? kModifiedIndicatorActiveColour : inactiveColour);
-   state.modifiedIndicator->Refresh();
+   const auto inactiveColour = componentViewport_ ? componentViewport_->GetBackgroundColour() : wxNullColour;
+   row->modifiedIndicator->SetBackgroundColour(isModified ? kModifiedIndicatorActiveColour : inactiveColour);
+   row->modifiedIndicator->Refresh();
 
    if (isModified) {
-      state.modifiedIndicator->SetToolTip("Modified from XML");
+      row->modifiedIndicator->SetToolTip("Modified from XML");
    } else {
-      state.modifiedIndicator->UnsetToolTip();
+      row->modifiedIndicator->UnsetToolTip();
    }
 }
 
 void MainFrame::RefreshRowEnabledState(std::size_t componentIndex)
 {
-   if (componentIndex >= config_.components.size() || componentIndex >= rows_.size()) {
+   auto *slot = FindRowSlot(componentIndex);
+   if (slot == nullptr) {
       return;
    }
 
    const auto &component = config_.components[componentIndex];
-   auto &row             = rows_[componentIndex];
+   auto &row             = *slot;
 
    const bool sourceExists   = HasSource(component);
    const bool artifactExists = HasArtifact(component);
@@ -743,17 +1288,23 @@ void MainFrame::EnqueueSourceRefsFetch(std::size_t componentIndex, bool prioriti
    if (!HasSource(config_.components[componentIndex]) || config_.components[componentIndex].source.url.empty()) {
       return;
    }
-   if (metadataState_[componentIndex].sourceRefsLoaded && !prioritize) {
+   const auto repositoryUrl = GitClient::NormalizeRepositoryUrl(config_.components[componentIndex].source.url);
+   if (metadataState_[componentIndex].sourceRefsLoaded &&
+       (!prioritize ||
+           metadataCache_->GetFreshness(BuildSourceRefsCacheKey(repositoryUrl)) == MetadataCache::Freshness::Fresh)) {
       return;
    }
 
    MetadataTask task;
    task.type           = MetadataTaskType::SourceRefs;
    task.componentIndex = componentIndex;
-   const auto key      = "s:" + std::to_string(componentIndex);
+   task.repositoryUrl  = repositoryUrl;
+   task.interactive    = prioritize;
+   const auto key      = "s:" + repositoryUrl;
 
    // Queue semantics:
-   // - At most one queued source-ref task per component key.
+   // - At most one queued source-ref task per repository URL, however many
+   //   components point at it.
    // - Prioritized requests move the existing queued task to the front.
    // - Deduplication applies to queued tasks; once dequeued, a new request can
    //   be queued even if an older one is still in-flight.
@@ -764,8 +1315,9 @@ void MainFrame::EnqueueSourceRefsFetch(std::size_t componentIndex, bool prioriti
             return;
          }
          for (auto it = metadataTasks_.begin(); it != metadataTasks_.end(); ++it) {
-            if (it->type == MetadataTaskType::SourceRefs && it->componentIndex == componentIndex) {
+            if (it->type == MetadataTaskType::SourceRefs && it->repositoryUrl == repositoryUrl) {
                std::rotate(metadataTasks_.begin(), it, it + 1);
+               metadataTasks_.front().interactive = true;
                break;
             }
          }
@@ -782,6 +1334,230 @@ void MainFrame::EnqueueSourceRefsFetch(std::size_t componentIndex, bool prioriti
    metadataCv_.notify_one();
 }
 
+void MainFrame::SetSourceRefsLoading(const std::string &repositoryUrl, bool loading)
+{
+   for (std::size_t i = 0; i < componentSourceRequests_.size() && i < metadataState_.size(); ++i) {
+      if (!componentSourceRequests_[i].empty() &&
+          GitClient::NormalizeRepositoryUrl(componentSourceRequests_[i]) == repositoryUrl) {
+         metadataState_[i].sourceRefsLoading = loading;
+      }
+   }
+}
+
+void MainFrame::ApplySourceRefs(const std::string &repositoryUrl, const std::vector<std::string> &refs, bool loaded)
+{
+   sourceRefsByUrl_[repositoryUrl] = refs;
+   const auto shownCount           = std::min(refs.size(), kMaxComboRefs);
+   const std::vector<std::string> shownRefs(refs.begin(), refs.begin() + static_cast<std::ptrdiff_t>(shownCount));
+   for (std::size_t i = 0; i < componentSourceRequests_.size(); ++i) {
+      if (i >= metadataState_.size() || componentSourceRequests_[i].empty() ||
+          GitClient::NormalizeRepositoryUrl(componentSourceRequests_[i]) != repositoryUrl) {
+         continue;
+      }
+
+      metadataState_[i].sourceRefsLoaded    = loaded;
+      metadataState_[i].sourceRefsTruncated = shownCount < refs.size();
+      rowItems_[i].sourceRefs               = shownRefs;
+      if (auto *row = FindRowSlot(i)) {
+         ReplaceComboItems(*row->sourceBranch, shownRefs);
+      }
+   }
+}
+
+void MainFrame::ApplyVersions(std::size_t componentIndex, const std::vector<std::string> &versions, bool loaded)
+{
+   if (componentIndex >= metadataState_.size() || componentIndex >= config_.components.size()) {
+      return;
+   }
+
+   metadataState_[componentIndex].versionsLoaded = loaded;
+   rowItems_[componentIndex].versions            = versions;
+   if (auto *row = FindRowSlot(componentIndex)) {
+      ReplaceComboItems(*row->artifactVersion, versions);
+   }
+   if (!config_.components[componentIndex].artifact.version.empty()) {
+      EnqueueBuildTypeFetch(componentIndex, config_.components[componentIndex].artifact.version);
+   }
+   // Speculatively list the newest versions too; they are the likeliest
+   // picks and ride along in the same batched task.
+   const auto prefetchCount = AppSettings::Get().GetBuildTypePrefetchCount();
+   if (prefetchCount > 0) {
+      EnqueueBuildTypeBatch(componentIndex, NexusClient::SelectNewestVersions(versions, prefetchCount), false);
+   }
+}
+
+void MainFrame::ApplyBuildTypes(std::size_t componentIndex,
+    const std::string &version,
+    const std::vector<std::string> &buildTypes)
+{
+   if (componentIndex >= metadataState_.size() || componentIndex >= config_.components.size()) {
+      return;
+   }
+
+   metadataState_[componentIndex].buildTypesByVersion[version] = buildTypes;
+   if (config_.components[componentIndex].artifact.version == version) {
+      SetBuildTypeItems(componentIndex, buildTypes);
+   }
+}
+
+void MainFrame::SetBuildTypeItems(std::size_t componentIndex, const std::vector<std::string> &buildTypes)
+{
+   rowItems_[componentIndex].buildTypes = buildTypes;
+   if (auto *row = FindRowSlot(componentIndex)) {
+      ReplaceComboItems(*row->artifactBuildType, buildTypes);
+   }
+}
+
+void MainFrame::PopulateFromMetadataCache()
+{
+   // Cached lists fill the combos immediately. Fresh entries count as loaded;
+   // stale or missing ones are (re)fetched in the background as usual.
+   std::unordered_set<std::string> cachedRepositories;
+   std::vector<std::string> values;
+   for (std::size_t i = 0; i < config_.components.size(); ++i) {
+      const auto &requestUrl = componentSourceRequests_[i];
+      if (HasSource(config_.components[i]) && !requestUrl.empty() && !metadataState_[i].sourceRefsLoaded) {
+         const auto repositoryUrl = GitClient::NormalizeRepositoryUrl(requestUrl);
+         if (cachedRepositories.insert(repositoryUrl).second) {
+            const auto freshness = metadataCache_->Lookup(BuildSourceRefsCacheKey(repositoryUrl), values);
+            if (freshness != MetadataCache::Freshness::Missing) {
+               ApplySourceRefs(repositoryUrl, values, freshness == MetadataCache::Freshness::Fresh);
+            }
+         }
+      }
+
+      const auto &request = componentArtifactRequests_[i];
+      if (!HasArtifact(config_.components[i]) || request.first.empty()) {
+         continue;
+      }
+      // Build types first: a fresh hit lands in buildTypesByVersion, so the
+      // build-type fetch ApplyVersions queues for the current version is skipped.
+      const auto &state   = metadataState_[i];
+      const auto &version = config_.components[i].artifact.version;
+      if (!version.empty() && state.buildTypesByVersion.find(version) == state.buildTypesByVersion.end()) {
+         const auto freshness = metadataCache_->Lookup(BuildBuildTypesCacheKey(request, version), values);
+         if (freshness == MetadataCache::Freshness::Fresh) {
+            ApplyBuildTypes(i, version, values);
+         } else if (freshness == MetadataCache::Freshness::Stale) {
+            SetBuildTypeItems(i, values);
+         }
+      }
+      if (state.versionsLoaded) {
+         continue;
+      }
+      const auto freshness = metadataCache_->Lookup(BuildVersionsCacheKey(request), values);
+      if (freshness != MetadataCache::Freshness::Missing) {
+         ApplyVersions(i, values, freshness == MetadataCache::Freshness::Fresh);
+      }
+   }
+}
+
+void MainFrame::ScheduleRefSearch(std::size_t componentIndex)
+{
+   if (componentIndex >= metadataState_.size() || !metadataState_[componentIndex].sourceRefsTruncated) {
+      return;
+   }
+   refSearchComponent_ = componentIndex;
+   refSearchTimer_->StartOnce(kRefSearchDebounceMs);
+}
+
+void MainFrame::OnRefSearchTimer(wxTimerEvent &)
+{
+   const auto index = refSearchComponent_;
+   if (index >= config_.components.size() || index >= componentSourceRequests_.size() ||
+       componentSourceRequests_[index].empty()) {
+      return;
+   }
+
+   const auto generation    = ++refSearchGeneration_;
+   const auto filterText    = config_.components[index].source.branchOrTag;
+   const auto repositoryUrl = GitClient::NormalizeRepositoryUrl(componentSourceRequests_[index]);
+   if (!RefListingService::SupportsSearch(repositoryUrl)) {
+      bool hasMore       = false;
+      const auto matches = RefListingService::FilterRefs(sourceRefsByUrl_[repositoryUrl], filterText, kRefSearchPageSize, hasMore);
+      ShowRefSearchResults(index, generation, matches, hasMore);
+      return;
+   }
+
+   MetadataTask task;
+   task.type           = MetadataTaskType::SourceRefSearch;
+   task.componentIndex = index;
+   task.repositoryUrl  = repositoryUrl;
+   task.filterText     = filterText;
+   task.generation     = generation;
+   task.interactive    = true;
+   {
+      std::scoped_lock lock(metadataMutex_);
+      // Only the latest search matters; drop any that have not started yet.
+      metadataTasks_.erase(std::remove_if(metadataTasks_.begin(),
+                               metadataTasks_.end(),
+                               [](const MetadataTask &queued) { return queued.type == MetadataTaskType::SourceRefSearch; }),
+          metadataTasks_.end());
+      metadataTasks_.push_front(std::move(task));
+   }
+   metadataCv_.notify_one();
+}
+
+void MainFrame::ShowRefSearchResults(std::size_t componentIndex,
+    std::uint64_t generation,
+    const std::vector<std::string> &refs,
+    bool hasMore)
+{
+   if (generation != refSearchGeneration_.load() || componentIndex >= rowItems_.size()) {
+      return;
+   }
+
+   // The matches replace the row's list even if it scrolled out of view
+   // meanwhile; they are shown when it comes back.
+   rowItems_[componentIndex].sourceRefs = refs;
+   auto *row                            = FindRowSlot(componentIndex);
+   if (row == nullptr) {
+      return;
+   }
+
+   auto *sourceBranch        = row->sourceBranch;
+   const auto typedText      = sourceBranch->GetValue();
+   const auto insertionPoint = sourceBranch->GetInsertionPoint();
+
+   wxArrayString values;
+   values.Alloc(refs.size());
+   for (const auto &ref : refs) {
+      values.Add(ref);
+   }
+   uiUpdating_ = true;
+   sourceBranch->Set(values);
+   sourceBranch->ChangeValue(typedText);
+   sourceBranch->SetInsertionPoint(insertionPoint);
+   uiUpdating_ = false;
+   sourceBranch->SetToolTip(hasMore
+           ? wxString::Format("%s\nShowing the first %zu matches; keep typing to narrow down.", typedText, refs.size())
+           : typedText);
+}
+
+void MainFrame::RunSourceRefSearch(const MetadataTask &task, const std::string &settingsPath)
+{
+   if (task.generation != refSearchGeneration_.load() || settingsPath.empty()) {
+      return;
+   }
+
+   AuthCredentials credentials;
+   std::string errorMessage;
+   if (!credentials.LoadFromM2SettingsXml(settingsPath, errorMessage)) {
+      return;
+   }
+
+   std::vector<std::string> refs;
+   bool hasMore = false;
+   RefListingService refListing(std::move(credentials));
+   if (!refListing.SearchBranchesAndTags(task.repositoryUrl, task.filterText, kRefSearchPageSize, refs, hasMore, errorMessage)) {
+      CONFY_LOG(LogModule::Metadata, LogLevel::Warning, "ref search failed for %s: %s", task.repositoryUrl.c_str(), errorMessage.c_str());
+      return;
+   }
+   PostUiUpdate([this, index = task.componentIndex, generation = task.generation, refs = std::move(refs), hasMore]() {
+      ShowRefSearchResults(index, generation, refs, hasMore);
+   });
+}
+
 void MainFrame::StartMetadataWorkers()
 {
    std::scoped_lock lock(metadataMutex_);
@@ -789,7 +1565,7 @@ void MainFrame::StartMetadataWorkers()
       return;
    }
    // Two background workers process metadata in parallel. UI work remains on
-   // the main thread and is posted via CallAfter from worker code.
+   // the main thread and is posted via PostUiUpdate from worker code.
    stopMetadataWorkers_ = false;
    metadataWorkers_.emplace_back(&MainFrame::MetadataWorkerLoop, this);
    metadataWorkers_.emplace_back(&MainFrame::MetadataWorkerLoop, this);
@@ -813,6 +1589,11 @@ void MainFrame::StopMetadataWorkers()
       }
    }
    metadataWorkers_.clear();
+
+   std::string cacheError;
+   if (metadataCache_ && !metadataCache_->SaveIfModified(cacheError)) {
+      CONFY_LOG(LogModule::Metadata, LogLevel::Warning, "%s", cacheError.c_str());
+   }
 }
 
 void MainFrame::EnqueueVersionFetch(std::size_t componentIndex, bool prioritize)
@@ -830,6 +1611,7 @@ void MainFrame::EnqueueVersionFetch(std::size_t componentIndex, bool prioritize)
    MetadataTask task;
    task.type           = MetadataTaskType::Versions;
    task.componentIndex = componentIndex;
+   task.interactive    = prioritize;
    const auto key      = "v:" + std::to_string(componentIndex);
 
    // Same queueing contract as source refs: dedupe by key while queued and
@@ -843,6 +1625,7 @@ void MainFrame::EnqueueVersionFetch(std::size_t componentIndex, bool prioritize)
          for (auto it = metadataTasks_.begin(); it != metadataTasks_.end(); ++it) {
             if (it->type == MetadataTaskType::Versions && it->componentIndex == componentIndex) {
                std::rotate(metadataTasks_.begin(), it, it + 1);
+               metadataTasks_.front().interactive = true;
                break;
             }
          }
@@ -871,37 +1654,65 @@ void MainFrame::EnqueueBuildTypeFetch(std::size_t componentIndex, const std::str
    const auto hit = state.buildTypesByVersion.find(version);
    if (hit != state.buildTypesByVersion.end()) {
       // Cache hit; apply the previously-fetched build types to the dropdown
-      auto &buildTypeBox           = rows_[componentIndex].artifactBuildType;
-      const auto previousSelection = buildTypeBox->GetValue().ToStdString();
-      uiUpdating_                  = true;
-      buildTypeBox->Clear();
-      for (const auto &buildType : hit->second) {
-         buildTypeBox->Append(buildType);
-      }
-      if (!previousSelection.empty()) {
-         buildTypeBox->SetValue(previousSelection);
-      }
-      uiUpdating_ = false;
-      UpdateComboTooltip(*buildTypeBox);
+      SetBuildTypeItems(componentIndex, hit->second);
       return;
    }
-   // Already in-flight for this version; wait for the worker callback.
-   if (state.buildTypesLoadingVersions.find(version) != state.buildTypesLoadingVersions.end()) {
+   EnqueueBuildTypeBatch(componentIndex, {version}, true);
+}
+
+void MainFrame::EnqueueBuildTypeBatch(std::size_t componentIndex, const std::vector<std::string> &versions, bool prioritize)
+{
+   if (componentIndex >= metadataState_.size()) {
+      return;
+   }
+   // Skip versions that are known or already being listed.
+   const auto &state = metadataState_[componentIndex];
+   std::vector<std::string> missing;
+   for (const auto &version : versions) {
+      if (!version.empty() && state.buildTypesByVersion.find(version) == state.buildTypesByVersion.end() &&
+          state.buildTypesLoadingVersions.find(version) == state.buildTypesLoadingVersions.end()) {
+         missing.push_back(version);
+      }
+   }
+   if (missing.empty()) {
       return;
    }
 
-   MetadataTask task;
-   task.type           = MetadataTaskType::BuildTypes;
-   task.componentIndex = componentIndex;
-   task.version        = version;
-   const auto key      = "b:" + std::to_string(componentIndex) + ":" + version;
-   // Build-type tasks are version-scoped and deduped per component+version key.
+   const auto key = "b:" + std::to_string(componentIndex);
+   // One queued build-type task per component: versions requested while it
+   // waits (e.g. the user stepping through the version list) join that task
+   // instead of each costing a separate request.
    {
       std::scoped_lock lock(metadataMutex_);
       if (metadataTaskKeys_.find(key) != metadataTaskKeys_.end()) {
+         for (auto it = metadataTasks_.begin(); it != metadataTasks_.end(); ++it) {
+            if (it->type != MetadataTaskType::BuildTypes || it->componentIndex != componentIndex) {
+               continue;
+            }
+            for (auto &version : missing) {
+               if (std::find(it->versions.begin(), it->versions.end(), version) == it->versions.end()) {
+                  it->versions.push_back(std::move(version));
+               }
+            }
+            if (prioritize) {
+               std::rotate(metadataTasks_.begin(), it, it + 1);
+               metadataTasks_.front().interactive = true;
+            }
+            break;
+         }
          return;
       }
-      metadataTasks_.push_front(task);
+
+      MetadataTask task;
+      task.type           = MetadataTaskType::BuildTypes;
+      task.componentIndex = componentIndex;
+      task.versions       = std::move(missing);
+      task.interactive    = prioritize;
+      if (prioritize) {
+         metadataTasks_.push_front(std::move(task));
+      } else {
+         metadataTasks_.push_back(std::move(task));
+      }
       metadataTaskKeys_.insert(key);
    }
    metadataCv_.notify_one();
@@ -909,25 +1720,13 @@ void MainFrame::EnqueueBuildTypeFetch(std::size_t componentIndex, const std::str
 
 void MainFrame::MetadataWorkerLoop()
 {
-#ifdef _WIN32
-   std::string homeDir;
-   if (const char *h = std::getenv("USERPROFILE")) {
-      homeDir = h;
-   } else {
-      const char *drive    = std::getenv("HOMEDRIVE");
-      const char *homepath = std::getenv("HOMEPATH");
-      if (drive && homepath) {
-         homeDir = std::string(drive) + homepath;
-      }
-   }
-#else
-   const char *homeEnv       = std::getenv("HOME");
-   const std::string homeDir = homeEnv ? homeEnv : "";
-#endif
-   const std::string settingsPath = homeDir.empty() ? "" : (std::filesystem::path(homeDir) / ".m2" / "settings.xml").string();
+   const std::string settingsPath = AuthCredentials::DefaultM2SettingsPath();
 
    while (true) {
       MetadataTask task;
+      std::string sourceUrl;
+      std::pair<std::string, std::string> request;
+      std::uint64_t configGeneration = 0;
       {
          std::unique_lock lock(metadataMutex_);
          metadataCv_.wait(lock, [this]() { return stopMetadataWorkers_ || !metadataTasks_.empty(); });
@@ -936,74 +1735,72 @@ void MainFrame::MetadataWorkerLoop()
          }
          // Copy one task out while holding the lock, then release the lock and
          // perform network/auth work without blocking other workers/queue ops.
-         task = metadataTasks_.front();
-         metadataTasks_.pop_front();
-         if (task.type == MetadataTaskType::SourceRefs) {
-            metadataTaskKeys_.erase("s:" + std::to_string(task.componentIndex));
+         task = TakeNextMetadataTaskLocked();
+         if (task.type == MetadataTaskType::SourceRefSearch) {
+            // Searches are not keyed; at most one is ever queued.
+         } else if (task.type == MetadataTaskType::SourceRefs) {
+            metadataTaskKeys_.erase("s:" + task.repositoryUrl);
          } else if (task.type == MetadataTaskType::Versions) {
             metadataTaskKeys_.erase("v:" + std::to_string(task.componentIndex));
          } else {
-            metadataTaskKeys_.erase("b:" + std::to_string(task.componentIndex) + ":" + task.version);
+            metadataTaskKeys_.erase("b:" + std::to_string(task.componentIndex));
+         }
+         // A reload may rewrite the request snapshots; take this task's copy
+         // under the lock. Component-indexed results of an older generation
+         // are dropped on the GUI thread, since indices may have moved.
+         configGeneration = metadataGeneration_;
+         if (task.componentIndex < componentSourceRequests_.size()) {
+            sourceUrl = componentSourceRequests_[task.componentIndex];
+         }
+         if (task.componentIndex < componentArtifactRequests_.size()) {
+            request = componentArtifactRequests_[task.componentIndex];
          }
       }
 
-      if (task.type == MetadataTaskType::SourceRefs && task.componentIndex >= componentSourceRequests_.size()) {
+      if (task.type == MetadataTaskType::SourceRefSearch) {
+         RunSourceRefSearch(task, settingsPath);
          continue;
       }
-      std::pair<std::string, std::string> request;
-      if (task.type != MetadataTaskType::SourceRefs) {
-         if (task.componentIndex >= componentArtifactRequests_.size()) {
-            continue;
-         }
-         request = componentArtifactRequests_[task.componentIndex];
-         if (request.first.empty() || request.second.empty()) {
-            continue;
-         }
+      if (task.type == MetadataTaskType::SourceRefs && sourceUrl.empty()) {
+         continue;
       }
-
-      if (task.componentIndex >= metadataState_.size()) {
+      if (task.type != MetadataTaskType::SourceRefs && (request.first.empty() || request.second.empty())) {
          continue;
       }
 
       if (task.type == MetadataTaskType::SourceRefs) {
          // Workers never update wx widgets or GUI-owned metadata state directly.
-         // CallAfter marshals updates onto the main GUI event loop.
-         CallAfter([this, index = task.componentIndex]() {
-            if (index < metadataState_.size()) {
-               metadataState_[index].sourceRefsLoading = true;
-            }
-         });
+         // PostUiUpdate queues updates for the next batch on the GUI thread.
+         PostUiUpdate([this, url = task.repositoryUrl]() { SetSourceRefsLoading(url, true); });
       } else if (task.type == MetadataTaskType::Versions) {
-         CallAfter([this, index = task.componentIndex]() {
-            if (index < metadataState_.size()) {
+         PostUiUpdate([this, index = task.componentIndex, configGeneration]() {
+            if (configGeneration == metadataGeneration_ && index < metadataState_.size()) {
                metadataState_[index].versionsLoading = true;
             }
          });
       } else {
-         CallAfter([this, index = task.componentIndex, version = task.version]() {
-            if (index < metadataState_.size()) {
-               metadataState_[index].buildTypesLoadingVersions.insert(version);
+         PostUiUpdate([this, index = task.componentIndex, versions = task.versions, configGeneration]() {
+            if (configGeneration == metadataGeneration_ && index < metadataState_.size()) {
+               metadataState_[index].buildTypesLoadingVersions.insert(versions.begin(), versions.end());
             }
          });
       }
 
       if (settingsPath.empty()) {
          if (task.type == MetadataTaskType::SourceRefs) {
-            CallAfter([this, index = task.componentIndex]() {
-               if (index < metadataState_.size()) {
-                  metadataState_[index].sourceRefsLoading = false;
-               }
-            });
+            PostUiUpdate([this, url = task.repositoryUrl]() { SetSourceRefsLoading(url, false); });
          } else if (task.type == MetadataTaskType::Versions) {
-            CallAfter([this, index = task.componentIndex]() {
-               if (index < metadataState_.size()) {
+            PostUiUpdate([this, index = task.componentIndex, configGeneration]() {
+               if (configGeneration == metadataGeneration_ && index < metadataState_.size()) {
                   metadataState_[index].versionsLoading = false;
                }
             });
          } else {
-            CallAfter([this, index = task.componentIndex, version = task.version]() {
-               if (index < metadataState_.size()) {
-                  metadataState_[index].buildTypesLoadingVersions.erase(version);
+            PostUiUpdate([this, index = task.componentIndex, versions = task.versions, configGeneration]() {
+               if (configGeneration == metadataGeneration_ && index < metadataState_.size()) {
+                  for (const auto &version : versions) {
+                     metadataState_[index].buildTypesLoadingVersions.erase(version);
+                  }
                }
             });
          }
@@ -1014,11 +1811,7 @@ void MainFrame::MetadataWorkerLoop()
       std::string authError;
       if (!credentials.LoadFromM2SettingsXml(settingsPath, authError)) {
          if (task.type == MetadataTaskType::SourceRefs) {
-            CallAfter([this, index = task.componentIndex]() {
-               if (index < metadataState_.size()) {
-                  metadataState_[index].sourceRefsLoading = false;
-               }
-            });
+            PostUiUpdate([this, url = task.repositoryUrl]() { SetSourceRefsLoading(url, false); });
          }
          continue;
       }
@@ -1026,36 +1819,21 @@ void MainFrame::MetadataWorkerLoop()
       if (task.type == MetadataTaskType::SourceRefs) {
          std::vector<std::string> refs;
          std::string errorMessage;
-         GitClient client(std::move(credentials));
-         const auto ok = client.ListBranchesAndTags(componentSourceRequests_[task.componentIndex], refs, errorMessage);
+         RefListingService refListing(std::move(credentials));
+         const auto ok = refListing.ListBranchesAndTags(sourceUrl, refs, errorMessage);
+         if (ok) {
+            metadataCache_->Store(BuildSourceRefsCacheKey(task.repositoryUrl), refs);
+         }
          // Move fetched data into the posted callback so the worker thread can
          // continue and UI mutation happens only on the event loop thread.
-         CallAfter([this, index = task.componentIndex, refs = std::move(refs), ok]() mutable {
-            if (index >= metadataState_.size() || index >= rows_.size() || index >= config_.components.size()) {
-               return;
+         PostUiUpdate([this, url = task.repositoryUrl, refs = std::move(refs), ok]() mutable {
+            SetSourceRefsLoading(url, false);
+            // A failed revalidation keeps whatever cached refs are already shown.
+            if (ok) {
+               ApplySourceRefs(url, refs, true);
             }
-
-            auto &state             = metadataState_[index];
-            state.sourceRefsLoading = false;
-            state.sourceRefsLoaded  = ok;
-            if (!ok) {
-               return;
-            }
-
-            auto *sourceBranch           = rows_[index].sourceBranch;
-            const auto previousSelection = sourceBranch->GetValue().ToStdString();
-
-            uiUpdating_ = true;
-            sourceBranch->Clear();
-            for (const auto &ref : refs) {
-               sourceBranch->Append(ref);
-            }
-            if (!previousSelection.empty()) {
-               sourceBranch->SetValue(previousSelection);
-            }
-            uiUpdating_ = false;
-            UpdateComboTooltip(*sourceBranch);
          });
+         SaveMetadataCacheIfIdle();
          continue;
       }
 
@@ -1063,80 +1841,172 @@ void MainFrame::MetadataWorkerLoop()
       std::string errorMessage;
       if (task.type == MetadataTaskType::Versions) {
          std::vector<std::string> versions;
-         const auto ok = client.ListComponentVersions(
-             request.first, request.second, versions, errorMessage);
+         const auto ok      = client.ListComponentVersions(request.first, request.second, versions, errorMessage);
+         const auto changed = ok && metadataCache_->Store(BuildVersionsCacheKey(request), versions);
          // Result ownership is transferred to the GUI callback by move-capture.
-         CallAfter([this, index = task.componentIndex, versions = std::move(versions), ok]() mutable {
-            if (index >= metadataState_.size() || index >= rows_.size() || index >= config_.components.size()) {
+         PostUiUpdate([this, index = task.componentIndex, versions = std::move(versions), ok, changed, configGeneration]() mutable {
+            if (configGeneration != metadataGeneration_ || index >= metadataState_.size()) {
                return;
             }
 
             auto &state           = metadataState_[index];
             state.versionsLoading = false;
-            state.versionsLoaded  = ok;
             if (!ok) {
                return;
             }
-
-            auto &versionBox             = rows_[index].artifactVersion;
-            const auto previousSelection = versionBox->GetValue().ToStdString();
-            uiUpdating_                  = true;
-            versionBox->Clear();
-            for (const auto &version : versions) {
-               versionBox->Append(version);
-            }
-            if (!previousSelection.empty()) {
-               versionBox->SetValue(previousSelection);
-            }
-            uiUpdating_ = false;
-            UpdateComboTooltip(*versionBox);
-
-            if (!config_.components[index].artifact.version.empty()) {
-               EnqueueBuildTypeFetch(index, config_.components[index].artifact.version);
+            // Unchanged lists are already on screen from the cache.
+            if (changed || !state.versionsLoaded) {
+               ApplyVersions(index, versions, true);
             }
          });
+         SaveMetadataCacheIfIdle();
          continue;
       }
 
-      std::vector<std::string> buildTypes;
-      const auto ok = client.ListBuildTypes(
-          request.first, request.second, task.version, buildTypes, errorMessage);
-      // Version and payload are copied/moved into the callback to decouple UI
-      // application from worker lifetime and stack storage.
-      CallAfter([this,
-                    index      = task.componentIndex,
-                    version    = task.version,
-                    buildTypes = std::move(buildTypes),
-                    ok]() mutable {
-         if (index >= metadataState_.size() || index >= rows_.size() || index >= config_.components.size()) {
+      std::map<std::string, std::vector<std::string>> buildTypesByVersion;
+      if (!client.ListBuildTypesForVersions(request.first, request.second, task.versions, buildTypesByVersion, errorMessage)) {
+         CONFY_LOG(LogModule::Metadata, LogLevel::Warning, "%s", errorMessage.c_str());
+      }
+      for (const auto &[version, buildTypes] : buildTypesByVersion) {
+         metadataCache_->Store(BuildBuildTypesCacheKey(request, version), buildTypes);
+      }
+      // Payloads are moved into the callback to decouple UI application from
+      // worker lifetime and stack storage.
+      PostUiUpdate([this,
+                    index               = task.componentIndex,
+                    versions            = std::move(task.versions),
+                    buildTypesByVersion = std::move(buildTypesByVersion),
+                    configGeneration]() {
+         if (configGeneration != metadataGeneration_ || index >= metadataState_.size()) {
             return;
          }
 
-         auto &state = metadataState_[index];
-         state.buildTypesLoadingVersions.erase(version);
-         if (!ok) {
-            return;
+         for (const auto &version : versions) {
+            metadataState_[index].buildTypesLoadingVersions.erase(version);
          }
-         state.buildTypesByVersion[version] = buildTypes;
-
-         if (config_.components[index].artifact.version != version) {
-            return;
+         for (const auto &[version, buildTypes] : buildTypesByVersion) {
+            ApplyBuildTypes(index, version, buildTypes);
          }
+      });
+      SaveMetadataCacheIfIdle();
+   }
+}
+
+MainFrame::MetadataTask MainFrame::TakeNextMetadataTaskLocked()
+{
+   // Order of service: tasks the user is interacting with, then tasks for
+   // rows currently on screen, then everything else in queue order. Priority
+   // is decided here rather than at enqueue time so rows that scrolled away
+   // fall back on their own.
+   auto selected = std::find_if(metadataTasks_.begin(), metadataTasks_.end(), [](const MetadataTask &task) {
+      return task.interactive;
+   });
+   if (selected == metadataTasks_.end()) {
+      selected = std::find_if(metadataTasks_.begin(), metadataTasks_.end(), [this](const MetadataTask &task) {
+         return task.componentIndex < visibleComponents_.size() && visibleComponents_[task.componentIndex];
+      });
+   }
+   if (selected == metadataTasks_.end()) {
+      selected = metadataTasks_.begin();
+   }
 
-         auto &buildTypeBox           = rows_[index].artifactBuildType;
-         const auto previousSelection = buildTypeBox->GetValue().ToStdString();
-         uiUpdating_                  = true;
-         buildTypeBox->Clear();
-         for (const auto &buildType : buildTypes) {
-            buildTypeBox->Append(buildType);
+   auto task = std::move(*selected);
+   metadataTasks_.erase(selected);
+   return task;
+}
+
+void MainFrame::PromoteComponentMetadataTasks(std::size_t componentIndex)
+{
+   if (componentIndex >= componentSourceRequests_.size()) {
+      return;
+   }
+   const auto repositoryUrl = componentSourceRequests_[componentIndex].empty()
+                                  ? std::string()
+                                  : GitClient::NormalizeRepositoryUrl(componentSourceRequests_[componentIndex]);
+   bool promoted = false;
+   {
+      std::scoped_lock lock(metadataMutex_);
+      for (auto &task : metadataTasks_) {
+         // Ref tasks are shared per repository and may have been queued by
+         // another component using the same URL.
+         const bool matches = task.componentIndex == componentIndex ||
+                              (task.type == MetadataTaskType::SourceRefs && !repositoryUrl.empty() &&
+                                  task.repositoryUrl == repositoryUrl);
+         if (matches && !task.interactive) {
+            task.interactive = true;
+            promoted         = true;
          }
-         if (!previousSelection.empty()) {
-            buildTypeBox->SetValue(previousSelection);
+      }
+   }
+   if (promoted) {
+      metadataCv_.notify_one();
+   }
+}
+
+void MainFrame::UpdateVisibleComponents()
+{
+   std::vector<char> visible(config_.components.size(), 0);
+   const auto last = std::min(firstVisibleComponent_ + visibleRowCount_, visible.size());
+   for (auto i = firstVisibleComponent_; i < last; ++i) {
+      visible[i] = 1;
+   }
+
+   std::scoped_lock lock(metadataMutex_);
+   visibleComponents_ = std::move(visible);
+}
+
+void MainFrame::PostUiUpdate(std::function<void()> update)
+{
+   bool firstInBatch = false;
+   {
+      std::scoped_lock lock(uiUpdatesMutex_);
+      firstInBatch = pendingUiUpdates_.empty();
+      pendingUiUpdates_.push_back(std::move(update));
+   }
+   // Only the first update of a batch reaches the event loop, to arm the
+   // flush timer; the rest just queue up behind it.
+   if (firstInBatch) {
+      CallAfter([this]() {
+         if (!uiUpdateTimer_->IsRunning()) {
+            uiUpdateTimer_->StartOnce(kUiUpdateIntervalMs);
          }
-         uiUpdating_ = false;
-         UpdateComboTooltip(*buildTypeBox);
       });
    }
 }
 
+void MainFrame::OnUiUpdateTimer(wxTimerEvent &)
+{
+   std::vector<std::function<void()>> updates;
+   {
+      std::scoped_lock lock(uiUpdatesMutex_);
+      updates.swap(pendingUiUpdates_);
+   }
+   if (updates.empty()) {
+      return;
+   }
+
+   // One repaint for the whole batch, however many rows it touched.
+   componentViewport_->Freeze();
+   for (auto &update : updates) {
+      update();
+   }
+   componentViewport_->Thaw();
+}
+
+void MainFrame::SaveMetadataCacheIfIdle()
+{
+   // Writing the whole cache after every response would make a large config
+   // rewrite the file hundreds of times; save once the queue has drained.
+   {
+      std::scoped_lock lock(metadataMutex_);
+      if (!metadataTasks_.empty()) {
+         return;
+      }
+   }
+   std::string cacheError;
+   if (!metadataCache_->SaveIfModified(cacheError)) {
+      CONFY_LOG(LogModule::Metadata, LogLevel::Warning, "%s", cacheError.c_str());
+   }
+}
+
 } // namespace confy
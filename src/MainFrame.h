@@ -1,13 +1,18 @@
 #pragma once
 
+#include "ApplyPlanner.h"
 #include "ConfigModel.h"
+#include "JobTypes.h"
 
 #include <wx/frame.h>
 
+#include <atomic>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -23,13 +28,20 @@ class wxCommandEvent;
 class wxCloseEvent;
 class wxSizeEvent;
 class wxUpdateUIEvent;
+class wxMouseEvent;
 class wxPanel;
-class wxScrolledWindow;
+class wxScrollBar;
 class wxSizer;
+class wxStaticBox;
 class wxStaticText;
+class wxTimer;
+class wxTimerEvent;
 
 namespace confy {
 
+class MetadataCache;
+class TransferHistory;
+
 class MainFrame final : public wxFrame
 {
  public:
@@ -37,14 +49,31 @@ class MainFrame final : public wxFrame
    ~MainFrame() override;
 
  private:
+   static constexpr std::size_t kNoComponent = static_cast<std::size_t>(-1);
+
+   // One recycled row of controls. Only as many slots exist as fit in the
+   // viewport; scrolling rebinds them to other components.
    struct ComponentRowWidgets
    {
+      wxPanel *card{nullptr};
+      wxStaticBox *box{nullptr};
+      wxPanel *modifiedIndicator{nullptr};
       wxCheckBox *sourceEnabled{nullptr};
       wxCheckBox *sourceShallow{nullptr};
       wxComboBox *sourceBranch{nullptr};
       wxCheckBox *artifactEnabled{nullptr};
       wxComboBox *artifactVersion{nullptr};
       wxComboBox *artifactBuildType{nullptr};
+      std::size_t componentIndex{kNoComponent};
+   };
+
+   // Dropdown contents per component, kept outside the widgets so a slot can
+   // be rebound to any component without refetching.
+   struct ComponentRowItems
+   {
+      std::vector<std::string> sourceRefs;
+      std::vector<std::string> versions;
+      std::vector<std::string> buildTypes;
    };
 
    struct ComponentRowBaseline
@@ -56,7 +85,6 @@ class MainFrame final : public wxFrame
 
    struct ComponentRowChangeState
    {
-      wxPanel *modifiedIndicator{nullptr};
       bool sourceBranchTouched{false};
       bool artifactVersionTouched{false};
       bool artifactBuildTypeTouched{false};
@@ -68,21 +96,39 @@ class MainFrame final : public wxFrame
    void OnCloseWindow(wxCloseEvent &event);
    void OnSaveAs(wxCommandEvent &event);
    void OnApply(wxCommandEvent &event);
+   void OnPlanApply(wxCommandEvent &event);
    void OnSelectAll(wxCommandEvent &event);
    void OnDeselectAll(wxCommandEvent &event);
    void OnCopyConfig(wxCommandEvent &event);
    void OnToggleDebugConsole(wxCommandEvent &event);
    void OnUpdateSaveAs(wxUpdateUIEvent &event);
+   void OnUpdateReloadConfig(wxUpdateUIEvent &event);
+   void OnUpdatePlanApply(wxUpdateUIEvent &event);
+   void OnUpdateApply(wxUpdateUIEvent &event);
    void OnUpdateSelectAll(wxUpdateUIEvent &event);
    void OnUpdateDeselectAll(wxUpdateUIEvent &event);
    void OnUpdateCopyConfig(wxUpdateUIEvent &event);
    void OnUpdateDebugConsole(wxUpdateUIEvent &event);
-   void OnFrameSize(wxSizeEvent &event);
+   void OnComponentAreaSize(wxSizeEvent &event);
+   void OnComponentMouseWheel(wxMouseEvent &event);
+   void OnRefSearchTimer(wxTimerEvent &event);
+   std::vector<DownloadJob> BuildApplyJobs() const;
+   void StartApply(std::vector<DownloadJob> jobs, const std::vector<ApplyJobProblem> &problems);
+   void ShowPlanSummary(const std::string &summary);
    void RelayoutComponentArea();
    void RenderConfig();
    bool LoadConfigFromPath(const wxString &path);
-   void AddComponentRow(std::size_t componentIndex);
+   bool ReloadConfigFromPath(const wxString &path);
+   void MergeReloadedConfig(ConfigModel config);
+   static ComponentRowBaseline MakeRowBaseline(const ComponentConfig &component);
+   static ComponentRowItems MakeInitialRowItems(const ComponentConfig &component);
+   void AddRowSlot();
+   void BindRowSlot(std::size_t slotIndex, std::size_t componentIndex);
+   void BindVisibleRows();
+   void ScrollComponentRows(int rowDelta);
+   ComponentRowWidgets *FindRowSlot(std::size_t componentIndex);
    void UpdateComboTooltip(wxComboBox &comboBox);
+   bool ReplaceComboItems(wxComboBox &comboBox, const std::vector<std::string> &items);
    void UpdateRowTooltips(std::size_t componentIndex);
    void RefreshRowModifiedIndicator(std::size_t componentIndex);
    void RefreshRowEnabledState(std::size_t componentIndex);
@@ -90,12 +136,32 @@ class MainFrame final : public wxFrame
    void StopMetadataWorkers();
    void EnqueueVersionFetch(std::size_t componentIndex, bool prioritize);
    void EnqueueBuildTypeFetch(std::size_t componentIndex, const std::string &version);
+   void EnqueueBuildTypeBatch(std::size_t componentIndex, const std::vector<std::string> &versions, bool prioritize);
    void EnqueueSourceRefsFetch(std::size_t componentIndex, bool prioritize);
+   void ApplySourceRefs(const std::string &repositoryUrl, const std::vector<std::string> &refs, bool loaded);
+   void ApplyVersions(std::size_t componentIndex, const std::vector<std::string> &versions, bool loaded);
+   void ApplyBuildTypes(std::size_t componentIndex, const std::string &version, const std::vector<std::string> &buildTypes);
+   void SetBuildTypeItems(std::size_t componentIndex, const std::vector<std::string> &buildTypes);
+   void PopulateFromMetadataCache();
+   void SetSourceRefsLoading(const std::string &repositoryUrl, bool loading);
+   void ScheduleRefSearch(std::size_t componentIndex);
+   void ShowRefSearchResults(std::size_t componentIndex,
+       std::uint64_t generation,
+       const std::vector<std::string> &refs,
+       bool hasMore);
    void MetadataWorkerLoop();
+   void PromoteComponentMetadataTasks(std::size_t componentIndex);
+   void UpdateVisibleComponents();
+   void SaveMetadataCacheIfIdle();
+   // Worker threads hand GUI work to PostUiUpdate; OnUiUpdateTimer applies it
+   // in batches instead of one event per result.
+   void PostUiUpdate(std::function<void()> update);
+   void OnUiUpdateTimer(wxTimerEvent &event);
 
    enum class MetadataTaskType
    {
       SourceRefs,
+      SourceRefSearch,
       Versions,
       BuildTypes
    };
@@ -103,12 +169,30 @@ class MainFrame final : public wxFrame
    {
       MetadataTaskType type{MetadataTaskType::Versions};
       std::size_t componentIndex{0};
-      std::string version;
+      // BuildTypes tasks cover every version still to be listed for the
+      // component; later requests are merged into a queued task.
+      std::vector<std::string> versions;
+      // SourceRefs tasks are per repository: every component sharing the
+      // normalized URL receives the result.
+      std::string repositoryUrl;
+      // SourceRefSearch only: the typed text and the search generation it
+      // belongs to. Superseded searches are dropped before and after the fetch.
+      std::string filterText;
+      std::uint64_t generation{0};
+      // Set when the user asked for this data (open or focused combo);
+      // interactive tasks are served before everything else.
+      bool interactive{false};
    };
+   // Requires metadataMutex_.
+   MetadataTask TakeNextMetadataTaskLocked();
+   void RunSourceRefSearch(const MetadataTask &task, const std::string &settingsPath);
    struct ComponentMetadataState
    {
       bool sourceRefsLoading{false};
       bool sourceRefsLoaded{false};
+      // Set when the ref list is longer than the combo shows; typing then
+      // searches instead of scrolling through thousands of entries.
+      bool sourceRefsTruncated{false};
       bool versionsLoading{false};
       bool versionsLoaded{false};
       std::unordered_map<std::string, std::vector<std::string>> buildTypesByVersion;
@@ -116,34 +200,71 @@ class MainFrame final : public wxFrame
    };
 
    ConfigModel config_;
-   wxScrolledWindow *componentScroll_{nullptr};
-   wxPanel *componentContentPanel_{nullptr};
+   wxPanel *componentViewport_{nullptr};
+   wxScrollBar *componentScrollBar_{nullptr};
    wxSizer *componentListSizer_{nullptr};
    wxButton *applyButton_{nullptr};
-   std::vector<ComponentRowWidgets> rows_;
+   // The component list is virtual: the scroll bar position is the index of
+   // the first component shown, and rowSlots_[k] shows component first + k.
+   std::vector<ComponentRowWidgets> rowSlots_;
+   std::size_t firstVisibleComponent_{0};
+   std::size_t visibleRowCount_{0};
+   int rowHeight_{0};
+   std::vector<ComponentRowItems> rowItems_;
    std::vector<ComponentRowBaseline> rowBaselines_;
    std::vector<ComponentRowChangeState> rowChangeState_;
    std::unordered_set<const wxComboBox *> openComboDropdowns_;
    // GUI-thread state: workers never mutate these directly. Worker results are
-   // marshaled back to the main event loop via CallAfter before touching them.
+   // marshaled back to the main event loop via PostUiUpdate before touching them.
    std::vector<ComponentMetadataState> metadataState_;
 
-   // Per-render request snapshots indexed by component. Workers read from these
-   // after dequeuing a task; RenderConfig rebuilds them only between
-   // StopMetadataWorkers()/StartMetadataWorkers() boundaries.
+   // Per-render request snapshots indexed by component. Workers copy them under
+   // metadataMutex_ when dequeuing a task; RenderConfig rebuilds them with the
+   // workers stopped, a reload replaces them under the lock.
    std::vector<std::string> componentSourceRequests_;
    std::vector<std::pair<std::string, std::string>> componentArtifactRequests_;
    std::string loadedConfigPath_;
    bool uiUpdating_{false};
+   // Thread-safe on its own; shared by the GUI thread and metadata workers.
+   std::unique_ptr<MetadataCache> metadataCache_;
+   // Shared with the download workers of each Apply, which record into it.
+   std::shared_ptr<TransferHistory> transferHistory_;
+   // Plan Apply and the Apply preflight run on checkThread_, one at a time;
+   // checkRunning_ is GUI-thread state. Closing the window sets
+   // checkCancelRequested_ so that the check skips the jobs it has not
+   // started and the join does not wait for all of them.
+   std::thread checkThread_;
+   bool checkRunning_{false};
+   std::atomic<bool> checkCancelRequested_{false};
+   // Full ref lists by normalized repository URL (GUI thread only); combos
+   // only hold a bounded slice of them.
+   std::unordered_map<std::string, std::vector<std::string>> sourceRefsByUrl_;
+
+   // Type-ahead ref search: keystrokes restart the debounce timer, and every
+   // search that fires bumps the generation so older results are ignored.
+   wxTimer *refSearchTimer_{nullptr};
+   std::size_t refSearchComponent_{0};
+   std::atomic<std::uint64_t> refSearchGeneration_{0};
+
+   wxTimer *uiUpdateTimer_{nullptr};
+   std::mutex uiUpdatesMutex_;
+   std::vector<std::function<void()>> pendingUiUpdates_;
 
    // Cross-thread coordination for metadata workers:
-   // - metadataTasks_/metadataTaskKeys_/stopMetadataWorkers_ are protected by metadataMutex_.
+   // - metadataTasks_/metadataTaskKeys_/visibleComponents_/stopMetadataWorkers_ are protected by metadataMutex_,
+   //   as are writes to metadataGeneration_ and to the request snapshots.
    // - metadataTaskKeys_ deduplicates queued work (not currently executing work).
    // - metadataCv_ wakes worker threads when new tasks arrive or shutdown begins.
    std::mutex metadataMutex_;
    std::condition_variable metadataCv_;
    std::deque<MetadataTask> metadataTasks_;
    std::unordered_set<std::string> metadataTaskKeys_;
+   // Per-component flag for rows inside the scroll viewport; refreshed by the
+   // GUI thread on scroll/resize and read by workers when picking a task.
+   std::vector<char> visibleComponents_;
+   // Bumped whenever component indices may refer to other components; worker
+   // results stamped with an older generation are dropped.
+   std::uint64_t metadataGeneration_{0};
    std::vector<std::thread> metadataWorkers_;
    bool stopMetadataWorkers_{false};
    bool exitRequested_{false};
@@ -0,0 +1,109 @@
+#include "MetadataCache.h"
+
+#include <nlohmann/json.hpp>
+
+#include <utility>
+
+namespace confy {
+
+namespace {
+
+using Json = nlohmann::json;
+
+constexpr int kCacheFormatVersion = 1;
+
+std::int64_t NowSeconds()
+{
+   return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+       .count();
+}
+
+} // namespace
+
+MetadataCache::MetadataCache(std::string filePath, std::chrono::seconds timeToLive) :
+    file_(std::move(filePath), kCacheFormatVersion, "metadata cache"),
+    timeToLive_(timeToLive) {}
+
+MetadataCache::Freshness MetadataCache::FreshnessOf(const Entry &entry) const
+{
+   const auto age = NowSeconds() - entry.fetchedAtSeconds;
+   return age >= 0 && age < timeToLive_.count() ? Freshness::Fresh : Freshness::Stale;
+}
+
+MetadataCache::Freshness MetadataCache::Lookup(const std::string &key, std::vector<std::string> &outValues) const
+{
+   std::scoped_lock lock(mutex_);
+   const auto it = entries_.find(key);
+   if (it == entries_.end()) {
+      outValues.clear();
+      return Freshness::Missing;
+   }
+   outValues = it->second.values;
+   return FreshnessOf(it->second);
+}
+
+MetadataCache::Freshness MetadataCache::GetFreshness(const std::string &key) const
+{
+   std::scoped_lock lock(mutex_);
+   const auto it = entries_.find(key);
+   return it == entries_.end() ? Freshness::Missing : FreshnessOf(it->second);
+}
+
+bool MetadataCache::Store(const std::string &key, std::vector<std::string> values)
+{
+   std::scoped_lock lock(mutex_);
+   const auto inserted    = entries_.find(key) == entries_.end();
+   auto &entry            = entries_[key];
+   const auto changed     = inserted || entry.values != values;
+   entry.values           = std::move(values);
+   entry.fetchedAtSeconds = NowSeconds();
+   file_.MarkChanged();
+   return changed;
+}
+
+bool MetadataCache::Load(std::string &errorMessage)
+{
+   std::unordered_map<std::string, Entry> loaded;
+   const auto readEntries = [&loaded](const Json &entries) {
+      for (const auto &item : entries.items()) {
+         Entry entry;
+         entry.fetchedAtSeconds = item.value().at("fetchedAt").get<std::int64_t>();
+         entry.values           = item.value().at("values").get<std::vector<std::string>>();
+         loaded.emplace(item.key(), std::move(entry));
+      }
+   };
+   if (!file_.Read(readEntries, errorMessage)) {
+      return false;
+   }
+
+   std::scoped_lock lock(mutex_);
+   entries_ = std::move(loaded);
+   file_.MarkSaved(file_.Revision());
+   return true;
+}
+
+bool MetadataCache::Save(std::string &errorMessage) const
+{
+   auto entries           = Json::object();
+   std::uint64_t revision = 0;
+   {
+      std::scoped_lock lock(mutex_);
+      for (const auto &[key, entry] : entries_) {
+         entries[key] = {{"fetchedAt", entry.fetchedAtSeconds}, {"values", entry.values}};
+      }
+      revision = file_.Revision();
+   }
+   return file_.Write(entries, revision, errorMessage);
+}
+
+bool MetadataCache::SaveIfModified(std::string &errorMessage) const
+{
+   return !file_.IsModified() || Save(errorMessage);
+}
+
+std::string MetadataCache::BuildKey(const std::string &kind, const std::string &identity)
+{
+   return kind + ":" + identity;
+}
+
+} // namespace confy
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "JsonStoreFile.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace confy {
+
+// Persistent cache of remote metadata lists (git refs, Nexus versions, ...)
+// keyed by a caller-defined string. Entries older than the TTL are still
+// returned, flagged as stale, so callers can show them immediately and
+// revalidate in the background. All methods are thread-safe.
+class MetadataCache final
+{
+ public:
+   enum class Freshness
+   {
+      Missing,
+      Stale,
+      Fresh
+   };
+
+   MetadataCache(std::string filePath, std::chrono::seconds timeToLive);
+
+   Freshness Lookup(const std::string &key, std::vector<std::string> &outValues) const;
+   Freshness GetFreshness(const std::string &key) const;
+   // Returns true when the values differ from the cached ones, so callers
+   // can skip UI updates for revalidations that changed nothing.
+   bool Store(const std::string &key, std::vector<std::string> values);
+
+   // Load replaces the in-memory entries with the file contents; a missing
+   // file is not an error. Save replaces the file atomically, see
+   // JsonStoreFile.
+   bool Load(std::string &errorMessage);
+   bool Save(std::string &errorMessage) const;
+   // Saves only if entries were stored since the last Load/Save.
+   bool SaveIfModified(std::string &errorMessage) const;
+
+   static std::string BuildKey(const std::string &kind, const std::string &identity);
+
+ private:
+   struct Entry
+   {
+      std::vector<std::string> values;
+      std::int64_t fetchedAtSeconds{0};
+   };
+
+   Freshness FreshnessOf(const Entry &entry) const;
+
+   JsonStoreFile file_;
+   std::chrono::seconds timeToLive_;
+   mutable std::mutex mutex_;
+   std::unordered_map<std::string, Entry> entries_;
+};
+
+} // namespace confy
@@ -1,11 +1,14 @@
 #include "NexusClient.h"
 
+#include "HttpTimings.h"
+#include "Log.h"
+#include "ParallelTasks.h"
+
 #include <curl/curl.h>
 
 #include <algorithm>
 #include <cctype>
 #include <chrono>
-#include <cstdarg>
 #include <cstdio>
 #include <filesystem>
 #include <fstream>
@@ -14,35 +17,6 @@
 #include <unordered_set>
 #include <vector>
 
-#if defined(__has_include)
-#if __has_include(<wx/log.h>)
-#include <wx/log.h>
-#define CONFY_HAS_WX_LOG 1
-#endif
-#endif
-
-#ifndef CONFY_HAS_WX_LOG
-namespace {
-
-void FallbackLog(const char *level, const char *format, ...)
-{
-   std::fprintf(stderr, "[nexus][%s] ", level);
-
-   va_list args;
-   va_start(args, format);
-   std::vfprintf(stderr, format, args);
-   va_end(args);
-
-   std::fprintf(stderr, "\n");
-}
-
-} // namespace
-
-#define wxLogMessage(...) FallbackLog("INFO", __VA_ARGS__)
-#define wxLogWarning(...) FallbackLog("WARN", __VA_ARGS__)
-#define wxLogError(...)   FallbackLog("ERROR", __VA_ARGS__)
-#endif
-
 namespace fs = std::filesystem;
 
 namespace {
@@ -358,6 +332,34 @@ bool ExtractPathFromHref(const std::string &href,
 
 namespace confy {
 
+class NexusClient::CurlSession final
+{
+ public:
+   CurlSession() :
+       curl_(curl_easy_init()) {}
+   ~CurlSession()
+   {
+      if (curl_ != nullptr) {
+         curl_easy_cleanup(curl_);
+      }
+   }
+
+   CurlSession(const CurlSession &)            = delete;
+   CurlSession &operator=(const CurlSession &) = delete;
+
+   // Clears the options of the previous request; open connections stay.
+   CURL *Reset()
+   {
+      if (curl_ != nullptr) {
+         curl_easy_reset(curl_);
+      }
+      return curl_;
+   }
+
+ private:
+   CURL *curl_;
+};
+
 NexusClient::NexusClient(AuthCredentials credentials) :
     credentials_(std::move(credentials)) {}
 
@@ -418,7 +420,7 @@ bool NexusClient::ListComponentVersions(const std::string &repositoryBrowseUrl,
     std::vector<std::string> &outVersions,
     std::string &errorMessage) const
 {
-   wxLogMessage("[nexus] listing component versions path='%s' repoUrl='%s'",
+   CONFY_LOG(LogModule::Nexus, LogLevel::Info, "listing component versions path='%s' repoUrl='%s'",
        artifactPath.c_str(),
        repositoryBrowseUrl.c_str());
    outVersions.clear();
@@ -438,7 +440,7 @@ bool NexusClient::ListComponentVersions(const std::string &repositoryBrowseUrl,
       return false;
    }
 
-   wxLogMessage("[nexus] discovered versions path='%s' count=%zu",
+   CONFY_LOG(LogModule::Nexus, LogLevel::Info, "discovered versions path='%s' count=%zu",
        artifactPath.c_str(),
        outVersions.size());
    // Keep per-component version logging bounded to avoid excessive console spam on large repos.
@@ -446,12 +448,12 @@ bool NexusClient::ListComponentVersions(const std::string &repositoryBrowseUrl,
    const auto toLog                         = std::min(outVersions.size(), kMaxLoggedVersions);
    for (std::size_t i = 0; i < toLog; ++i) {
       const auto &version = outVersions[i];
-      wxLogMessage("[nexus] discovered version path='%s' value='%s'",
+      CONFY_LOG(LogModule::Nexus, LogLevel::Debug, "discovered version path='%s' value='%s'",
           artifactPath.c_str(),
           version.c_str());
    }
    if (outVersions.size() > kMaxLoggedVersions) {
-      wxLogMessage("[nexus] additional versions omitted path='%s' omittedCount=%zu",
+      CONFY_LOG(LogModule::Nexus, LogLevel::Info, "additional versions omitted path='%s' omittedCount=%zu",
           artifactPath.c_str(),
           outVersions.size() - kMaxLoggedVersions);
    }
@@ -484,6 +486,100 @@ bool NexusClient::ListBuildTypes(const std::string &repositoryBrowseUrl,
    return true;
 }
 
+bool NexusClient::ListBuildTypesForVersions(const std::string &repositoryBrowseUrl,
+    const std::string &artifactPath,
+    const std::vector<std::string> &versions,
+    std::map<std::string, std::vector<std::string>> &outBuildTypesByVersion,
+    std::string &errorMessage) const
+{
+   outBuildTypesByVersion.clear();
+   RepoInfo repo;
+   if (!ParseRepoInfo(repositoryBrowseUrl, repo)) {
+      errorMessage = "Unable to parse Nexus repository URL: " + repositoryBrowseUrl;
+      return false;
+   }
+
+   ServerCredentials creds;
+   if (!credentials_.TryGetForHost(repo.hostPort, creds)) {
+      errorMessage = "No credentials found in ~/.m2/settings.xml for host '" + repo.hostPort + "'.";
+      return false;
+   }
+
+   constexpr std::size_t kMaxConcurrentListings = 4;
+   std::vector<std::vector<std::string>> buildTypes(versions.size());
+   std::vector<std::string> errors(versions.size());
+   std::vector<char> succeeded(versions.size(), 0);
+   RunParallel(versions.size(), kMaxConcurrentListings, [&](std::size_t i) {
+      succeeded[i] = ListChildDirectories(repo, creds, artifactPath + "/" + versions[i], buildTypes[i], errors[i]) ? 1 : 0;
+   });
+
+   bool allSucceeded = true;
+   for (std::size_t i = 0; i < versions.size(); ++i) {
+      if (succeeded[i]) {
+         outBuildTypesByVersion[versions[i]] = std::move(buildTypes[i]);
+      } else if (allSucceeded) {
+         allSucceeded = false;
+         errorMessage = "Listing build types of version '" + versions[i] + "' failed: " + errors[i];
+      }
+   }
+   CONFY_LOG(LogModule::Nexus, LogLevel::Info, "discovered build types path='%s' versions=%zu listed=%zu",
+       artifactPath.c_str(),
+       versions.size(),
+       outBuildTypesByVersion.size());
+   return allSucceeded;
+}
+
+bool NexusClient::IsNewerVersion(const std::string &lhs, const std::string &rhs)
+{
+   std::size_t i = 0;
+   std::size_t j = 0;
+   while (i < lhs.size() && j < rhs.size()) {
+      const bool lhsDigit = std::isdigit(static_cast<unsigned char>(lhs[i])) != 0;
+      const bool rhsDigit = std::isdigit(static_cast<unsigned char>(rhs[j])) != 0;
+      if (lhsDigit && rhsDigit) {
+         // Compare digit runs by value: skip leading zeros, then longer wins.
+         while (i < lhs.size() && lhs[i] == '0') {
+            ++i;
+         }
+         while (j < rhs.size() && rhs[j] == '0') {
+            ++j;
+         }
+         auto lhsEnd = i;
+         auto rhsEnd = j;
+         while (lhsEnd < lhs.size() && std::isdigit(static_cast<unsigned char>(lhs[lhsEnd]))) {
+            ++lhsEnd;
+         }
+         while (rhsEnd < rhs.size() && std::isdigit(static_cast<unsigned char>(rhs[rhsEnd]))) {
+            ++rhsEnd;
+         }
+         if (lhsEnd - i != rhsEnd - j) {
+            return lhsEnd - i > rhsEnd - j;
+         }
+         const auto order = lhs.compare(i, lhsEnd - i, rhs, j, rhsEnd - j);
+         if (order != 0) {
+            return order > 0;
+         }
+         i = lhsEnd;
+         j = rhsEnd;
+         continue;
+      }
+      if (lhs[i] != rhs[j]) {
+         return lhs[i] > rhs[j];
+      }
+      ++i;
+      ++j;
+   }
+   return lhs.size() - i > rhs.size() - j;
+}
+
+std::vector<std::string> NexusClient::SelectNewestVersions(std::vector<std::string> versions, std::size_t count)
+{
+   count = std::min(count, versions.size());
+   std::partial_sort(versions.begin(), versions.begin() + static_cast<std::ptrdiff_t>(count), versions.end(), &IsNewerVersion);
+   versions.resize(count);
+   return versions;
+}
+
 bool NexusClient::DownloadArtifactTree(const std::string &repositoryBrowseUrl,
     const std::string &artifactPath,
     const std::string &version,
@@ -495,8 +591,8 @@ bool NexusClient::DownloadArtifactTree(const std::string &repositoryBrowseUrl,
     ProgressCallback progress,
     std::string &errorMessage) const
 {
-   wxLogMessage(
-       "[nexus] download request repoUrl='%s' artifactPath='%s' version='%s' buildType='%s' target='%s'",
+   CONFY_LOG(LogModule::Nexus, LogLevel::Info,
+       "download request repoUrl='%s' artifactPath='%s' version='%s' buildType='%s' target='%s'",
        repositoryBrowseUrl.c_str(),
        artifactPath.c_str(),
        version.c_str(),
@@ -504,39 +600,222 @@ bool NexusClient::DownloadArtifactTree(const std::string &repositoryBrowseUrl,
        targetDirectory.c_str());
 
    RepoInfo repo;
-   if (!ParseRepoInfo(repositoryBrowseUrl, repo)) {
-      errorMessage = "Unable to parse Nexus repository URL: " + repositoryBrowseUrl;
-      wxLogError("[nexus] parse repo URL failed: %s", errorMessage.c_str());
+   ServerCredentials creds;
+   if (!ResolveRepository(repositoryBrowseUrl, repo, creds, errorMessage)) {
       return false;
    }
 
-   wxLogMessage("[nexus] parsed baseUrl='%s' repository='%s' hostPort='%s'",
-       repo.baseUrl.c_str(),
-       repo.repository.c_str(),
-       repo.hostPort.c_str());
+   std::vector<NexusArtifactFile> matches;
+   if (!ListMatchingFiles(repo,
+           creds,
+           artifactPath,
+           version,
+           buildType,
+           regexIncludes,
+           regexExcludes,
+           matches,
+           errorMessage)) {
+      return false;
+   }
+
+   if (!ResetDirectoryWithRetries(fs::path(targetDirectory), errorMessage)) {
+      CONFY_LOG(LogModule::Nexus, LogLevel::Error, "target directory reset failed target='%s' error='%s'",
+          targetDirectory.c_str(),
+          errorMessage.c_str());
+      return false;
+   }
+
+   const std::size_t total = matches.size();
+   std::size_t completed   = 0;
+
+   for (const auto &matched : matches) {
+      if (cancelRequested.load()) {
+         CONFY_LOG(LogModule::Nexus, LogLevel::Info, "cancel requested during downloads");
+         return false;
+      }
 
+      const fs::path outputPath = fs::path(targetDirectory) / matched.relativePath;
+      fs::create_directories(outputPath.parent_path());
+
+      std::string downloadError;
+      std::uint64_t currentDownloadedBytes = 0;
+      CONFY_LOG(LogModule::Nexus, LogLevel::Debug, "downloading path='%s' url='%s'",
+          matched.path.c_str(),
+          matched.downloadUrl.c_str());
+      if (!HttpDownloadBinary(
+              matched.downloadUrl,
+              creds,
+              outputPath.string(),
+              cancelRequested,
+              [&](std::uint64_t downloadedBytes, std::uint64_t totalBytes) {
+                 currentDownloadedBytes    = downloadedBytes;
+                 const double fileProgress = totalBytes > 0
+                                                 ? static_cast<double>(downloadedBytes) /
+                                                       static_cast<double>(totalBytes)
+                                                 : 0.0;
+                 const int overallPercent =
+                     static_cast<int>(((static_cast<double>(completed) + fileProgress) * 100.0) /
+                                      static_cast<double>(total));
+                 progress(overallPercent, downloadedBytes, matched.path);
+              },
+              downloadError)) {
+         errorMessage = "Failed downloading '" + matched.path + "': " + downloadError;
+         CONFY_LOG(LogModule::Nexus, LogLevel::Error, "download failed path='%s' error='%s'",
+             matched.path.c_str(),
+             downloadError.c_str());
+         return false;
+      }
+
+      ++completed;
+      const int overallPercent = static_cast<int>((completed * 100) / total);
+      progress(overallPercent, currentDownloadedBytes, matched.path);
+   }
+
+   return true;
+}
+
+bool NexusClient::ListArtifactFiles(const std::string &repositoryBrowseUrl,
+    const std::string &artifactPath,
+    const std::string &version,
+    const std::string &buildType,
+    const std::vector<std::string> &regexIncludes,
+    const std::vector<std::string> &regexExcludes,
+    std::vector<NexusArtifactFile> &outFiles,
+    std::string &errorMessage) const
+{
+   outFiles.clear();
+
+   RepoInfo repo;
    ServerCredentials creds;
-   if (!credentials_.TryGetForHost(repo.hostPort, creds)) {
+   if (!ResolveRepository(repositoryBrowseUrl, repo, creds, errorMessage)) {
+      return false;
+   }
+   if (!ListMatchingFiles(repo,
+           creds,
+           artifactPath,
+           version,
+           buildType,
+           regexIncludes,
+           regexExcludes,
+           outFiles,
+           errorMessage)) {
+      return false;
+   }
+
+   // The browse listing has no sizes; one HEAD request per file fills them
+   // in, several at a time. Each worker keeps its curl handle for all of its
+   // requests, so a large tree costs a handshake per worker rather than per
+   // file. A failed request only leaves that size unknown.
+   constexpr std::size_t kMaxConcurrentHeadRequests = 8;
+   const auto workerCount                           = std::min(outFiles.size(), kMaxConcurrentHeadRequests);
+   std::atomic<std::size_t> nextFile{0};
+   RunParallel(workerCount, workerCount, [&](std::size_t) {
+      CurlSession session;
+      for (auto i = nextFile.fetch_add(1); i < outFiles.size(); i = nextFile.fetch_add(1)) {
+         auto &file = outFiles[i];
+         std::string headError;
+         file.sizeKnown = HttpHeadContentLength(session, file.downloadUrl, creds, file.sizeBytes, headError);
+         if (!file.sizeKnown) {
+            CONFY_LOG(LogModule::Nexus, LogLevel::Debug, "size unknown path='%s' error='%s'",
+                file.path.c_str(),
+                headError.c_str());
+         }
+      }
+   });
+   return true;
+}
+
+bool NexusClient::CheckArtifactExists(const std::string &repositoryBrowseUrl,
+    const std::string &artifactPath,
+    const std::string &version,
+    const std::string &buildType,
+    std::string &errorMessage) const
+{
+   // Downloads list artifactPath/version/buildType/, so both must be set.
+   if (version.empty()) {
+      errorMessage = "No version selected";
+      return false;
+   }
+   if (buildType.empty()) {
+      errorMessage = "No build type selected";
+      return false;
+   }
+
+   RepoInfo repo;
+   ServerCredentials creds;
+   if (!ResolveRepository(repositoryBrowseUrl, repo, creds, errorMessage)) {
+      return false;
+   }
+
+   std::vector<std::string> versions;
+   if (!ListChildDirectories(repo, creds, artifactPath, versions, errorMessage)) {
+      return false;
+   }
+   if (std::find(versions.begin(), versions.end(), version) == versions.end()) {
+      errorMessage = "Version '" + version + "' not found in '" + artifactPath + "'";
+      return false;
+   }
+
+   std::vector<std::string> buildTypes;
+   if (!ListChildDirectories(repo, creds, artifactPath + "/" + version, buildTypes, errorMessage)) {
+      return false;
+   }
+   if (std::find(buildTypes.begin(), buildTypes.end(), buildType) == buildTypes.end()) {
+      errorMessage = "Build type '" + buildType + "' not found in '" + artifactPath + "/" + version + "'";
+      return false;
+   }
+   return true;
+}
+
+bool NexusClient::ResolveRepository(const std::string &repositoryBrowseUrl,
+    RepoInfo &outRepo,
+    ServerCredentials &outCreds,
+    std::string &errorMessage) const
+{
+   if (!ParseRepoInfo(repositoryBrowseUrl, outRepo)) {
+      errorMessage = "Unable to parse Nexus repository URL: " + repositoryBrowseUrl;
+      CONFY_LOG(LogModule::Nexus, LogLevel::Error, "parse repo URL failed: %s", errorMessage.c_str());
+      return false;
+   }
+
+   CONFY_LOG(LogModule::Nexus, LogLevel::Info, "parsed baseUrl='%s' repository='%s' hostPort='%s'",
+       outRepo.baseUrl.c_str(),
+       outRepo.repository.c_str(),
+       outRepo.hostPort.c_str());
+
+   if (!credentials_.TryGetForHost(outRepo.hostPort, outCreds)) {
       errorMessage =
-          "No credentials found in ~/.m2/settings.xml for host '" + repo.hostPort + "'.";
-      wxLogError("[nexus] credential lookup failed for hostPort='%s'", repo.hostPort.c_str());
+          "No credentials found in ~/.m2/settings.xml for host '" + outRepo.hostPort + "'.";
+      CONFY_LOG(LogModule::Nexus, LogLevel::Error, "credential lookup failed for hostPort='%s'", outRepo.hostPort.c_str());
       return false;
    }
 
-   wxLogMessage("[nexus] credentials resolved for hostPort='%s' username='%s'",
-       repo.hostPort.c_str(),
-       creds.username.c_str());
+   CONFY_LOG(LogModule::Nexus, LogLevel::Info, "credentials resolved for hostPort='%s' username='%s'",
+       outRepo.hostPort.c_str(),
+       outCreds.username.c_str());
+   return true;
+}
 
+bool NexusClient::ListMatchingFiles(const RepoInfo &repo,
+    const ServerCredentials &creds,
+    const std::string &artifactPath,
+    const std::string &version,
+    const std::string &buildType,
+    const std::vector<std::string> &regexIncludes,
+    const std::vector<std::string> &regexExcludes,
+    std::vector<NexusArtifactFile> &outFiles,
+    std::string &errorMessage) const
+{
    const auto prefix = artifactPath + "/" + version + "/" + buildType + "/";
 
    std::vector<NexusArtifactAsset> assets;
    if (!ListAssets(repo, creds, prefix, assets, errorMessage)) {
-      wxLogError("[nexus] list assets failed: %s", errorMessage.c_str());
+      CONFY_LOG(LogModule::Nexus, LogLevel::Error, "list assets failed: %s", errorMessage.c_str());
       return false;
    }
 
-   wxLogMessage(
-       "[nexus] total assets returned (query='%s')=%zu includeFilters=%zu excludeFilters=%zu",
+   CONFY_LOG(LogModule::Nexus, LogLevel::Info,
+       "total assets returned (query='%s')=%zu includeFilters=%zu excludeFilters=%zu",
        prefix.c_str(),
        assets.size(),
        regexIncludes.size(),
@@ -563,11 +842,6 @@ bool NexusClient::DownloadArtifactTree(const std::string &repositoryBrowseUrl,
          return false;
       }
    }
-   struct MatchedAsset
-   {
-      NexusArtifactAsset asset;
-      std::string relativePath;
-   };
 
    auto extractRelativePath = [&prefix](const std::string &rawPath, std::string &relativePath) -> bool {
       std::string normalized = rawPath;
@@ -596,7 +870,7 @@ bool NexusClient::DownloadArtifactTree(const std::string &repositoryBrowseUrl,
       return false;
    };
 
-   std::vector<MatchedAsset> matches;
+   outFiles.clear();
    for (const auto &asset : assets) {
       std::string relativePath;
       if (extractRelativePath(asset.path, relativePath)) {
@@ -626,76 +900,27 @@ bool NexusClient::DownloadArtifactTree(const std::string &repositoryBrowseUrl,
             continue;
          }
 
-         matches.push_back({asset, relativePath});
+         NexusArtifactFile file;
+         file.path         = asset.path;
+         file.relativePath = relativePath;
+         file.downloadUrl  = asset.downloadUrl;
+         outFiles.push_back(std::move(file));
       }
    }
 
-   wxLogMessage("[nexus] filtered matches prefix='%s' count=%zu",
+   CONFY_LOG(LogModule::Nexus, LogLevel::Info, "filtered matches prefix='%s' count=%zu",
        prefix.c_str(),
-       matches.size());
+       outFiles.size());
 
-   if (matches.empty()) {
+   if (outFiles.empty()) {
       errorMessage = "No assets found for path prefix: " + prefix;
       for (const auto &asset : assets) {
-         wxLogMessage("[nexus] candidate asset path='%s'", asset.path.c_str());
+         CONFY_LOG(LogModule::Nexus, LogLevel::Debug, "candidate asset path='%s'", asset.path.c_str());
       }
-      wxLogError("[nexus] no matching assets");
+      CONFY_LOG(LogModule::Nexus, LogLevel::Error, "no matching assets");
       return false;
    }
 
-   if (!ResetDirectoryWithRetries(fs::path(targetDirectory), errorMessage)) {
-      wxLogError("[nexus] target directory reset failed target='%s' error='%s'",
-          targetDirectory.c_str(),
-          errorMessage.c_str());
-      return false;
-   }
-
-   const std::size_t total = matches.size();
-   std::size_t completed   = 0;
-
-   for (const auto &matched : matches) {
-      if (cancelRequested.load()) {
-         wxLogMessage("[nexus] cancel requested during downloads");
-         return false;
-      }
-
-      const fs::path outputPath = fs::path(targetDirectory) / matched.relativePath;
-      fs::create_directories(outputPath.parent_path());
-
-      std::string downloadError;
-      std::uint64_t currentDownloadedBytes = 0;
-      wxLogMessage("[nexus] downloading path='%s' url='%s'",
-          matched.asset.path.c_str(),
-          matched.asset.downloadUrl.c_str());
-      if (!HttpDownloadBinary(
-              matched.asset.downloadUrl,
-              creds,
-              outputPath.string(),
-              cancelRequested,
-              [&](std::uint64_t downloadedBytes, std::uint64_t totalBytes) {
-                 currentDownloadedBytes    = downloadedBytes;
-                 const double fileProgress = totalBytes > 0
-                                                 ? static_cast<double>(downloadedBytes) /
-                                                       static_cast<double>(totalBytes)
-                                                 : 0.0;
-                 const int overallPercent =
-                     static_cast<int>(((static_cast<double>(completed) + fileProgress) * 100.0) /
-                                      static_cast<double>(total));
-                 progress(overallPercent, downloadedBytes, matched.asset.path);
-              },
-              downloadError)) {
-         errorMessage = "Failed downloading '" + matched.asset.path + "': " + downloadError;
-         wxLogError("[nexus] download failed path='%s' error='%s'",
-             matched.asset.path.c_str(),
-             downloadError.c_str());
-         return false;
-      }
-
-      ++completed;
-      const int overallPercent = static_cast<int>((completed * 100) / total);
-      progress(overallPercent, currentDownloadedBytes, matched.asset.path);
-   }
-
    return true;
 }
 
@@ -749,11 +974,11 @@ bool NexusClient::ListAssets(const RepoInfo &repo,
          browseUrl += EncodePath(currentDirectory);
       }
 
-      wxLogMessage("[nexus] browse listing url='%s'", browseUrl.c_str());
+      CONFY_LOG(LogModule::Nexus, LogLevel::Debug, "browse listing url='%s'", browseUrl.c_str());
 
       std::string responseBody;
       if (!HttpGetText(browseUrl, creds, responseBody, errorMessage)) {
-         wxLogError("[nexus] browse listing request failed: %s", errorMessage.c_str());
+         CONFY_LOG(LogModule::Nexus, LogLevel::Error, "browse listing request failed: %s", errorMessage.c_str());
          return false;
       }
 
@@ -779,7 +1004,7 @@ bool NexusClient::ListAssets(const RepoInfo &repo,
          }
       }
 
-      wxLogMessage("[nexus] browse listing discovered files=%zu", discovered);
+      CONFY_LOG(LogModule::Nexus, LogLevel::Info, "browse listing discovered files=%zu", discovered);
    }
 
    return true;
@@ -846,20 +1071,65 @@ bool NexusClient::HttpGetText(const std::string &url,
    const CURLcode result = curl_easy_perform(curl);
    long statusCode       = 0;
    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &statusCode);
+   HttpTimings::RecordTransfer(LogModule::Nexus, curl, result);
    curl_easy_cleanup(curl);
 
    if (result != CURLE_OK) {
       errorMessage = std::string("HTTP request failed: ") + curl_easy_strerror(result);
-      wxLogError("[nexus] http get failed error='%s'", errorMessage.c_str());
+      CONFY_LOG(LogModule::Nexus, LogLevel::Error, "http get failed error='%s'", errorMessage.c_str());
+      return false;
+   }
+
+   if (statusCode < 200 || statusCode >= 300) {
+      errorMessage = "HTTP status " + std::to_string(statusCode);
+      CONFY_LOG(LogModule::Nexus, LogLevel::Error, "http get status=%ld", statusCode);
+      return false;
+   }
+
+   return true;
+}
+
+bool NexusClient::HttpHeadContentLength(CurlSession &session,
+    const std::string &url,
+    const ServerCredentials &creds,
+    std::uint64_t &outBytes,
+    std::string &errorMessage) const
+{
+   CURL *curl = session.Reset();
+   if (!curl) {
+      errorMessage = "Failed to initialize curl";
       return false;
    }
 
+   const std::string requestUrl = EncodeUrlForCurl(url);
+   const std::string userPwd    = BuildCurlUserPwd(creds);
+   curl_easy_setopt(curl, CURLOPT_URL, requestUrl.c_str());
+   curl_easy_setopt(curl, CURLOPT_USERPWD, userPwd.c_str());
+   curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+   curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+   curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+
+   const CURLcode result = curl_easy_perform(curl);
+   long statusCode       = 0;
+   curl_off_t length     = -1;
+   curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &statusCode);
+   curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+   HttpTimings::RecordTransfer(LogModule::Nexus, curl, result);
+
+   if (result != CURLE_OK) {
+      errorMessage = std::string("HTTP request failed: ") + curl_easy_strerror(result);
+      return false;
+   }
    if (statusCode < 200 || statusCode >= 300) {
       errorMessage = "HTTP status " + std::to_string(statusCode);
-      wxLogError("[nexus] http get status=%ld", statusCode);
+      return false;
+   }
+   if (length < 0) {
+      errorMessage = "No Content-Length";
       return false;
    }
 
+   outBytes = static_cast<std::uint64_t>(length);
    return true;
 }
 
@@ -873,7 +1143,7 @@ bool NexusClient::HttpDownloadBinary(const std::string &url,
    std::ofstream output(outFile, std::ios::binary);
    if (!output) {
       errorMessage = "Unable to open local output file";
-      wxLogError("[nexus] open output file failed path='%s'", outFile.c_str());
+      CONFY_LOG(LogModule::Nexus, LogLevel::Error, "open output file failed path='%s'", outFile.c_str());
       return false;
    }
 
@@ -899,13 +1169,14 @@ bool NexusClient::HttpDownloadBinary(const std::string &url,
    const CURLcode result = curl_easy_perform(curl);
    long statusCode       = 0;
    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &statusCode);
+   HttpTimings::RecordTransfer(LogModule::Nexus, curl, result);
    curl_easy_cleanup(curl);
 
    auto deletePartialFile = [outFile]() {
       std::error_code removeError;
       fs::remove(outFile, removeError);
       if (removeError) {
-         wxLogError("[nexus] failed to remove partial file path='%s' error='%s'",
+         CONFY_LOG(LogModule::Nexus, LogLevel::Error, "failed to remove partial file path='%s' error='%s'",
              outFile.c_str(),
              removeError.message().c_str());
       }
@@ -921,7 +1192,7 @@ bool NexusClient::HttpDownloadBinary(const std::string &url,
          output.close();
       }
       deletePartialFile();
-      wxLogError("[nexus] http download failed path='%s' error='%s'",
+      CONFY_LOG(LogModule::Nexus, LogLevel::Error, "http download failed path='%s' error='%s'",
           outFile.c_str(),
           errorMessage.c_str());
       return false;
@@ -933,7 +1204,7 @@ bool NexusClient::HttpDownloadBinary(const std::string &url,
          output.close();
       }
       deletePartialFile();
-      wxLogError("[nexus] http download status=%ld path='%s'", statusCode, outFile.c_str());
+      CONFY_LOG(LogModule::Nexus, LogLevel::Error, "http download status=%ld path='%s'", statusCode, outFile.c_str());
       return false;
    }
 
@@ -943,7 +1214,7 @@ bool NexusClient::HttpDownloadBinary(const std::string &url,
          output.close();
       }
       deletePartialFile();
-      wxLogError("[nexus] write output file failed path='%s'", outFile.c_str());
+      CONFY_LOG(LogModule::Nexus, LogLevel::Error, "write output file failed path='%s'", outFile.c_str());
       return false;
    }
 
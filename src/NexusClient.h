@@ -5,6 +5,7 @@
 #include <atomic>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -16,6 +17,17 @@ struct NexusArtifactAsset
    std::string downloadUrl;
 };
 
+// A file of an artifact tree after include/exclude filtering. relativePath is
+// where it lands below the target directory.
+struct NexusArtifactFile
+{
+   std::string path;
+   std::string relativePath;
+   std::string downloadUrl;
+   std::uint64_t sizeBytes{0};
+   bool sizeKnown{false};
+};
+
 class NexusClient final
 {
  public:
@@ -35,6 +47,25 @@ class NexusClient final
        std::atomic<bool> &cancelRequested,
        ProgressCallback progress,
        std::string &errorMessage) const;
+   // The files DownloadArtifactTree would fetch, with their sizes from HEAD
+   // requests issued several at a time. Sizes the server does not report
+   // keep sizeKnown == false. Nothing is written locally.
+   bool ListArtifactFiles(const std::string &repositoryBrowseUrl,
+       const std::string &artifactPath,
+       const std::string &version,
+       const std::string &buildType,
+       const std::vector<std::string> &regexIncludes,
+       const std::vector<std::string> &regexExcludes,
+       std::vector<NexusArtifactFile> &outFiles,
+       std::string &errorMessage) const;
+   // Preflight for a download: the URL parses, the host has credentials
+   // and artifactPath/version/buildType is listed; an empty version or
+   // build type fails. Two browse requests, no file listing.
+   bool CheckArtifactExists(const std::string &repositoryBrowseUrl,
+       const std::string &artifactPath,
+       const std::string &version,
+       const std::string &buildType,
+       std::string &errorMessage) const;
    bool ListComponentVersions(const std::string &repositoryBrowseUrl,
        const std::string &artifactPath,
        std::vector<std::string> &outVersions,
@@ -44,6 +75,19 @@ class NexusClient final
        const std::string &version,
        std::vector<std::string> &outBuildTypes,
        std::string &errorMessage) const;
+   // Two-level listing of artifactPath/<version>/<buildtype>/ for several
+   // versions at once; the version directories are browsed concurrently.
+   // Versions that could not be listed are missing from the result and make
+   // the call return false.
+   bool ListBuildTypesForVersions(const std::string &repositoryBrowseUrl,
+       const std::string &artifactPath,
+       const std::vector<std::string> &versions,
+       std::map<std::string, std::vector<std::string>> &outBuildTypesByVersion,
+       std::string &errorMessage) const;
+   // Version-aware ordering: digit runs compare numerically, so 1.10 sorts
+   // after 1.9. Returns the `count` newest versions, newest first.
+   static bool IsNewerVersion(const std::string &lhs, const std::string &rhs);
+   static std::vector<std::string> SelectNewestVersions(std::vector<std::string> versions, std::size_t count);
    static std::vector<std::string> ExtractImmediateChildDirectories(
        const std::vector<std::string> &directoryPaths,
        const std::string &parentPath);
@@ -60,6 +104,19 @@ class NexusClient final
    };
 
    bool ParseRepoInfo(const std::string &inputUrl, RepoInfo &out) const;
+   bool ResolveRepository(const std::string &repositoryBrowseUrl,
+       RepoInfo &outRepo,
+       ServerCredentials &outCreds,
+       std::string &errorMessage) const;
+   bool ListMatchingFiles(const RepoInfo &repo,
+       const ServerCredentials &creds,
+       const std::string &artifactPath,
+       const std::string &version,
+       const std::string &buildType,
+       const std::vector<std::string> &regexIncludes,
+       const std::vector<std::string> &regexExcludes,
+       std::vector<NexusArtifactFile> &outFiles,
+       std::string &errorMessage) const;
    bool ListAssets(const RepoInfo &repo,
        const ServerCredentials &creds,
        const std::string &query,
@@ -74,6 +131,15 @@ class NexusClient final
        const ServerCredentials &creds,
        std::string &out,
        std::string &errorMessage) const;
+   // An easy handle kept across requests, so that consecutive requests to
+   // the same host reuse its connection.
+   class CurlSession;
+
+   bool HttpHeadContentLength(CurlSession &session,
+       const std::string &url,
+       const ServerCredentials &creds,
+       std::uint64_t &outBytes,
+       std::string &errorMessage) const;
    bool HttpDownloadBinary(const std::string &url,
        const ServerCredentials &creds,
        const std::string &outFile,
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace confy {
+
+// Runs task(0) ... task(taskCount - 1) on at most maxConcurrency threads and
+// returns once all of them finished. Tasks are handed out in index order; each
+// task must only touch its own slot of any shared output.
+template <typename Task>
+void RunParallel(std::size_t taskCount, std::size_t maxConcurrency, Task task)
+{
+   const auto threadCount = std::min(taskCount, std::max<std::size_t>(maxConcurrency, 1));
+   if (threadCount <= 1) {
+      for (std::size_t i = 0; i < taskCount; ++i) {
+         task(i);
+      }
+      return;
+   }
+
+   std::atomic<std::size_t> nextIndex{0};
+   auto drain = [&]() {
+      for (auto i = nextIndex.fetch_add(1); i < taskCount; i = nextIndex.fetch_add(1)) {
+         task(i);
+      }
+   };
+
+   std::vector<std::thread> threads;
+   threads.reserve(threadCount - 1);
+   for (std::size_t i = 1; i < threadCount; ++i) {
+      threads.emplace_back(drain);
+   }
+   drain();
+   for (auto &thread : threads) {
+      thread.join();
+   }
+}
+
+} // namespace confy
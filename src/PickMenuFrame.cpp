@@ -23,8 +23,6 @@
 #include <algorithm>
 #include <atomic>
 #include <cstdint>
-#include <cstdlib>
-#include <filesystem>
 #include <thread>
 #include <vector>
 
@@ -37,30 +35,6 @@ constexpr int kPickerButtonWidth   = 280;
 constexpr int kPickerButtonHeight  = 56;
 constexpr int kPickerButtonGap     = 12;
 
-std::string ResolveM2SettingsPath()
-{
-#ifdef _WIN32
-   std::string homeDir;
-   if (const char *h = std::getenv("USERPROFILE")) {
-      homeDir = h;
-   } else {
-      const char *drive    = std::getenv("HOMEDRIVE");
-      const char *homePath = std::getenv("HOMEPATH");
-      if (drive && homePath) {
-         homeDir = std::string(drive) + homePath;
-      }
-   }
-#else
-   const char *homeEnv       = std::getenv("HOME");
-   const std::string homeDir = homeEnv ? homeEnv : "";
-#endif
-
-   if (homeDir.empty()) {
-      return {};
-   }
-   return (std::filesystem::path(homeDir) / ".m2" / "settings.xml").string();
-}
-
 class BitbucketLoadDialog final : public wxDialog
 {
  public:
@@ -448,7 +422,7 @@ void PickMenuFrame::OnLoadFromBitbucket(wxCommandEvent &)
       return;
    }
 
-   const auto settingsPath = ResolveM2SettingsPath();
+   const auto settingsPath = AuthCredentials::DefaultM2SettingsPath();
    if (settingsPath.empty()) {
       wxMessageBox("Unable to resolve home directory for ~/.m2/settings.xml.",
           "Bitbucket auth",
@@ -0,0 +1,104 @@
+#include "RefListingService.h"
+
+#include "BitbucketClient.h"
+#include "GitClient.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+bool ContainsIgnoringCase(const std::string &haystack, const std::string &needle)
+{
+   const auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(), [](char a, char b) {
+      return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+   });
+   return it != haystack.end();
+}
+
+} // namespace
+
+namespace confy {
+
+RefListingService::RefListingService(AuthCredentials credentials) :
+    credentials_(std::move(credentials)) {}
+
+bool RefListingService::ListBranchesAndTags(const std::string &repositoryUrl,
+    std::vector<std::string> &outRefs,
+    std::string &errorMessage) const
+{
+   const auto normalizedRepositoryUrl = GitClient::NormalizeRepositoryUrl(repositoryUrl);
+   if (BitbucketClient::IsRepositoryUrl(normalizedRepositoryUrl)) {
+      BitbucketClient bitbucket(credentials_);
+      std::string restError;
+      if (bitbucket.ListBranchesAndTags(normalizedRepositoryUrl, outRefs, restError)) {
+         return true;
+      }
+      CONFY_LOG(LogModule::Refs, LogLevel::Warning, "REST ref listing failed for %s, falling back to git ls-remote: %s",
+          normalizedRepositoryUrl.c_str(),
+          restError.c_str());
+   }
+
+   GitClient git(credentials_);
+   return git.ListBranchesAndTags(normalizedRepositoryUrl, outRefs, errorMessage);
+}
+
+bool RefListingService::SupportsSearch(const std::string &repositoryUrl)
+{
+   return BitbucketClient::IsRepositoryUrl(GitClient::NormalizeRepositoryUrl(repositoryUrl));
+}
+
+bool RefListingService::SearchBranchesAndTags(const std::string &repositoryUrl,
+    const std::string &filterText,
+    std::size_t limit,
+    std::vector<std::string> &outRefs,
+    bool &outHasMore,
+    std::string &errorMessage) const
+{
+   outRefs.clear();
+   outHasMore = false;
+   if (!SupportsSearch(repositoryUrl)) {
+      errorMessage = "Ref search is not supported for " + repositoryUrl + ".";
+      return false;
+   }
+
+   BitbucketClient bitbucket(credentials_);
+   // Branches and tags are paged separately, so the merged result can hold up
+   // to twice the limit; trim it back to one page.
+   if (!bitbucket.SearchBranchesAndTags(GitClient::NormalizeRepositoryUrl(repositoryUrl),
+           filterText,
+           static_cast<int>(limit),
+           outRefs,
+           outHasMore,
+           errorMessage)) {
+      return false;
+   }
+   if (outRefs.size() > limit) {
+      outRefs.resize(limit);
+      outHasMore = true;
+   }
+   return true;
+}
+
+std::vector<std::string> RefListingService::FilterRefs(const std::vector<std::string> &refs,
+    const std::string &filterText,
+    std::size_t limit,
+    bool &outHasMore)
+{
+   outHasMore = false;
+   std::vector<std::string> matches;
+   for (const auto &ref : refs) {
+      if (!ContainsIgnoringCase(ref, filterText)) {
+         continue;
+      }
+      if (matches.size() == limit) {
+         outHasMore = true;
+         break;
+      }
+      matches.push_back(ref);
+   }
+   return matches;
+}
+
+} // namespace confy
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "AuthCredentials.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace confy {
+
+// Lists the branches and tags of a source repository. Bitbucket Server
+// repositories are queried through the REST API with concurrent paging; any
+// other host, or a REST failure, falls back to `git ls-remote`.
+class RefListingService final
+{
+ public:
+   explicit RefListingService(AuthCredentials credentials);
+
+   bool ListBranchesAndTags(const std::string &repositoryUrl,
+       std::vector<std::string> &outRefs,
+       std::string &errorMessage) const;
+
+   // Type-ahead search: only hosts with server-side filtering support it.
+   // Callers filter an already listed set with FilterRefs otherwise.
+   static bool SupportsSearch(const std::string &repositoryUrl);
+   bool SearchBranchesAndTags(const std::string &repositoryUrl,
+       const std::string &filterText,
+       std::size_t limit,
+       std::vector<std::string> &outRefs,
+       bool &outHasMore,
+       std::string &errorMessage) const;
+
+   // Case-insensitive substring match, keeping the input order.
+   static std::vector<std::string> FilterRefs(const std::vector<std::string> &refs,
+       const std::string &filterText,
+       std::size_t limit,
+       bool &outHasMore);
+
+ private:
+   AuthCredentials credentials_;
+};
+
+} // namespace confy
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace confy {
+
+// Fixed-capacity FIFO that overwrites its oldest entry once full. Storage
+// grows on demand up to the capacity and is never reallocated after that.
+template <typename T>
+class RingBuffer
+{
+ public:
+   explicit RingBuffer(std::size_t capacity) : capacity_(std::max<std::size_t>(capacity, 1)) {}
+
+   void Push(T value)
+   {
+      if (items_.size() < capacity_) {
+         items_.push_back(std::move(value));
+         return;
+      }
+      items_[head_] = std::move(value);
+      head_         = (head_ + 1) % capacity_;
+   }
+
+   // Index 0 is the oldest entry still held.
+   const T &At(std::size_t index) const { return items_[(head_ + index) % items_.size()]; }
+
+   std::size_t Size() const { return items_.size(); }
+   std::size_t Capacity() const { return capacity_; }
+
+   void Clear()
+   {
+      items_.clear();
+      head_ = 0;
+   }
+
+ private:
+   std::size_t capacity_;
+   std::size_t head_{0};
+   std::vector<T> items_;
+};
+
+} // namespace confy
@@ -0,0 +1,486 @@
+#include "SyncCommand.h"
+
+#include "ApplyPlanner.h"
+#include "ConfigLoader.h"
+#include "DownloadEventStream.h"
+#include "DownloadWorkerQueue.h"
+#include "HttpTimings.h"
+#include "Log.h"
+#include "TransferHistory.h"
+
+#include <wx/log.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+constexpr auto kEventPollInterval = std::chrono::milliseconds(20);
+// Jobs resolved at the same time by --dry-run.
+constexpr std::size_t kMaxConcurrentPlanJobs = 8;
+
+bool ParseAssignment(const std::string &option,
+    const std::string &value,
+    std::map<std::string, std::string> &outAssignments,
+    std::string &errorMessage)
+{
+   const auto separator = value.find('=');
+   if (separator == std::string::npos || separator == 0 || separator + 1 == value.size()) {
+      errorMessage = option + " expects <component>=<value>, got '" + value + "'";
+      return false;
+   }
+   outAssignments[value.substr(0, separator)] = value.substr(separator + 1);
+   return true;
+}
+
+bool ParseJobCount(const std::string &value, std::size_t &outJobs, std::string &errorMessage)
+{
+   std::size_t parsedLength = 0;
+   unsigned long jobs       = 0;
+   try {
+      jobs = std::stoul(value, &parsedLength);
+   } catch (const std::exception &) {
+      parsedLength = 0;
+   }
+   if (parsedLength != value.size() || value.empty() || value[0] == '-' || jobs == 0 || jobs > 64) {
+      errorMessage = "--jobs expects a number between 1 and 64, got '" + value + "'";
+      return false;
+   }
+   outJobs = static_cast<std::size_t>(jobs);
+   return true;
+}
+
+bool IsFinalEvent(confy::DownloadEventType type)
+{
+   return type == confy::DownloadEventType::Completed ||
+          type == confy::DownloadEventType::Failed ||
+          type == confy::DownloadEventType::Cancelled;
+}
+
+const char *JobKindName(const confy::DownloadJob &job)
+{
+   return job.kind == confy::DownloadJobKind::GitSource ? "source" : "artifact";
+}
+
+const std::string &JobComponentName(const confy::DownloadJob &job)
+{
+   return job.kind == confy::DownloadJobKind::GitSource ? job.source.componentName : job.artifact.componentName;
+}
+
+void WriteTextEvent(std::ostream &out, const confy::DownloadJob &job, const confy::DownloadEvent &event)
+{
+   out << JobComponentName(job) << " [" << JobKindName(job) << ' ' << job.Target() << "] ";
+   switch (event.type) {
+      case confy::DownloadEventType::Progress:
+         out << std::setw(3) << event.percent << '%';
+         if (!event.message.empty()) {
+            out << ' ' << event.message;
+         }
+         break;
+      case confy::DownloadEventType::Failed:
+         out << "failed: " << event.message;
+         break;
+      default:
+         out << confy::DownloadEventTypeName(event.type);
+         break;
+   }
+   out << '\n';
+   out.flush();
+}
+
+int RunPlan(const confy::SyncOptions &options,
+    const std::vector<confy::DownloadJob> &jobs,
+    const confy::TransferHistory *history,
+    std::ostream &out,
+    std::ostream &err)
+{
+   confy::AuthCredentials credentials;
+   std::string errorMessage;
+   if (!credentials.LoadFromM2SettingsXml(confy::AuthCredentials::DefaultM2SettingsPath(), errorMessage)) {
+      err << "Failed to load credentials: " << errorMessage << '\n';
+      return confy::kExitConfigError;
+   }
+
+   const auto plan =
+       confy::BuildApplyPlan(jobs, confy::MakeApplyPlanResolvers(credentials), history, options.jobs, kMaxConcurrentPlanJobs);
+   const auto summary = confy::BuildHumanReadablePlanSummary(plan);
+   out << summary;
+   out.flush();
+
+   if (!options.planOutput.empty()) {
+      std::ofstream output(options.planOutput, std::ios::binary | std::ios::trunc);
+      output << summary;
+      if (!output.good()) {
+         err << "--plan-output: failed to write " << options.planOutput << '\n';
+         return confy::kExitUsageError;
+      }
+   }
+   // A job the plan cannot resolve would fail in a real sync as well.
+   return plan.failedJobs > 0 ? confy::kExitJobsFailed : confy::kExitSuccess;
+}
+
+} // namespace
+
+namespace confy {
+
+std::string SyncUsage()
+{
+   return "Usage: confy_cli sync <config.xml> [options]\n"
+          "\n"
+          "Downloads the sources and artifacts enabled in the config without the GUI.\n"
+          "\n"
+          "Options:\n"
+          "  --jobs <n>                        Number of parallel download jobs (default 6)\n"
+          "  --only <component>[,...]          Sync only these components\n"
+          "  --ref <component>=<ref>           Clone this branch or tag\n"
+          "  --version <component>=<version>   Download this artifact version\n"
+          "  --build-type <component>=<type>   Download this artifact build type\n"
+          "  --format text|json                Progress as text or as JSON lines (default text)\n"
+          "  --events <destination>            Also write JSON lines to a file, '-' for stdout or\n"
+          "                                    unix:<path> for a Unix socket\n"
+          "  --dry-run                         Only list what would be transferred, with sizes and\n"
+          "                                    an estimated duration; nothing is written\n"
+          "  --plan-output <file>              Write the --dry-run summary to a file as well\n"
+          "  --http-timings <file>             Write p50/p95/p99 HTTP request timings per host to a\n"
+          "                                    file after the sync\n"
+          "  --log-level <spec>                Log levels, e.g. 'info' or 'warning,nexus=debug'\n"
+          "  -v, --verbose                     Same as --log-level info\n"
+          "  -h, --help                        Show this help\n"
+          "\n"
+          "Exit codes: 0 success, 1 a job failed, 2 usage error, 3 config error, 130 cancelled.\n";
+}
+
+bool ParseSyncArguments(const std::vector<std::string> &args,
+    SyncOptions &outOptions,
+    bool &showHelp,
+    std::string &errorMessage)
+{
+   outOptions = {};
+   showHelp   = false;
+
+   for (std::size_t i = 0; i < args.size(); ++i) {
+      const auto &arg = args[i];
+      if (arg == "-h" || arg == "--help") {
+         showHelp = true;
+         return true;
+      }
+      if (arg == "-v" || arg == "--verbose") {
+         outOptions.verbose = true;
+         continue;
+      }
+      if (arg == "--dry-run") {
+         outOptions.dryRun = true;
+         continue;
+      }
+
+      if (arg.size() > 1 && arg[0] == '-') {
+         // Every other option takes a value, either as --option=value or as
+         // the next argument.
+         std::string option = arg;
+         std::string value;
+         const auto equals = arg.find('=');
+         if (arg.compare(0, 2, "--") == 0 && equals != std::string::npos) {
+            option = arg.substr(0, equals);
+            value  = arg.substr(equals + 1);
+         } else if (i + 1 < args.size()) {
+            value = args[++i];
+         } else {
+            errorMessage = "Missing value for " + arg;
+            return false;
+         }
+
+         if (option == "--jobs" || option == "-j") {
+            if (!ParseJobCount(value, outOptions.jobs, errorMessage)) {
+               return false;
+            }
+         } else if (option == "--only") {
+            std::size_t start = 0;
+            while (start <= value.size()) {
+               const auto end  = std::min(value.find(',', start), value.size());
+               const auto name = value.substr(start, end - start);
+               if (!name.empty()) {
+                  outOptions.onlyComponents.push_back(name);
+               }
+               start = end + 1;
+            }
+         } else if (option == "--ref") {
+            if (!ParseAssignment(option, value, outOptions.refOverrides, errorMessage)) {
+               return false;
+            }
+         } else if (option == "--version") {
+            if (!ParseAssignment(option, value, outOptions.versionOverrides, errorMessage)) {
+               return false;
+            }
+         } else if (option == "--build-type") {
+            if (!ParseAssignment(option, value, outOptions.buildTypeOverrides, errorMessage)) {
+               return false;
+            }
+         } else if (option == "--format") {
+            if (value == "text") {
+               outOptions.progressFormat = SyncProgressFormat::Text;
+            } else if (value == "json") {
+               outOptions.progressFormat = SyncProgressFormat::JsonLines;
+            } else {
+               errorMessage = "--format expects 'text' or 'json', got '" + value + "'";
+               return false;
+            }
+         } else if (option == "--events") {
+            outOptions.eventStream = value;
+         } else if (option == "--plan-output") {
+            outOptions.planOutput = value;
+            outOptions.dryRun     = true;
+         } else if (option == "--http-timings") {
+            outOptions.httpTimingsOutput = value;
+         } else if (option == "--log-level") {
+            outOptions.logLevels = value;
+         } else {
+            errorMessage = "Unknown option " + option;
+            return false;
+         }
+         continue;
+      }
+
+      if (!outOptions.configPath.empty()) {
+         errorMessage = "Unexpected argument '" + arg + "'";
+         return false;
+      }
+      outOptions.configPath = arg;
+   }
+
+   if (outOptions.configPath.empty()) {
+      errorMessage = "Missing config file";
+      return false;
+   }
+   return true;
+}
+
+bool ApplySyncOverrides(const SyncOptions &options, ConfigModel &config, std::string &errorMessage)
+{
+   std::unordered_map<std::string, ComponentConfig *> componentsByName;
+   for (auto &component : config.components) {
+      componentsByName.emplace(component.name, &component);
+   }
+
+   auto findComponent = [&](const std::string &name, const char *option) -> ComponentConfig * {
+      const auto it = componentsByName.find(name);
+      if (it == componentsByName.end()) {
+         errorMessage = std::string(option) + ": no component named '" + name + "' in the config";
+         return nullptr;
+      }
+      return it->second;
+   };
+
+   if (!options.onlyComponents.empty()) {
+      std::set<std::string> selected;
+      for (const auto &name : options.onlyComponents) {
+         if (findComponent(name, "--only") == nullptr) {
+            return false;
+         }
+         selected.insert(name);
+      }
+      for (auto &component : config.components) {
+         if (selected.count(component.name) == 0) {
+            component.source.enabled   = false;
+            component.artifact.enabled = false;
+         }
+      }
+   }
+
+   for (const auto &[name, ref] : options.refOverrides) {
+      auto *component = findComponent(name, "--ref");
+      if (component == nullptr) {
+         return false;
+      }
+      if (!component->sourcePresent) {
+         errorMessage = "--ref: component '" + name + "' has no source";
+         return false;
+      }
+      component->source.branchOrTag = ref;
+      component->source.enabled     = true;
+   }
+
+   auto applyArtifactOverride = [&](const std::map<std::string, std::string> &overrides,
+                                    const char *option,
+                                    std::string ArtifactConfig::*field) {
+      for (const auto &[name, value] : overrides) {
+         auto *component = findComponent(name, option);
+         if (component == nullptr) {
+            return false;
+         }
+         if (!component->artifactPresent) {
+            errorMessage = std::string(option) + ": component '" + name + "' has no artifact";
+            return false;
+         }
+         component->artifact.*field  = value;
+         component->artifact.enabled = true;
+      }
+      return true;
+   };
+   return applyArtifactOverride(options.versionOverrides, "--version", &ArtifactConfig::version) &&
+          applyArtifactOverride(options.buildTypeOverrides, "--build-type", &ArtifactConfig::buildType);
+}
+
+int RunSync(const SyncOptions &options,
+    const SourceJobSettings &sourceSettings,
+    const std::shared_ptr<TransferHistory> &history,
+    const std::atomic<bool> &cancelRequested,
+    std::ostream &out,
+    std::ostream &err)
+{
+   const auto startTime = std::chrono::steady_clock::now();
+
+   ConfigLoader loader;
+   auto loadResult = loader.LoadFromFile(options.configPath);
+   if (!loadResult.success) {
+      err << "Failed to load " << options.configPath << ": " << loadResult.errorMessage << '\n';
+      return kExitConfigError;
+   }
+
+   std::string errorMessage;
+   if (!ApplySyncOverrides(options, loadResult.config, errorMessage)) {
+      err << errorMessage << '\n';
+      return kExitUsageError;
+   }
+
+   std::uint64_t nextJobId = 1;
+   const auto jobs         = BuildDownloadJobs(loadResult.config, sourceSettings, nextJobId);
+   if (jobs.empty()) {
+      err << "No source/artifact jobs are enabled.\n";
+      return kExitSuccess;
+   }
+   if (options.dryRun) {
+      return RunPlan(options, jobs, history.get(), out, err);
+   }
+
+   std::vector<std::unique_ptr<DownloadEventStream>> eventStreams;
+   if (options.progressFormat == SyncProgressFormat::JsonLines) {
+      eventStreams.push_back(std::make_unique<DownloadEventStream>([&out](const std::string &line) {
+         out << line;
+         out.flush();
+         return static_cast<bool>(out);
+      }));
+   }
+   if (!options.eventStream.empty()) {
+      auto eventStream = DownloadEventStream::Open(options.eventStream,
+          DownloadEventStream::kDefaultProgressInterval,
+          errorMessage);
+      if (!eventStream) {
+         err << "--events: " << errorMessage << '\n';
+         return kExitUsageError;
+      }
+      eventStreams.push_back(std::move(eventStream));
+   }
+   for (auto &eventStream : eventStreams) {
+      eventStream->AddJobs(jobs);
+   }
+
+   std::unordered_map<std::uint64_t, std::size_t> jobIndexById;
+   for (std::size_t i = 0; i < jobs.size(); ++i) {
+      jobIndexById.emplace(jobs[i].JobId(), i);
+   }
+
+   DownloadWorkerQueue worker(std::min(options.jobs, jobs.size()));
+   worker.SetTransferHistory(history);
+   worker.Start();
+   for (const auto &job : jobs) {
+      worker.Submit(job);
+   }
+
+   // Text progress is reported once per percent step; git and Nexus report
+   // far more often than that. Event streams rate-limit on their own.
+   std::vector<int> lastPercent(jobs.size(), -1);
+   std::size_t finished  = 0;
+   std::size_t completed = 0;
+   std::size_t failed    = 0;
+   std::size_t cancelled = 0;
+   bool cancelling       = false;
+
+   while (finished < jobs.size()) {
+      if (!cancelling && cancelRequested.load()) {
+         cancelling = true;
+         CONFY_LOG(LogModule::General, LogLevel::Warning, "cancel requested; stopping remaining jobs");
+         worker.RequestCancelAll();
+      }
+
+      DownloadEvent event;
+      bool processedAny = false;
+      while (worker.TryPopEvent(event)) {
+         processedAny  = true;
+         const auto it = jobIndexById.find(event.jobId);
+         if (it == jobIndexById.end()) {
+            continue;
+         }
+         const auto jobIndex = it->second;
+         for (auto &eventStream : eventStreams) {
+            eventStream->Write(event);
+         }
+         if (options.progressFormat == SyncProgressFormat::Text) {
+            const bool isProgress = event.type == DownloadEventType::Progress;
+            if (!isProgress || event.percent != lastPercent[jobIndex]) {
+               WriteTextEvent(out, jobs[jobIndex], event);
+            }
+            if (isProgress) {
+               lastPercent[jobIndex] = event.percent;
+            }
+         }
+
+         if (IsFinalEvent(event.type)) {
+            ++finished;
+            if (event.type == DownloadEventType::Completed) {
+               ++completed;
+            } else if (event.type == DownloadEventType::Failed) {
+               ++failed;
+            } else {
+               ++cancelled;
+            }
+         }
+      }
+
+      // Messages logged through wxLog on worker threads are buffered until
+      // the main thread flushes them; there is no event loop to do it here.
+      wxLog::FlushActive();
+      if (!processedAny && finished < jobs.size()) {
+         std::this_thread::sleep_for(kEventPollInterval);
+      }
+   }
+
+   worker.Stop();
+   HttpTimings::LogReport();
+   Log::Flush();
+
+   for (auto &eventStream : eventStreams) {
+      eventStream->WriteSummary();
+   }
+   if (options.progressFormat == SyncProgressFormat::Text) {
+      const auto elapsedMs =
+          std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+      out << "Synced " << completed << " of " << jobs.size() << " job(s) in " << std::fixed << std::setprecision(1)
+          << static_cast<double>(elapsedMs) / 1000.0 << " s";
+      if (failed > 0 || cancelled > 0) {
+         out << "; " << failed << " failed, " << cancelled << " cancelled";
+      }
+      out << '\n';
+   }
+   out.flush();
+
+   if (!options.httpTimingsOutput.empty() && !HttpTimings::WriteReport(options.httpTimingsOutput, errorMessage)) {
+      err << "--http-timings: " << errorMessage << '\n';
+   }
+   if (failed > 0) {
+      return kExitJobsFailed;
+   }
+   if (cancelled > 0 || cancelling) {
+      return kExitCancelled;
+   }
+   return kExitSuccess;
+}
+
+} // namespace confy
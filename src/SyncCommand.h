@@ -0,0 +1,80 @@
+#pragma once
+
+#include "ConfigModel.h"
+#include "DownloadJobBuilder.h"
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace confy {
+
+class TransferHistory;
+
+// Process exit codes of the command line front end.
+constexpr int kExitSuccess     = 0;
+constexpr int kExitJobsFailed  = 1;
+constexpr int kExitUsageError  = 2;
+constexpr int kExitConfigError = 3;
+constexpr int kExitCancelled   = 130;
+
+enum class SyncProgressFormat
+{
+   Text,
+   JsonLines
+};
+
+struct SyncOptions
+{
+   std::string configPath;
+   std::size_t jobs{6};
+   SyncProgressFormat progressFormat{SyncProgressFormat::Text};
+   bool verbose{false};
+   std::string logLevels;
+   // Optional extra JSON lines destination, see DownloadEventStream::Open.
+   std::string eventStream;
+   // Components to sync; empty syncs every component enabled in the config.
+   std::vector<std::string> onlyComponents;
+   // Keyed by component name. An override also enables the section it applies to.
+   std::map<std::string, std::string> refOverrides;
+   std::map<std::string, std::string> versionOverrides;
+   std::map<std::string, std::string> buildTypeOverrides;
+   // Print what would be transferred instead of syncing; planOutput also
+   // writes that summary to a file and implies dryRun.
+   bool dryRun{false};
+   std::string planOutput;
+   // Per-host HTTP timing summary written after the sync, see HttpTimings.
+   std::string httpTimingsOutput;
+};
+
+std::string SyncUsage();
+
+// Parses the arguments following "sync". showHelp is set for --help, in
+// which case the other options are not validated.
+bool ParseSyncArguments(const std::vector<std::string> &args,
+    SyncOptions &outOptions,
+    bool &showHelp,
+    std::string &errorMessage);
+
+// Applies --only and the ref/version/build type overrides to a loaded
+// config. Fails on component names the config does not contain and on
+// overrides for sections a component does not have.
+bool ApplySyncOverrides(const SyncOptions &options, ConfigModel &config, std::string &errorMessage);
+
+// Loads the config, runs its jobs on a DownloadWorkerQueue and streams
+// progress to out until all of them finished. Setting cancelRequested
+// cancels the remaining jobs. With dryRun the jobs are only planned, see
+// BuildApplyPlan. history may be null; it provides the plan's estimates and
+// records the downloads. Returns one of the kExit* codes.
+int RunSync(const SyncOptions &options,
+    const SourceJobSettings &sourceSettings,
+    const std::shared_ptr<TransferHistory> &history,
+    const std::atomic<bool> &cancelRequested,
+    std::ostream &out,
+    std::ostream &err);
+
+} // namespace confy
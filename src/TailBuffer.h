@@ -0,0 +1,70 @@
+#pragma once
+
+#include "RingBuffer.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace confy {
+
+// Keeps the last `capacity` bytes of a text stream, e.g. the output of a
+// long git command. A capacity of 0 is treated as 1, like RingBuffer.
+class TailBuffer final
+{
+ public:
+   explicit TailBuffer(std::size_t capacity) : bytes_(capacity) {}
+
+   void Append(std::string_view data)
+   {
+      const auto capacity = bytes_.Capacity();
+      if (data.size() > capacity) {
+         // Only the end of data can survive; skip the rest up front.
+         const auto skipped = data.size() - capacity;
+         dropped_ += skipped;
+         data.remove_prefix(skipped);
+      }
+      for (const char c : data) {
+         if (bytes_.Size() == capacity) {
+            ++dropped_;
+         }
+         bytes_.Push(c);
+      }
+   }
+
+   // Bytes pushed out of the buffer so far.
+   std::size_t Dropped() const { return dropped_; }
+
+   // The text held, preceded by a marker line when anything was dropped.
+   // A truncated text starts at the first complete line, or, if it holds
+   // no line break, at the first complete UTF-8 character, so that it never
+   // begins with half a line or half a character.
+   std::string Str() const
+   {
+      std::string text;
+      text.reserve(bytes_.Size());
+      for (std::size_t i = 0; i < bytes_.Size(); ++i) {
+         text.push_back(bytes_.At(i));
+      }
+      if (dropped_ == 0) {
+         return text;
+      }
+
+      std::size_t start = text.find('\n');
+      if (start != std::string::npos && start + 1 < text.size()) {
+         ++start;
+      } else {
+         start = 0;
+         while (start < text.size() && (static_cast<unsigned char>(text[start]) & 0xC0) == 0x80) {
+            ++start;
+         }
+      }
+      return "[... " + std::to_string(dropped_ + start) + " bytes omitted ...]\n" + text.substr(start);
+   }
+
+ private:
+   RingBuffer<char> bytes_;
+   std::size_t dropped_{0};
+};
+
+} // namespace confy
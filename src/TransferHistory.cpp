@@ -0,0 +1,139 @@
+#include "TransferHistory.h"
+
+#include "UrlUtils.h"
+
+#include <nlohmann/json.hpp>
+
+#include <utility>
+
+namespace confy {
+
+namespace {
+
+using Json = nlohmann::json;
+
+constexpr int kHistoryFormatVersion = 1;
+// Weight of a new sample in the moving average.
+constexpr double kSampleWeight = 0.3;
+
+std::string ArtifactKey(const std::string &repositoryUrl)
+{
+   return "nexus:" + UrlHost(repositoryUrl);
+}
+
+std::string SourceKey(const std::string &repositoryUrl)
+{
+   return "git:" + repositoryUrl;
+}
+
+double ToSeconds(std::chrono::milliseconds duration)
+{
+   return static_cast<double>(duration.count()) / 1000.0;
+}
+
+} // namespace
+
+TransferHistory::TransferHistory(std::string filePath) :
+    file_(std::move(filePath), kHistoryFormatVersion, "transfer history") {}
+
+void TransferHistory::RecordArtifact(const std::string &repositoryUrl,
+    std::uint64_t bytes,
+    std::chrono::milliseconds duration)
+{
+   if (bytes == 0 || duration.count() <= 0) {
+      return;
+   }
+   Update(ArtifactKey(repositoryUrl), static_cast<double>(bytes) / ToSeconds(duration));
+}
+
+void TransferHistory::RecordSource(const std::string &repositoryUrl, std::chrono::milliseconds duration)
+{
+   if (duration.count() < 0) {
+      return;
+   }
+   Update(SourceKey(repositoryUrl), ToSeconds(duration));
+}
+
+bool TransferHistory::EstimateArtifactSeconds(const std::string &repositoryUrl,
+    std::uint64_t bytes,
+    double &outSeconds) const
+{
+   Entry entry;
+   if (!Find(ArtifactKey(repositoryUrl), entry) || entry.value <= 0.0) {
+      return false;
+   }
+   outSeconds = static_cast<double>(bytes) / entry.value;
+   return true;
+}
+
+bool TransferHistory::EstimateSourceSeconds(const std::string &repositoryUrl, double &outSeconds) const
+{
+   Entry entry;
+   if (!Find(SourceKey(repositoryUrl), entry)) {
+      return false;
+   }
+   outSeconds = entry.value;
+   return true;
+}
+
+void TransferHistory::Update(const std::string &key, double sample)
+{
+   std::scoped_lock lock(mutex_);
+   auto &entry = entries_[key];
+   entry.value = entry.samples == 0 ? sample : entry.value + kSampleWeight * (sample - entry.value);
+   ++entry.samples;
+   file_.MarkChanged();
+}
+
+bool TransferHistory::Find(const std::string &key, Entry &outEntry) const
+{
+   std::scoped_lock lock(mutex_);
+   const auto it = entries_.find(key);
+   if (it == entries_.end()) {
+      return false;
+   }
+   outEntry = it->second;
+   return true;
+}
+
+bool TransferHistory::Load(std::string &errorMessage)
+{
+   std::unordered_map<std::string, Entry> loaded;
+   const auto readEntries = [&loaded](const Json &entries) {
+      for (const auto &item : entries.items()) {
+         Entry entry;
+         entry.value   = item.value().at("value").get<double>();
+         entry.samples = item.value().at("samples").get<std::uint64_t>();
+         loaded.emplace(item.key(), entry);
+      }
+   };
+   if (!file_.Read(readEntries, errorMessage)) {
+      return false;
+   }
+
+   std::scoped_lock lock(mutex_);
+   entries_ = std::move(loaded);
+   file_.MarkSaved(file_.Revision());
+   return true;
+}
+
+bool TransferHistory::Save(std::string &errorMessage) const
+{
+   auto entries           = Json::object();
+   std::uint64_t revision = 0;
+   {
+      std::scoped_lock lock(mutex_);
+      for (const auto &[key, entry] : entries_) {
+         entries[key] = {{"value", entry.value}, {"samples", entry.samples}};
+      }
+      revision = file_.Revision();
+   }
+   return file_.Write(entries, revision, errorMessage);
+}
+
+bool TransferHistory::SaveIfModified(std::string &errorMessage) const
+{
+   return !file_.IsModified() || Save(errorMessage);
+}
+
+} // namespace confy
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "JsonStoreFile.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace confy {
+
+// Persistent record of how fast past downloads were, used to estimate how
+// long a planned Apply will take. Artifact downloads are averaged as bytes
+// per second per Nexus host; source jobs as seconds per repository, since
+// a clone's duration depends on the repository rather than on its size.
+// Newer samples weigh more than older ones. All methods are thread-safe.
+class TransferHistory final
+{
+ public:
+   explicit TransferHistory(std::string filePath);
+
+   void RecordArtifact(const std::string &repositoryUrl, std::uint64_t bytes, std::chrono::milliseconds duration);
+   void RecordSource(const std::string &repositoryUrl, std::chrono::milliseconds duration);
+
+   // Return false when nothing was recorded for the host or repository yet.
+   bool EstimateArtifactSeconds(const std::string &repositoryUrl, std::uint64_t bytes, double &outSeconds) const;
+   bool EstimateSourceSeconds(const std::string &repositoryUrl, double &outSeconds) const;
+
+   // See JsonStoreFile: a missing file is not an error and Save replaces
+   // the file atomically.
+   bool Load(std::string &errorMessage);
+   bool Save(std::string &errorMessage) const;
+   bool SaveIfModified(std::string &errorMessage) const;
+
+ private:
+   struct Entry
+   {
+      double value{0.0};
+      std::uint64_t samples{0};
+   };
+
+   void Update(const std::string &key, double sample);
+   bool Find(const std::string &key, Entry &outEntry) const;
+
+   JsonStoreFile file_;
+   mutable std::mutex mutex_;
+   std::unordered_map<std::string, Entry> entries_;
+};
+
+} // namespace confy
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+
+namespace confy {
+
+// Host and port of a URL, without scheme, user info, path, query or
+// fragment: "https://user@nexus.example.com:8443/#browse/..." ->
+// "nexus.example.com:8443". A URL without a scheme is taken to start with
+// the host.
+inline std::string UrlHost(const std::string &url)
+{
+   const auto scheme = url.find("://");
+   const auto start  = scheme == std::string::npos ? 0 : scheme + 3;
+   const auto end    = url.find_first_of("/?#", start);
+   auto host         = url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+   const auto at     = host.rfind('@');
+   return at == std::string::npos ? host : host.substr(at + 1);
+}
+
+} // namespace confy
@@ -0,0 +1,216 @@
+#include "ApplyPlanner.h"
+#include "TransferHistory.h"
+
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+confy::DownloadJob MakeSourceJob(const std::string &name, const std::string &ref, const std::string &target)
+{
+   confy::GitCloneJob job;
+   job.jobId                = 1;
+   job.componentName        = name;
+   job.componentDisplayName = name;
+   job.repositoryUrl        = "https://git.example.com/scm/prj/" + name + ".git";
+   job.branchOrTag          = ref;
+   job.targetDirectory      = target;
+   return confy::DownloadJob::FromSource(std::move(job));
+}
+
+confy::DownloadJob MakeArtifactJob(const std::string &name, const std::string &target)
+{
+   confy::NexusDownloadJob job;
+   job.jobId                = 2;
+   job.componentName        = name;
+   job.componentDisplayName = name;
+   job.repositoryUrl        = "https://nexus.example.com/#browse/browse:raw";
+   job.version              = "1.0";
+   job.buildType            = "Release";
+   job.targetDirectory      = target;
+   return confy::DownloadJob::FromArtifact(std::move(job));
+}
+
+confy::NexusArtifactFile MakeFile(const std::string &relativePath, std::uint64_t size, bool sizeKnown = true)
+{
+   confy::NexusArtifactFile file;
+   file.path         = "tools/1.0/Release/" + relativePath;
+   file.relativePath = relativePath;
+   file.sizeBytes    = size;
+   file.sizeKnown    = sizeKnown;
+   return file;
+}
+
+} // namespace
+
+TEST_CASE("ApplyPlan resolves jobs without touching the target directories")
+{
+   const auto root = std::filesystem::temp_directory_path() / "confy-apply-plan-test";
+   std::filesystem::remove_all(root);
+   std::filesystem::create_directories(root / "core" / ".git");
+   std::filesystem::create_directories(root / "tools" / "bin");
+   {
+      std::ofstream present(root / "tools" / "bin" / "present.dll", std::ios::binary);
+      present << std::string(100, 'a');
+      std::ofstream changed(root / "tools" / "bin" / "changed.dll", std::ios::binary);
+      changed << std::string(10, 'b');
+   }
+
+   confy::ApplyPlanResolvers resolvers;
+   resolvers.listRefs = [](const std::string &, std::vector<std::string> &outRefs, std::string &) {
+      outRefs = {"main", "release/2.0"};
+      return true;
+   };
+   resolvers.listArtifactFiles = [](const confy::NexusDownloadJob &, std::vector<confy::NexusArtifactFile> &outFiles, std::string &) {
+      outFiles = {MakeFile("bin/present.dll", 100), MakeFile("bin/changed.dll", 200), MakeFile("bin/new.dll", 300),
+          MakeFile("readme.txt", 0, false)};
+      return true;
+   };
+
+   confy::TransferHistory history((root / "history.json").string());
+   // 1000 bytes per second from this Nexus host; 20 s for the core clone.
+   history.RecordArtifact("https://nexus.example.com/#browse/browse:raw", 10000, std::chrono::seconds(10));
+   history.RecordSource("https://git.example.com/scm/prj/core.git", std::chrono::seconds(20));
+
+   const std::vector<confy::DownloadJob> jobs = {MakeSourceJob("core", "main", (root / "core").string()),
+       MakeArtifactJob("tools", (root / "tools").string()),
+       MakeSourceJob("other", "feature/missing", (root / "other").string())};
+   const auto plan = confy::BuildApplyPlan(jobs, resolvers, &history, 2, 4);
+
+   REQUIRE(plan.jobs.size() == 3);
+   // Existing checkouts are reported as updates.
+   CHECK(plan.jobs[0].resolved);
+   CHECK(plan.jobs[0].refExists);
+   CHECK(plan.jobs[0].checkoutExists);
+   CHECK(plan.jobs[0].estimateKnown);
+   CHECK(plan.jobs[0].estimatedSeconds == doctest::Approx(20.0));
+
+   // Only files with the same size count as present; unknown sizes are not summed.
+   const auto &artifact = plan.jobs[1];
+   CHECK(artifact.resolved);
+   CHECK(artifact.target == "1.0/Release");
+   CHECK(artifact.totalBytes == 600);
+   CHECK(artifact.unknownSizeFiles == 1);
+   CHECK(artifact.presentFiles == 1);
+   CHECK(artifact.presentBytes == 100);
+   CHECK(artifact.estimatedSeconds == doctest::Approx(0.6));
+
+   // Missing refs fail the job in the plan.
+   CHECK_FALSE(plan.jobs[2].resolved);
+   CHECK_FALSE(plan.jobs[2].refExists);
+   CHECK(plan.failedJobs == 1);
+
+   // The run lasts as long as the slowest job when there are enough workers.
+   CHECK(plan.fileCount == 4);
+   CHECK(plan.totalBytes == 600);
+   CHECK(plan.estimatedSeconds == doctest::Approx(20.0));
+
+   const auto summary = confy::BuildHumanReadablePlanSummary(plan);
+   CHECK(summary.find("update existing checkout") != std::string::npos);
+   CHECK(summary.find("4 files, 600 B + 1 of unknown size") != std::string::npos);
+   CHECK(summary.find("ERROR: Branch or tag 'feature/missing' not found") != std::string::npos);
+   CHECK(summary.find("~20s with 2 parallel jobs") != std::string::npos);
+
+   // Nothing was created or removed.
+   CHECK_FALSE(std::filesystem::exists(root / "other"));
+   CHECK_FALSE(std::filesystem::exists(root / "tools" / "bin" / "new.dll"));
+   CHECK(std::filesystem::file_size(root / "tools" / "bin" / "changed.dll") == 10);
+
+   std::filesystem::remove_all(root);
+}
+
+TEST_CASE("ApplyPlan fails artifact jobs without a version or build type")
+{
+   std::atomic<int> fileListings{0};
+   confy::ApplyPlanResolvers resolvers;
+   resolvers.listArtifactFiles = [&](const confy::NexusDownloadJob &, std::vector<confy::NexusArtifactFile> &, std::string &) {
+      ++fileListings;
+      return true;
+   };
+
+   auto noVersion                 = MakeArtifactJob("unset", "/tmp/confy-apply-plan-unset/unset");
+   noVersion.artifact.version     = "";
+   auto noBuildType               = MakeArtifactJob("untyped", "/tmp/confy-apply-plan-unset/untyped");
+   noBuildType.artifact.buildType = "";
+   const auto plan                = confy::BuildApplyPlan({noVersion, noBuildType}, resolvers, nullptr, 2, 4);
+
+   // Neither job asks Nexus for its files.
+   REQUIRE(plan.jobs.size() == 2);
+   CHECK(fileListings == 0);
+   CHECK(plan.failedJobs == 2);
+   CHECK_FALSE(plan.jobs[0].resolved);
+   CHECK(plan.jobs[0].errorMessage == "No version selected");
+   CHECK_FALSE(plan.jobs[1].resolved);
+   CHECK(plan.jobs[1].errorMessage == "No build type selected");
+}
+
+TEST_CASE("ValidateApplyJobs reports every problem before anything is downloaded")
+{
+   std::atomic<int> refListings{0};
+   confy::ApplyPlanResolvers resolvers;
+   resolvers.listRefs = [&](const std::string &repositoryUrl, std::vector<std::string> &outRefs, std::string &errorMessage) {
+      ++refListings;
+      if (repositoryUrl.find("offline") != std::string::npos) {
+         errorMessage = "No credentials found in .m2/settings.xml for server id 'git.example.com'.";
+         return false;
+      }
+      outRefs = {"main", "v1.0"};
+      return true;
+   };
+   resolvers.checkArtifact = [](const confy::NexusDownloadJob &job, std::string &errorMessage) {
+      if (job.buildType != "Release") {
+         errorMessage = "Build type '" + job.buildType + "' not found";
+         return false;
+      }
+      return true;
+   };
+
+   auto debugArtifact               = MakeArtifactJob("debug", "/tmp/confy-preflight/debug");
+   debugArtifact.artifact.buildType = "Debug";
+   auto noVersion                   = MakeArtifactJob("unset", "/tmp/confy-preflight/unset");
+   noVersion.artifact.version       = "";
+   auto noBuildType                 = MakeArtifactJob("untyped", "/tmp/confy-preflight/untyped");
+   noBuildType.artifact.buildType   = "";
+
+   const std::vector<confy::DownloadJob> jobs = {MakeSourceJob("core", "main", "/tmp/confy-preflight/core"),
+       MakeSourceJob("core", "feature/gone", "/tmp/confy-preflight/core-feature"),
+       MakeSourceJob("core", "", "/tmp/confy-preflight/core-default"),
+       MakeSourceJob("offline", "main", "/tmp/confy-preflight/offline"),
+       MakeArtifactJob("tools", "/tmp/confy-preflight/tools"),
+       debugArtifact,
+       noVersion,
+       noBuildType};
+
+   const auto problems = confy::ValidateApplyJobs(jobs, resolvers, 4);
+   // The core repository is listed once for its three jobs.
+   CHECK(refListings == 2);
+   REQUIRE(problems.size() == 5);
+   CHECK(problems[0].jobIndex == 1);
+   CHECK(problems[0].message == "Branch or tag 'feature/gone' not found");
+   CHECK(problems[1].jobIndex == 3);
+   CHECK(problems[1].message.find("No credentials") == 0);
+   CHECK(problems[2].jobIndex == 5);
+   CHECK(problems[2].kind == confy::DownloadJobKind::NexusArtifact);
+   CHECK(problems[3].jobIndex == 6);
+   CHECK(problems[3].message == "No version selected");
+   // Without a build type the download would list version// and fail mid-run.
+   CHECK(problems[4].jobIndex == 7);
+   CHECK(problems[4].message == "No build type selected");
+
+   const auto report = confy::BuildHumanReadablePreflightReport(problems);
+   CHECK(report.find("- debug (debug) artifact: Build type 'Debug' not found\n") != std::string::npos);
+
+   std::atomic<bool> cancelRequested{true};
+   refListings              = 0;
+   const auto cancelled     = confy::ValidateApplyJobs(jobs, resolvers, 4, &cancelRequested);
+   const auto cancelledPlan = confy::BuildApplyPlan(jobs, resolvers, nullptr, 2, 4, &cancelRequested);
+   // Once cancelled, nothing is looked up and every job is reported.
+   CHECK(refListings == 0);
+   CHECK(cancelled.size() == jobs.size());
+   CHECK(cancelled[0].message == "Cancelled");
+   CHECK(cancelledPlan.failedJobs == jobs.size());
+   CHECK(cancelledPlan.jobs[4].errorMessage == "Cancelled");
+}
@@ -2,6 +2,9 @@
 
 #include <doctest/doctest.h>
 
+#include <algorithm>
+#include <atomic>
+
 TEST_CASE("BitbucketClient parses supported repository URL formats")
 {
    confy::BitbucketClient::RepoCoordinates repo;
@@ -28,3 +31,47 @@ TEST_CASE("BitbucketClient parses supported repository URL formats")
    CHECK_FALSE(confy::BitbucketClient::ParseRepositoryUrl(
        "https://bitbucket.example.com/OPS/confy-configs", repo, error));
 }
+
+TEST_CASE("BitbucketClient collects concurrently fetched pages in order")
+{
+   constexpr int kTotal    = 2350;
+   constexpr int kPageSize = 100;
+   std::atomic<int> requests{0};
+   const auto fetchPage = [&](int start, confy::BitbucketClient::Page &page, std::string &) {
+      ++requests;
+      for (int i = start; i < std::min(start + kPageSize, kTotal); ++i) {
+         page.values.push_back(std::to_string(i));
+      }
+      page.limit         = kPageSize;
+      page.isLastPage    = start + kPageSize >= kTotal;
+      page.nextPageStart = page.isLastPage ? -1 : start + kPageSize;
+      return true;
+   };
+
+   std::vector<std::string> values;
+   std::string error;
+   REQUIRE(confy::BitbucketClient::CollectPages(fetchPage, 4, values, error));
+
+   // Every value should arrive exactly once and in page order.
+   REQUIRE(values.size() == static_cast<std::size_t>(kTotal));
+   for (int i = 0; i < kTotal; ++i) {
+      CHECK(values[static_cast<std::size_t>(i)] == std::to_string(i));
+   }
+   // Speculative windows may overshoot by less than one window.
+   CHECK(requests.load() < kTotal / kPageSize + 1 + 4);
+
+   // A failing page should fail the whole listing with its error.
+   const auto failingFetch = [&](int start, confy::BitbucketClient::Page &page, std::string &pageError) {
+      if (start == 300) {
+         pageError = "boom";
+         return false;
+      }
+      return fetchPage(start, page, pageError);
+   };
+   CHECK_FALSE(confy::BitbucketClient::CollectPages(failingFetch, 4, values, error));
+   CHECK(error == "boom");
+
+   // Bitbucket repository URLs are recognized without logging parse errors.
+   CHECK(confy::BitbucketClient::IsRepositoryUrl("https://bitbucket.example.com/scm/OPS/confy.git"));
+   CHECK_FALSE(confy::BitbucketClient::IsRepositoryUrl("https://github.com/example/confy.git"));
+}
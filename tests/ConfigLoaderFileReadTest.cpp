@@ -0,0 +1,91 @@
+#include "ConfigLoader.h"
+
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+
+constexpr char kConfigXml[] = R"xml(<CONFIG>
+    <Version>3</Version>
+    <PATH>/opt/confy</PATH>
+    <Components>
+        <component>
+            <NAME>core</NAME>
+            <name>ignored</name>
+            <PATH>%PATH%/core</PATH>
+            <SOURCE>
+                <ISENABLED/>
+                <Url>https://git.example.com/core.git?a=1&amp;b=2</Url>
+                <BranchOrTag>main</BranchOrTag>
+                <SparseCheckout><Path>libs</Path><PATH>tools</PATH></SparseCheckout>
+            </SOURCE>
+            <ARTIFACT>
+                <Url>https://nexus.example.com/#browse/browse:raw</Url>
+                <Version>1.0</Version>
+                <BuildType>Release</BuildType>
+                <Regex-Include><REGEX>\.dll$</REGEX></Regex-Include>
+            </ARTIFACT>
+        </component>
+        <Component>
+            <name>tools</name>
+            <Artifact>
+                <Regex-Include><regex>\.dll$</regex></Regex-Include>
+            </Artifact>
+        </Component>
+    </Components>
+</CONFIG>
+)xml";
+
+std::string WriteConfig(const std::string &fileName, const std::string &text)
+{
+   const auto path = std::filesystem::temp_directory_path() / fileName;
+   std::ofstream output(path, std::ios::binary | std::ios::trunc);
+   output << text;
+   return path.string();
+}
+
+} // namespace
+
+TEST_CASE("ConfigLoader reads files the same way as strings")
+{
+   confy::ConfigLoader loader;
+   const auto fromString = loader.LoadFromString(kConfigXml);
+   REQUIRE(fromString.success);
+
+   // Element names match in any case; the first of duplicate children wins.
+   REQUIRE(fromString.config.components.size() == 2);
+   const auto &core = fromString.config.components[0];
+   CHECK(core.name == "core");
+   CHECK(core.path == "/opt/confy/core");
+   CHECK(core.source.enabled);
+   CHECK(core.source.url == "https://git.example.com/core.git?a=1&b=2");
+   CHECK(core.source.sparsePaths == std::vector<std::string>{"libs", "tools"});
+   CHECK(core.artifact.regexIncludes == std::vector<std::string>{"\\.dll$"});
+   CHECK_FALSE(core.artifact.enabled);
+   CHECK(fromString.config.components[1].displayName == "tools");
+
+   const auto filePath = WriteConfig("confy-config-file-read.xml", kConfigXml);
+   const auto fromFile = loader.LoadFromFile(filePath);
+   REQUIRE(fromFile.success);
+   CHECK(fromFile.config == fromString.config);
+
+   // A file that fills its last memory page exactly leaves no room for the
+   // terminating zero of a mapping and is read into memory instead.
+   std::string padded = kConfigXml;
+   padded.resize(64 * 1024, ' ');
+   const auto paddedPath = WriteConfig("confy-config-file-read-padded.xml", padded);
+   const auto fromPadded = loader.LoadFromFile(paddedPath);
+   REQUIRE(fromPadded.success);
+   CHECK(fromPadded.config == fromString.config);
+
+   // Empty files fail like empty strings.
+   const auto emptyPath = WriteConfig("confy-config-file-read-empty.xml", "");
+   CHECK(loader.LoadFromFile(emptyPath).errorMessage == "Root <Config> node not found.");
+
+   std::filesystem::remove(filePath);
+   std::filesystem::remove(paddedPath);
+   std::filesystem::remove(emptyPath);
+}
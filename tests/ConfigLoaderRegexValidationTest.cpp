@@ -33,3 +33,30 @@ TEST_CASE("ConfigLoader rejects invalid artifact regex filters")
    CHECK_FALSE(result.success);
    CHECK(result.errorMessage.find("Invalid regex") != std::string::npos);
 }
+
+TEST_CASE("ConfigLoader rejects unknown source clone filters")
+{
+   static constexpr char kInvalidFilterConfigXml[] = R"xml(<Config>
+    <version>1</version>
+    <path>/tmp/confy-downloads</path>
+    <components>
+        <Component>
+            <name>bad_filter_component</name>
+            <Path>componentBad</Path>
+            <Source>
+                <IsEnabled/>
+                <url>https://bitbucket.example.com/project/myrepo.git</url>
+                <Filter>blob:none --upload-pack=touch</Filter>
+            </Source>
+        </Component>
+    </components>
+</Config>
+)xml";
+
+   confy::ConfigLoader loader;
+   const auto result = loader.LoadFromString(kInvalidFilterConfigXml);
+
+   // Filters are passed to git, so anything but the known filter specs is rejected.
+   CHECK_FALSE(result.success);
+   CHECK(result.errorMessage.find("Invalid <Filter>") != std::string::npos);
+}
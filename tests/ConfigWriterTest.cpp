@@ -19,6 +19,8 @@ TEST_CASE("ConfigWriter round-trips configuration and summary output")
    enabledArtifact.source.url             = "https://example.com/core.git";
    enabledArtifact.source.branchOrTag     = "main";
    enabledArtifact.source.shallow         = false;
+   enabledArtifact.source.filter          = "blob:none";
+   enabledArtifact.source.sparsePaths     = {"libs/core", "tools/build & deploy"};
    enabledArtifact.source.script          = "git submodule update --init --recursive";
    enabledArtifact.artifact.enabled       = true;
    enabledArtifact.artifact.url           = "https://repo.example.com/releases";
@@ -0,0 +1,119 @@
+#include "DownloadEventStream.h"
+
+#include <doctest/doctest.h>
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+TEST_CASE("DownloadEventStream writes JSON lines with rate-limited progress and final totals")
+{
+   using namespace std::chrono_literals;
+   using Json = nlohmann::json;
+
+   std::vector<Json> lines;
+   confy::DownloadEventStream stream(
+       [&lines](const std::string &line) {
+          // Every record is one complete line.
+          CHECK(line.back() == '\n');
+          CHECK(line.find('\n') == line.size() - 1);
+          lines.push_back(Json::parse(line));
+          return true;
+       },
+       100ms);
+
+   confy::NexusDownloadJob artifact;
+   artifact.jobId         = 7;
+   artifact.componentName = "core";
+   artifact.version       = "1.2.3";
+   artifact.buildType     = "Release";
+   confy::GitCloneJob source;
+   source.jobId         = 8;
+   source.componentName = "tools";
+   source.branchOrTag   = "main";
+   stream.AddJobs({confy::DownloadJob::FromArtifact(artifact), confy::DownloadJob::FromSource(source)});
+
+   const auto t0 = confy::DownloadEventStream::Clock::now();
+   stream.Write({7, 0, confy::DownloadEventType::Started, 0, 0, "Starting"}, t0);
+   stream.Write({7, 0, confy::DownloadEventType::Progress, 10, 1000, ""}, t0 + 10ms);
+   stream.Write({7, 0, confy::DownloadEventType::Progress, 20, 2000, ""}, t0 + 50ms);
+   stream.Write({7, 0, confy::DownloadEventType::Progress, 30, 3000, ""}, t0 + 120ms);
+   stream.Write({7, 0, confy::DownloadEventType::Completed, 100, 0, ""}, t0 + 400ms);
+   stream.Write({8, 1, confy::DownloadEventType::Failed, 0, 0, "clone failed \xff"}, t0 + 500ms);
+   stream.WriteSummary(t0 + 600ms);
+
+   // The progress line at +50ms falls inside the interval and is dropped.
+   REQUIRE(lines.size() == 6);
+   CHECK(stream.DroppedProgressCount() == 1);
+   CHECK(lines[0]["event"] == "started");
+   CHECK(lines[0]["component"] == "core");
+   CHECK(lines[0]["kind"] == "artifact");
+   CHECK(lines[0]["target"] == "1.2.3/Release");
+   CHECK(lines[1]["percent"] == 10);
+   CHECK(lines[2]["percent"] == 30);
+   CHECK(lines[2]["bytes"] == 3000);
+
+   // Final events carry status, duration and the highest byte count seen.
+   CHECK(lines[3]["status"] == "completed");
+   CHECK(lines[3]["durationMs"] == 400);
+   CHECK(lines[3]["bytes"] == 3000);
+   CHECK(lines[4]["status"] == "failed");
+   CHECK(lines[4]["component"] == "tools");
+   CHECK(lines[4]["kind"] == "source");
+   CHECK(lines[4]["message"].get<std::string>().find("clone failed") == 0);
+
+   CHECK(lines[5]["event"] == "summary");
+   CHECK(lines[5]["jobs"] == 2);
+   CHECK(lines[5]["completed"] == 1);
+   CHECK(lines[5]["failed"] == 1);
+   CHECK(lines[5]["bytes"] == 3000);
+   CHECK(lines[5]["droppedProgress"] == 1);
+}
+
+#ifndef _WIN32
+TEST_CASE("DownloadEventStream disconnects a Unix socket reader that stops reading")
+{
+   const auto socketPath = "/tmp/confy-event-stream-test-" + std::to_string(::getpid()) + ".sock";
+   ::unlink(socketPath.c_str());
+   const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+   REQUIRE(listener >= 0);
+   sockaddr_un address{};
+   address.sun_family = AF_UNIX;
+   std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+   REQUIRE(::bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0);
+   REQUIRE(::listen(listener, 1) == 0);
+
+   std::string errorMessage;
+   auto stream = confy::DownloadEventStream::Open("unix:" + socketPath, std::chrono::milliseconds(0), errorMessage);
+   REQUIRE(stream);
+   // The reader accepts the connection but never reads from it.
+   const int reader = ::accept(listener, nullptr, nullptr);
+   REQUIRE(reader >= 0);
+
+   confy::GitCloneJob source;
+   source.jobId         = 1;
+   source.componentName = "core";
+   stream->AddJobs({confy::DownloadJob::FromSource(source)});
+   const std::string message(64 * 1024, 'x');
+   const auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < 200; ++i) {
+      stream->Write({1, 0, confy::DownloadEventType::Started, 0, 0, message});
+   }
+   stream->WriteSummary();
+   // Far more than the socket buffers; the writer gives up instead of blocking.
+   CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+
+   ::close(reader);
+   ::close(listener);
+   ::unlink(socketPath.c_str());
+}
+#endif
@@ -1,7 +1,17 @@
 #include "GitClient.h"
+#include "GitProgress.h"
 
 #include <doctest/doctest.h>
 
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
 TEST_CASE("GitClient extracts hosts and parses ls-remote refs")
 {
    std::string host;
@@ -26,3 +36,209 @@ TEST_CASE("GitClient extracts hosts and parses ls-remote refs")
    CHECK(refs[2] == "v1.0.0");
    CHECK(refs[3] == "v2.0.0");
 }
+
+TEST_CASE("GitClient derives stable mirror directory names")
+{
+   const auto name = confy::GitClient::BuildMirrorDirectoryName("https://bitbucket.example.com/scm/prj/repo.git");
+
+   // Mirror names keep a readable host/path prefix and end in a hash plus .git.
+   CHECK(name.rfind("bitbucket.example.com_scm_prj_repo-", 0) == 0);
+   CHECK(name.size() == std::string("bitbucket.example.com_scm_prj_repo-").size() + 16 + 4);
+   CHECK(name.compare(name.size() - 4, 4, ".git") == 0);
+
+   // Trailing slashes do not change the mirror identity.
+   CHECK(confy::GitClient::BuildMirrorDirectoryName("https://bitbucket.example.com/scm/prj/repo.git/") == name);
+
+   // Different repositories map to different mirrors.
+   CHECK(confy::GitClient::BuildMirrorDirectoryName("https://bitbucket.example.com/scm/prj/other.git") != name);
+}
+
+TEST_CASE("GitClient formats commands for logging without credentials")
+{
+   const auto formatted = confy::GitClient::FormatCommandForLog(
+       {"git", "-c", "http.extraHeader=Authorization: Bearer s3cr3t", "clone", "--", "https://host/repo.git", "/tmp/my dir"});
+
+   // The bearer token never reaches the log.
+   CHECK(formatted.find("s3cr3t") == std::string::npos);
+   CHECK(formatted.find("http.extraHeader=Authorization: <redacted>") != std::string::npos);
+
+   // Arguments with spaces are quoted so the logged command stays readable.
+   CHECK(formatted.find("clone -- https://host/repo.git \"/tmp/my dir\"") != std::string::npos);
+}
+
+namespace {
+
+using ProgressReports = std::vector<std::pair<int, std::string>>;
+
+confy::GitClient::ProgressCallback RecordProgress(ProgressReports &reports)
+{
+   return [&reports](int percent, const std::string &message) { reports.emplace_back(percent, message); };
+}
+
+} // namespace
+
+TEST_CASE("Git progress follows carriage-return redraws split across chunks")
+{
+   ProgressReports reports;
+   const auto progress = RecordProgress(reports);
+   confy::GitProgressState state;
+
+   confy::PumpGitProgress(progress, "Cloning into 'repo'...\nReceiving objects:  10% (1/10)\rReceiving obj", state);
+   // The half line stays buffered until the rest of it arrives.
+   REQUIRE(reports.size() == 1);
+   CHECK(reports[0] == std::make_pair(47, std::string("Receiving objects")));
+
+   confy::PumpGitProgress(progress, "ects:  50% (5/10)\r", state);
+   confy::PumpGitProgress(progress, "Receiving objects: 100% (10/10), done.\r\nResolving deltas:  50% (1/2)\r", state);
+   // Each redraw of the line counts, mapped into the stage's share of the clone.
+   REQUIRE(reports.size() == 4);
+   CHECK(reports[1].first == 62);
+   CHECK(reports[2].first == 80);
+   CHECK(reports[3] == std::make_pair(87, std::string("Resolving deltas")));
+
+   confy::PumpGitProgress(progress, "Resolving deltas: 100% (2/2), done.", state);
+   // Output that ends without a line break is handled when flushed.
+   CHECK(reports.size() == 4);
+   confy::FlushGitProgress(progress, state);
+   REQUIRE(reports.size() == 5);
+   CHECK(reports[4].first == 94);
+   CHECK(state.partialLine.empty());
+}
+
+TEST_CASE("Git progress stays monotonic while submodule lines interleave")
+{
+   ProgressReports reports;
+   const auto progress = RecordProgress(reports);
+   confy::GitProgressState state;
+
+   confy::PumpGitProgress(progress, "Receiving objects: 100% (4/4)\nResolving deltas:  50% (1/2)\r", state);
+   // The superproject clone maps into the first 80% or so.
+   REQUIRE(reports.size() == 2);
+   CHECK(reports[1].first == 87);
+
+   state.submodulePhase      = true;
+   state.lastReportedPercent = 80;
+   reports.clear();
+   confy::PumpGitProgress(progress,
+       "Submodule 'a' (https://host/a.git) registered for path 'a'\n"
+       "Submodule 'b' (https://host/b.git) registered for path 'b'\n"
+       "Receiving objects:  50% (1/2)\r"
+       "Receiving objects:  10% (1/10)\r"
+       "Resolving deltas: 100% (3/3), done.\n",
+       state);
+   // With two submodules registered, stage lines advance within the first
+   // submodule's slot; b's line at 10% would move backwards and is dropped.
+   REQUIRE(state.submodulesRegistered == 2);
+   REQUIRE(reports.size() == 2);
+   CHECK(reports[0] == std::make_pair(85, std::string("Receiving objects")));
+   CHECK(reports[1] == std::make_pair(88, std::string("Resolving deltas")));
+
+   confy::PumpGitProgress(progress, "Submodule path 'a': checked out '0123abcd'\nResolving deltas:  50% (1/2)\r", state);
+   // A completed submodule moves on to the next slot.
+   REQUIRE(reports.size() == 4);
+   CHECK(reports[2] == std::make_pair(89, std::string("Updating submodules (1/2)")));
+   CHECK(reports[3] == std::make_pair(97, std::string("Resolving deltas")));
+
+   confy::PumpGitProgress(progress, "Receiving objects:  90% (9/10)\rSubmodule path 'b': checked out '4567ef01'\n", state);
+   // Once every submodule is checked out the clone is at 99%.
+   REQUIRE(reports.size() == 5);
+   CHECK(reports[4] == std::make_pair(99, std::string("Updating submodules (2/2)")));
+}
+
+#ifndef _WIN32
+TEST_CASE("GitClient keeps only the output tail but logs the full output")
+{
+   // 200 numbered lines of 10 bytes each ("line 0000\n" ... "line 0199\n").
+   const std::vector<std::string> command{"sh", "-c", "i=0; while [ $i -lt 200 ]; do printf 'line %04d\\n' $i; i=$((i+1)); done"};
+   std::string output;
+   std::string error;
+
+   REQUIRE(confy::GitClient::RunCommandCapture(command, output, error));
+   // Without a tail limit the caller gets every byte.
+   CHECK(output.size() == 2000);
+   CHECK(output.rfind("line 0000\n", 0) == 0);
+
+   std::ostringstream log;
+   REQUIRE(confy::GitClient::RunCommandCapture(command, output, error, nullptr, nullptr, 256, &log));
+   // With a limit the caller gets the newest lines behind a marker...
+   CHECK(output.rfind("[... ", 0) == 0);
+   CHECK(output.size() <= 256 + 64);
+   CHECK(output.find("line 0000") == std::string::npos);
+   CHECK(output.compare(output.size() - 10, 10, "line 0199\n") == 0);
+   // ...and it starts at a complete line.
+   CHECK(output.find(" bytes omitted ...]\nline ") != std::string::npos);
+   // The log receives the command line and the whole output.
+   const auto logged = log.str();
+   CHECK(logged.rfind("$ sh -c ", 0) == 0);
+   CHECK(logged.find("line 0000\n") != std::string::npos);
+   CHECK(logged.size() > 2000);
+}
+
+TEST_CASE("GitClient stops a running command once cancellation is notified")
+{
+   const std::vector<std::string> command{"sleep", "30"};
+   std::string output;
+   std::string error;
+
+   // A flag set before the command starts stops it right away.
+   std::atomic<bool> cancelled{true};
+   auto started = std::chrono::steady_clock::now();
+   CHECK_FALSE(confy::GitClient::RunCommandCapture(command, output, error, nullptr, &cancelled));
+   CHECK(error == "Cancelled");
+   CHECK(std::chrono::steady_clock::now() - started < std::chrono::seconds(5));
+
+   // The notification wakes a command that is waiting for output or exit.
+   std::atomic<bool> cancelRequested{false};
+   std::thread canceller([&cancelRequested] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      cancelRequested.store(true);
+      confy::GitClient::NotifyCancelRequested(cancelRequested);
+   });
+   started = std::chrono::steady_clock::now();
+   CHECK_FALSE(confy::GitClient::RunCommandCapture(command, output, error, nullptr, &cancelRequested));
+   canceller.join();
+   CHECK(error == "Cancelled");
+   CHECK(std::chrono::steady_clock::now() - started < std::chrono::seconds(5));
+}
+
+TEST_CASE("GitClient clones the remote's default branch through the mirror")
+{
+   const auto root = std::filesystem::temp_directory_path() / "confy-git-mirror-head-test";
+   std::filesystem::remove_all(root);
+   const auto work = (root / "work").string();
+   std::string output;
+   std::string error;
+   auto git = [&](const std::string &directory, std::vector<std::string> arguments) {
+      arguments.insert(arguments.begin(),
+          {"git", "-c", "user.name=Test", "-c", "user.email=test@example.com", "-c", "init.defaultBranch=trunk", "-C", directory});
+      return confy::GitClient::RunCommandCapture(arguments, output, error);
+   };
+
+   // An origin whose only branch is "trunk", so the mirror's initial
+   // HEAD (master) names nothing.
+   std::filesystem::create_directories(work);
+   std::ofstream(root / "work" / "README") << "hello\n";
+   REQUIRE(git(work, {"init", "--quiet"}));
+   REQUIRE(git(work, {"add", "README"}));
+   REQUIRE(git(work, {"commit", "--quiet", "-m", "initial"}));
+   REQUIRE(git(root.string(), {"clone", "--quiet", "--bare", work, "origin.git"}));
+   const auto originUrl = "file://" + (root / "origin.git").string();
+
+   REQUIRE(confy::GitClient::RunCommandCapture({"git", "ls-remote", "--symref", originUrl, "HEAD"}, output, error));
+   CHECK(confy::GitClient::ParseLsRemoteHead(output) == "refs/heads/trunk");
+
+   confy::GitClient client{confy::AuthCredentials()};
+   confy::GitCloneOptions options;
+   options.mirrorCacheDirectory = (root / "mirrors").string();
+   std::atomic<bool> cancel{false};
+   for (const bool shallow : {true, false}) {
+      options.shallow    = shallow;
+      const auto checkout = root / (shallow ? "shallow" : "full");
+      // An empty ref means the remote's default branch.
+      REQUIRE(client.CloneRepository(originUrl, "", checkout.string(), options, cancel, nullptr, error));
+      CHECK(std::filesystem::is_regular_file(checkout / "README"));
+   }
+
+   std::filesystem::remove_all(root);
+}
+#endif
@@ -0,0 +1,107 @@
+#include "HttpTimings.h"
+#include "UrlUtils.h"
+
+#include <doctest/doctest.h>
+
+#include <string>
+
+TEST_CASE("LatencyHistogram percentiles stay within a bucket of the exact value")
+{
+   confy::LatencyHistogram histogram;
+   // An empty histogram reports zeros.
+   CHECK(histogram.Percentile(0.5) == 0.0);
+
+   for (int i = 1; i <= 1000; ++i) {
+      histogram.Add(i / 1000.0);
+   }
+   REQUIRE(histogram.Count() == 1000);
+   // Buckets are 10% wide and percentiles report their upper bound.
+   CHECK(histogram.Percentile(0.50) >= 0.500);
+   CHECK(histogram.Percentile(0.50) <= 0.550);
+   CHECK(histogram.Percentile(0.95) >= 0.950);
+   CHECK(histogram.Percentile(0.95) <= 1.000);
+   CHECK(histogram.Percentile(0.99) >= 0.990);
+   CHECK(histogram.Percentile(1.00) == 1.000);
+   CHECK(histogram.Max() == 1.000);
+   CHECK(histogram.Mean() == doctest::Approx(0.5005));
+
+   confy::LatencyHistogram reused;
+   reused.Add(0.0);
+   reused.Add(0.0);
+   reused.Add(0.0);
+   reused.Add(0.020);
+   reused.Add(-1.0);
+   // Zeros count below every other value; negative values are ignored.
+   CHECK(reused.Count() == 4);
+   CHECK(reused.Percentile(0.50) == 0.0);
+   CHECK(reused.Percentile(0.99) == doctest::Approx(0.020));
+
+   confy::LatencyHistogram throughput;
+   throughput.Add(50.0 * 1024 * 1024 * 1024);
+   // Values far above the range of seconds share the same buckets.
+   CHECK(throughput.Percentile(0.5) == doctest::Approx(50.0 * 1024 * 1024 * 1024));
+}
+
+TEST_CASE("UrlHost keeps only the host and port")
+{
+   // Credentials, path and fragment are dropped; the port stays.
+   CHECK(confy::UrlHost("https://user@nexus.example.com:8443/#browse/browse:raw") == "nexus.example.com:8443");
+   CHECK(confy::UrlHost("https://bitbucket.example.com/rest/api/1.0/projects?limit=100") == "bitbucket.example.com");
+   // Without a scheme the URL starts with the host.
+   CHECK(confy::UrlHost("git.example.com/scm/prj/repo.git") == "git.example.com");
+}
+
+TEST_CASE("HttpTimings aggregates requests per host")
+{
+   confy::HttpTimings::Reset();
+   // Nothing recorded means an empty report.
+   CHECK(confy::HttpTimings::BuildReport().empty());
+
+   for (int i = 0; i < 100; ++i) {
+      confy::HttpRequestTiming timing;
+      timing.host              = "nexus.example.com:8443";
+      timing.nameLookupSeconds = i == 0 ? 0.050 : 0.0;
+      timing.connectSeconds    = i == 0 ? 0.010 : 0.0;
+      timing.tlsSeconds        = i == 0 ? 0.030 : 0.0;
+      timing.firstByteSeconds  = i < 90 ? 0.020 : 0.400;
+      timing.totalSeconds      = timing.firstByteSeconds + 0.1;
+      timing.downloadBytes     = 1024 * 1024;
+      timing.bytesPerSecond    = 10.0 * 1024 * 1024;
+      confy::HttpTimings::Record(timing);
+   }
+   confy::HttpRequestTiming failed;
+   failed.host         = "bitbucket.example.com";
+   failed.totalSeconds = 30.0;
+   failed.failed       = true;
+   confy::HttpTimings::Record(failed);
+
+   const auto hosts = confy::HttpTimings::Snapshot();
+   REQUIRE(hosts.size() == 2);
+   // Hosts are sorted and keep their own counters.
+   CHECK(hosts[0].host == "bitbucket.example.com");
+   CHECK(hosts[0].requests == 1);
+   CHECK(hosts[0].failures == 1);
+   CHECK(hosts[0].bytesPerSecond.Count() == 0);
+   const auto &nexus = hosts[1];
+   CHECK(nexus.requests == 100);
+   CHECK(nexus.failures == 0);
+   CHECK(nexus.downloadBytes == 100ull * 1024 * 1024);
+   // Only the first request set up a connection; the others reused it.
+   CHECK(nexus.nameLookup.Percentile(0.50) == 0.0);
+   CHECK(nexus.nameLookup.Max() == doctest::Approx(0.050));
+   // The slow tail of the server shows up in p95 but not in p50.
+   CHECK(nexus.firstByte.Percentile(0.50) >= 0.020);
+   CHECK(nexus.firstByte.Percentile(0.50) <= 0.022);
+   CHECK(nexus.firstByte.Percentile(0.95) == doctest::Approx(0.400));
+
+   const auto report = confy::HttpTimings::BuildReport(hosts);
+   // One block per host, each with a row per phase.
+   CHECK(report.find("bitbucket.example.com: 1 request(s), 1 failed, 0 B downloaded\n") != std::string::npos);
+   CHECK(report.find("nexus.example.com:8443: 100 request(s), 0 failed, 100.0 MiB downloaded\n") != std::string::npos);
+   CHECK(report.find("first byte ms") != std::string::npos);
+   CHECK(report.find("download KiB/s") != std::string::npos);
+   CHECK(report.find("p99") != std::string::npos);
+
+   confy::HttpTimings::Reset();
+   CHECK(confy::HttpTimings::Snapshot().empty());
+}
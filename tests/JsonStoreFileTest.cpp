@@ -0,0 +1,70 @@
+#include "JsonStoreFile.h"
+
+#include <doctest/doctest.h>
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+TEST_CASE("JsonStoreFile writes atomically and tracks unsaved changes")
+{
+   const auto directory = std::filesystem::temp_directory_path() / "confy-json-store-file-test";
+   const auto storeFile = (directory / "store.json").string();
+   std::filesystem::remove_all(directory);
+
+   nlohmann::json read;
+   const auto readEntries = [&read](const nlohmann::json &entries) { read = entries; };
+   std::string error;
+
+   confy::JsonStoreFile file(storeFile, 2, "test store");
+   // A missing file reads nothing and is not an error.
+   REQUIRE(file.Read(readEntries, error));
+   CHECK(read.is_null());
+   CHECK_FALSE(file.IsModified());
+
+   // A change made after the revision was taken stays unsaved.
+   file.MarkChanged();
+   const auto revision = file.Revision();
+   file.MarkChanged();
+   REQUIRE(file.Write({{"a", 1}}, revision, error));
+   CHECK(file.IsModified());
+   REQUIRE(file.Write({{"a", 1}, {"b", 2}}, file.Revision(), error));
+   CHECK_FALSE(file.IsModified());
+
+   REQUIRE(file.Read(readEntries, error));
+   CHECK(read == nlohmann::json{{"a", 1}, {"b", 2}});
+
+   // A file of another format version reads nothing.
+   read = nullptr;
+   confy::JsonStoreFile otherVersion(storeFile, 3, "test store");
+   REQUIRE(otherVersion.Read(readEntries, error));
+   CHECK(read.is_null());
+
+   // Malformed JSON, or entries the reader rejects, fail the read.
+   {
+      std::ofstream output(storeFile, std::ios::binary | std::ios::trunc);
+      output << "{\"version\": 2, \"entries\":";
+   }
+   CHECK_FALSE(file.Read(readEntries, error));
+   CHECK(error.find("Failed to parse test store") == 0);
+   REQUIRE(file.Write({{"a", "text"}}, file.Revision(), error));
+   error.clear();
+   CHECK_FALSE(file.Read([](const nlohmann::json &entries) { (void)entries.at("a").get<int>(); }, error));
+   CHECK_FALSE(error.empty());
+
+   // A directory in the way makes the write fail; the change stays unsaved
+   // and no temporary file is left behind.
+   file.MarkChanged();
+   std::filesystem::remove(storeFile);
+   std::filesystem::create_directories(std::filesystem::path(storeFile) / "blocker");
+   CHECK_FALSE(file.Write({{"a", 1}}, file.Revision(), error));
+   CHECK(file.IsModified());
+   std::filesystem::remove_all(storeFile);
+   CHECK(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()) == 0);
+   REQUIRE(file.Write({{"a", 1}}, file.Revision(), error));
+   CHECK(std::filesystem::is_regular_file(storeFile));
+   CHECK_FALSE(file.IsModified());
+
+   std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,78 @@
+#include "Log.h"
+
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+TEST_CASE("Log applies per-module levels before formatting")
+{
+   std::string error;
+   REQUIRE(confy::Log::Configure("warning, nexus=debug", error));
+   // The bare level applies to every module; the override only to nexus.
+   CHECK(confy::Log::IsEnabled(confy::LogModule::Nexus, confy::LogLevel::Debug));
+   CHECK_FALSE(confy::Log::IsEnabled(confy::LogModule::Nexus, confy::LogLevel::Trace));
+   CHECK_FALSE(confy::Log::IsEnabled(confy::LogModule::Git, confy::LogLevel::Info));
+   CHECK(confy::Log::IsEnabled(confy::LogModule::Git, confy::LogLevel::Error));
+
+   // Invalid specs are rejected as a whole and leave the levels as they were.
+   CHECK_FALSE(confy::Log::Configure("info,nexus=loud", error));
+   CHECK_FALSE(confy::Log::Configure("info,unknown=debug", error));
+   CHECK_FALSE(confy::Log::IsEnabled(confy::LogModule::Git, confy::LogLevel::Info));
+
+   // Disabled records never reach the sink, and their arguments are not evaluated.
+   std::mutex mutex;
+   std::vector<std::string> messages;
+   // Records still queued by earlier tests must not reach this sink.
+   confy::Log::Flush();
+   confy::Log::SetSink([&](confy::LogLevel, confy::LogModule module, const std::string &message) {
+      std::scoped_lock lock(mutex);
+      messages.push_back(std::string(confy::Log::ModuleName(module)) + ": " + message);
+   });
+   int evaluations = 0;
+   CONFY_LOG(confy::LogModule::Git, confy::LogLevel::Info, "skipped %d", ++evaluations);
+   CONFY_LOG(confy::LogModule::Nexus, confy::LogLevel::Debug, "file %d of %d", 1, 2);
+   CONFY_LOG(confy::LogModule::Git, confy::LogLevel::Error, "%s", std::string(600, 'x').c_str());
+   confy::Log::Flush();
+   CHECK(evaluations == 0);
+   {
+      std::scoped_lock lock(mutex);
+      REQUIRE(messages.size() == 2);
+      CHECK(messages[0] == "nexus: file 1 of 2");
+      // Messages longer than the formatting buffer are kept whole.
+      CHECK(messages[1] == "git: " + std::string(600, 'x'));
+   }
+
+   confy::Log::SetSink(nullptr);
+   confy::Log::SetLevel(confy::LogLevel::Info);
+}
+
+TEST_CASE("Log rotates its file once it reaches the size limit")
+{
+   const auto directory = std::filesystem::temp_directory_path() / "confy-log-test";
+   std::filesystem::remove_all(directory);
+   const auto logFile = (directory / "confy.log").string();
+
+   std::string error;
+   confy::Log::Flush();
+   confy::Log::SetSink([](confy::LogLevel, confy::LogModule, const std::string &) {});
+   REQUIRE(confy::Log::OpenFile(logFile, 256, 2, error));
+   for (int i = 0; i < 40; ++i) {
+      CONFY_LOG(confy::LogModule::General, confy::LogLevel::Info, "line %02d of the rotation test", i);
+   }
+   confy::Log::Flush();
+   confy::Log::CloseFile();
+   confy::Log::SetSink(nullptr);
+
+   // The current file and two rotated ones are kept, each below the limit.
+   CHECK(std::filesystem::exists(logFile));
+   CHECK(std::filesystem::exists(logFile + ".1"));
+   CHECK(std::filesystem::exists(logFile + ".2"));
+   CHECK_FALSE(std::filesystem::exists(logFile + ".3"));
+   CHECK(std::filesystem::file_size(logFile) <= 256);
+   CHECK(std::filesystem::file_size(logFile + ".1") <= 256);
+
+   std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,50 @@
+#include "MetadataCache.h"
+
+#include <doctest/doctest.h>
+
+#include <filesystem>
+
+TEST_CASE("MetadataCache persists entries and reports freshness")
+{
+   const auto cacheFile =
+       (std::filesystem::temp_directory_path() / "confy-metadata-cache-test" / "metadata.json").string();
+   std::filesystem::remove_all(std::filesystem::path(cacheFile).parent_path());
+
+   const auto key = confy::MetadataCache::BuildKey("git-refs", "https://example.com/scm/prj/repo.git");
+   std::vector<std::string> values;
+   std::string error;
+
+   {
+      confy::MetadataCache cache(cacheFile, std::chrono::hours(1));
+      // A missing cache file loads as an empty cache.
+      REQUIRE(cache.Load(error));
+      CHECK(cache.Lookup(key, values) == confy::MetadataCache::Freshness::Missing);
+
+      CHECK(cache.Store(key, {"main", "release/1.0", "v1.0.0"}));
+      CHECK(cache.Lookup(key, values) == confy::MetadataCache::Freshness::Fresh);
+      REQUIRE(cache.SaveIfModified(error));
+      CHECK(std::filesystem::exists(cacheFile));
+
+      // Storing identical values refreshes the entry but reports no change.
+      CHECK_FALSE(cache.Store(key, {"main", "release/1.0", "v1.0.0"}));
+      REQUIRE(cache.Save(error));
+   }
+
+   {
+      confy::MetadataCache cache(cacheFile, std::chrono::hours(1));
+      // Entries survive a reload with their values intact.
+      REQUIRE(cache.Load(error));
+      CHECK(cache.Lookup(key, values) == confy::MetadataCache::Freshness::Fresh);
+      CHECK(values == std::vector<std::string>{"main", "release/1.0", "v1.0.0"});
+   }
+
+   {
+      confy::MetadataCache cache(cacheFile, std::chrono::seconds(0));
+      // Expired entries are still returned, flagged for revalidation.
+      REQUIRE(cache.Load(error));
+      CHECK(cache.Lookup(key, values) == confy::MetadataCache::Freshness::Stale);
+      CHECK(values.size() == 3);
+   }
+
+   std::filesystem::remove_all(std::filesystem::path(cacheFile).parent_path());
+}
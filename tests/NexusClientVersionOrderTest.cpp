@@ -0,0 +1,27 @@
+#include "NexusClient.h"
+
+#include <vector>
+
+#include <doctest/doctest.h>
+
+TEST_CASE("NexusClient orders versions numerically")
+{
+   // Digit runs compare by value rather than lexically.
+   CHECK(confy::NexusClient::IsNewerVersion("1.10.0", "1.9.3"));
+   CHECK(confy::NexusClient::IsNewerVersion("2.0", "1.99"));
+   CHECK_FALSE(confy::NexusClient::IsNewerVersion("1.2.3", "1.2.3"));
+   CHECK(confy::NexusClient::IsNewerVersion("1.2.3.1", "1.2.3"));
+   CHECK_FALSE(confy::NexusClient::IsNewerVersion("1.02", "1.2"));
+
+   const std::vector<std::string> versions{"1.9.0", "1.10.0", "0.5.1", "1.10.2", "1.2.0"};
+   const auto newest = confy::NexusClient::SelectNewestVersions(versions, 3);
+
+   // The newest versions are returned newest first.
+   REQUIRE(newest.size() == 3);
+   CHECK(newest[0] == "1.10.2");
+   CHECK(newest[1] == "1.10.0");
+   CHECK(newest[2] == "1.9.0");
+
+   // Asking for more versions than exist returns all of them.
+   CHECK(confy::NexusClient::SelectNewestVersions(versions, 10).size() == versions.size());
+}
@@ -43,6 +43,11 @@ TEST_CASE("ConfigLoader parses representative config XML")
                 <url>https://bitbucket.example.com/project/another-repo.git</url>
                 <BranchOrTag>release/1.0</BranchOrTag>
                 <NoShallow/>
+                <Filter>blob:none</Filter>
+                <SparseCheckout>
+                    <path>libs/core</path>
+                    <path>tools</path>
+                </SparseCheckout>
                 <Script></Script>
             </Source>
         </Component>
@@ -228,6 +233,13 @@ TEST_CASE("ConfigLoader parses representative config XML")
    CHECK(!second.artifactPresent);
    CHECK(second.source.enabled);
    CHECK(!second.source.shallow);
+   // Partial clone and sparse-checkout options should be read from the Source block.
+   CHECK(second.source.filter == "blob:none");
+   REQUIRE(second.source.sparsePaths.size() == 2);
+   CHECK(second.source.sparsePaths[0] == "libs/core");
+   CHECK(second.source.sparsePaths[1] == "tools");
+   CHECK(first.source.filter.empty());
+   CHECK(first.source.sparsePaths.empty());
 
    const auto &last = model.components[11];
    // The last component should remain source-only and enabled.
@@ -0,0 +1,28 @@
+#include "RefListingService.h"
+
+#include <doctest/doctest.h>
+
+TEST_CASE("RefListingService filters refs for type-ahead search")
+{
+   const std::vector<std::string> refs = {"develop", "feature/Login", "feature/logout", "main", "release/1.0"};
+   bool hasMore                        = true;
+
+   // Matching is a case-insensitive substring search that keeps input order.
+   const auto matches = confy::RefListingService::FilterRefs(refs, "LOG", 10, hasMore);
+   REQUIRE(matches.size() == 2);
+   CHECK(matches[0] == "feature/Login");
+   CHECK(matches[1] == "feature/logout");
+   CHECK_FALSE(hasMore);
+
+   // Results are capped at one page and report that more matches exist.
+   const auto firstPage = confy::RefListingService::FilterRefs(refs, "e", 2, hasMore);
+   CHECK(firstPage.size() == 2);
+   CHECK(hasMore);
+
+   // An empty filter matches everything.
+   CHECK(confy::RefListingService::FilterRefs(refs, "", 10, hasMore).size() == refs.size());
+
+   // Only Bitbucket repositories support server-side search.
+   CHECK(confy::RefListingService::SupportsSearch("https://bitbucket.example.com/scm/OPS/confy.git/"));
+   CHECK_FALSE(confy::RefListingService::SupportsSearch("https://github.com/example/confy.git"));
+}
@@ -0,0 +1,38 @@
+#include "RingBuffer.h"
+
+#include <doctest/doctest.h>
+
+#include <string>
+
+TEST_CASE("RingBuffer keeps the newest entries in order")
+{
+   confy::RingBuffer<std::string> buffer(3);
+   buffer.Push("a");
+   buffer.Push("b");
+   // Below capacity nothing is dropped.
+   REQUIRE(buffer.Size() == 2);
+   CHECK(buffer.At(0) == "a");
+   CHECK(buffer.At(1) == "b");
+
+   buffer.Push("c");
+   buffer.Push("d");
+   buffer.Push("e");
+   // Once full, each push replaces the oldest entry.
+   REQUIRE(buffer.Size() == 3);
+   CHECK(buffer.At(0) == "c");
+   CHECK(buffer.At(1) == "d");
+   CHECK(buffer.At(2) == "e");
+
+   buffer.Clear();
+   buffer.Push("f");
+   // Clearing starts over from an empty buffer.
+   REQUIRE(buffer.Size() == 1);
+   CHECK(buffer.At(0) == "f");
+
+   confy::RingBuffer<int> minimal(0);
+   minimal.Push(1);
+   minimal.Push(2);
+   // A zero capacity is treated as one.
+   CHECK(minimal.Capacity() == 1);
+   CHECK(minimal.At(0) == 2);
+}
@@ -0,0 +1,121 @@
+#include "SyncCommand.h"
+
+#include <doctest/doctest.h>
+
+namespace {
+
+confy::ConfigModel MakeSyncConfig()
+{
+   confy::ConfigModel config;
+   config.rootPath = "/tmp/confy-sync";
+
+   confy::ComponentConfig core;
+   core.name                  = "core";
+   core.path                  = "core";
+   core.sourcePresent         = true;
+   core.artifactPresent       = true;
+   core.source.enabled        = true;
+   core.source.url            = "https://example.com/core.git";
+   core.source.branchOrTag    = "main";
+   core.artifact.enabled      = false;
+   core.artifact.url          = "https://nexus.example.com/#browse/browse:raw";
+   core.artifact.relativePath = "products";
+   core.artifact.version      = "1.0.0";
+   core.artifact.buildType    = "Release";
+
+   confy::ComponentConfig tools;
+   tools.name               = "tools";
+   tools.path               = "tools";
+   tools.sourcePresent      = true;
+   tools.source.enabled     = true;
+   tools.source.url         = "https://example.com/tools.git";
+   tools.source.branchOrTag = "develop";
+
+   config.components = {core, tools};
+   return config;
+}
+
+} // namespace
+
+TEST_CASE("ParseSyncArguments reads the config path, job count and overrides")
+{
+   confy::SyncOptions options;
+   bool showHelp = false;
+   std::string errorMessage;
+
+   // Options may come before or after the config path, with or without '='.
+   REQUIRE(confy::ParseSyncArguments({"--jobs", "4", "config.xml", "--ref=core=release/2.0", "--version", "core=2.1.0",
+                                         "--build-type", "core=Debug", "--only", "core,tools", "--format=json"},
+       options,
+       showHelp,
+       errorMessage));
+   CHECK_FALSE(showHelp);
+   CHECK(options.configPath == "config.xml");
+   CHECK(options.jobs == 4);
+   CHECK(options.progressFormat == confy::SyncProgressFormat::JsonLines);
+   CHECK(options.refOverrides.at("core") == "release/2.0");
+   CHECK(options.versionOverrides.at("core") == "2.1.0");
+   CHECK(options.buildTypeOverrides.at("core") == "Debug");
+   CHECK(options.onlyComponents == std::vector<std::string>{"core", "tools"});
+
+   // --plan-output implies --dry-run.
+   REQUIRE(confy::ParseSyncArguments({"config.xml", "--plan-output", "plan.txt"}, options, showHelp, errorMessage));
+   CHECK(options.dryRun);
+   CHECK(options.planOutput == "plan.txt");
+   REQUIRE(confy::ParseSyncArguments({"--dry-run", "config.xml"}, options, showHelp, errorMessage));
+   CHECK(options.dryRun);
+   CHECK(options.planOutput.empty());
+
+   // --help wins over missing or invalid arguments.
+   CHECK(confy::ParseSyncArguments({"--help", "--jobs", "0"}, options, showHelp, errorMessage));
+   CHECK(showHelp);
+
+   // Invalid input is reported, not guessed at.
+   CHECK_FALSE(confy::ParseSyncArguments({}, options, showHelp, errorMessage));
+   CHECK_FALSE(confy::ParseSyncArguments({"config.xml", "--jobs", "0"}, options, showHelp, errorMessage));
+   CHECK_FALSE(confy::ParseSyncArguments({"config.xml", "--jobs", "4x"}, options, showHelp, errorMessage));
+   CHECK_FALSE(confy::ParseSyncArguments({"config.xml", "--ref", "core"}, options, showHelp, errorMessage));
+   CHECK_FALSE(confy::ParseSyncArguments({"config.xml", "--format", "xml"}, options, showHelp, errorMessage));
+   CHECK_FALSE(confy::ParseSyncArguments({"config.xml", "--bogus", "1"}, options, showHelp, errorMessage));
+   CHECK_FALSE(confy::ParseSyncArguments({"a.xml", "b.xml"}, options, showHelp, errorMessage));
+   CHECK_FALSE(confy::ParseSyncArguments({"config.xml", "--jobs"}, options, showHelp, errorMessage));
+}
+
+TEST_CASE("ApplySyncOverrides selects components and overrides refs and versions")
+{
+   std::string errorMessage;
+
+   confy::SyncOptions options;
+   options.onlyComponents           = {"core"};
+   options.refOverrides["core"]     = "release/2.0";
+   options.versionOverrides["core"] = "2.1.0";
+
+   auto config = MakeSyncConfig();
+   REQUIRE(confy::ApplySyncOverrides(options, config, errorMessage));
+   // --only disables everything else; a version override enables the artifact.
+   CHECK(config.components[0].source.branchOrTag == "release/2.0");
+   CHECK(config.components[0].artifact.enabled);
+   CHECK(config.components[0].artifact.version == "2.1.0");
+   CHECK(config.components[0].artifact.buildType == "Release");
+   CHECK_FALSE(config.components[1].source.enabled);
+
+   std::uint64_t nextJobId = 10;
+   const auto jobs         = confy::BuildDownloadJobs(config, confy::SourceJobSettings{}, nextJobId);
+   REQUIRE(jobs.size() == 2);
+   CHECK(jobs[0].kind == confy::DownloadJobKind::GitSource);
+   CHECK(jobs[0].JobId() == 10);
+   CHECK(jobs[1].artifact.artifactPath == "products/core");
+   CHECK(nextJobId == 12);
+
+   // Unknown components and sections a component lacks are errors.
+   confy::SyncOptions unknown;
+   unknown.refOverrides["missing"] = "main";
+   config                          = MakeSyncConfig();
+   CHECK_FALSE(confy::ApplySyncOverrides(unknown, config, errorMessage));
+   CHECK(errorMessage.find("missing") != std::string::npos);
+
+   confy::SyncOptions noArtifact;
+   noArtifact.versionOverrides["tools"] = "1.0";
+   config                               = MakeSyncConfig();
+   CHECK_FALSE(confy::ApplySyncOverrides(noArtifact, config, errorMessage));
+}
@@ -0,0 +1,42 @@
+#include "TailBuffer.h"
+
+#include <doctest/doctest.h>
+
+#include <string>
+
+TEST_CASE("TailBuffer keeps the last bytes and starts at a boundary")
+{
+   confy::TailBuffer small(16);
+   small.Append("abc\n");
+   small.Append("def\n");
+   // Below the limit the text comes back unchanged and without a marker.
+   CHECK(small.Dropped() == 0);
+   CHECK(small.Str() == "abc\ndef\n");
+
+   confy::TailBuffer lines(10);
+   lines.Append("line one\nline two\nend\n");
+   // 12 bytes fall off the front, and the remaining "e two\n" is only part
+   // of a line, so the tail resumes at the next complete line.
+   CHECK(lines.Dropped() == 12);
+   CHECK(lines.Str() == "[... 18 bytes omitted ...]\nend\n");
+
+   confy::TailBuffer exact(8);
+   exact.Append("0123");
+   exact.Append("456789AB");
+   // A chunk longer than the whole buffer replaces everything held; the
+   // limit is exact when there is no line break to align to.
+   CHECK(exact.Dropped() == 4);
+   CHECK(exact.Str() == "[... 4 bytes omitted ...]\n456789AB");
+
+   confy::TailBuffer utf8(5);
+   // "ü" is two bytes and "€" three; the cut falls inside the first "€".
+   utf8.Append("x\xC3\xBC\xE2\x82\xAC\xE2\x82\xAC");
+   REQUIRE(utf8.Dropped() == 4);
+   // The leftover continuation bytes of "€" are skipped.
+   CHECK(utf8.Str() == "[... 6 bytes omitted ...]\n\xE2\x82\xAC");
+
+   confy::TailBuffer trailing(6);
+   trailing.Append("abcdefgh\n");
+   // A line break only at the very end leaves nothing to align to.
+   CHECK(trailing.Str() == "[... 3 bytes omitted ...]\ndefgh\n");
+}
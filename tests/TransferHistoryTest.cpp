@@ -0,0 +1,40 @@
+#include "TransferHistory.h"
+
+#include <doctest/doctest.h>
+
+#include <filesystem>
+
+TEST_CASE("TransferHistory averages samples and survives a reload")
+{
+   const auto historyFile = (std::filesystem::temp_directory_path() / "confy-transfer-history-test" / "history.json").string();
+   std::filesystem::remove_all(std::filesystem::path(historyFile).parent_path());
+
+   std::string error;
+   double seconds = 0.0;
+   {
+      confy::TransferHistory history(historyFile);
+      REQUIRE(history.Load(error));
+      CHECK_FALSE(history.EstimateSourceSeconds("https://git.example.com/scm/prj/core.git", seconds));
+
+      // The first sample is taken as is, later ones move the average towards them.
+      history.RecordSource("https://git.example.com/scm/prj/core.git", std::chrono::seconds(10));
+      history.RecordSource("https://git.example.com/scm/prj/core.git", std::chrono::seconds(20));
+      REQUIRE(history.EstimateSourceSeconds("https://git.example.com/scm/prj/core.git", seconds));
+      CHECK(seconds == doctest::Approx(13.0));
+
+      // Throughput is shared by every repository on the same host.
+      history.RecordArtifact("https://nexus.example.com/#browse/browse:a", 4096, std::chrono::seconds(2));
+      REQUIRE(history.EstimateArtifactSeconds("https://nexus.example.com/#browse/browse:b", 8192, seconds));
+      CHECK(seconds == doctest::Approx(4.0));
+      REQUIRE(history.SaveIfModified(error));
+   }
+
+   {
+      confy::TransferHistory history(historyFile);
+      REQUIRE(history.Load(error));
+      REQUIRE(history.EstimateSourceSeconds("https://git.example.com/scm/prj/core.git", seconds));
+      CHECK(seconds == doctest::Approx(13.0));
+   }
+
+   std::filesystem::remove_all(std::filesystem::path(historyFile).parent_path());
+}